@@ -100,6 +100,180 @@ drizzle_return_t drizzle_binlog_start(drizzle_binlog_st *binlog,
                                         const char *file,
                                         uint32_t start_position);
 
+/**
+* Start the binlog transaction from a set of executed GTIDs
+*
+* The server sends every transaction which is not part of 'gtid_set', starting
+* from the oldest binlog file which holds one, like a replica with
+* auto-positioning does. A GTID set is a comma separated list of server UUIDs,
+* each followed by one or more ranges of transaction numbers, for example
+* "3e11fa47-71ca-11e1-9e33-c80aa9429562:1-5:7-9". An empty string requests
+* every transaction the server still has.
+*
+* The set is then kept up to date with the GTID of every transaction received,
+* see drizzle_binlog_get_gtid_set(). Other than the start, this behaves like
+* drizzle_binlog_start(). The server needs gtid_mode enabled. The set is
+* parsed before the server is contacted and kept if starting fails.
+*
+* @param[in] binlog    A binlog object created using drizzle_binlog_init()
+* @param[in] server_id A unique server ID (or 0) to connect to the MySQL server
+*                      with
+* @param[in] gtid_set  The transactions which have already been received
+* @return A Drizzle return type. DRIZZLE_RETURN_OK upon success,
+*         DRIZZLE_RETURN_INVALID_ARGUMENT if gtid_set can not be parsed.
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_start_gtid(drizzle_binlog_st *binlog,
+                                           uint32_t server_id,
+                                           const char *gtid_set);
+
+/**
+* Get the set of GTIDs received so far
+*
+* The set starts as the one passed to drizzle_binlog_start_gtid(), or empty
+* for drizzle_binlog_start(), and a transaction is added to it once its commit
+* has been received. Called from the event callback this is the position to
+* restart from after the current event.
+*
+* When events are read from a ring, a transaction is only added once its
+* commit event has been given back with drizzle_binlog_ring_release(). The
+* thread reading the ring may call this, and after releasing only handled
+* events gets the position to restart from after them.
+*
+* The set is allocated by the function and needs to be freed by the
+* application when finished with.
+*
+* @param[in]  binlog   A binlog object created using drizzle_binlog_init()
+* @param[out] gtid_set The GTID set, in the text form used by MySQL
+* @return A Drizzle return type. DRIZZLE_RETURN_OK upon success.
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_get_gtid_set(drizzle_binlog_st *binlog,
+                                             char **gtid_set);
+
+/**
+* Read the binlog from local files instead of a server
+*
+* 'path' is a binlog file, a binlog index file listing files one per line, or
+* a directory holding one index file. Relative names in an index file are
+* relative to the directory of the index. Each file is mapped into memory and
+* its events are handed to the event callback, or the ring, as
+* drizzle_binlog_start() does. Their data points into the mapping and is only
+* valid until the callback returns. The connection the binlog object was
+* created for is only used to report errors, it does not need to be
+* connected, and the binlog object is not freed with it.
+*
+* @param[in] binlog A binlog object created using drizzle_binlog_init()
+* @param[in] path   The binlog file, index file or directory to read
+* @return DRIZZLE_RETURN_EOF once every event was read, otherwise the error
+*         which stopped the reader
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_start_file(drizzle_binlog_st *binlog,
+                                           const char *path);
+
+/**
+* Create a ring which hands binlog events from the thread running
+* drizzle_binlog_start() to a single consumer thread
+*
+* Each event is copied into the ring, so it stays valid until the consumer
+* releases it. Events are published to the consumer in batches of
+* 'batch_size', or earlier when no further event is buffered and the reader is
+* about to wait for the network. When the ring is full the reading thread
+* waits for the consumer to release events.
+*
+* @param[in] event_count The maximum number of events held by the ring
+* @param[in] data_size   The number of bytes of raw event data held by the
+*                        ring, which limits the size of a single event
+* @param[in] batch_size  The number of events published at once, 0 for one
+* @return The new ring, or NULL on failure
+*/
+DRIZZLE_API
+drizzle_binlog_ring_st *drizzle_binlog_ring_create(uint32_t event_count,
+                                                   size_t data_size,
+                                                   uint32_t batch_size);
+
+/**
+* Frees a ring created with drizzle_binlog_ring_create()
+*
+* Neither side may be using the ring when it is freed.
+*
+* @param[in] ring The ring to be freed
+*/
+DRIZZLE_API
+void drizzle_binlog_ring_free(drizzle_binlog_ring_st *ring);
+
+/**
+* Make the binlog stream copy its events into a ring instead of calling the
+* event callback
+*
+* Must be called before drizzle_binlog_start(), which marks the ring as
+* finished with its own return value when it returns. Passing NULL goes back
+* to the event callback.
+*
+* @param[in] binlog A binlog object created using drizzle_binlog_init()
+* @param[in] ring   A ring created using drizzle_binlog_ring_create(), or NULL
+* @return DRIZZLE_RETURN_OK on success, DRIZZLE_RETURN_INVALID_ARGUMENT if
+*         binlog is NULL
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_set_ring(drizzle_binlog_st *binlog,
+                                         drizzle_binlog_ring_st *ring);
+
+/**
+* Leave the checksum verification of the events to the thread reading the ring
+*
+* When the binlog object was created to verify checksums, the thread running
+* drizzle_binlog_start() then only copies each event into the ring, and
+* drizzle_binlog_ring_read() verifies the events it returns. Must be called
+* before drizzle_binlog_start().
+*
+* @param[in] ring   A ring created using drizzle_binlog_ring_create()
+* @param[in] verify Set to true to verify checksums when events are read
+* @return DRIZZLE_RETURN_OK on success, DRIZZLE_RETURN_INVALID_ARGUMENT if
+*         ring is NULL
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_ring_set_verify_checksums(drizzle_binlog_ring_st *ring,
+                                                          bool verify);
+
+/**
+* Get the next batch of events from a ring, waiting until one is published
+*
+* The events are returned from the oldest one not yet released, so calling
+* this again without drizzle_binlog_ring_release() returns the same events.
+* Only one thread may read from a ring.
+*
+* @param[in]  ring       The ring to read from
+* @param[out] event_list Array to store pointers to up to 'count' events into
+* @param[in]  count      The size of event_list
+* @param[out] ret_ptr    DRIZZLE_RETURN_OK if events were returned. Once the
+*                        stream has ended and the ring is drained,
+*                        DRIZZLE_RETURN_EOF or the error returned by
+*                        drizzle_binlog_start(). DRIZZLE_RETURN_BINLOG_CRC
+*                        with the single event whose checksum does not match,
+*                        if the ring verifies checksums.
+* @return The number of events stored in event_list
+*/
+DRIZZLE_API
+uint32_t drizzle_binlog_ring_read(drizzle_binlog_ring_st *ring,
+                                  drizzle_binlog_event_st **event_list,
+                                  uint32_t count, drizzle_return_t *ret_ptr);
+
+/**
+* Give the oldest events returned by drizzle_binlog_ring_read() back to the
+* ring, after which their data may be overwritten
+*
+* The transactions the events commit are added to the set returned by
+* drizzle_binlog_get_gtid_set(), so events should only be released once they
+* are handled.
+*
+* @param[in] ring  The ring the events were read from
+* @param[in] count The number of events to release
+*/
+DRIZZLE_API
+void drizzle_binlog_ring_release(drizzle_binlog_ring_st *ring, uint32_t count);
+
 /**
 * Get the timestamp for the event received by the event callback
 *
@@ -193,6 +367,22 @@ const unsigned char *drizzle_binlog_event_raw_data(drizzle_binlog_event_st *even
 DRIZZLE_API
 uint32_t drizzle_binlog_event_raw_length(drizzle_binlog_event_st *event);
 
+/**
+* Compute the CRC32 used by binlog event checksums, the same as zlib's crc32()
+*
+* The checksum of an event is the CRC32 of its raw data without the last 4
+* bytes, which hold the checksum. The CPU's carry-less multiplication is used
+* where available.
+*
+* @param[in] crc  The CRC32 of the data before, 0 to start
+* @param[in] data The data
+* @param[in] size The size of the data
+* @return The CRC32 of the data
+*/
+DRIZZLE_API
+uint32_t drizzle_binlog_crc32(uint32_t crc, const unsigned char *data,
+                              size_t size);
+
 /**
 * Get the event type for the binlog event as string
 *
@@ -233,6 +423,27 @@ DRIZZLE_API
 drizzle_return_t drizzle_binlog_get_filename(drizzle_st *con, char **filename,
                                              uint32_t *end_position, int file_index);
 
+/**
+ * Get the set of GTIDs the server has executed
+ *
+ * Queries the gtid_executed variable of the server. The result can be stored
+ * as a checkpoint and passed to drizzle_binlog_start_gtid() later on to stream
+ * every transaction executed since.
+ *
+ * The gtid_set parameter is allocated by the function and needs to be freed
+ * by the application when finished with.
+ *
+ * @param[in] con Drizzle structure previously initialized with drizzle_create()
+ * @param[out] gtid_set The executed GTID set, empty if gtid_mode is disabled
+ * @return Standard drizzle return value
+ *         - DRIZZLE_RETURN_OK the GTID set was retrieved successfully.
+ *         - DRIZZLE_RETURN_INVALID_ARGUMENT: invalid argument(s)
+ *         - DRIZZLE_RETURN_NOT_FOUND: the server returned no GTID set
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_get_gtid_executed(drizzle_st *con,
+                                                  char **gtid_set);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,306 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Create a decoder for the row events of a binlog stream
+*
+* The decoder keeps the TABLE_MAP events it is given, so the ROWS events which
+* follow them can be split into column values. Up to 4096 table maps are
+* kept, beyond that the least recently used one is dropped.
+*
+* @return The new decoder, or NULL on failure
+*/
+DRIZZLE_API
+drizzle_binlog_rows_st *drizzle_binlog_rows_create(void);
+
+/**
+* Frees a decoder created with drizzle_binlog_rows_create() along with the
+* table maps it holds
+*
+* @param[in] rows The decoder to be freed
+*/
+DRIZZLE_API
+void drizzle_binlog_rows_free(drizzle_binlog_rows_st *rows);
+
+/**
+* Pass a binlog event to the decoder
+*
+* TABLE_MAP events are stored by table id. WRITE_ROWS, UPDATE_ROWS and
+* DELETE_ROWS events become the current event, whose rows are then read with
+* drizzle_binlog_rows_next(). Other events are ignored.
+*
+* Column values refer to the data of the event, which must stay valid until
+* the next event is decoded.
+*
+* @param[in] rows  A decoder created with drizzle_binlog_rows_create()
+* @param[in] event The event from the binlog stream
+* @return DRIZZLE_RETURN_OK on success, DRIZZLE_RETURN_NOT_FOUND if a ROWS event
+*         refers to a table without a table map, DRIZZLE_RETURN_UNEXPECTED_DATA
+*         if the event is malformed or has a column type which can not be
+*         decoded
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_rows_decode(drizzle_binlog_rows_st *rows,
+                                            drizzle_binlog_event_st *event);
+
+/**
+* Move to the next row of the current ROWS event
+*
+* @param[in] rows A decoder which was given a ROWS event
+* @return DRIZZLE_RETURN_OK if a row was read, DRIZZLE_RETURN_ROW_END after the
+*         last row, DRIZZLE_RETURN_UNEXPECTED_DATA if the row is malformed
+*/
+DRIZZLE_API
+drizzle_return_t drizzle_binlog_rows_next(drizzle_binlog_rows_st *rows);
+
+/**
+* Get the table of the current ROWS event
+*
+* @param[in] rows A decoder which was given a ROWS event
+* @return The table, or NULL if there is no current ROWS event
+*/
+DRIZZLE_API
+const drizzle_binlog_table_st *drizzle_binlog_rows_table(drizzle_binlog_rows_st *rows);
+
+/**
+* Check whether the rows of the current event have an image. WRITE_ROWS
+* events only have an after image, DELETE_ROWS events only a before image and
+* UPDATE_ROWS events both.
+*
+* @param[in] rows  A decoder which was given a ROWS event
+* @param[in] image The image to check for
+* @return true if the rows have the image
+*/
+DRIZZLE_API
+bool drizzle_binlog_rows_has_image(drizzle_binlog_rows_st *rows,
+                                   drizzle_binlog_image_t image);
+
+/**
+* Check whether a column of the current row is NULL
+*
+* @param[in]  rows    A decoder positioned on a row
+* @param[in]  image   The row image to read from
+* @param[in]  column  The column number (starting at 0)
+* @param[out] ret_ptr DRIZZLE_RETURN_OK on success, DRIZZLE_RETURN_NOT_FOUND if
+*                     the column is not in the image
+* @return true if the value is NULL
+*/
+DRIZZLE_API
+bool drizzle_binlog_rows_is_null(drizzle_binlog_rows_st *rows,
+                                 drizzle_binlog_image_t image, uint32_t column,
+                                 drizzle_return_t *ret_ptr);
+
+/**
+* Get a column of the current row as a signed integer
+*
+* Integer, YEAR, ENUM, SET, BIT and TIMESTAMP columns convert without loss.
+* Floating point and decimal columns are truncated.
+*
+* @param[in]  rows    A decoder positioned on a row
+* @param[in]  image   The row image to read from
+* @param[in]  column  The column number (starting at 0)
+* @param[out] ret_ptr DRIZZLE_RETURN_OK on success, DRIZZLE_RETURN_NULL_SIZE
+*                     for a NULL value, DRIZZLE_RETURN_NOT_FOUND if the column
+*                     is not in the image, DRIZZLE_RETURN_TRUNCATED if the
+*                     value lost its fraction and
+*                     DRIZZLE_RETURN_INVALID_CONVERSION for other types
+* @return The value
+*/
+DRIZZLE_API
+int64_t drizzle_binlog_rows_get_int(drizzle_binlog_rows_st *rows,
+                                    drizzle_binlog_image_t image,
+                                    uint32_t column, drizzle_return_t *ret_ptr);
+
+/**
+* Get a column of the current row as an unsigned integer, the same as
+* drizzle_binlog_rows_get_int() except that integer columns are not sign
+* extended
+*
+* @param[in]  rows    A decoder positioned on a row
+* @param[in]  image   The row image to read from
+* @param[in]  column  The column number (starting at 0)
+* @param[out] ret_ptr See drizzle_binlog_rows_get_int()
+* @return The value
+*/
+DRIZZLE_API
+uint64_t drizzle_binlog_rows_get_uint(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_image_t image,
+                                      uint32_t column, drizzle_return_t *ret_ptr);
+
+/**
+* Get a numeric column of the current row as a double
+*
+* Integers are treated as signed unless the table map says they are unsigned.
+*
+* @param[in]  rows    A decoder positioned on a row
+* @param[in]  image   The row image to read from
+* @param[in]  column  The column number (starting at 0)
+* @param[out] ret_ptr See drizzle_binlog_rows_get_int()
+* @return The value
+*/
+DRIZZLE_API
+double drizzle_binlog_rows_get_double(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_image_t image,
+                                      uint32_t column, drizzle_return_t *ret_ptr);
+
+/**
+* Get a column of the current row as a string
+*
+* String, blob, JSON, geometry and BIT columns are returned as they are in the
+* event, without a terminating NUL. Numbers, decimals and temporal values are
+* formatted as text into a buffer of the decoder which is overwritten by the
+* next call for the same column.
+*
+* @param[in]  rows    A decoder positioned on a row
+* @param[in]  image   The row image to read from
+* @param[in]  column  The column number (starting at 0)
+* @param[out] size    The size of the value, can be NULL
+* @param[out] ret_ptr See drizzle_binlog_rows_get_int()
+* @return A pointer to the value, or NULL on failure
+*/
+DRIZZLE_API
+const char *drizzle_binlog_rows_get_string(drizzle_binlog_rows_st *rows,
+                                           drizzle_binlog_image_t image,
+                                           uint32_t column, size_t *size,
+                                           drizzle_return_t *ret_ptr);
+
+/**
+* Get the table id of a table map
+*
+* @param[in] table A table returned by drizzle_binlog_rows_table()
+* @return The table id
+*/
+DRIZZLE_API
+uint64_t drizzle_binlog_table_id(const drizzle_binlog_table_st *table);
+
+/**
+* Get the schema name of a table map
+*
+* @param[in] table A table returned by drizzle_binlog_rows_table()
+* @return The schema name
+*/
+DRIZZLE_API
+const char *drizzle_binlog_table_schema(const drizzle_binlog_table_st *table);
+
+/**
+* Get the table name of a table map
+*
+* @param[in] table A table returned by drizzle_binlog_rows_table()
+* @return The table name
+*/
+DRIZZLE_API
+const char *drizzle_binlog_table_name(const drizzle_binlog_table_st *table);
+
+/**
+* Get the number of columns of a table map
+*
+* @param[in] table A table returned by drizzle_binlog_rows_table()
+* @return The number of columns
+*/
+DRIZZLE_API
+uint32_t drizzle_binlog_table_column_count(const drizzle_binlog_table_st *table);
+
+/**
+* Get the type of a column. The real type of ENUM and SET columns is given
+* instead of DRIZZLE_COLUMN_TYPE_STRING.
+*
+* @param[in] table  A table returned by drizzle_binlog_rows_table()
+* @param[in] column The column number (starting at 0)
+* @return The column type
+*/
+DRIZZLE_API
+drizzle_column_type_t drizzle_binlog_table_column_type(const drizzle_binlog_table_st *table,
+                                                       uint32_t column);
+
+/**
+* Get the type specific metadata of a column, such as the maximum length in
+* bytes of a VARCHAR or CHAR, the precision and scale of a DECIMAL or the
+* fractional digits of a DATETIME. For ENUM and SET columns it is the size of
+* the stored value.
+*
+* @param[in] table  A table returned by drizzle_binlog_rows_table()
+* @param[in] column The column number (starting at 0)
+* @return The column metadata
+*/
+DRIZZLE_API
+uint16_t drizzle_binlog_table_column_meta(const drizzle_binlog_table_st *table,
+                                          uint32_t column);
+
+/**
+* Check whether a column can be NULL
+*
+* @param[in] table  A table returned by drizzle_binlog_rows_table()
+* @param[in] column The column number (starting at 0)
+* @return true if the column can be NULL
+*/
+DRIZZLE_API
+bool drizzle_binlog_table_column_nullable(const drizzle_binlog_table_st *table,
+                                          uint32_t column);
+
+/**
+* Check whether a numeric column is unsigned. Only known when the server
+* sends the full table map metadata (binlog_row_metadata=FULL).
+*
+* @param[in] table  A table returned by drizzle_binlog_rows_table()
+* @param[in] column The column number (starting at 0)
+* @return true if the column is unsigned
+*/
+DRIZZLE_API
+bool drizzle_binlog_table_column_is_unsigned(const drizzle_binlog_table_st *table,
+                                             uint32_t column);
+
+/**
+* Get the name of a column. Only known when the server sends the full table
+* map metadata (binlog_row_metadata=FULL).
+*
+* @param[in] table  A table returned by drizzle_binlog_rows_table()
+* @param[in] column The column number (starting at 0)
+* @return The column name, or NULL if it is not known
+*/
+DRIZZLE_API
+const char *drizzle_binlog_table_column_name(const drizzle_binlog_table_st *table,
+                                             uint32_t column);
+
+#ifdef __cplusplus
+}
+#endif
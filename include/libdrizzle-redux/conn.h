@@ -294,6 +294,121 @@ void drizzle_options_set_auth_plugin(drizzle_options_st *options, bool state);
 DRIZZLE_API
 bool drizzle_options_get_auth_plugin(drizzle_options_st *options);
 
+/**
+ * Sets/unsets the result arena option. When set, drizzle_result_buffer()
+ * stores rows, field values, field sizes and NULL bitmaps in a chunked
+ * arena owned by the result instead of allocating every field separately.
+ * The buffered rows are released in one go by drizzle_result_free() and
+ * must not be freed individually with drizzle_row_free().
+ *
+ * @param[in,out] options The options object to modify
+ * @param[in] state Set to true/false
+ */
+DRIZZLE_API
+void drizzle_options_set_result_arena(drizzle_options_st *options, bool state);
+
+/**
+ * Gets the result arena option
+ *
+ * @param[in] options The options object to get the value from
+ * @return The state of the result arena option
+ */
+DRIZZLE_API
+bool drizzle_options_get_result_arena(drizzle_options_st *options);
+
+/**
+ * Sets the compression algorithm for the connection. When set to anything
+ * other than DRIZZLE_COMPRESSION_NONE the compressed protocol is requested
+ * during the handshake, and used if the server supports it. Only
+ * DRIZZLE_COMPRESSION_ZLIB is understood by MySQL servers.
+ *
+ * @param[in,out] options The options object to modify
+ * @param[in] compression The compression algorithm to use
+ */
+DRIZZLE_API
+void drizzle_options_set_compression(drizzle_options_st *options,
+                                     drizzle_compression_t compression);
+
+/**
+ * Gets the compression algorithm option
+ *
+ * @param[in] options The options object to get the value from
+ * @return The compression algorithm requested for the connection
+ */
+DRIZZLE_API
+drizzle_compression_t drizzle_options_get_compression(drizzle_options_st *options);
+
+/**
+ * Sets the number of prepared statements cached per connection. While the
+ * cache is enabled, drizzle_stmt_prepare() hands back an idle statement
+ * prepared earlier with the same SQL text and default schema instead of
+ * preparing it again, and drizzle_stmt_close() keeps the statement prepared
+ * on the server. The least recently used statement is closed when the cache
+ * is full. The default of 0 disables the cache.
+ *
+ * The default schema is the one set with drizzle_select_db(). A USE
+ * statement sent with drizzle_query() is not seen by the cache, so switch
+ * schemas with drizzle_select_db() while the cache is enabled.
+ *
+ * @param[in,out] options The options object to modify
+ * @param[in] size The maximum number of cached statements
+ */
+DRIZZLE_API
+void drizzle_options_set_stmt_cache_size(drizzle_options_st *options,
+                                         uint32_t size);
+
+/**
+ * Gets the prepared statement cache size option
+ *
+ * @param[in] options The options object to get the value from
+ * @return The maximum number of cached statements
+ */
+DRIZZLE_API
+uint32_t drizzle_options_get_stmt_cache_size(drizzle_options_st *options);
+
+/**
+ * Sets the size the buffer of a connection is allocated with. The buffer
+ * grows to hold packets larger than this and shrinks back to this size when
+ * the next command is sent or the connection is returned to a pool. The
+ * size is at least DRIZZLE_MIN_BUFFER_SIZE, the default is
+ * DRIZZLE_DEFAULT_BUFFER_SIZE.
+ *
+ * @param[in,out] options The options object to modify
+ * @param[in] size The initial size of the buffer in bytes
+ */
+DRIZZLE_API
+void drizzle_options_set_buffer_size(drizzle_options_st *options, size_t size);
+
+/**
+ * Gets the initial buffer size option
+ *
+ * @param[in] options The options object to get the value from
+ * @return The initial size of the buffer in bytes
+ */
+DRIZZLE_API
+size_t drizzle_options_get_buffer_size(drizzle_options_st *options);
+
+/**
+ * Sets the size the buffer of a connection may grow to. Reading a packet
+ * that does not fit fails with DRIZZLE_RETURN_INTERNAL_ERROR. The default
+ * is DRIZZLE_MAX_BUFFER_SIZE.
+ *
+ * @param[in,out] options The options object to modify
+ * @param[in] size The maximum size of the buffer in bytes
+ */
+DRIZZLE_API
+void drizzle_options_set_max_buffer_size(drizzle_options_st *options,
+                                         size_t size);
+
+/**
+ * Gets the maximum buffer size option
+ *
+ * @param[in] options The options object to get the value from
+ * @return The maximum size of the buffer in bytes
+ */
+DRIZZLE_API
+size_t drizzle_options_get_max_buffer_size(drizzle_options_st *options);
+
 /**
  * Sets the owner of the socket connection
  *
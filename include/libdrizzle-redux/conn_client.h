@@ -115,6 +115,20 @@ drizzle_result_st *drizzle_kill(drizzle_st *con,
 DRIZZLE_API
 drizzle_result_st *drizzle_ping(drizzle_st *con, drizzle_return_t *ret_ptr);
 
+/**
+ * Reset the session state of the connection on the server, such as user
+ * variables, temporary tables and prepared statements, without logging in
+ * again. Requires MySQL 5.7 or MariaDB 10.2.
+ *
+ * @param[in] con Connection structure previously initialized with drizzle_create().
+ * @param[out] ret_ptr Standard drizzle return value.
+ * @return On success, a pointer to the (possibly allocated) structure. On
+ *  failure this will be NULL.
+ */
+DRIZZLE_API
+drizzle_result_st *drizzle_reset_connection(drizzle_st *con,
+                                            drizzle_return_t *ret_ptr);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -79,14 +79,20 @@ extern "C" {
 #define DRIZZLE_MAX_COLUMN_NAME_SIZE     2048
 #define DRIZZLE_MAX_DEFAULT_VALUE_SIZE   2048
 #define DRIZZLE_MAX_PACKET_SIZE          UINT32_MAX
+#define DRIZZLE_MAX_PAYLOAD_SIZE         0xFFFFFF
 #define DRIZZLE_MAX_BUFFER_SIZE          1024*1024*1024
 #define DRIZZLE_DEFAULT_BUFFER_SIZE      1024*1024
+#define DRIZZLE_MIN_BUFFER_SIZE          4096
 #define DRIZZLE_BUFFER_COPY_THRESHOLD    8192
 #define DRIZZLE_MAX_SERVER_VERSION_SIZE  32
 #define DRIZZLE_MAX_SERVER_EXTRA_SIZE    32
 #define DRIZZLE_MAX_SCRAMBLE_SIZE        20
 #define DRIZZLE_STATE_STACK_SIZE         8
 #define DRIZZLE_ROW_GROW_SIZE            8192
+#define DRIZZLE_DEFAULT_PIPELINE_WINDOW  64
+#define DRIZZLE_DEFAULT_POOL_SPARE       1
+#define DRIZZLE_DEFAULT_POOL_IDLE_TIME   60
+#define DRIZZLE_DEFAULT_POOL_PING_TIME   30
 #define DRIZZLE_DEFAULT_SOCKET_TIMEOUT   10
 #define DRIZZLE_DEFAULT_SOCKET_SEND_SIZE DRIZZLE_DEFAULT_BUFFER_SIZE
 #define DRIZZLE_DEFAULT_SOCKET_RECV_SIZE DRIZZLE_DEFAULT_BUFFER_SIZE
@@ -96,6 +102,7 @@ extern "C" {
 #define DRIZZLE_BINLOG_CHECKSUM_VERSION  "5.6.1"
 
 #define DRIZZLE_BINLOG_MAGIC             "\xFE\x62\x69\x6E"
+#define DRIZZLE_BINLOG_UUID_SIZE         16
 
 /** @} */
 
@@ -181,7 +188,8 @@ enum drizzle_result_options_t
   DRIZZLE_RESULT_BUFFER_ROW=    (1 << 3),
   DRIZZLE_RESULT_EOF_PACKET=    (1 << 4),
   DRIZZLE_RESULT_ROW_BREAK=     (1 << 5),
-  DRIZZLE_RESULT_BINARY_ROWS=   (1 << 6)
+  DRIZZLE_RESULT_BINARY_ROWS=   (1 << 6),
+  DRIZZLE_RESULT_BUFFER_COLUMNAR= (1 << 7)
 };
 
 #ifndef __cplusplus
@@ -227,6 +235,7 @@ enum drizzle_column_type_t
   DRIZZLE_COLUMN_TYPE_TIMESTAMP2,
   DRIZZLE_COLUMN_TYPE_DATETIME2,
   DRIZZLE_COLUMN_TYPE_TIME2,
+  DRIZZLE_COLUMN_TYPE_JSON=        245,
   DRIZZLE_COLUMN_TYPE_NEWDECIMAL=  246,
   DRIZZLE_COLUMN_TYPE_ENUM=        247,
   DRIZZLE_COLUMN_TYPE_SET=         248,
@@ -293,6 +302,16 @@ typedef enum
 
 typedef drizzle_socket_owner_t drizzle_socket_owner __attribute__ ((deprecated));
 
+/**
+ * @ingroup drizzle_con
+ * Compression algorithms for the compressed client/server protocol
+ */
+typedef enum
+{
+  DRIZZLE_COMPRESSION_NONE= 0,
+  DRIZZLE_COMPRESSION_ZLIB
+} drizzle_compression_t;
+
 /**
  * @ingroup drizzle_con
  * Available options to set for the socket connection
@@ -360,6 +379,12 @@ typedef enum
   DRIZZLE_EVENT_TYPE_END
 } drizzle_binlog_event_types_t;
 
+typedef enum
+{
+  DRIZZLE_BINLOG_IMAGE_BEFORE,
+  DRIZZLE_BINLOG_IMAGE_AFTER
+} drizzle_binlog_image_t;
+
 typedef enum
 {
   DRIZZLE_CHARSET_NONE= 0,
@@ -591,6 +616,12 @@ typedef struct drizzle_result_st drizzle_result_st;
 typedef struct drizzle_column_st drizzle_column_st;
 typedef struct drizzle_binlog_st drizzle_binlog_st;
 typedef struct drizzle_binlog_event_st drizzle_binlog_event_st;
+typedef struct drizzle_binlog_ring_st drizzle_binlog_ring_st;
+typedef struct drizzle_binlog_rows_st drizzle_binlog_rows_st;
+typedef struct drizzle_binlog_table_st drizzle_binlog_table_st;
+typedef struct drizzle_pipeline_st drizzle_pipeline_st;
+typedef struct drizzle_group_st drizzle_group_st;
+typedef struct drizzle_pool_st drizzle_pool_st;
 typedef struct drizzle_stmt_st drizzle_stmt_st;
 typedef struct drizzle_bind_st drizzle_bind_st;
 typedef char *drizzle_field_t;
@@ -619,6 +650,29 @@ typedef drizzle_return_t (drizzle_event_watch_fn)(drizzle_st *con,
                                                   short events,
                                                   void *context);
 
+/**
+ * Custom function to supply the data of a LOAD DATA LOCAL INFILE statement.
+ * See drizzle_set_infile_fn().
+ *
+ * @param[in] con Connection the server asked for the file on.
+ * @param[in] filename Name of the file as given in the statement.
+ * @param[out] buffer Buffer to copy the next chunk of data into.
+ * @param[in] buffer_size Size of the buffer, at most one packet payload.
+ * @param[out] read_size Number of bytes copied into the buffer, 0 when all
+ *  the data has been sent.
+ * @param[in] context Application context pointer registered with
+ *  drizzle_set_infile_fn().
+ * @return DRIZZLE_RETURN_OK if successful, DRIZZLE_RETURN_IO_WAIT if no data
+ *  is available yet on a non-blocking connection. Any other value aborts the
+ *  statement and closes the connection.
+ */
+typedef drizzle_return_t (drizzle_infile_fn)(drizzle_st *con,
+                                             const char *filename,
+                                             unsigned char *buffer,
+                                             size_t buffer_size,
+                                             size_t *read_size,
+                                             void *context);
+
 /** @} */
 
 /**
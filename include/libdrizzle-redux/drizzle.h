@@ -183,6 +183,28 @@ void drizzle_set_event_watch_fn(drizzle_st *con,
                                 drizzle_event_watch_fn *function,
                                 void *context);
 
+/**
+ * Set a function to supply the data of LOAD DATA LOCAL INFILE statements.
+ * The server is only told the client can send local files when a function
+ * is set before connecting. When the server asks for a file, the function
+ * is called repeatedly to fill one packet at a time, which is sent before
+ * the function is called again, until it reports no more data. The name of
+ * the file is passed on as is, so the function decides what it maps to: a
+ * file it reads in chunks, a region of memory or data generated on the fly.
+ * On a non-blocking connection the function may return
+ * DRIZZLE_RETURN_IO_WAIT, which is passed on to the caller of
+ * drizzle_query(). Calling it again resumes sending. Any other error aborts
+ * the statement by closing the connection. See drizzle_infile_fn().
+ *
+ * @param[in] con Drizzle structure previously initialized with drizzle_create().
+ * @param[in] function Function to call for the data of the file, or NULL to
+ *  disable LOAD DATA LOCAL INFILE.
+ * @param[in] context Argument to pass into the callback function.
+ */
+DRIZZLE_API
+void drizzle_set_infile_fn(drizzle_st *con, drizzle_infile_fn *function,
+                           void *context);
+
 
 /**
  * Wait for I/O on connections.
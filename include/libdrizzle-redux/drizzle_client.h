@@ -64,6 +64,10 @@
 #include <libdrizzle-redux/error.h>
 #include <libdrizzle-redux/ssl.h>
 #include <libdrizzle-redux/binlog.h>
+#include <libdrizzle-redux/binlog_rows.h>
+#include <libdrizzle-redux/pipeline.h>
+#include <libdrizzle-redux/group.h>
+#include <libdrizzle-redux/pool.h>
 #include <libdrizzle-redux/statement.h>
 #include <libdrizzle-redux/version.h>
 
@@ -0,0 +1,138 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @brief Connection group declarations
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup drizzle_group Connection Groups
+ * @ingroup drizzle_client_interface
+ * Wait for I/O on many non-blocking connections at once. A group watches
+ * the sockets of its connections, edge-triggered with epoll where it is
+ * available, and hands back every connection that can make progress.
+ * @{
+ */
+
+/**
+ * Create an empty connection group.
+ *
+ * @return A newly allocated group, or NULL on failure.
+ */
+DRIZZLE_API
+drizzle_group_st *drizzle_group_create(void);
+
+/**
+ * Free a group. Its connections are removed from it first, but are neither
+ * closed nor freed.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ */
+DRIZZLE_API
+void drizzle_group_free(drizzle_group_st *group);
+
+/**
+ * Add a connection to a group. The connection is switched to non-blocking
+ * mode and its event watcher is replaced by the group's until it is
+ * removed, so it must not already be in a group. A connection has to be
+ * removed from its group before it is freed.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ * @param[in] con Connection to add.
+ * @return Standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_group_add(drizzle_group_st *group, drizzle_st *con);
+
+/**
+ * Remove a connection from a group, restoring the event watcher and the
+ * blocking mode it had before it was added.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ * @param[in] con Connection to remove.
+ * @return Standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_group_remove(drizzle_group_st *group, drizzle_st *con);
+
+/**
+ * Get the number of connections in a group.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ * @return The number of connections.
+ */
+DRIZZLE_API
+uint32_t drizzle_group_count(const drizzle_group_st *group);
+
+/**
+ * Wait for I/O on the connections of a group until at least one connection
+ * that returned DRIZZLE_RETURN_IO_WAIT can make progress. Those connections
+ * are collected with drizzle_group_ready(), after which the function that
+ * returned DRIZZLE_RETURN_IO_WAIT has to be called again for each of them.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ * @param[in] timeout Milliseconds to wait for I/O each time the group
+ *  waits, or -1 to wait without a limit.
+ * @return DRIZZLE_RETURN_OK when connections are ready, DRIZZLE_RETURN_TIMEOUT
+ *  when the timeout expired first, DRIZZLE_RETURN_NO_ACTIVE_CONNECTIONS when
+ *  no connection waits on I/O, or another standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_group_wait(drizzle_group_st *group, int timeout);
+
+/**
+ * Get the next connection that became ready during drizzle_group_wait(),
+ * in the order they became ready.
+ *
+ * @param[in] group Group previously created with drizzle_group_create().
+ * @return The connection, or NULL if no more connections are ready.
+ */
+DRIZZLE_API
+drizzle_st *drizzle_group_ready(drizzle_group_st *group);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
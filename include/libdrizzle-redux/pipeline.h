@@ -0,0 +1,145 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @brief Pipelined query declarations
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup drizzle_pipeline Pipelined Queries
+ * @ingroup drizzle_client_interface
+ * Send several queries on a connection without waiting for the result of
+ * each one before writing the next. Results are returned in the order the
+ * queries were queued.
+ * @{
+ */
+
+/**
+ * Create a pipeline for a connection. At most window queries are sent ahead
+ * of the result currently being read, so the server is never left blocked
+ * writing results the client has not started to read.
+ *
+ * While a pipeline has queries pending no other command may be issued on
+ * the connection.
+ *
+ * @param[in] con Connection the queries are sent on.
+ * @param[in] window Maximum number of queries in flight, or 0 for
+ *  DRIZZLE_DEFAULT_PIPELINE_WINDOW.
+ * @return A newly allocated pipeline, or NULL on allocation failure.
+ */
+DRIZZLE_API
+drizzle_pipeline_st *drizzle_pipeline_create(drizzle_st *con, uint32_t window);
+
+/**
+ * Free a pipeline. Queries that were sent but whose results were not read
+ * are not drained, so the connection should be closed if any are left.
+ *
+ * @param[in] pipeline Pipeline previously created with
+ *  drizzle_pipeline_create().
+ */
+DRIZZLE_API
+void drizzle_pipeline_free(drizzle_pipeline_st *pipeline);
+
+/**
+ * Queue a query in the pipeline. Nothing is sent until
+ * drizzle_pipeline_flush() or drizzle_pipeline_result() is called.
+ *
+ * @param[in] pipeline Pipeline previously created with
+ *  drizzle_pipeline_create().
+ * @param[in] query The query to queue.
+ * @param[in] size The length of the query, if 0 strlen() is used.
+ * @return Standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_pipeline_query(drizzle_pipeline_st *pipeline,
+                                        const char *query, size_t size);
+
+/**
+ * Send queued queries, writing as many as the window allows back to back
+ * in one write.
+ *
+ * @param[in] pipeline Pipeline previously created with
+ *  drizzle_pipeline_create().
+ * @return Standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_pipeline_flush(drizzle_pipeline_st *pipeline);
+
+/**
+ * Read the result of the next query in the pipeline, sending more queued
+ * queries first when the window has room. The previous result, and any
+ * further results it announced for drizzle_result_next(), must have been
+ * read completely before this is called.
+ *
+ * A query failing on the server sets DRIZZLE_RETURN_ERROR_CODE and the
+ * error of the returned result, and the following queries are still read
+ * normally. If the connection is lost, the current and every remaining
+ * query report the error in turn, with a NULL result.
+ *
+ * @param[in] pipeline Pipeline previously created with
+ *  drizzle_pipeline_create().
+ * @param[out] ret_ptr Standard drizzle return value.
+ * @return The result of the next query, or NULL with DRIZZLE_RETURN_OK in
+ *  ret_ptr when no queries are pending.
+ */
+DRIZZLE_API
+drizzle_result_st *drizzle_pipeline_result(drizzle_pipeline_st *pipeline,
+                                           drizzle_return_t *ret_ptr);
+
+/**
+ * Get the number of queries in the pipeline whose results have not been
+ * returned by drizzle_pipeline_result() yet.
+ *
+ * @param[in] pipeline Pipeline previously created with
+ *  drizzle_pipeline_create().
+ * @return The number of pending queries.
+ */
+DRIZZLE_API
+uint32_t drizzle_pipeline_pending(drizzle_pipeline_st *pipeline);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
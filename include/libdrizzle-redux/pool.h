@@ -0,0 +1,175 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @brief Connection pool declarations
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup drizzle_pool Connection Pools
+ * @ingroup drizzle_client_interface
+ * Share connections between threads. Connections are checked out and in
+ * without taking a lock, while a background thread keeps spare connections
+ * open ahead of demand, closes connections left idle and pings the others.
+ * @{
+ */
+
+/**
+ * Create a pool of connections to the server of a connection. New
+ * connections are copies of it, opened in blocking mode, and the pool opens
+ * min of them in the background right away. The connection itself is not
+ * used by the pool and may be freed afterwards.
+ *
+ * @param[in] con Connection whose settings new connections are copied from.
+ * @param[in] min Number of connections kept open at all times.
+ * @param[in] max Maximum number of connections open at the same time.
+ * @return A newly allocated pool, or NULL on failure.
+ */
+DRIZZLE_API
+drizzle_pool_st *drizzle_pool_create(const drizzle_st *con, uint32_t min,
+                                     uint32_t max);
+
+/**
+ * Free a pool and close its idle connections. Connections still checked out
+ * are left open and belong to their holders from then on, they can not be
+ * checked in any more and have to be freed with drizzle_quit().
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ */
+DRIZZLE_API
+void drizzle_pool_free(drizzle_pool_st *pool);
+
+/**
+ * Set the number of idle connections the pool keeps open, within its
+ * maximum size, so checkouts do not have to wait for a new connection. The
+ * default is DRIZZLE_DEFAULT_POOL_SPARE.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[in] spare Number of spare connections.
+ */
+DRIZZLE_API
+void drizzle_pool_set_spare(drizzle_pool_st *pool, uint32_t spare);
+
+/**
+ * Set the number of seconds after which an idle connection above the
+ * minimum size of the pool is closed. The default is
+ * DRIZZLE_DEFAULT_POOL_IDLE_TIME.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[in] seconds Idle time, or 0 to keep idle connections open.
+ */
+DRIZZLE_API
+void drizzle_pool_set_idle_time(drizzle_pool_st *pool, uint32_t seconds);
+
+/**
+ * Set the number of seconds after which an idle connection is pinged, and
+ * replaced if the server does not answer. The default is
+ * DRIZZLE_DEFAULT_POOL_PING_TIME.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[in] seconds Time between pings, or 0 to never ping.
+ */
+DRIZZLE_API
+void drizzle_pool_set_ping_time(drizzle_pool_st *pool, uint32_t seconds);
+
+/**
+ * Set whether the session state of a connection is reset when it is checked
+ * in, with drizzle_reset_connection(), or by logging in again on servers
+ * without it. Enabled by default.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[in] reset Whether to reset connections.
+ */
+DRIZZLE_API
+void drizzle_pool_set_reset(drizzle_pool_st *pool, bool reset);
+
+/**
+ * Check a connection out of a pool. An idle connection is returned if there
+ * is one, otherwise a new connection is opened as long as the pool is below
+ * its maximum size.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[out] ret_ptr Standard drizzle return value,
+ *  DRIZZLE_RETURN_POOL_EXHAUSTED when all connections are checked out.
+ * @return A connected connection, or NULL on failure.
+ */
+DRIZZLE_API
+drizzle_st *drizzle_pool_checkout(drizzle_pool_st *pool,
+                                  drizzle_return_t *ret_ptr);
+
+/**
+ * Return a connection to the pool it was checked out of. Its results are
+ * freed. A connection that was closed, is in the middle of a command or has
+ * results left to read is closed and replaced instead of being reused.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @param[in] con Connection returned by drizzle_pool_checkout().
+ * @return Standard drizzle return value.
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_pool_checkin(drizzle_pool_st *pool, drizzle_st *con);
+
+/**
+ * Get the number of open connections of a pool, whether checked out or not.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @return The number of open connections.
+ */
+DRIZZLE_API
+uint32_t drizzle_pool_size(const drizzle_pool_st *pool);
+
+/**
+ * Get the number of idle connections of a pool.
+ *
+ * @param[in] pool Pool previously created with drizzle_pool_create().
+ * @return The number of idle connections.
+ */
+DRIZZLE_API
+uint32_t drizzle_pool_idle(const drizzle_pool_st *pool);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
@@ -161,6 +161,16 @@ uint16_t drizzle_result_column_count(drizzle_result_st *result);
 DRIZZLE_API
 uint64_t drizzle_result_row_count(drizzle_result_st *result);
 
+/**
+ * Gets the memory reserved by the arena of a result buffered with the result
+ * arena option, see drizzle_options_set_result_arena()
+ *
+ * @param[in] result A result object
+ * @return The size of the arena chunks in bytes, 0 without an arena
+ */
+DRIZZLE_API
+uint64_t drizzle_result_arena_size(drizzle_result_st *result);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -66,6 +66,35 @@ DRIZZLE_API
 drizzle_result_st *drizzle_result_read(drizzle_st *con,
                                        drizzle_return_t *ret_ptr);
 
+/**
+ * Reads the result following the given one when the server returned more
+ * than one result for a command, such as for several statements sent in one
+ * query with drizzle_options_set_multi_statements() enabled.
+ *
+ * The given result must have been read completely, up to its last row,
+ * before the next one can be read. It stays valid and must still be freed
+ * with drizzle_result_free().
+ *
+ * @param[in] result A result object
+ * @param[out] ret_ptr A pointer to a drizzle_return_t to store the return
+ *  status into
+ * @return The next result, or NULL with DRIZZLE_RETURN_OK in ret_ptr if the
+ *  given result was the last one
+ */
+DRIZZLE_API
+drizzle_result_st *drizzle_result_next(drizzle_result_st *result,
+                                       drizzle_return_t *ret_ptr);
+
+/**
+ * Tests whether the server announced another result after this one. This is
+ * only known once the result has been read completely.
+ *
+ * @param[in] result A result object
+ * @return true if drizzle_result_next() will return another result
+ */
+DRIZZLE_API
+bool drizzle_result_more_results(drizzle_result_st *result);
+
 /**
  * Buffers a result set
  *
@@ -75,6 +104,60 @@ drizzle_result_st *drizzle_result_read(drizzle_st *con,
 DRIZZLE_API
 drizzle_return_t drizzle_result_buffer(drizzle_result_st *result);
 
+/**
+ * Buffers a result set column by column. Instead of a list of rows, every
+ * column gets one contiguous buffer holding the values of all rows, an array
+ * of row_count + 1 offsets into that buffer and a validity bitmap. Values of
+ * binary protocol results are stored in their wire format.
+ *
+ * Rows of a result buffered this way can not be accessed with
+ * drizzle_row_next() and related functions.
+ *
+ * @param[in,out] result A result object
+ * @return DRIZZLE_RETURN_OK upon success else DRIZZLE_RETURN_MEMORY
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_result_buffer_columnar(drizzle_result_st *result);
+
+/**
+ * Gets the value buffer of a column from a result buffered with
+ * drizzle_result_buffer_columnar(). The value of row r starts at
+ * offsets[r] and ends at offsets[r + 1], see drizzle_result_column_offsets().
+ *
+ * @param[in] result A result object
+ * @param[in] column The column number
+ * @return The value buffer, or NULL if the column does not exist or no value
+ *         is stored in it
+ */
+DRIZZLE_API
+const char *drizzle_result_column_values(drizzle_result_st *result,
+                                         uint16_t column);
+
+/**
+ * Gets the row_count + 1 value offsets of a column from a result buffered
+ * with drizzle_result_buffer_columnar().
+ *
+ * @param[in] result A result object
+ * @param[in] column The column number
+ * @return The offsets array, or NULL if the column does not exist
+ */
+DRIZZLE_API
+const uint64_t *drizzle_result_column_offsets(drizzle_result_st *result,
+                                              uint16_t column);
+
+/**
+ * Gets the validity bitmap of a column from a result buffered with
+ * drizzle_result_buffer_columnar(). Bit r % 8 of byte r / 8 is set if the
+ * value of row r is not NULL.
+ *
+ * @param[in] result A result object
+ * @param[in] column The column number
+ * @return The validity bitmap, or NULL if the column does not exist
+ */
+DRIZZLE_API
+const uint8_t *drizzle_result_column_validity(drizzle_result_st *result,
+                                              uint16_t column);
+
 /**
  * Get result row packet size in bytes.
  *
@@ -82,6 +82,53 @@ DRIZZLE_API
 drizzle_row_t drizzle_row_buffer(drizzle_result_st *result,
                                  drizzle_return_t *ret_ptr);
 
+/**
+ * Read one row of a text protocol result without copying the field data. The
+ * returned fields point directly into the connection read buffer and are not
+ * NUL-terminated, use the sizes stored in field_sizes to access them. NULL
+ * fields are returned as NULL pointers with a size of 0. Rows which do not
+ * sit contiguously in the read buffer are copied into the result instead.
+ *
+ * The row and its fields are only valid until the next read call on the
+ * connection and must not be freed by the caller.
+ *
+ * @param[in,out] result pointer to the result structure to read from.
+ * @param[out] field_sizes Set to the array of field sizes for the row.
+ * @param[out] ret_ptr Standard drizzle return value. Returns
+ *      DRIZZLE_RETURN_INVALID_ARGUMENT for results using the binary protocol.
+ * @return the row that was read, or NULL if there are no more rows.
+ */
+DRIZZLE_API
+drizzle_row_t drizzle_row_view(drizzle_result_st *result, size_t **field_sizes,
+                               drizzle_return_t *ret_ptr);
+
+/**
+ * Read up to max_rows rows of a text protocol result in one call. The first
+ * row is read like drizzle_row_read(), any further rows whose packets are
+ * already complete in the connection read buffer are decoded in a single
+ * pass without going through the state machine.
+ *
+ * Fields are not copied. For row r and column c of the batch, the field data
+ * starts at data + offsets[r * column_count + c] and is
+ * lengths[r * column_count + c] bytes long. The data is only valid until the
+ * next read call on the connection.
+ *
+ * @param[in,out] result pointer to the result structure to read from.
+ * @param[in] max_rows The maximum number of rows to read.
+ * @param[out] data Set to the base pointer of the field offsets.
+ * @param[out] offsets Array of at least max_rows * column_count field offsets.
+ * @param[out] lengths Array of at least max_rows * column_count field lengths.
+ * @param[out] nulls Optional array of at least max_rows * column_count flags
+ *      set to true for NULL fields, may be NULL.
+ * @param[out] ret_ptr Standard drizzle return value.
+ * @return the number of rows read, or 0 if there are no more rows or an error.
+ */
+DRIZZLE_API
+uint64_t drizzle_row_read_many(drizzle_result_st *result, uint64_t max_rows,
+                               const char **data, size_t *offsets,
+                               size_t *lengths, bool *nulls,
+                               drizzle_return_t *ret_ptr);
+
 /**
  * Free a row that was buffered with drizzle_row_buffer().
  *
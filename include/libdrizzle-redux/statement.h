@@ -65,6 +65,28 @@ drizzle_stmt_st *drizzle_stmt_prepare(drizzle_st *con, const char *statement,
 DRIZZLE_API
 drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt);
 
+/**
+ * Executes a prepared statement once for each of rows rows of the arrays
+ * bound with drizzle_stmt_set_array(). Parameters set to a single value are
+ * the same for every row. The executions are written to the server back to
+ * back, so a batch costs a round trip per DRIZZLE_DEFAULT_PIPELINE_WINDOW
+ * rows rather than one per row. The statement must not return a result set.
+ *
+ * A row failing on the server does not stop the following rows.
+ *
+ * @param stmt The prepared statement object
+ * @param rows The number of rows to execute
+ * @param affected_rows An array of rows elements receiving the affected row
+ *  count of each row, UINT64_MAX for rows that failed, or NULL
+ * @return A return status code, DRIZZLE_RETURN_OK upon success or
+ *  DRIZZLE_RETURN_ERROR_CODE if a row failed, with drizzle_error() set to
+ *  the error of the last failed row
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_stmt_execute_array(drizzle_stmt_st *stmt,
+                                            uint32_t rows,
+                                            uint64_t *affected_rows);
+
 /**
  * Send long binary data packet
  *
@@ -87,6 +109,20 @@ drizzle_return_t drizzle_stmt_send_long_data(drizzle_stmt_st *stmt,
  */
 DRIZZLE_API
 drizzle_return_t drizzle_stmt_reset(drizzle_stmt_st *stmt);
+
+/** Read the rows of subsequent executions through a server-side cursor
+ *
+ * The server keeps the result set and drizzle_stmt_fetch() pulls it in
+ * batches of prefetch_rows rows, so other statements can run on the
+ * connection between fetches.
+ *
+ * @param stmt The prepared statement object
+ * @param prefetch_rows The number of rows per batch, 0 disables the cursor
+ * @return A return status code, DRIZZLE_RETURN_OK upon success
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_stmt_set_cursor(drizzle_stmt_st *stmt,
+                                         uint32_t prefetch_rows);
 /**
  * Fetch a row from the result set, can be used with buffered or unbuffered
  * result sets
@@ -106,6 +142,32 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt);
 DRIZZLE_API
 drizzle_return_t drizzle_stmt_buffer(drizzle_stmt_st *stmt);
 
+/**
+ * Bind a caller owned buffer that drizzle_stmt_fetch() fills with a column
+ * of each fetched row, converted to the given type
+ *
+ * Integer and floating point types are stored in host byte order, strings
+ * and blobs are copied up to buffer_length bytes. drizzle_stmt_fetch()
+ * returns DRIZZLE_RETURN_TRUNCATED when a value did not fit. Binding
+ * DRIZZLE_COLUMN_TYPE_NONE removes the binding.
+ *
+ * @param stmt The prepared statement object
+ * @param column_number The column number, starting at 0
+ * @param type One of TINY, SHORT, LONG, LONGLONG, FLOAT, DOUBLE, STRING,
+ *             VAR_STRING or BLOB
+ * @param buffer The buffer the value is stored in
+ * @param buffer_length The size of the buffer
+ * @param length Set to the length of the value when not NULL
+ * @param is_null Set to whether the value is NULL when not NULL
+ * @return A return status code, DRIZZLE_RETURN_OK upon success
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_stmt_bind_result(drizzle_stmt_st *stmt,
+                                          uint16_t column_number,
+                                          drizzle_column_type_t type,
+                                          void *buffer, size_t buffer_length,
+                                          size_t *length, bool *is_null);
+
 /**
  * Close and free a prepared statement
  *
@@ -124,6 +186,21 @@ drizzle_return_t drizzle_stmt_close(drizzle_stmt_st *stmt);
 DRIZZLE_API
 uint16_t drizzle_stmt_column_count(drizzle_stmt_st *stmt);
 
+/**
+ * Resolve a column name to its column number, so a row can be read with the
+ * numbered getters instead of looking the name up for every value
+ *
+ * @param stmt The prepared statement object
+ * @param column_name The column name
+ * @param ret_ptr A pointer to a drizzle_return_t to store the return status
+ *                into, DRIZZLE_RETURN_NOT_FOUND when no column has the name
+ * @return The column number, starting at 0
+ */
+DRIZZLE_API
+uint16_t drizzle_stmt_column_number(drizzle_stmt_st *stmt,
+                                    const char *column_name,
+                                    drizzle_return_t *ret_ptr);
+
 /**
  * Gets the affected rows count for a result set which has been executed using
  * drizzle_stmt_execute
@@ -300,6 +377,35 @@ drizzle_return_t drizzle_stmt_set_timestamp(drizzle_stmt_st *stmt, uint16_t para
                                             uint8_t hours, uint8_t minutes, uint8_t seconds,
                                             uint32_t microseconds);
 
+/**
+ * Binds a parameter of a prepared statement to an array of values, one for
+ * each row executed by drizzle_stmt_execute_array(). The arrays are not
+ * copied and must stay valid until then.
+ *
+ * The values array holds uint8_t, uint16_t, uint32_t, uint64_t, float or
+ * double values for DRIZZLE_COLUMN_TYPE_TINY, DRIZZLE_COLUMN_TYPE_SHORT,
+ * DRIZZLE_COLUMN_TYPE_LONG, DRIZZLE_COLUMN_TYPE_LONGLONG,
+ * DRIZZLE_COLUMN_TYPE_FLOAT and DRIZZLE_COLUMN_TYPE_DOUBLE,
+ * drizzle_datetime_st values for the time and date types, and pointers to
+ * the data for the string, blob and decimal types, whose lengths are then
+ * given in lengths.
+ *
+ * @param stmt A prepared statement object
+ * @param param_num The parameter number to set (starting at 0)
+ * @param type The type of the values
+ * @param values The array of values
+ * @param lengths The array of value lengths for string types, or NULL
+ * @param nulls An array of flags set for rows where the value is NULL, or
+ *  NULL if no value is NULL
+ * @param is_unsigned Set to true if the values are unsigned
+ * @return A return status code, DRIZZLE_RETURN_OK upon success
+ */
+DRIZZLE_API
+drizzle_return_t drizzle_stmt_set_array(drizzle_stmt_st *stmt, uint16_t param_num,
+                                        drizzle_column_type_t type,
+                                        const void *values, const size_t *lengths,
+                                        const bool *nulls, bool is_unsigned);
+
 /**
  * Check if a column for a fetched row is set to NULL using a column name
  *
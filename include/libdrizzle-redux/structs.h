@@ -43,6 +43,9 @@ struct drizzle_tcp_st;
 struct drizzle_uds_st;
 struct drizzle_result_st;
 struct drizzle_binlog_st;
+struct drizzle_pipeline_st;
+struct drizzle_group_st;
+struct drizzle_pool_st;
 struct drizzle_column_st;
 struct drizzle_stmt_st;
 struct drizzle_bind_st;
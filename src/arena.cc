@@ -0,0 +1,177 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2008-2013 Drizzle Developer Group
+ * Copyright (C) 2008 Eric Day (eday@oddments.org)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Arena allocator definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+/*
+ * Private declarations
+ */
+
+static inline size_t _arena_align(size_t size)
+{
+  return (size + DRIZZLE_ARENA_ALIGNMENT - 1) & ~(DRIZZLE_ARENA_ALIGNMENT - 1);
+}
+
+static inline unsigned char *_arena_chunk_data(drizzle_arena_chunk_st *chunk)
+{
+  return (unsigned char *)chunk + _arena_align(sizeof(drizzle_arena_chunk_st));
+}
+
+static drizzle_arena_chunk_st *_arena_chunk_create(size_t size)
+{
+  drizzle_arena_chunk_st *chunk= (drizzle_arena_chunk_st *)
+    malloc(_arena_align(sizeof(drizzle_arena_chunk_st)) + size);
+  if (chunk == NULL)
+  {
+    return NULL;
+  }
+
+  chunk->next= NULL;
+  chunk->size= size;
+  chunk->used= 0;
+
+  return chunk;
+}
+
+/*
+ * Common definitions
+ */
+
+drizzle_arena_st *drizzle_arena_create(void)
+{
+  return new (std::nothrow) drizzle_arena_st;
+}
+
+void drizzle_arena_free(drizzle_arena_st *arena)
+{
+  drizzle_arena_chunk_st *chunk;
+
+  if (arena == NULL)
+  {
+    return;
+  }
+
+  while (arena->chunk_list != NULL)
+  {
+    chunk= arena->chunk_list;
+    arena->chunk_list= chunk->next;
+    free(chunk);
+  }
+
+  delete arena;
+}
+
+void *drizzle_arena_alloc(drizzle_arena_st *arena, size_t size)
+{
+  drizzle_arena_chunk_st *chunk;
+  void *ptr;
+
+  if (arena == NULL)
+  {
+    return NULL;
+  }
+
+  size= _arena_align(size == 0 ? 1 : size);
+  chunk= arena->chunk_list;
+
+  if (chunk == NULL || (chunk->size - chunk->used) < size)
+  {
+    /* Oversized requests get a chunk of their own which is linked behind the
+       current one, so the free space left in the current chunk is not lost. */
+    if (size > arena->chunk_size / 4)
+    {
+      chunk= _arena_chunk_create(size);
+      if (chunk == NULL)
+      {
+        return NULL;
+      }
+
+      if (arena->chunk_list == NULL)
+      {
+        arena->chunk_list= chunk;
+      }
+      else
+      {
+        chunk->next= arena->chunk_list->next;
+        arena->chunk_list->next= chunk;
+      }
+    }
+    else
+    {
+      chunk= _arena_chunk_create(arena->chunk_size);
+      if (chunk == NULL)
+      {
+        return NULL;
+      }
+
+      chunk->next= arena->chunk_list;
+      arena->chunk_list= chunk;
+    }
+
+    arena->allocated+= chunk->size;
+  }
+
+  ptr= _arena_chunk_data(chunk) + chunk->used;
+  chunk->used+= size;
+
+  return ptr;
+}
+
+char *drizzle_arena_strndup(drizzle_arena_st *arena, const char *data,
+                            size_t size)
+{
+  char *ptr= (char *)drizzle_arena_alloc(arena, size + 1);
+  if (ptr == NULL)
+  {
+    return NULL;
+  }
+
+  if (size > 0)
+  {
+    memcpy(ptr, data, size);
+  }
+  ptr[size]= 0;
+
+  return ptr;
+}
@@ -0,0 +1,101 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Arena allocator declarations
+ */
+
+#pragma once
+
+/**
+ * @addtogroup drizzle_arena_private Private Arena Allocator
+ *
+ * A chunked bump allocator owned by a result set. Memory handed out by the
+ * arena is never freed individually, the whole arena is released at once
+ * with drizzle_arena_free().
+ * @{
+ */
+
+#define DRIZZLE_ARENA_CHUNK_SIZE  (256*1024)
+#define DRIZZLE_ARENA_ALIGNMENT   sizeof(uint64_t)
+
+struct drizzle_arena_chunk_st
+{
+  drizzle_arena_chunk_st *next;
+  size_t size;
+  size_t used;
+};
+
+struct drizzle_arena_st
+{
+  drizzle_arena_chunk_st *chunk_list;
+  size_t chunk_size;
+  size_t allocated;
+
+  drizzle_arena_st() :
+    chunk_list(NULL),
+    chunk_size(DRIZZLE_ARENA_CHUNK_SIZE),
+    allocated(0)
+  { }
+};
+
+/**
+ * Create an empty arena. No memory is reserved until the first allocation.
+ */
+drizzle_arena_st *drizzle_arena_create(void);
+
+/**
+ * Release every chunk owned by the arena along with the arena itself.
+ */
+void drizzle_arena_free(drizzle_arena_st *arena);
+
+/**
+ * Allocate size bytes from the arena. The returned memory is aligned to
+ * DRIZZLE_ARENA_ALIGNMENT and is not initialized.
+ *
+ * @return Pointer to the memory or NULL if a new chunk could not be allocated.
+ */
+void *drizzle_arena_alloc(drizzle_arena_st *arena, size_t size);
+
+/**
+ * Copy size bytes into the arena and append a terminating NUL byte.
+ */
+char *drizzle_arena_strndup(drizzle_arena_st *arena, const char *data,
+                            size_t size);
+
+/** @} */
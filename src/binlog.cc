@@ -38,8 +38,109 @@
 #include "config.h"
 #include "src/common.h"
 
-#include <zlib.h>
 #include <inttypes.h>
+#include <ctype.h>
+#include <errno.h>
+
+/* Flags of COM_BINLOG_DUMP_GTID */
+#define DRIZZLE_BINLOG_DUMP_NON_BLOCK 0x01
+#define DRIZZLE_BINLOG_THROUGH_GTID 0x04
+
+/* Text of a GTID interval, ":<start>-<end>" */
+#define DRIZZLE_BINLOG_GTID_INTERVAL_TEXT 42
+
+/* Server version field of a format description, and the checksum algorithm
+   which follows its post header lengths from 5.6.1 on */
+#define DRIZZLE_BINLOG_SERVER_VERSION_SIZE 50
+#define DRIZZLE_BINLOG_CHECKSUM_ALG_CRC32 1
+
+static void _gtid_clear(drizzle_binlog_gtid_set_st *set);
+
+static drizzle_return_t _gtid_parse(drizzle_binlog_gtid_set_st *set,
+                                    const char *gtid_set);
+
+static drizzle_return_t _gtid_add(drizzle_binlog_gtid_set_st *set,
+                                  const unsigned char *uuid, uint64_t start,
+                                  uint64_t end);
+
+static drizzle_return_t _gtid_copy(drizzle_binlog_gtid_set_st *set,
+                                   const drizzle_binlog_gtid_set_st *from);
+
+static drizzle_return_t _gtid_track(drizzle_binlog_st *binlog);
+
+static char *_gtid_format(const drizzle_binlog_gtid_set_st *set);
+
+static bool _binlog_has_checksum_alg(const drizzle_binlog_event_st *event);
+
+/* Tell the consumer of the ring that the binlog stream has ended */
+static drizzle_return_t _binlog_finish(drizzle_binlog_st *binlog,
+                                       drizzle_return_t ret)
+{
+  if (binlog->ring != NULL && ret != DRIZZLE_RETURN_IO_WAIT &&
+      binlog->con->options.socket_owner == DRIZZLE_SOCKET_OWNER_NATIVE)
+  {
+    drizzle_binlog_ring_close(binlog->ring, ret);
+  }
+
+  return ret;
+}
+
+/* Send a binlog dump command and, if the socket is ours, read the stream */
+static drizzle_return_t _binlog_dump(drizzle_binlog_st *binlog,
+                                     drizzle_command_t command,
+                                     const unsigned char *data, size_t size)
+{
+  drizzle_result_st *result;
+  drizzle_st *con= binlog->con;
+  drizzle_return_t ret;
+
+  ret= drizzle_binlog_ring_open(binlog);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return _binlog_finish(binlog, ret);
+  }
+
+  // Hack in 5.6 to say that client support checksums
+  result= drizzle_query(con, "SET @master_binlog_checksum='NONE'", 0, &ret);
+  drizzle_result_free(result);
+
+  // Ensure the checksum query is executed if we are in non-blocking mode
+  if (con->options.non_blocking)
+  {
+    drizzle_wait(con);
+    ret = drizzle_state_loop(con);
+  }
+
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return _binlog_finish(binlog, ret);
+  }
+
+  result= drizzle_command_write(con, NULL, command, data, size, size, &ret);
+
+  con->binlog= binlog;
+
+  if (con->options.non_blocking)
+  {
+    // In non-blocking node, wait for IO but free the result as data is
+    // expected to be read by the client
+    ret = drizzle_wait(con);
+    drizzle_result_free(result);
+  }
+
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return _binlog_finish(binlog, ret);
+  }
+
+  if (con->options.socket_owner == DRIZZLE_SOCKET_OWNER_NATIVE)
+  {
+    result->push_state(drizzle_state_binlog_read);
+    result->push_state(drizzle_state_packet_read);
+  }
+
+  return _binlog_finish(binlog, drizzle_state_loop(con));
+}
 
 drizzle_binlog_st *drizzle_binlog_init(drizzle_st *con,
                                        drizzle_binlog_fn *binlog_fn,
@@ -83,6 +184,13 @@ drizzle_binlog_st *drizzle_binlog_init(drizzle_st *con,
 
 void drizzle_binlog_free(drizzle_binlog_st *binlog)
 {
+  if (binlog == NULL)
+  {
+    return;
+  }
+
+  _gtid_clear(&binlog->gtid_set);
+  delete[] binlog->gtid_set.sid_list;
   delete binlog;
 }
 
@@ -94,32 +202,14 @@ drizzle_return_t drizzle_binlog_start(drizzle_binlog_st *binlog,
   unsigned char data[128];
   unsigned char *ptr;
   uint8_t len= 0, fn_len= 0;
-  drizzle_result_st *result;
-  drizzle_st *con;
-  drizzle_return_t ret;
 
   if (binlog == NULL)
   {
     return DRIZZLE_RETURN_INVALID_ARGUMENT;
   }
 
-  con= binlog->con;
-
-  // Hack in 5.6 to say that client support checksums
-  result= drizzle_query(con, "SET @master_binlog_checksum='NONE'", 0, &ret);
-  drizzle_result_free(result);
-
-  // Ensure the checksum query is executed if we are in non-blocking mode
-  if (con->options.non_blocking)
-  {
-    drizzle_wait(con);
-    ret = drizzle_state_loop(con);
-  }
-
-  if (ret != DRIZZLE_RETURN_OK)
-  {
-    return ret;
-  }
+  // Only the transactions streamed from here on are tracked
+  drizzle_binlog_gtid_reset(binlog);
 
   ptr= data;
 
@@ -156,31 +246,136 @@ drizzle_return_t drizzle_binlog_start(drizzle_binlog_st *binlog,
     memcpy(ptr, file, fn_len);
   }
 
-  result= drizzle_command_write(con, NULL, DRIZZLE_COMMAND_BINLOG_DUMP,
-                                   data, len, len, &ret);
+  return _binlog_dump(binlog, DRIZZLE_COMMAND_BINLOG_DUMP, data, len);
+}
 
-  con->binlog= binlog;
+drizzle_return_t drizzle_binlog_start_gtid(drizzle_binlog_st *binlog,
+                                           uint32_t server_id,
+                                           const char *gtid_set)
+{
+  unsigned char *data;
+  unsigned char *ptr;
+  drizzle_return_t ret;
+  size_t sid_size;
+  size_t len;
 
-  if (con->options.non_blocking)
+  if (binlog == NULL || gtid_set == NULL)
   {
-    // In non-blocking node, wait for IO but free the result as data is
-    // expected to be read by the client
-    ret = drizzle_wait(con);
-    drizzle_result_free(result);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
   }
 
-  if (ret != DRIZZLE_RETURN_OK)
+  drizzle_binlog_gtid_reset(binlog);
+  ret= _gtid_parse(&binlog->gtid_set, gtid_set);
+  if (ret == DRIZZLE_RETURN_INVALID_ARGUMENT)
   {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "invalid GTID set: %s", gtid_set);
+    return ret;
+  }
+  else if (ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
     return ret;
   }
 
-  if (con->options.socket_owner == DRIZZLE_SOCKET_OWNER_NATIVE)
+  sid_size= 8;
+  for (uint32_t x= 0; x < binlog->gtid_set.sid_count; x++)
   {
-    result->push_state(drizzle_state_binlog_read);
-    result->push_state(drizzle_state_packet_read);
+    sid_size+= DRIZZLE_BINLOG_UUID_SIZE + 8 +
+               (size_t)binlog->gtid_set.sid_list[x].interval_count * 16;
+  }
+
+  len= 2 +         // Binlog flags
+       4 +         // Server ID
+       4 +         // Binlog file name length, no name
+       8 +         // Binlog position
+       4 +         // GTID data length
+       sid_size;
+  data= new (std::nothrow) unsigned char[len];
+  if (data == NULL)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  ptr= data;
+  // A server ID of 0 disconnects at the end of the last log, as it does
+  // for drizzle_binlog_start()
+  drizzle_set_byte2(ptr, DRIZZLE_BINLOG_THROUGH_GTID |
+                    (server_id == 0 ? DRIZZLE_BINLOG_DUMP_NON_BLOCK : 0));
+  ptr+= 2;
+  drizzle_set_byte4(ptr, server_id);
+  ptr+= 4;
+  drizzle_set_byte4(ptr, 0);
+  ptr+= 4;
+  drizzle_set_byte8(ptr, UINT64_C(4));
+  ptr+= 8;
+  drizzle_set_byte4(ptr, sid_size);
+  ptr+= 4;
+
+  // The transactions to skip, with exclusive interval ends
+  drizzle_set_byte8(ptr, (uint64_t)binlog->gtid_set.sid_count);
+  ptr+= 8;
+  for (uint32_t x= 0; x < binlog->gtid_set.sid_count; x++)
+  {
+    drizzle_binlog_gtid_sid_st *sid= &binlog->gtid_set.sid_list[x];
+    memcpy(ptr, sid->uuid, DRIZZLE_BINLOG_UUID_SIZE);
+    ptr+= DRIZZLE_BINLOG_UUID_SIZE;
+    drizzle_set_byte8(ptr, (uint64_t)sid->interval_count);
+    ptr+= 8;
+    for (uint32_t y= 0; y < sid->interval_count; y++)
+    {
+      drizzle_set_byte8(ptr, sid->interval_list[y].start);
+      ptr+= 8;
+      drizzle_set_byte8(ptr, sid->interval_list[y].end);
+      ptr+= 8;
+    }
+  }
+
+  ret= _binlog_dump(binlog, DRIZZLE_COMMAND_BINLOG_DUMP_GTID, data, len);
+  delete[] data;
+  return ret;
+}
+
+drizzle_return_t drizzle_binlog_get_gtid_set(drizzle_binlog_st *binlog,
+                                             char **gtid_set)
+{
+  if (binlog == NULL || gtid_set == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  // The set of the reading thread may be ahead of the consumer of a ring,
+  // which gets the one following its releases. The connection belongs to
+  // the reading thread, so no error is set on it.
+  if (binlog->ring != NULL)
+  {
+    drizzle_binlog_ring_st *ring= binlog->ring;
+    drizzle_return_t ret;
+
+    pthread_mutex_lock(&ring->lock);
+    ret= ring->gtid_ret;
+    if (ret == DRIZZLE_RETURN_OK)
+    {
+      *gtid_set= _gtid_format(&ring->gtid_set);
+      if (*gtid_set == NULL)
+      {
+        ret= DRIZZLE_RETURN_MEMORY;
+      }
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    return ret;
+  }
+
+  *gtid_set= _gtid_format(&binlog->gtid_set);
+  if (*gtid_set == NULL)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+    return DRIZZLE_RETURN_MEMORY;
   }
 
-  return drizzle_state_loop(con);
+  return DRIZZLE_RETURN_OK;
 }
 
 uint32_t drizzle_binlog_event_timestamp(drizzle_binlog_event_st *event)
@@ -283,17 +478,21 @@ uint32_t drizzle_binlog_event_raw_length(drizzle_binlog_event_st *event)
   return event->raw_length;
 }
 
+uint32_t drizzle_binlog_crc32(uint32_t crc, const unsigned char *data,
+                              size_t size)
+{
+  return drizzle_crc32(crc, data, size);
+}
+
 drizzle_return_t drizzle_state_binlog_read(drizzle_st *con)
 {
-  drizzle_binlog_event_st *binlog_event;
+  drizzle_return_t ret;
 
   if (con == NULL)
   {
     return DRIZZLE_RETURN_INVALID_ARGUMENT;
   }
 
-  binlog_event= &con->binlog->event;
-
   if (con->packet_size != 0 && con->buffer_size < con->packet_size)
   {
     con->push_state(drizzle_state_read);
@@ -332,113 +531,155 @@ drizzle_return_t drizzle_state_binlog_read(drizzle_st *con)
     con->buffer_ptr++;
     con->packet_size--;
     con->buffer_size--;
-    binlog_event->raw_data= con->buffer_ptr;
-    binlog_event->timestamp= drizzle_get_byte4(con->buffer_ptr);
-    binlog_event->type=
-      (drizzle_binlog_event_types_t)con->buffer_ptr[DRIZZLE_EVENT_POSITION_TYPE];
-    binlog_event->server_id= drizzle_get_byte4(
-      con->buffer_ptr + DRIZZLE_EVENT_POSITION_SERVERID);
-    binlog_event->raw_length= binlog_event->length= drizzle_get_byte4(
-      con->buffer_ptr + DRIZZLE_EVENT_POSITION_LENGTH);
-    if (con->packet_size != binlog_event->length)
-    {
-        drizzle_set_error(con, __FILE_LINE_FUNC__, "packet size error:%" PRIu32
-                          ":%" PRIu32, con->packet_size, binlog_event->length);
-        if (con->binlog->error_fn != NULL)
-        {
-          con->binlog->error_fn(DRIZZLE_RETURN_UNEXPECTED_DATA, con, con->binlog->binlog_context);
-        }
-        return DRIZZLE_RETURN_UNEXPECTED_DATA;
-    }
-    if (binlog_event->length <= 27)
-    {
-      binlog_event->next_pos= drizzle_get_byte4(
-        con->buffer_ptr + DRIZZLE_EVENT_POSITION_NEXT);
-      binlog_event->flags= drizzle_get_byte2(
-        con->buffer_ptr + DRIZZLE_EVENT_POSITION_FLAGS);
-      con->buffer_ptr+= binlog_event->length;
-      con->buffer_size-= binlog_event->length;
-      con->packet_size-= binlog_event->length;
-      binlog_event->length= 0;
-      binlog_event->data= NULL;
-    }
-    else
+
+    ret= drizzle_binlog_event_parse(con->binlog, con->buffer_ptr,
+                                    con->packet_size);
+    if (ret != DRIZZLE_RETURN_OK)
     {
-      // Binary log v4: Used in MySQL 5.0 and up
-      // 19 is the fixed Header length
-      uint32_t HEADER_V4_LENGTH = 19;
-      binlog_event->length= binlog_event->length - HEADER_V4_LENGTH;
-      binlog_event->next_pos= drizzle_get_byte4(
-        con->buffer_ptr + DRIZZLE_EVENT_POSITION_NEXT);
-      binlog_event->flags= drizzle_get_byte2(
-        con->buffer_ptr + DRIZZLE_EVENT_POSITION_FLAGS);
-
-      con->buffer_ptr+= HEADER_V4_LENGTH;
-      con->buffer_size-= HEADER_V4_LENGTH;
-      con->packet_size-= HEADER_V4_LENGTH;
-      /* 5.6.1 or higher is automatic checksums on */
-      if (binlog_event->type == DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION)
-      {
-        if (strncmp((const char*)con->buffer_ptr + 2, DRIZZLE_BINLOG_CHECKSUM_VERSION, strlen(DRIZZLE_BINLOG_CHECKSUM_VERSION)) <= 0)
-        {
-          con->binlog->has_checksums= true;
-        }
-      }
-      /* A checksum is basically a CRC32 at the end of the event data (4 bytes) */
-      binlog_event->data= con->buffer_ptr;
-      con->buffer_ptr+= binlog_event->length;
-      con->buffer_size-= binlog_event->length;
-      con->packet_size-= binlog_event->length;
-      /* Remove the CRC32 from the event length */
-      if (con->binlog->has_checksums)
+      if (con->binlog->error_fn != NULL)
       {
-        binlog_event->length-= DRIZZLE_BINLOG_CRC32_LEN;
+        con->binlog->error_fn(ret, con, con->binlog->binlog_context);
       }
+      return ret;
+    }
+
+    con->buffer_ptr+= con->packet_size;
+    con->buffer_size-= con->packet_size;
+    con->packet_size= 0;
+    con->pop_state();
+  }
+
+  ret= drizzle_binlog_event_dispatch(con->binlog);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    if (con->binlog->error_fn != NULL)
+    {
+      con->binlog->error_fn(ret, con, con->binlog->binlog_context);
     }
+    return ret;
+  }
+  con->push_state(drizzle_state_binlog_read);
+  con->push_state(drizzle_state_packet_read);
 
-    /* Check if checksum is correct
-     * each event is checksummed individually, the checksum is the last 4 bytes
-     * of the binary log event
-     * */
-    if (con->binlog->has_checksums)
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_binlog_event_parse(drizzle_binlog_st *binlog,
+                                            unsigned char *raw_data,
+                                            uint32_t raw_length)
+{
+  drizzle_binlog_event_st *binlog_event= &binlog->event;
+
+  binlog_event->raw_data= raw_data;
+  binlog_event->timestamp= drizzle_get_byte4(raw_data);
+  binlog_event->type=
+    (drizzle_binlog_event_types_t)raw_data[DRIZZLE_EVENT_POSITION_TYPE];
+  binlog_event->server_id= drizzle_get_byte4(
+    raw_data + DRIZZLE_EVENT_POSITION_SERVERID);
+  binlog_event->raw_length= binlog_event->length= drizzle_get_byte4(
+    raw_data + DRIZZLE_EVENT_POSITION_LENGTH);
+  if (raw_length != binlog_event->length)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "packet size error:%"
+                      PRIu32 ":%" PRIu32, raw_length, binlog_event->length);
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+  if (binlog_event->length <= 27)
+  {
+    binlog_event->next_pos= drizzle_get_byte4(
+      raw_data + DRIZZLE_EVENT_POSITION_NEXT);
+    binlog_event->flags= drizzle_get_byte2(
+      raw_data + DRIZZLE_EVENT_POSITION_FLAGS);
+    binlog_event->length= 0;
+    binlog_event->data= NULL;
+  }
+  else
+  {
+    // Binary log v4: Used in MySQL 5.0 and up
+    // 19 is the fixed Header length
+    uint32_t HEADER_V4_LENGTH = 19;
+    binlog_event->length= binlog_event->length - HEADER_V4_LENGTH;
+    binlog_event->next_pos= drizzle_get_byte4(
+      raw_data + DRIZZLE_EVENT_POSITION_NEXT);
+    binlog_event->flags= drizzle_get_byte2(
+      raw_data + DRIZZLE_EVENT_POSITION_FLAGS);
+
+    /* A checksum is basically a CRC32 at the end of the event data (4 bytes) */
+    binlog_event->data= raw_data + HEADER_V4_LENGTH;
+    /* 5.6.1 or higher is automatic checksums on */
+    if (binlog_event->type == DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION)
     {
-      uint32_t event_crc;
-      memcpy(&binlog_event->checksum, binlog_event->raw_data + (binlog_event->raw_length - DRIZZLE_BINLOG_CRC32_LEN), DRIZZLE_BINLOG_CRC32_LEN);
-      if (con->binlog->verify_checksums)
+      if (binlog->from_file)
       {
-        event_crc= (uint32_t)crc32(0, binlog_event->raw_data, (binlog_event->raw_length - DRIZZLE_BINLOG_CRC32_LEN));
-        if (event_crc != binlog_event->checksum)
+        /* A file was written with the checksum setting of its server, which
+           the format description records in the byte before its own
+           checksum */
+        binlog->has_checksums= false;
+        if (_binlog_has_checksum_alg(binlog_event))
         {
-          drizzle_set_error(con, __FILE_LINE_FUNC__, "CRC doesn't match: 0x%"
-            PRIX32 ", 0x%" PRIX32, event_crc, binlog_event->checksum);
-          if (con->binlog->error_fn != NULL)
+          binlog->has_checksums=
+            raw_data[raw_length - DRIZZLE_BINLOG_CRC32_LEN - 1] ==
+            DRIZZLE_BINLOG_CHECKSUM_ALG_CRC32;
+          if (!binlog->has_checksums)
           {
-            con->binlog->error_fn(DRIZZLE_RETURN_BINLOG_CRC, con, con->binlog->binlog_context);
+            binlog_event->length-= DRIZZLE_BINLOG_CRC32_LEN;
           }
-          return DRIZZLE_RETURN_BINLOG_CRC;
         }
       }
+      else if (strncmp((const char*)binlog_event->data + 2, DRIZZLE_BINLOG_CHECKSUM_VERSION, strlen(DRIZZLE_BINLOG_CHECKSUM_VERSION)) <= 0)
+      {
+        binlog->has_checksums= true;
+      }
     }
+    /* Remove the CRC32 from the event length */
+    if (binlog->has_checksums)
+    {
+      binlog_event->length-= DRIZZLE_BINLOG_CRC32_LEN;
+    }
+  }
 
-    if (con->packet_size != 0)
+  /* Check if checksum is correct
+   * each event is checksummed individually, the checksum is the last 4 bytes
+   * of the binary log event
+   * */
+  if (binlog->has_checksums)
+  {
+    uint32_t event_crc;
+    memcpy(&binlog_event->checksum, binlog_event->raw_data + (binlog_event->raw_length - DRIZZLE_BINLOG_CRC32_LEN), DRIZZLE_BINLOG_CRC32_LEN);
+    // With a ring the consumer may verify it instead
+    if (binlog->verify_checksums &&
+        (binlog->ring == NULL || !binlog->ring->verify_checksums))
     {
-      drizzle_set_error(con, __FILE_LINE_FUNC__,
-                        "unexpected data after packet:%" PRIu64, con->buffer_size);
-      if (con->binlog->error_fn != NULL)
+      event_crc= drizzle_crc32(0, binlog_event->raw_data, (binlog_event->raw_length - DRIZZLE_BINLOG_CRC32_LEN));
+      if (event_crc != binlog_event->checksum)
       {
-        con->binlog->error_fn(DRIZZLE_RETURN_UNEXPECTED_DATA, con, con->binlog->binlog_context);
+        drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "CRC doesn't match: 0x%"
+          PRIX32 ", 0x%" PRIX32, event_crc, binlog_event->checksum);
+        return DRIZZLE_RETURN_BINLOG_CRC;
       }
-      return DRIZZLE_RETURN_UNEXPECTED_DATA;
     }
-    con->pop_state();
   }
 
-  if (con->binlog->binlog_fn != NULL)
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_binlog_event_dispatch(drizzle_binlog_st *binlog)
+{
+  drizzle_return_t ret= _gtid_track(binlog);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
+  if (binlog->ring != NULL)
   {
-    con->binlog->binlog_fn(&con->binlog->event, con->binlog->binlog_context);
+    return drizzle_binlog_ring_push(binlog);
+  }
+
+  if (binlog->binlog_fn != NULL)
+  {
+    binlog->binlog_fn(&binlog->event, binlog->binlog_context);
   }
-  con->push_state(drizzle_state_binlog_read);
-  con->push_state(drizzle_state_packet_read);
 
   return DRIZZLE_RETURN_OK;
 }
@@ -547,3 +788,897 @@ drizzle_return_t drizzle_binlog_get_filename(drizzle_st *con, char **filename,
   drizzle_result_free(result);
   return DRIZZLE_RETURN_OK;
 }
+
+drizzle_return_t drizzle_binlog_get_gtid_executed(drizzle_st *con,
+                                                  char **gtid_set)
+{
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_row_t row;
+  size_t *field_sizes;
+
+  if (con == NULL || gtid_set == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  *gtid_set= NULL;
+  result= drizzle_query(con, "SELECT @@GLOBAL.gtid_executed", 0, &driz_ret);
+  if (driz_ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "Query to retrieve the executed GTID set failed");
+    drizzle_result_free(result);
+    return driz_ret;
+  }
+
+  driz_ret= drizzle_result_buffer(result);
+  if (driz_ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_result_free(result);
+    return driz_ret;
+  }
+
+  row= drizzle_row_next(result);
+  if (row == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "No executed GTID set found");
+    drizzle_result_free(result);
+    return DRIZZLE_RETURN_NOT_FOUND;
+  }
+
+  field_sizes= drizzle_row_field_sizes(result);
+  *gtid_set= (char*)malloc(field_sizes[0] + 1);
+  if (*gtid_set == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "malloc");
+    drizzle_result_free(result);
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  if (row[0] != NULL)
+  {
+    memcpy(*gtid_set, row[0], field_sizes[0]);
+  }
+  (*gtid_set)[field_sizes[0]]= '\0';
+
+  drizzle_result_free(result);
+  return DRIZZLE_RETURN_OK;
+}
+
+/* Format descriptions written by 5.6.1 and later end with the checksum
+   algorithm of the events and a checksum, whether it is used or not */
+static bool _binlog_has_checksum_alg(const drizzle_binlog_event_st *event)
+{
+  char version[DRIZZLE_BINLOG_SERVER_VERSION_SIZE + 1];
+  unsigned int major= 0;
+  unsigned int minor= 0;
+  unsigned int patch= 0;
+
+  /* Binlog version, server version, timestamp, header length, algorithm
+     and checksum */
+  if (event->length < 2 + DRIZZLE_BINLOG_SERVER_VERSION_SIZE + 4 + 1 + 1 +
+                      DRIZZLE_BINLOG_CRC32_LEN)
+  {
+    return false;
+  }
+
+  memcpy(version, event->data + 2, DRIZZLE_BINLOG_SERVER_VERSION_SIZE);
+  version[DRIZZLE_BINLOG_SERVER_VERSION_SIZE]= 0;
+  if (sscanf(version, "%u.%u.%u", &major, &minor, &patch) < 2)
+  {
+    return false;
+  }
+
+  return major > 5 || (major == 5 && (minor > 6 || (minor == 6 && patch >= 1)));
+}
+
+/*
+ * Binlog GTID sets
+ */
+
+static void _gtid_clear(drizzle_binlog_gtid_set_st *set)
+{
+  for (uint32_t x= 0; x < set->sid_count; x++)
+  {
+    delete[] set->sid_list[x].interval_list;
+    set->sid_list[x].interval_list= NULL;
+    set->sid_list[x].interval_count= 0;
+    set->sid_list[x].interval_size= 0;
+  }
+  set->sid_count= 0;
+}
+
+void drizzle_binlog_gtid_reset(drizzle_binlog_st *binlog)
+{
+  _gtid_clear(&binlog->gtid_set);
+  binlog->gtid_pending= false;
+  binlog->gtid_commit_gno= 0;
+}
+
+static int _gtid_hex(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/* A UUID in its 8-4-4-4-12 text form */
+static const char *_gtid_parse_uuid(const char *ptr, unsigned char *uuid)
+{
+  uint32_t byte= 0;
+
+  for (uint32_t x= 0; x < 36; x++)
+  {
+    if (x == 8 || x == 13 || x == 18 || x == 23)
+    {
+      if (ptr[x] != '-')
+      {
+        return NULL;
+      }
+      continue;
+    }
+
+    int high= _gtid_hex(ptr[x]);
+    int low= high < 0 ? -1 : _gtid_hex(ptr[x + 1]);
+    if (low < 0)
+    {
+      return NULL;
+    }
+    uuid[byte++]= (unsigned char)((high << 4) | low);
+    x++;
+  }
+
+  return ptr + 36;
+}
+
+static const char *_gtid_parse_number(const char *ptr, uint64_t *number)
+{
+  char *end;
+
+  if (*ptr < '0' || *ptr > '9')
+  {
+    return NULL;
+  }
+
+  errno= 0;
+  *number= strtoull(ptr, &end, 10);
+  if (errno != 0)
+  {
+    return NULL;
+  }
+
+  return end;
+}
+
+static const char *_gtid_skip_space(const char *ptr)
+{
+  while (isspace((unsigned char)*ptr))
+  {
+    ptr++;
+  }
+  return ptr;
+}
+
+static drizzle_return_t _gtid_parse(drizzle_binlog_gtid_set_st *set,
+                                    const char *gtid_set)
+{
+  unsigned char uuid[DRIZZLE_BINLOG_UUID_SIZE];
+  const char *ptr;
+  drizzle_return_t ret;
+
+  _gtid_clear(set);
+
+  ptr= _gtid_skip_space(gtid_set);
+  while (*ptr != '\0')
+  {
+    ptr= _gtid_parse_uuid(ptr, uuid);
+    if (ptr == NULL)
+    {
+      return DRIZZLE_RETURN_INVALID_ARGUMENT;
+    }
+
+    ptr= _gtid_skip_space(ptr);
+    if (*ptr != ':')
+    {
+      return DRIZZLE_RETURN_INVALID_ARGUMENT;
+    }
+
+    // One or more intervals of transaction numbers, "start[-end]"
+    while (*ptr == ':')
+    {
+      uint64_t start;
+      uint64_t end;
+
+      ptr= _gtid_parse_number(_gtid_skip_space(ptr + 1), &start);
+      if (ptr == NULL || start == 0)
+      {
+        return DRIZZLE_RETURN_INVALID_ARGUMENT;
+      }
+      end= start;
+
+      ptr= _gtid_skip_space(ptr);
+      if (*ptr == '-')
+      {
+        ptr= _gtid_parse_number(_gtid_skip_space(ptr + 1), &end);
+        if (ptr == NULL || end < start)
+        {
+          return DRIZZLE_RETURN_INVALID_ARGUMENT;
+        }
+        ptr= _gtid_skip_space(ptr);
+      }
+
+      if (end == UINT64_MAX)
+      {
+        return DRIZZLE_RETURN_INVALID_ARGUMENT;
+      }
+
+      ret= _gtid_add(set, uuid, start, end + 1);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+    }
+
+    if (*ptr == ',')
+    {
+      ptr= _gtid_skip_space(ptr + 1);
+      if (*ptr == '\0')
+      {
+        return DRIZZLE_RETURN_INVALID_ARGUMENT;
+      }
+    }
+    else if (*ptr != '\0')
+    {
+      return DRIZZLE_RETURN_INVALID_ARGUMENT;
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/* Add the transactions [start, end) of a server to the set, keeping the
+   intervals sorted and merged */
+static drizzle_return_t _gtid_add(drizzle_binlog_gtid_set_st *set,
+                                  const unsigned char *uuid, uint64_t start,
+                                  uint64_t end)
+{
+  drizzle_binlog_gtid_sid_st *sid= NULL;
+  uint32_t first;
+  uint32_t last;
+
+  for (uint32_t x= 0; x < set->sid_count; x++)
+  {
+    if (memcmp(set->sid_list[x].uuid, uuid, DRIZZLE_BINLOG_UUID_SIZE) == 0)
+    {
+      sid= &set->sid_list[x];
+      break;
+    }
+  }
+
+  if (sid == NULL)
+  {
+    if (set->sid_count == set->sid_size)
+    {
+      uint32_t size= set->sid_size == 0 ? 4 : set->sid_size * 2;
+      drizzle_binlog_gtid_sid_st *sid_list=
+        new (std::nothrow) drizzle_binlog_gtid_sid_st[size];
+      if (sid_list == NULL)
+      {
+        return DRIZZLE_RETURN_MEMORY;
+      }
+      for (uint32_t x= 0; x < set->sid_count; x++)
+      {
+        sid_list[x]= set->sid_list[x];
+      }
+      delete[] set->sid_list;
+      set->sid_list= sid_list;
+      set->sid_size= size;
+    }
+
+    sid= &set->sid_list[set->sid_count++];
+    memcpy(sid->uuid, uuid, DRIZZLE_BINLOG_UUID_SIZE);
+    sid->interval_list= NULL;
+    sid->interval_count= 0;
+    sid->interval_size= 0;
+  }
+
+  // The intervals from 'first' up to 'last' touch the new one
+  for (first= 0; first < sid->interval_count; first++)
+  {
+    if (sid->interval_list[first].end >= start)
+    {
+      break;
+    }
+  }
+  for (last= first; last < sid->interval_count; last++)
+  {
+    if (sid->interval_list[last].start > end)
+    {
+      break;
+    }
+  }
+
+  if (first < last)
+  {
+    if (sid->interval_list[first].start < start)
+    {
+      start= sid->interval_list[first].start;
+    }
+    if (sid->interval_list[last - 1].end > end)
+    {
+      end= sid->interval_list[last - 1].end;
+    }
+    sid->interval_list[first].start= start;
+    sid->interval_list[first].end= end;
+    memmove(&sid->interval_list[first + 1], &sid->interval_list[last],
+            (sid->interval_count - last) *
+            sizeof(drizzle_binlog_gtid_interval_st));
+    sid->interval_count-= last - first - 1;
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (sid->interval_count == sid->interval_size)
+  {
+    uint32_t size= sid->interval_size == 0 ? 4 : sid->interval_size * 2;
+    drizzle_binlog_gtid_interval_st *interval_list=
+      new (std::nothrow) drizzle_binlog_gtid_interval_st[size];
+    if (interval_list == NULL)
+    {
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    if (sid->interval_count > 0)
+    {
+      memcpy(interval_list, sid->interval_list,
+             sid->interval_count * sizeof(drizzle_binlog_gtid_interval_st));
+    }
+    delete[] sid->interval_list;
+    sid->interval_list= interval_list;
+    sid->interval_size= size;
+  }
+
+  memmove(&sid->interval_list[first + 1], &sid->interval_list[first],
+          (sid->interval_count - first) *
+          sizeof(drizzle_binlog_gtid_interval_st));
+  sid->interval_list[first].start= start;
+  sid->interval_list[first].end= end;
+  sid->interval_count++;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/* Replace the set with a copy of another one */
+static drizzle_return_t _gtid_copy(drizzle_binlog_gtid_set_st *set,
+                                   const drizzle_binlog_gtid_set_st *from)
+{
+  _gtid_clear(set);
+  for (uint32_t x= 0; x < from->sid_count; x++)
+  {
+    drizzle_binlog_gtid_sid_st *sid= &from->sid_list[x];
+    for (uint32_t y= 0; y < sid->interval_count; y++)
+    {
+      drizzle_return_t ret= _gtid_add(set, sid->uuid,
+                                      sid->interval_list[y].start,
+                                      sid->interval_list[y].end);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/* Add the transaction of the last GTID event to the set once it commits */
+static drizzle_return_t _gtid_track(drizzle_binlog_st *binlog)
+{
+  drizzle_binlog_event_st *event= &binlog->event;
+  drizzle_return_t ret;
+
+  binlog->gtid_commit_gno= 0;
+
+  if (event->type == DRIZZLE_EVENT_TYPE_GTID)
+  {
+    // Flags, server UUID and transaction number
+    if (event->length < 1 + DRIZZLE_BINLOG_UUID_SIZE + 8)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                        "GTID event too short:%" PRIu32, event->length);
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    memcpy(binlog->gtid_pending_uuid, event->data + 1,
+           DRIZZLE_BINLOG_UUID_SIZE);
+    binlog->gtid_pending_gno=
+      drizzle_get_byte8(event->data + 1 + DRIZZLE_BINLOG_UUID_SIZE);
+    binlog->gtid_pending= binlog->gtid_pending_gno > 0;
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (event->type == DRIZZLE_EVENT_TYPE_ANONYMOUS_GTID)
+  {
+    binlog->gtid_pending= false;
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (!binlog->gtid_pending)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (event->type == DRIZZLE_EVENT_TYPE_QUERY)
+  {
+    // A BEGIN opens the transaction, any other statement is one on its own
+    // or ends it
+    if (event->length >= 13)
+    {
+      uint32_t offset= 13 + drizzle_get_byte2(event->data + 11) +
+                       event->data[8] + 1;
+      if (offset + 5 == event->length &&
+          memcmp(event->data + offset, "BEGIN", 5) == 0)
+      {
+        return DRIZZLE_RETURN_OK;
+      }
+    }
+  }
+  else if (event->type != DRIZZLE_EVENT_TYPE_XID)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  binlog->gtid_pending= false;
+  binlog->gtid_commit_gno= binlog->gtid_pending_gno;
+  ret= _gtid_add(&binlog->gtid_set, binlog->gtid_pending_uuid,
+                 binlog->gtid_pending_gno, binlog->gtid_pending_gno + 1);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+  }
+
+  return ret;
+}
+
+static char *_gtid_format(const drizzle_binlog_gtid_set_st *set)
+{
+  static const char hex[]= "0123456789abcdef";
+  size_t size= 1;
+  char *gtid_set;
+  char *ptr;
+
+  for (uint32_t x= 0; x < set->sid_count; x++)
+  {
+    size+= 36 + 1 + (size_t)set->sid_list[x].interval_count *
+                    DRIZZLE_BINLOG_GTID_INTERVAL_TEXT;
+  }
+
+  gtid_set= (char*)malloc(size);
+  if (gtid_set == NULL)
+  {
+    return NULL;
+  }
+
+  ptr= gtid_set;
+  for (uint32_t x= 0; x < set->sid_count; x++)
+  {
+    drizzle_binlog_gtid_sid_st *sid= &set->sid_list[x];
+
+    if (x > 0)
+    {
+      *ptr++= ',';
+    }
+    for (uint32_t y= 0; y < DRIZZLE_BINLOG_UUID_SIZE; y++)
+    {
+      if (y == 4 || y == 6 || y == 8 || y == 10)
+      {
+        *ptr++= '-';
+      }
+      *ptr++= hex[sid->uuid[y] >> 4];
+      *ptr++= hex[sid->uuid[y] & 0xf];
+    }
+    for (uint32_t y= 0; y < sid->interval_count; y++)
+    {
+      uint64_t start= sid->interval_list[y].start;
+      uint64_t end= sid->interval_list[y].end - 1;
+      if (start == end)
+      {
+        ptr+= sprintf(ptr, ":%" PRIu64, start);
+      }
+      else
+      {
+        ptr+= sprintf(ptr, ":%" PRIu64 "-%" PRIu64, start, end);
+      }
+    }
+  }
+  *ptr= '\0';
+
+  return gtid_set;
+}
+
+/*
+ * Binlog ring
+ */
+
+/* Room for the next event of the given size, starting at *offset */
+static bool _ring_has_room(drizzle_binlog_ring_st *ring, uint32_t size,
+                           size_t *offset)
+{
+  uint64_t tail= __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+  uint64_t data_tail= __atomic_load_n(&ring->data_tail, __ATOMIC_SEQ_CST);
+  size_t position= (size_t)(ring->data_head % ring->data_size);
+
+  /* Event data is kept contiguous, skipping the end of the ring if needed */
+  *offset= (position + size > ring->data_size) ? ring->data_size - position : 0;
+
+  return ring->pending - tail < ring->event_count &&
+         ring->data_head + *offset + size - data_tail <= ring->data_size;
+}
+
+static void _ring_publish(drizzle_binlog_ring_st *ring)
+{
+  if (__atomic_load_n(&ring->head, __ATOMIC_RELAXED) == ring->pending)
+  {
+    return;
+  }
+
+  __atomic_store_n(&ring->head, ring->pending, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->consumer_waiting, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+  }
+}
+
+/* A complete packet follows in the read buffer */
+static bool _ring_packet_buffered(drizzle_st *con)
+{
+  return con->buffer_size >= 4 &&
+         con->buffer_size >= 4 + (uint64_t)drizzle_get_byte3(con->buffer_ptr);
+}
+
+drizzle_return_t drizzle_binlog_ring_open(drizzle_binlog_st *binlog)
+{
+  drizzle_binlog_ring_st *ring= binlog->ring;
+  drizzle_return_t ret;
+
+  if (ring == NULL)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  pthread_mutex_lock(&ring->lock);
+  ret= _gtid_copy(&ring->gtid_set, &binlog->gtid_set);
+  ring->gtid_ret= ret;
+  pthread_mutex_unlock(&ring->lock);
+
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+  }
+
+  return ret;
+}
+
+drizzle_return_t drizzle_binlog_ring_push(drizzle_binlog_st *binlog)
+{
+  drizzle_binlog_ring_st *ring= binlog->ring;
+  drizzle_binlog_event_st *event= &binlog->event;
+  drizzle_binlog_event_st *slot;
+  drizzle_binlog_ring_gtid_st *gtid;
+  size_t offset;
+
+  if (event->raw_length > ring->data_size)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "binlog event of %" PRIu32 " bytes does not fit into "
+                      "the ring of %zu bytes", event->raw_length,
+                      ring->data_size);
+    return DRIZZLE_RETURN_INTERNAL_ERROR;
+  }
+
+  if (!_ring_has_room(ring, event->raw_length, &offset))
+  {
+    /* The consumer may be waiting for what is already written */
+    _ring_publish(ring);
+
+    pthread_mutex_lock(&ring->lock);
+    __atomic_store_n(&ring->producer_waiting, true, __ATOMIC_SEQ_CST);
+    while (!_ring_has_room(ring, event->raw_length, &offset))
+    {
+      pthread_cond_wait(&ring->cond, &ring->lock);
+    }
+    __atomic_store_n(&ring->producer_waiting, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&ring->lock);
+  }
+
+  ring->data_head+= offset;
+  slot= &ring->event_list[ring->pending % ring->event_count];
+  *slot= *event;
+  slot->raw_data= ring->data + (ring->data_head % ring->data_size);
+  memcpy(slot->raw_data, event->raw_data, event->raw_length);
+  if (event->data != NULL)
+  {
+    slot->data= slot->raw_data + (event->data - event->raw_data);
+  }
+  ring->data_head+= event->raw_length;
+  ring->data_end_list[ring->pending % ring->event_count]= ring->data_head;
+  ring->verify_list[ring->pending % ring->event_count]=
+    ring->verify_checksums && binlog->verify_checksums &&
+    binlog->has_checksums;
+  gtid= &ring->gtid_list[ring->pending % ring->event_count];
+  memcpy(gtid->uuid, binlog->gtid_pending_uuid, DRIZZLE_BINLOG_UUID_SIZE);
+  gtid->gno= binlog->gtid_commit_gno;
+  ring->pending++;
+
+  /* Publish a batch once it is full or before blocking on the network */
+  if (ring->pending - __atomic_load_n(&ring->head, __ATOMIC_RELAXED) >=
+      ring->batch_size ||
+      (!binlog->from_file && !_ring_packet_buffered(binlog->con)))
+  {
+    _ring_publish(ring);
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+void drizzle_binlog_ring_close(drizzle_binlog_ring_st *ring,
+                               drizzle_return_t ret)
+{
+  _ring_publish(ring);
+
+  pthread_mutex_lock(&ring->lock);
+  /* The consumer needs an error to know that nothing more will come */
+  ring->close_ret= (ret == DRIZZLE_RETURN_OK) ? DRIZZLE_RETURN_EOF : ret;
+  __atomic_store_n(&ring->closed, true, __ATOMIC_SEQ_CST);
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+}
+
+drizzle_binlog_ring_st *drizzle_binlog_ring_create(uint32_t event_count,
+                                                   size_t data_size,
+                                                   uint32_t batch_size)
+{
+  if (event_count == 0 || data_size == 0)
+  {
+    return NULL;
+  }
+
+  drizzle_binlog_ring_st *ring= new (std::nothrow) drizzle_binlog_ring_st;
+  if (ring == NULL)
+  {
+    return NULL;
+  }
+
+  ring->event_list= new (std::nothrow) drizzle_binlog_event_st[event_count];
+  ring->data_end_list= new (std::nothrow) uint64_t[event_count];
+  ring->verify_list= new (std::nothrow) bool[event_count];
+  ring->gtid_list= new (std::nothrow) drizzle_binlog_ring_gtid_st[event_count];
+  ring->data= new (std::nothrow) unsigned char[data_size];
+  if (ring->event_list == NULL || ring->data_end_list == NULL ||
+      ring->verify_list == NULL || ring->gtid_list == NULL ||
+      ring->data == NULL)
+  {
+    delete[] ring->event_list;
+    delete[] ring->data_end_list;
+    delete[] ring->verify_list;
+    delete[] ring->gtid_list;
+    delete[] ring->data;
+    delete ring;
+    return NULL;
+  }
+
+  ring->event_count= event_count;
+  ring->data_size= data_size;
+  if (batch_size == 0)
+  {
+    ring->batch_size= 1;
+  }
+  else
+  {
+    ring->batch_size= batch_size > event_count ? event_count : batch_size;
+  }
+
+  pthread_mutex_init(&ring->lock, NULL);
+  pthread_cond_init(&ring->cond, NULL);
+
+  return ring;
+}
+
+void drizzle_binlog_ring_free(drizzle_binlog_ring_st *ring)
+{
+  if (ring == NULL)
+  {
+    return;
+  }
+
+  pthread_cond_destroy(&ring->cond);
+  pthread_mutex_destroy(&ring->lock);
+  _gtid_clear(&ring->gtid_set);
+  delete[] ring->gtid_set.sid_list;
+  delete[] ring->event_list;
+  delete[] ring->data_end_list;
+  delete[] ring->verify_list;
+  delete[] ring->gtid_list;
+  delete[] ring->data;
+  delete ring;
+}
+
+drizzle_return_t drizzle_binlog_ring_set_verify_checksums(drizzle_binlog_ring_st *ring,
+                                                          bool verify)
+{
+  if (ring == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  ring->verify_checksums= verify;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_binlog_set_ring(drizzle_binlog_st *binlog,
+                                         drizzle_binlog_ring_st *ring)
+{
+  if (binlog == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (ring != NULL)
+  {
+    pthread_mutex_lock(&ring->lock);
+    ring->close_ret= DRIZZLE_RETURN_OK;
+    __atomic_store_n(&ring->closed, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->lock);
+  }
+
+  binlog->ring= ring;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+uint32_t drizzle_binlog_ring_read(drizzle_binlog_ring_st *ring,
+                                  drizzle_binlog_event_st **event_list,
+                                  uint32_t count, drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  if (ring == NULL || event_list == NULL || count == 0)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return 0;
+  }
+
+  uint64_t tail= __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  uint64_t head= __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+  if (head == tail)
+  {
+    pthread_mutex_lock(&ring->lock);
+    __atomic_store_n(&ring->consumer_waiting, true, __ATOMIC_SEQ_CST);
+    while ((head= __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST)) == tail &&
+           !__atomic_load_n(&ring->closed, __ATOMIC_SEQ_CST))
+    {
+      pthread_cond_wait(&ring->cond, &ring->lock);
+    }
+    __atomic_store_n(&ring->consumer_waiting, false, __ATOMIC_RELAXED);
+    *ret_ptr= ring->close_ret;
+    pthread_mutex_unlock(&ring->lock);
+
+    if (head == tail)
+    {
+      return 0;
+    }
+  }
+
+  if (head - tail < count)
+  {
+    count= (uint32_t)(head - tail);
+  }
+
+  for (uint32_t x= 0; x < count; x++)
+  {
+    event_list[x]= &ring->event_list[(tail + x) % ring->event_count];
+  }
+
+  /* Events left to the consumer to verify are checked once, up to the
+     first one which fails */
+  if (ring->verified < tail)
+  {
+    ring->verified= tail;
+  }
+  while (ring->verified < tail + count)
+  {
+    uint32_t slot= (uint32_t)(ring->verified % ring->event_count);
+    drizzle_binlog_event_st *event= &ring->event_list[slot];
+
+    if (ring->verify_list[slot] &&
+        drizzle_crc32(0, event->raw_data,
+                      event->raw_length - DRIZZLE_BINLOG_CRC32_LEN) !=
+        event->checksum)
+    {
+      if (ring->verified == tail)
+      {
+        *ret_ptr= DRIZZLE_RETURN_BINLOG_CRC;
+        return 1;
+      }
+      count= (uint32_t)(ring->verified - tail);
+      break;
+    }
+    ring->verified++;
+  }
+
+  *ret_ptr= DRIZZLE_RETURN_OK;
+  return count;
+}
+
+void drizzle_binlog_ring_release(drizzle_binlog_ring_st *ring, uint32_t count)
+{
+  if (ring == NULL || count == 0)
+  {
+    return;
+  }
+
+  uint64_t tail= __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  uint64_t head= __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  if (count > head - tail)
+  {
+    count= (uint32_t)(head - tail);
+  }
+
+  if (count == 0)
+  {
+    return;
+  }
+
+  // The transactions committed by the released events are handled
+  bool locked= false;
+  for (uint64_t x= tail; x < tail + count; x++)
+  {
+    drizzle_binlog_ring_gtid_st *gtid= &ring->gtid_list[x % ring->event_count];
+    if (gtid->gno == 0)
+    {
+      continue;
+    }
+    if (!locked)
+    {
+      pthread_mutex_lock(&ring->lock);
+      locked= true;
+    }
+    if (_gtid_add(&ring->gtid_set, gtid->uuid, gtid->gno, gtid->gno + 1) !=
+        DRIZZLE_RETURN_OK)
+    {
+      ring->gtid_ret= DRIZZLE_RETURN_MEMORY;
+    }
+  }
+  if (locked)
+  {
+    pthread_mutex_unlock(&ring->lock);
+  }
+
+  tail+= count;
+  __atomic_store_n(&ring->data_tail,
+                   ring->data_end_list[(tail - 1) % ring->event_count],
+                   __ATOMIC_SEQ_CST);
+  __atomic_store_n(&ring->tail, tail, __ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&ring->producer_waiting, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->lock);
+  }
+}
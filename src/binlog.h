@@ -37,5 +37,219 @@
 
 #pragma once
 
+#include <pthread.h>
+
 drizzle_return_t drizzle_state_binlog_read(drizzle_st *con);
 
+/**
+ * Fill the current event of a binlog from its raw data, verifying its
+ * checksum unless a ring is left to do it.
+ */
+drizzle_return_t drizzle_binlog_event_parse(drizzle_binlog_st *binlog,
+                                            unsigned char *raw_data,
+                                            uint32_t raw_length);
+
+/**
+ * Track the GTID of the current event and hand it to the ring or the event
+ * callback.
+ */
+drizzle_return_t drizzle_binlog_event_dispatch(drizzle_binlog_st *binlog);
+
+/**
+ * Empty the GTID set tracked by a binlog.
+ */
+void drizzle_binlog_gtid_reset(drizzle_binlog_st *binlog);
+
+/**
+ * @addtogroup drizzle_binlog_ring_private Private Binlog Ring
+ *
+ * Events are handed from the thread reading the binlog stream to a single
+ * consumer thread through a fixed array of event slots and a byte ring
+ * holding the raw event data. Each side only writes its own counters, so
+ * neither needs a lock while there is room or there are events; the mutex
+ * is only taken to sleep on a full or an empty ring.
+ *
+ * Each slot also records the transaction its event commits. Releasing the
+ * event adds it to the GTID set of the ring, which only the consumer
+ * changes once the stream has started, so the set never gets ahead of the
+ * events the consumer has handled. The mutex guards this set.
+ * @{
+ */
+
+/* The transaction committed by an event of the ring */
+struct drizzle_binlog_ring_gtid_st
+{
+  unsigned char uuid[DRIZZLE_BINLOG_UUID_SIZE];
+  uint64_t gno;                  /* 0 if the event commits none */
+};
+
+struct drizzle_binlog_ring_st
+{
+  drizzle_binlog_event_st *event_list;
+  uint64_t *data_end_list;       /* data_head after each event */
+  bool *verify_list;             /* checksum left to the consumer */
+  drizzle_binlog_ring_gtid_st *gtid_list;
+  unsigned char *data;
+  uint32_t event_count;
+  size_t data_size;
+  uint32_t batch_size;
+  bool verify_checksums;
+  uint64_t pending;              /* events written by the producer */
+  uint64_t data_head;            /* bytes written by the producer */
+  uint64_t head;                 /* events published, atomic */
+  unsigned char head_pad[64];    /* keeps the counters on separate lines */
+  uint64_t tail;                 /* events released, atomic */
+  uint64_t data_tail;            /* bytes released, atomic */
+  uint64_t verified;             /* events checked by the consumer */
+  unsigned char tail_pad[64];
+  bool producer_waiting;         /* atomic */
+  bool consumer_waiting;         /* atomic */
+  bool closed;                   /* atomic */
+  drizzle_return_t close_ret;
+  drizzle_binlog_gtid_set_st gtid_set; /* released transactions */
+  drizzle_return_t gtid_ret;     /* DRIZZLE_RETURN_MEMORY if one was lost */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  drizzle_binlog_ring_st() :
+    event_list(NULL),
+    data_end_list(NULL),
+    verify_list(NULL),
+    gtid_list(NULL),
+    data(NULL),
+    event_count(0),
+    data_size(0),
+    batch_size(0),
+    verify_checksums(false),
+    pending(0),
+    data_head(0),
+    head(0),
+    tail(0),
+    data_tail(0),
+    verified(0),
+    producer_waiting(false),
+    consumer_waiting(false),
+    closed(false),
+    close_ret(DRIZZLE_RETURN_OK),
+    gtid_ret(DRIZZLE_RETURN_OK)
+  { }
+};
+
+/**
+ * Start the GTID set of the ring from the one the binlog stream starts
+ * from, called before the first event is pushed.
+ */
+drizzle_return_t drizzle_binlog_ring_open(drizzle_binlog_st *binlog);
+
+/**
+ * Copy the current event of the binlog stream into its ring, waiting for
+ * room if the ring is full.
+ */
+drizzle_return_t drizzle_binlog_ring_push(drizzle_binlog_st *binlog);
+
+/**
+ * Publish the pending events and mark the ring as finished with the given
+ * return code of the binlog stream.
+ */
+void drizzle_binlog_ring_close(drizzle_binlog_ring_st *ring,
+                               drizzle_return_t ret);
+
+/** @} */
+
+/**
+ * @addtogroup drizzle_binlog_rows_private Private Binlog Row Decoder
+ *
+ * Table maps are cached by table id in a hash table, and also kept in a list
+ * from the most to the least recently used one. Decoding a row only
+ * records where the value of each column starts and how long it is; the
+ * values are converted when they are asked for, and strings and blobs are
+ * handed out as views into the event data.
+ * @{
+ */
+
+/* Room for the text of a decimal, a date or a number */
+#define DRIZZLE_BINLOG_TEXT_SIZE 80
+
+/* Largest DECIMAL the server accepts, which fits the text above */
+#define DRIZZLE_BINLOG_DECIMAL_PRECISION 65
+#define DRIZZLE_BINLOG_DECIMAL_SCALE 30
+
+/* Cached table maps beyond which the least recently used one is dropped */
+#define DRIZZLE_BINLOG_TABLE_LIMIT 4096
+
+struct drizzle_binlog_table_st
+{
+  uint64_t table_id;
+  char *schema;
+  char *name;
+  uint32_t column_count;
+  drizzle_column_type_t *type_list;
+  uint16_t *meta_list;
+  unsigned char *null_bitmap;
+  bool *unsigned_list;            /* NULL without the optional metadata */
+  char **column_name_list;        /* NULL without the optional metadata */
+  unsigned char *map;             /* copy of the TABLE_MAP event data */
+  size_t map_size;
+  drizzle_binlog_table_st *next;   /* next in the hash bucket */
+  drizzle_binlog_table_st *lru_prev;
+  drizzle_binlog_table_st *lru_next;
+  drizzle_binlog_table_st() :
+    table_id(0),
+    schema(NULL),
+    name(NULL),
+    column_count(0),
+    type_list(NULL),
+    meta_list(NULL),
+    null_bitmap(NULL),
+    unsigned_list(NULL),
+    column_name_list(NULL),
+    map(NULL),
+    map_size(0),
+    next(NULL),
+    lru_prev(NULL),
+    lru_next(NULL)
+  { }
+};
+
+struct drizzle_binlog_value_st
+{
+  const unsigned char *data;
+  size_t size;
+  bool present;
+  bool null;
+  char text[DRIZZLE_BINLOG_TEXT_SIZE];
+};
+
+struct drizzle_binlog_rows_st
+{
+  drizzle_binlog_table_st **bucket_list;
+  uint32_t bucket_count;
+  uint32_t table_count;
+  drizzle_binlog_table_st *lru_first;  /* most recently used */
+  drizzle_binlog_table_st *lru_last;
+  drizzle_binlog_table_st *table;
+  const unsigned char *row_ptr;
+  const unsigned char *row_end;
+  const unsigned char *present_bitmap[2];
+  uint32_t present_count[2];
+  bool has_image[2];
+  drizzle_binlog_value_st *value_list[2];
+  uint32_t value_count;
+  drizzle_binlog_rows_st() :
+    bucket_list(NULL),
+    bucket_count(0),
+    table_count(0),
+    lru_first(NULL),
+    lru_last(NULL),
+    table(NULL),
+    row_ptr(NULL),
+    row_end(NULL),
+    value_count(0)
+  {
+    present_bitmap[0]= present_bitmap[1]= NULL;
+    present_count[0]= present_count[1]= 0;
+    has_image[0]= has_image[1]= false;
+    value_list[0]= value_list[1]= NULL;
+  }
+};
+
+/** @} */
@@ -0,0 +1,439 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Binlog file reader
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <ctype.h>
+#include <inttypes.h>
+
+#ifndef _WIN32
+# include <dirent.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+/* The fixed header of a v4 event */
+#define DRIZZLE_BINLOG_FILE_HEADER_SIZE 19
+
+/* Bytes of a file asked to be read ahead of the event being parsed */
+#define DRIZZLE_BINLOG_FILE_READ_AHEAD (8 * 1024 * 1024)
+#define DRIZZLE_BINLOG_INDEX_SUFFIX ".index"
+
+/*
+ * Private declarations
+ */
+
+#ifndef _WIN32
+static drizzle_return_t _file_read(drizzle_binlog_st *binlog,
+                                   const char *path);
+static drizzle_return_t _file_read_index(drizzle_binlog_st *binlog,
+                                         const char *path);
+static drizzle_return_t _file_find_index(drizzle_binlog_st *binlog,
+                                         const char *directory, char **path);
+static bool _file_is_binlog(const char *path);
+#endif
+
+/*
+ * Common definitions
+ */
+
+drizzle_return_t drizzle_binlog_start_file(drizzle_binlog_st *binlog,
+                                           const char *path)
+{
+  drizzle_return_t ret;
+
+  if (binlog == NULL || path == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+#ifdef _WIN32
+  drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                    "reading binlog files is not supported on this platform");
+  ret= DRIZZLE_RETURN_INTERNAL_ERROR;
+#else
+  struct stat path_stat;
+
+  drizzle_binlog_gtid_reset(binlog);
+  binlog->from_file= true;
+
+  ret= drizzle_binlog_ring_open(binlog);
+  if (ret == DRIZZLE_RETURN_OK)
+  {
+    if (stat(path, &path_stat) != 0)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "stat:%s:%s", path,
+                        strerror(errno));
+      binlog->con->last_errno= errno;
+      ret= DRIZZLE_RETURN_ERRNO;
+    }
+    else if (S_ISDIR(path_stat.st_mode))
+    {
+      char *index_path;
+
+      ret= _file_find_index(binlog, path, &index_path);
+      if (ret == DRIZZLE_RETURN_OK)
+      {
+        ret= _file_read_index(binlog, index_path);
+        free(index_path);
+      }
+    }
+    else if (_file_is_binlog(path))
+    {
+      ret= _file_read(binlog, path);
+    }
+    else
+    {
+      ret= _file_read_index(binlog, path);
+    }
+  }
+
+  binlog->from_file= false;
+#endif
+
+  // The end of the last file ends the stream as it does with a server ID of 0
+  if (ret == DRIZZLE_RETURN_OK)
+  {
+    ret= DRIZZLE_RETURN_EOF;
+  }
+
+  if (binlog->error_fn != NULL)
+  {
+    binlog->error_fn(ret, binlog->con, binlog->binlog_context);
+  }
+
+  if (binlog->ring != NULL)
+  {
+    drizzle_binlog_ring_close(binlog->ring, ret);
+  }
+
+  return ret;
+}
+
+/*
+ * Private definitions
+ */
+
+#ifndef _WIN32
+static bool _file_is_binlog(const char *path)
+{
+  char magic[4];
+  bool is_binlog= false;
+  int fd;
+
+  fd= open(path, O_RDONLY);
+  if (fd >= 0)
+  {
+    is_binlog= read(fd, magic, 4) == 4 &&
+               memcmp(magic, DRIZZLE_BINLOG_MAGIC, 4) == 0;
+    close(fd);
+  }
+
+  return is_binlog;
+}
+
+/* Hand every event of one binlog file over, from a read-only mapping */
+static drizzle_return_t _file_read(drizzle_binlog_st *binlog,
+                                   const char *path)
+{
+  drizzle_return_t ret= DRIZZLE_RETURN_OK;
+  struct stat file_stat;
+  unsigned char *map;
+  uint64_t page_size= (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t position;
+  uint64_t advised;
+  uint64_t released;
+  uint64_t size;
+  int fd;
+
+  fd= open(path, O_RDONLY);
+  if (fd < 0 || fstat(fd, &file_stat) != 0)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "open:%s:%s", path,
+                      strerror(errno));
+    binlog->con->last_errno= errno;
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+    return DRIZZLE_RETURN_ERRNO;
+  }
+
+  size= (uint64_t)file_stat.st_size;
+  if (size < 4)
+  {
+    close(fd);
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "not a binlog file:%s", path);
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  map= (unsigned char *)mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "mmap:%s:%s", path,
+                      strerror(errno));
+    binlog->con->last_errno= errno;
+    return DRIZZLE_RETURN_ERRNO;
+  }
+  madvise(map, (size_t)size, MADV_SEQUENTIAL);
+
+  if (memcmp(map, DRIZZLE_BINLOG_MAGIC, 4) != 0)
+  {
+    munmap(map, (size_t)size);
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "not a binlog file:%s", path);
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  // Every file starts with its own format description
+  binlog->has_checksums= false;
+
+  position= 4;
+  advised= 0;
+  released= 0;
+  while (position < size)
+  {
+    uint32_t length;
+
+    if (size - position < DRIZZLE_BINLOG_FILE_HEADER_SIZE)
+    {
+      length= 0;
+    }
+    else
+    {
+      length= drizzle_get_byte4(map + position + DRIZZLE_EVENT_POSITION_LENGTH);
+    }
+    if (length < DRIZZLE_BINLOG_FILE_HEADER_SIZE || length > size - position)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                        "truncated event in %s at %" PRIu64, path, position);
+      ret= DRIZZLE_RETURN_UNEXPECTED_DATA;
+      break;
+    }
+
+    /* Ask for the next window before reaching it, and give back the pages
+       of the events already handed over */
+    if (position + length > advised)
+    {
+      uint64_t start= position - position % page_size;
+
+      advised= start + DRIZZLE_BINLOG_FILE_READ_AHEAD;
+      if (advised < position + length)
+      {
+        advised= position + length;
+      }
+      if (advised > size)
+      {
+        advised= size;
+      }
+      madvise(map + start, (size_t)(advised - start), MADV_WILLNEED);
+      if (start > released)
+      {
+        madvise(map + released, (size_t)(start - released), MADV_DONTNEED);
+        released= start;
+      }
+    }
+
+    ret= drizzle_binlog_event_parse(binlog, map + position, length);
+    if (ret == DRIZZLE_RETURN_OK)
+    {
+      ret= drizzle_binlog_event_dispatch(binlog);
+    }
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      break;
+    }
+
+    position+= length;
+  }
+
+  munmap(map, (size_t)size);
+
+  return ret;
+}
+
+/* Read the binlog files listed in an index file, one name per line */
+static drizzle_return_t _file_read_index(drizzle_binlog_st *binlog,
+                                         const char *path)
+{
+  drizzle_return_t ret= DRIZZLE_RETURN_OK;
+  const char *separator;
+  size_t directory_size;
+  char *file_path= NULL;
+  char *line= NULL;
+  size_t line_size= 0;
+  uint32_t file_count= 0;
+  FILE *index;
+
+  index= fopen(path, "r");
+  if (index == NULL)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "fopen:%s:%s", path,
+                      strerror(errno));
+    binlog->con->last_errno= errno;
+    return DRIZZLE_RETURN_ERRNO;
+  }
+
+  // Relative names are relative to the directory of the index
+  separator= strrchr(path, '/');
+  directory_size= separator == NULL ? 0 : (size_t)(separator - path) + 1;
+
+  while (getline(&line, &line_size, index) != -1)
+  {
+    size_t size= strlen(line);
+
+    while (size > 0 && isspace((unsigned char)line[size - 1]))
+    {
+      size--;
+    }
+    line[size]= '\0';
+    if (size == 0)
+    {
+      continue;
+    }
+
+    free(file_path);
+    file_path= (char *)malloc(directory_size + size + 1);
+    if (file_path == NULL)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+      ret= DRIZZLE_RETURN_MEMORY;
+      break;
+    }
+    if (line[0] == '/')
+    {
+      memcpy(file_path, line, size + 1);
+    }
+    else
+    {
+      memcpy(file_path, path, directory_size);
+      memcpy(file_path + directory_size, line, size + 1);
+    }
+
+    ret= _file_read(binlog, file_path);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      break;
+    }
+    file_count++;
+  }
+
+  if (ret == DRIZZLE_RETURN_OK && file_count == 0)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "no binlog files listed in %s", path);
+    ret= DRIZZLE_RETURN_NOT_FOUND;
+  }
+
+  free(file_path);
+  free(line);
+  fclose(index);
+
+  return ret;
+}
+
+/* The one index file of a directory */
+static drizzle_return_t _file_find_index(drizzle_binlog_st *binlog,
+                                         const char *directory, char **path)
+{
+  size_t suffix_size= strlen(DRIZZLE_BINLOG_INDEX_SUFFIX);
+  size_t directory_size= strlen(directory);
+  struct dirent *entry;
+  DIR *dir;
+
+  *path= NULL;
+  dir= opendir(directory);
+  if (dir == NULL)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "opendir:%s:%s",
+                      directory, strerror(errno));
+    binlog->con->last_errno= errno;
+    return DRIZZLE_RETURN_ERRNO;
+  }
+
+  while ((entry= readdir(dir)) != NULL)
+  {
+    size_t size= strlen(entry->d_name);
+
+    if (size <= suffix_size ||
+        strcmp(entry->d_name + size - suffix_size,
+               DRIZZLE_BINLOG_INDEX_SUFFIX) != 0)
+    {
+      continue;
+    }
+
+    if (*path != NULL)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                        "more than one binlog index file in %s", directory);
+      free(*path);
+      *path= NULL;
+      closedir(dir);
+      return DRIZZLE_RETURN_INVALID_ARGUMENT;
+    }
+
+    *path= (char *)malloc(directory_size + size + 2);
+    if (*path == NULL)
+    {
+      drizzle_set_error(binlog->con, __FILE_LINE_FUNC__, "malloc");
+      closedir(dir);
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    snprintf(*path, directory_size + size + 2, "%s/%s", directory,
+             entry->d_name);
+  }
+  closedir(dir);
+
+  if (*path == NULL)
+  {
+    drizzle_set_error(binlog->con, __FILE_LINE_FUNC__,
+                      "no binlog index file in %s", directory);
+    return DRIZZLE_RETURN_NOT_FOUND;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+#endif
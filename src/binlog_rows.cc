@@ -0,0 +1,1911 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Row based binlog event decoder
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <inttypes.h>
+
+#define DRIZZLE_BINLOG_INITIAL_BUCKETS 64
+
+/* Optional metadata of MySQL 8.0 table maps */
+#define DRIZZLE_BINLOG_META_SIGNEDNESS 1
+#define DRIZZLE_BINLOG_META_COLUMN_NAME 4
+
+/* Offsets of the integer parts of the binary temporal types */
+#define DRIZZLE_BINLOG_DATETIMEF_INT_OFS INT64_C(0x8000000000)
+#define DRIZZLE_BINLOG_TIMEF_INT_OFS INT64_C(0x800000)
+#define DRIZZLE_BINLOG_TIMEF_OFS INT64_C(0x800000000000)
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Parse the copy of a TABLE_MAP event held by the table.
+ */
+static drizzle_return_t _table_parse(drizzle_binlog_table_st *table);
+
+static drizzle_return_t _table_optional(drizzle_binlog_table_st *table,
+                                        const unsigned char *ptr,
+                                        const unsigned char *end);
+
+static void _table_free(drizzle_binlog_table_st *table);
+
+static drizzle_binlog_table_st *_table_find(drizzle_binlog_rows_st *rows,
+                                            uint64_t table_id);
+
+static drizzle_return_t _table_insert(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_table_st *table);
+
+static void _table_remove(drizzle_binlog_rows_st *rows,
+                          drizzle_binlog_table_st *table);
+
+static void _table_touch(drizzle_binlog_rows_st *rows,
+                         drizzle_binlog_table_st *table);
+
+static void _table_clear(drizzle_binlog_rows_st *rows);
+
+static drizzle_return_t _table_map(drizzle_binlog_rows_st *rows,
+                                   const unsigned char *data, size_t size);
+
+static drizzle_return_t _rows_event(drizzle_binlog_rows_st *rows,
+                                    drizzle_binlog_event_types_t type,
+                                    const unsigned char *data, size_t size);
+
+/**
+ * Record the position of every column value of one row image.
+ */
+static drizzle_return_t _row_image(drizzle_binlog_rows_st *rows,
+                                   drizzle_binlog_image_t image);
+
+/**
+ * Number of metadata bytes a column type has in a TABLE_MAP event, or -1
+ * for types which can not be decoded.
+ */
+static int _meta_size(drizzle_column_type_t type);
+
+/**
+ * Find the data and size of a column value starting at ptr.
+ *
+ * @return The number of bytes the value takes up in the row image, or 0 if
+ *         it does not fit before end.
+ */
+static size_t _value_size(drizzle_column_type_t type, uint16_t meta,
+                          const unsigned char *ptr, const unsigned char *end,
+                          const unsigned char **data, size_t *size);
+
+static drizzle_binlog_value_st *_value(drizzle_binlog_rows_st *rows,
+                                       drizzle_binlog_image_t image,
+                                       uint32_t column,
+                                       drizzle_return_t *ret_ptr);
+
+static uint64_t _value_integer(drizzle_binlog_rows_st *rows,
+                               drizzle_binlog_value_st *value,
+                               uint32_t column, bool sign_extend,
+                               drizzle_return_t *ret_ptr);
+
+static double _value_double(drizzle_binlog_rows_st *rows,
+                            drizzle_binlog_value_st *value,
+                            uint32_t column, drizzle_return_t *ret_ptr);
+
+static void _value_decimal(uint16_t meta, const unsigned char *data,
+                           char *text);
+
+static void _text_append(char *text, size_t *used, const char *format, ...)
+  __attribute__((format(printf, 3, 4)));
+
+static void _value_temporal(drizzle_column_type_t type, uint16_t meta,
+                            const unsigned char *data, char *text);
+
+static bool _is_numeric(drizzle_column_type_t type);
+
+static bool _read_length(const unsigned char **ptr, const unsigned char *end,
+                         uint64_t *value);
+
+static uint64_t _get_be(const unsigned char *ptr, size_t size);
+
+static uint64_t _get_le(const unsigned char *ptr, size_t size);
+
+static bool _bit(const unsigned char *bitmap, uint32_t bit);
+
+/*
+ * Client definitions
+ */
+
+drizzle_binlog_rows_st *drizzle_binlog_rows_create(void)
+{
+  drizzle_binlog_rows_st *rows= new (std::nothrow) drizzle_binlog_rows_st;
+  if (rows == NULL)
+  {
+    return NULL;
+  }
+
+  rows->bucket_list=
+    new (std::nothrow) drizzle_binlog_table_st*[DRIZZLE_BINLOG_INITIAL_BUCKETS]();
+  if (rows->bucket_list == NULL)
+  {
+    delete rows;
+    return NULL;
+  }
+  rows->bucket_count= DRIZZLE_BINLOG_INITIAL_BUCKETS;
+
+  return rows;
+}
+
+void drizzle_binlog_rows_free(drizzle_binlog_rows_st *rows)
+{
+  if (rows == NULL)
+  {
+    return;
+  }
+
+  _table_clear(rows);
+  delete[] rows->bucket_list;
+  delete[] rows->value_list[DRIZZLE_BINLOG_IMAGE_BEFORE];
+  delete[] rows->value_list[DRIZZLE_BINLOG_IMAGE_AFTER];
+  delete rows;
+}
+
+drizzle_return_t drizzle_binlog_rows_decode(drizzle_binlog_rows_st *rows,
+                                            drizzle_binlog_event_st *event)
+{
+  if (rows == NULL || event == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  switch (event->type)
+  {
+  case DRIZZLE_EVENT_TYPE_TABLE_MAP:
+    return _table_map(rows, event->data, event->length);
+
+  case DRIZZLE_EVENT_TYPE_OBSOLETE_WRITE_ROWS:
+  case DRIZZLE_EVENT_TYPE_OBSOLETE_UPDATE_ROWS:
+  case DRIZZLE_EVENT_TYPE_OBSOLETE_DELETE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V1_WRITE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V1_UPDATE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V1_DELETE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V2_UPDATE_ROWS:
+  case DRIZZLE_EVENT_TYPE_V2_DELETE_ROWS:
+    return _rows_event(rows, event->type, event->data, event->length);
+
+  case DRIZZLE_EVENT_TYPE_UNKNOWN:
+  case DRIZZLE_EVENT_TYPE_START:
+  case DRIZZLE_EVENT_TYPE_QUERY:
+  case DRIZZLE_EVENT_TYPE_STOP:
+  case DRIZZLE_EVENT_TYPE_ROTATE:
+  case DRIZZLE_EVENT_TYPE_INTVAR:
+  case DRIZZLE_EVENT_TYPE_LOAD:
+  case DRIZZLE_EVENT_TYPE_SLAVE:
+  case DRIZZLE_EVENT_TYPE_CREATE_FILE:
+  case DRIZZLE_EVENT_TYPE_APPEND_BLOCK:
+  case DRIZZLE_EVENT_TYPE_EXEC_LOAD:
+  case DRIZZLE_EVENT_TYPE_DELETE_FILE:
+  case DRIZZLE_EVENT_TYPE_NEW_LOAD:
+  case DRIZZLE_EVENT_TYPE_RAND:
+  case DRIZZLE_EVENT_TYPE_USER_VAR:
+  case DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION:
+  case DRIZZLE_EVENT_TYPE_XID:
+  case DRIZZLE_EVENT_TYPE_BEGIN_LOAD_QUERY:
+  case DRIZZLE_EVENT_TYPE_EXECUTE_LOAD_QUERY:
+  case DRIZZLE_EVENT_TYPE_INCIDENT:
+  case DRIZZLE_EVENT_TYPE_HEARTBEAT:
+  case DRIZZLE_EVENT_TYPE_IGNORABLE:
+  case DRIZZLE_EVENT_TYPE_ROWS_QUERY:
+  case DRIZZLE_EVENT_TYPE_GTID:
+  case DRIZZLE_EVENT_TYPE_ANONYMOUS_GTID:
+  case DRIZZLE_EVENT_TYPE_PREVIOUS_GTIDS:
+  case DRIZZLE_EVENT_TYPE_END:
+  default:
+    break;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_binlog_rows_next(drizzle_binlog_rows_st *rows)
+{
+  drizzle_return_t ret;
+
+  if (rows == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (rows->table == NULL || rows->row_ptr >= rows->row_end)
+  {
+    return DRIZZLE_RETURN_ROW_END;
+  }
+
+  if (rows->has_image[DRIZZLE_BINLOG_IMAGE_BEFORE])
+  {
+    ret= _row_image(rows, DRIZZLE_BINLOG_IMAGE_BEFORE);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+  }
+
+  if (rows->has_image[DRIZZLE_BINLOG_IMAGE_AFTER])
+  {
+    ret= _row_image(rows, DRIZZLE_BINLOG_IMAGE_AFTER);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+const drizzle_binlog_table_st *drizzle_binlog_rows_table(drizzle_binlog_rows_st *rows)
+{
+  if (rows == NULL)
+  {
+    return NULL;
+  }
+
+  return rows->table;
+}
+
+bool drizzle_binlog_rows_has_image(drizzle_binlog_rows_st *rows,
+                                   drizzle_binlog_image_t image)
+{
+  if (rows == NULL || rows->table == NULL ||
+      (image != DRIZZLE_BINLOG_IMAGE_BEFORE && image != DRIZZLE_BINLOG_IMAGE_AFTER))
+  {
+    return false;
+  }
+
+  return rows->has_image[image];
+}
+
+bool drizzle_binlog_rows_is_null(drizzle_binlog_rows_st *rows,
+                                 drizzle_binlog_image_t image, uint32_t column,
+                                 drizzle_return_t *ret_ptr)
+{
+  drizzle_binlog_value_st *value= _value(rows, image, column, ret_ptr);
+  if (value == NULL)
+  {
+    return false;
+  }
+
+  return value->null;
+}
+
+int64_t drizzle_binlog_rows_get_int(drizzle_binlog_rows_st *rows,
+                                    drizzle_binlog_image_t image,
+                                    uint32_t column, drizzle_return_t *ret_ptr)
+{
+  drizzle_binlog_value_st *value;
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  value= _value(rows, image, column, ret_ptr);
+  if (value == NULL)
+  {
+    return 0;
+  }
+
+  return (int64_t)_value_integer(rows, value, column, true, ret_ptr);
+}
+
+uint64_t drizzle_binlog_rows_get_uint(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_image_t image,
+                                      uint32_t column, drizzle_return_t *ret_ptr)
+{
+  drizzle_binlog_value_st *value;
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  value= _value(rows, image, column, ret_ptr);
+  if (value == NULL)
+  {
+    return 0;
+  }
+
+  return _value_integer(rows, value, column, false, ret_ptr);
+}
+
+double drizzle_binlog_rows_get_double(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_image_t image,
+                                      uint32_t column, drizzle_return_t *ret_ptr)
+{
+  drizzle_binlog_value_st *value;
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  value= _value(rows, image, column, ret_ptr);
+  if (value == NULL)
+  {
+    return 0;
+  }
+
+  return _value_double(rows, value, column, ret_ptr);
+}
+
+const char *drizzle_binlog_rows_get_string(drizzle_binlog_rows_st *rows,
+                                           drizzle_binlog_image_t image,
+                                           uint32_t column, size_t *size,
+                                           drizzle_return_t *ret_ptr)
+{
+  drizzle_binlog_value_st *value;
+  drizzle_column_type_t type;
+  uint64_t integer;
+  double real;
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  value= _value(rows, image, column, ret_ptr);
+
+  if (size != NULL)
+  {
+    *size= 0;
+  }
+
+  if (value == NULL)
+  {
+    return NULL;
+  }
+
+  if (value->null)
+  {
+    *ret_ptr= DRIZZLE_RETURN_NULL_SIZE;
+    return NULL;
+  }
+
+  type= rows->table->type_list[column];
+  switch (type)
+  {
+  /* Views into the event */
+  case DRIZZLE_COLUMN_TYPE_VARCHAR:
+  case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+  case DRIZZLE_COLUMN_TYPE_STRING:
+  case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+  case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+  case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+  case DRIZZLE_COLUMN_TYPE_BLOB:
+  case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+  case DRIZZLE_COLUMN_TYPE_JSON:
+  case DRIZZLE_COLUMN_TYPE_BIT:
+    if (size != NULL)
+    {
+      *size= value->size;
+    }
+    return (const char *)value->data;
+
+  case DRIZZLE_COLUMN_TYPE_TINY:
+  case DRIZZLE_COLUMN_TYPE_SHORT:
+  case DRIZZLE_COLUMN_TYPE_INT24:
+  case DRIZZLE_COLUMN_TYPE_LONG:
+  case DRIZZLE_COLUMN_TYPE_LONGLONG:
+    if (rows->table->unsigned_list != NULL &&
+        rows->table->unsigned_list[column])
+    {
+      integer= _value_integer(rows, value, column, false, ret_ptr);
+      snprintf(value->text, DRIZZLE_BINLOG_TEXT_SIZE, "%" PRIu64, integer);
+    }
+    else
+    {
+      integer= _value_integer(rows, value, column, true, ret_ptr);
+      snprintf(value->text, DRIZZLE_BINLOG_TEXT_SIZE, "%" PRId64,
+               (int64_t)integer);
+    }
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_YEAR:
+  case DRIZZLE_COLUMN_TYPE_ENUM:
+  case DRIZZLE_COLUMN_TYPE_SET:
+    integer= _value_integer(rows, value, column, false, ret_ptr);
+    snprintf(value->text, DRIZZLE_BINLOG_TEXT_SIZE, "%" PRIu64, integer);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_FLOAT:
+    real= _value_double(rows, value, column, ret_ptr);
+    snprintf(value->text, DRIZZLE_BINLOG_TEXT_SIZE, "%.7g", real);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_DOUBLE:
+    real= _value_double(rows, value, column, ret_ptr);
+    snprintf(value->text, DRIZZLE_BINLOG_TEXT_SIZE, "%.17g", real);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+    _value_decimal(rows->table->meta_list[column], value->data, value->text);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+  case DRIZZLE_COLUMN_TYPE_DATE:
+  case DRIZZLE_COLUMN_TYPE_TIME:
+  case DRIZZLE_COLUMN_TYPE_DATETIME:
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+  case DRIZZLE_COLUMN_TYPE_DATETIME2:
+  case DRIZZLE_COLUMN_TYPE_TIME2:
+    _value_temporal(type, rows->table->meta_list[column], value->data,
+                    value->text);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_NULL:
+    *ret_ptr= DRIZZLE_RETURN_NULL_SIZE;
+    return NULL;
+
+  case DRIZZLE_COLUMN_TYPE_DECIMAL:
+  case DRIZZLE_COLUMN_TYPE_NEWDATE:
+  default:
+    *ret_ptr= DRIZZLE_RETURN_INVALID_CONVERSION;
+    return NULL;
+  }
+
+  if (size != NULL)
+  {
+    *size= strlen(value->text);
+  }
+  return value->text;
+}
+
+uint64_t drizzle_binlog_table_id(const drizzle_binlog_table_st *table)
+{
+  if (table == NULL)
+  {
+    return 0;
+  }
+
+  return table->table_id;
+}
+
+const char *drizzle_binlog_table_schema(const drizzle_binlog_table_st *table)
+{
+  if (table == NULL)
+  {
+    return NULL;
+  }
+
+  return table->schema;
+}
+
+const char *drizzle_binlog_table_name(const drizzle_binlog_table_st *table)
+{
+  if (table == NULL)
+  {
+    return NULL;
+  }
+
+  return table->name;
+}
+
+uint32_t drizzle_binlog_table_column_count(const drizzle_binlog_table_st *table)
+{
+  if (table == NULL)
+  {
+    return 0;
+  }
+
+  return table->column_count;
+}
+
+drizzle_column_type_t drizzle_binlog_table_column_type(const drizzle_binlog_table_st *table,
+                                                       uint32_t column)
+{
+  if (table == NULL || column >= table->column_count)
+  {
+    return DRIZZLE_COLUMN_TYPE_NONE;
+  }
+
+  return table->type_list[column];
+}
+
+uint16_t drizzle_binlog_table_column_meta(const drizzle_binlog_table_st *table,
+                                          uint32_t column)
+{
+  if (table == NULL || column >= table->column_count)
+  {
+    return 0;
+  }
+
+  return table->meta_list[column];
+}
+
+bool drizzle_binlog_table_column_nullable(const drizzle_binlog_table_st *table,
+                                          uint32_t column)
+{
+  if (table == NULL || column >= table->column_count)
+  {
+    return false;
+  }
+
+  return _bit(table->null_bitmap, column);
+}
+
+bool drizzle_binlog_table_column_is_unsigned(const drizzle_binlog_table_st *table,
+                                             uint32_t column)
+{
+  if (table == NULL || column >= table->column_count ||
+      table->unsigned_list == NULL)
+  {
+    return false;
+  }
+
+  return table->unsigned_list[column];
+}
+
+const char *drizzle_binlog_table_column_name(const drizzle_binlog_table_st *table,
+                                             uint32_t column)
+{
+  if (table == NULL || column >= table->column_count ||
+      table->column_name_list == NULL)
+  {
+    return NULL;
+  }
+
+  return table->column_name_list[column];
+}
+
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _table_parse(drizzle_binlog_table_st *table)
+{
+  const unsigned char *ptr= table->map + 8;
+  const unsigned char *end= table->map + table->map_size;
+  const unsigned char *meta_ptr;
+  const unsigned char *meta_end;
+  const unsigned char *type_ptr;
+  uint64_t column_count;
+  uint64_t meta_size;
+  size_t length;
+
+  /* Schema and table names, both NUL terminated */
+  for (int x= 0; x < 2; x++)
+  {
+    if (ptr >= end)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    length= *ptr++;
+    if ((size_t)(end - ptr) < length + 1 || ptr[length] != 0)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    if (x == 0)
+    {
+      table->schema= (char *)ptr;
+    }
+    else
+    {
+      table->name= (char *)ptr;
+    }
+    ptr+= length + 1;
+  }
+
+  if (!_read_length(&ptr, end, &column_count) ||
+      column_count > (uint64_t)(end - ptr))
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+  table->column_count= (uint32_t)column_count;
+  type_ptr= ptr;
+  ptr+= column_count;
+
+  if (!_read_length(&ptr, end, &meta_size) ||
+      meta_size > (uint64_t)(end - ptr))
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+  meta_ptr= ptr;
+  meta_end= ptr + meta_size;
+  ptr= meta_end;
+
+  if ((size_t)(end - ptr) < (table->column_count + 7) / 8)
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+  table->null_bitmap= (unsigned char *)ptr;
+  ptr+= (table->column_count + 7) / 8;
+
+  table->type_list= new (std::nothrow) drizzle_column_type_t[table->column_count];
+  table->meta_list= new (std::nothrow) uint16_t[table->column_count];
+  if (table->type_list == NULL || table->meta_list == NULL)
+  {
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  for (uint32_t x= 0; x < table->column_count; x++)
+  {
+    drizzle_column_type_t type= (drizzle_column_type_t)type_ptr[x];
+    int meta_length= _meta_size(type);
+    uint16_t meta;
+
+    if (meta_length < 0 || meta_end - meta_ptr < meta_length)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+
+    switch (meta_length)
+    {
+    case 1:
+      meta= meta_ptr[0];
+      break;
+    case 2:
+      if (type == DRIZZLE_COLUMN_TYPE_VARCHAR ||
+          type == DRIZZLE_COLUMN_TYPE_VAR_STRING ||
+          type == DRIZZLE_COLUMN_TYPE_BIT)
+      {
+        meta= drizzle_get_byte2(meta_ptr);
+      }
+      else
+      {
+        meta= (uint16_t)((meta_ptr[0] << 8) | meta_ptr[1]);
+      }
+      break;
+    default:
+      meta= 0;
+      break;
+    }
+    meta_ptr+= meta_length;
+
+    /* The real type of a CHAR column and the top bits of its length are
+       packed into the first metadata byte, the type list keeps the real
+       type and the metadata the maximum length */
+    if (type == DRIZZLE_COLUMN_TYPE_STRING)
+    {
+      unsigned int real_type= meta >> 8;
+      unsigned int max_length= meta & 0xFF;
+      if ((real_type & 0x30) != 0x30)
+      {
+        max_length|= ((real_type & 0x30) ^ 0x30) << 4;
+        real_type|= 0x30;
+      }
+      if (real_type == DRIZZLE_COLUMN_TYPE_ENUM ||
+          real_type == DRIZZLE_COLUMN_TYPE_SET)
+      {
+        /* The low byte is the size of the value */
+        type= (drizzle_column_type_t)real_type;
+      }
+      meta= (uint16_t)max_length;
+    }
+    else if (type == DRIZZLE_COLUMN_TYPE_NEWDECIMAL)
+    {
+      if ((meta >> 8) > DRIZZLE_BINLOG_DECIMAL_PRECISION ||
+          (meta & 0xFF) > DRIZZLE_BINLOG_DECIMAL_SCALE ||
+          (meta & 0xFF) > (meta >> 8))
+      {
+        return DRIZZLE_RETURN_UNEXPECTED_DATA;
+      }
+    }
+
+    table->type_list[x]= type;
+    table->meta_list[x]= meta;
+  }
+
+  return _table_optional(table, ptr, end);
+}
+
+static drizzle_return_t _table_optional(drizzle_binlog_table_st *table,
+                                        const unsigned char *ptr,
+                                        const unsigned char *end)
+{
+  while (ptr < end)
+  {
+    unsigned char field_type= *ptr++;
+    const unsigned char *field_end;
+    uint64_t length;
+
+    if (!_read_length(&ptr, end, &length) || length > (uint64_t)(end - ptr))
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    field_end= ptr + length;
+
+    if (field_type == DRIZZLE_BINLOG_META_SIGNEDNESS)
+    {
+      /* One bit per numeric column, the first one in the highest bit */
+      uint32_t bit= 0;
+      table->unsigned_list= new (std::nothrow) bool[table->column_count];
+      if (table->unsigned_list == NULL)
+      {
+        return DRIZZLE_RETURN_MEMORY;
+      }
+      for (uint32_t x= 0; x < table->column_count; x++)
+      {
+        table->unsigned_list[x]= false;
+        if (_is_numeric(table->type_list[x]))
+        {
+          if (bit / 8 >= length)
+          {
+            return DRIZZLE_RETURN_UNEXPECTED_DATA;
+          }
+          table->unsigned_list[x]= (ptr[bit / 8] & (0x80 >> (bit % 8))) != 0;
+          bit++;
+        }
+      }
+    }
+    else if (field_type == DRIZZLE_BINLOG_META_COLUMN_NAME)
+    {
+      const unsigned char *name_ptr= ptr;
+      size_t name_size= 0;
+      char *name_buffer;
+
+      for (uint32_t x= 0; x < table->column_count; x++)
+      {
+        uint64_t name_length;
+        if (!_read_length(&name_ptr, field_end, &name_length) ||
+            name_length > (uint64_t)(field_end - name_ptr))
+        {
+          return DRIZZLE_RETURN_UNEXPECTED_DATA;
+        }
+        name_ptr+= name_length;
+        name_size+= (size_t)name_length + 1;
+      }
+
+      /* The names are kept in one block after the pointers to them */
+      table->column_name_list= (char **)
+        new (std::nothrow) char[sizeof(char *) * table->column_count + name_size];
+      if (table->column_name_list == NULL)
+      {
+        return DRIZZLE_RETURN_MEMORY;
+      }
+      name_buffer= (char *)(table->column_name_list + table->column_count);
+      name_ptr= ptr;
+      for (uint32_t x= 0; x < table->column_count; x++)
+      {
+        uint64_t name_length;
+        (void)_read_length(&name_ptr, field_end, &name_length);
+        memcpy(name_buffer, name_ptr, (size_t)name_length);
+        name_buffer[name_length]= 0;
+        table->column_name_list[x]= name_buffer;
+        name_buffer+= name_length + 1;
+        name_ptr+= name_length;
+      }
+    }
+
+    ptr= field_end;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static void _table_free(drizzle_binlog_table_st *table)
+{
+  delete[] table->type_list;
+  delete[] table->meta_list;
+  delete[] table->unsigned_list;
+  delete[] (char *)table->column_name_list;
+  delete[] table->map;
+  delete table;
+}
+
+static drizzle_binlog_table_st *_table_find(drizzle_binlog_rows_st *rows,
+                                            uint64_t table_id)
+{
+  drizzle_binlog_table_st *table;
+
+  for (table= rows->bucket_list[table_id & (rows->bucket_count - 1)];
+       table != NULL; table= table->next)
+  {
+    if (table->table_id == table_id)
+    {
+      return table;
+    }
+  }
+
+  return NULL;
+}
+
+static drizzle_return_t _table_insert(drizzle_binlog_rows_st *rows,
+                                      drizzle_binlog_table_st *table)
+{
+  drizzle_binlog_table_st **bucket;
+
+  if (rows->table_count >= rows->bucket_count)
+  {
+    uint32_t bucket_count= rows->bucket_count * 2;
+    drizzle_binlog_table_st **bucket_list=
+      new (std::nothrow) drizzle_binlog_table_st*[bucket_count]();
+    if (bucket_list == NULL)
+    {
+      return DRIZZLE_RETURN_MEMORY;
+    }
+
+    for (uint32_t x= 0; x < rows->bucket_count; x++)
+    {
+      while (rows->bucket_list[x] != NULL)
+      {
+        drizzle_binlog_table_st *next= rows->bucket_list[x]->next;
+        bucket= &bucket_list[rows->bucket_list[x]->table_id & (bucket_count - 1)];
+        rows->bucket_list[x]->next= *bucket;
+        *bucket= rows->bucket_list[x];
+        rows->bucket_list[x]= next;
+      }
+    }
+
+    delete[] rows->bucket_list;
+    rows->bucket_list= bucket_list;
+    rows->bucket_count= bucket_count;
+  }
+
+  bucket= &rows->bucket_list[table->table_id & (rows->bucket_count - 1)];
+  table->next= *bucket;
+  *bucket= table;
+  rows->table_count++;
+  _table_touch(rows, table);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/* Unlink a table map from the cache and free it */
+static void _table_remove(drizzle_binlog_rows_st *rows,
+                          drizzle_binlog_table_st *table)
+{
+  drizzle_binlog_table_st **link;
+
+  for (link= &rows->bucket_list[table->table_id & (rows->bucket_count - 1)];
+       *link != table; link= &(*link)->next)
+  { }
+  *link= table->next;
+
+  if (table->lru_prev != NULL)
+  {
+    table->lru_prev->lru_next= table->lru_next;
+  }
+  else
+  {
+    rows->lru_first= table->lru_next;
+  }
+  if (table->lru_next != NULL)
+  {
+    table->lru_next->lru_prev= table->lru_prev;
+  }
+  else
+  {
+    rows->lru_last= table->lru_prev;
+  }
+
+  rows->table_count--;
+  if (rows->table == table)
+  {
+    rows->table= NULL;
+  }
+  _table_free(table);
+}
+
+/* Move a table map to the front of the recently used list */
+static void _table_touch(drizzle_binlog_rows_st *rows,
+                         drizzle_binlog_table_st *table)
+{
+  if (rows->lru_first == table)
+  {
+    return;
+  }
+
+  if (table->lru_prev != NULL)
+  {
+    table->lru_prev->lru_next= table->lru_next;
+  }
+  if (table->lru_next != NULL)
+  {
+    table->lru_next->lru_prev= table->lru_prev;
+  }
+  else if (rows->lru_last == table)
+  {
+    rows->lru_last= table->lru_prev;
+  }
+
+  table->lru_prev= NULL;
+  table->lru_next= rows->lru_first;
+  if (rows->lru_first != NULL)
+  {
+    rows->lru_first->lru_prev= table;
+  }
+  rows->lru_first= table;
+  if (rows->lru_last == NULL)
+  {
+    rows->lru_last= table;
+  }
+}
+
+static void _table_clear(drizzle_binlog_rows_st *rows)
+{
+  for (uint32_t x= 0; x < rows->bucket_count; x++)
+  {
+    while (rows->bucket_list[x] != NULL)
+    {
+      drizzle_binlog_table_st *next= rows->bucket_list[x]->next;
+      _table_free(rows->bucket_list[x]);
+      rows->bucket_list[x]= next;
+    }
+  }
+
+  rows->table_count= 0;
+  rows->lru_first= NULL;
+  rows->lru_last= NULL;
+  rows->table= NULL;
+}
+
+static drizzle_return_t _table_map(drizzle_binlog_rows_st *rows,
+                                   const unsigned char *data, size_t size)
+{
+  drizzle_binlog_table_st *table;
+  drizzle_return_t ret;
+  uint64_t table_id;
+
+  if (data == NULL || size < 8)
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  table_id= _get_le(data, 6);
+
+  /* The same map is sent again before every statement touching the table */
+  table= _table_find(rows, table_id);
+  if (table != NULL && table->map_size == size &&
+      memcmp(table->map, data, size) == 0)
+  {
+    _table_touch(rows, table);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  drizzle_binlog_table_st *new_table= new (std::nothrow) drizzle_binlog_table_st;
+  if (new_table == NULL)
+  {
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  new_table->table_id= table_id;
+  new_table->map_size= size;
+  new_table->map= new (std::nothrow) unsigned char[size];
+  if (new_table->map == NULL)
+  {
+    _table_free(new_table);
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  memcpy(new_table->map, data, size);
+
+  ret= _table_parse(new_table);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    _table_free(new_table);
+    return ret;
+  }
+
+  /* A table id is reused after the table definition changed */
+  if (table != NULL)
+  {
+    _table_remove(rows, table);
+  }
+
+  /* The maps of a statement are all sent right before its ROWS events, so
+     the least recently used map is not one of them */
+  if (rows->table_count >= DRIZZLE_BINLOG_TABLE_LIMIT)
+  {
+    _table_remove(rows, rows->lru_last);
+  }
+
+  ret= _table_insert(rows, new_table);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    _table_free(new_table);
+  }
+
+  return ret;
+}
+
+static drizzle_return_t _rows_event(drizzle_binlog_rows_st *rows,
+                                    drizzle_binlog_event_types_t type,
+                                    const unsigned char *data, size_t size)
+{
+  const unsigned char *ptr= data;
+  const unsigned char *end= data + size;
+  drizzle_binlog_table_st *table;
+  uint64_t column_count;
+  size_t bitmap_size;
+
+  rows->table= NULL;
+
+  if (data == NULL || size < 8)
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  table= _table_find(rows, _get_le(data, 6));
+  if (table == NULL)
+  {
+    return DRIZZLE_RETURN_NOT_FOUND;
+  }
+  _table_touch(rows, table);
+  ptr+= 8;
+
+  /* Version 2 events carry extra data after the flags */
+  if (type == DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS ||
+      type == DRIZZLE_EVENT_TYPE_V2_UPDATE_ROWS ||
+      type == DRIZZLE_EVENT_TYPE_V2_DELETE_ROWS)
+  {
+    size_t extra_size;
+    if (end - ptr < 2)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    extra_size= drizzle_get_byte2(ptr);
+    if (extra_size < 2 || (size_t)(end - ptr) < extra_size)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    ptr+= extra_size;
+  }
+
+  if (!_read_length(&ptr, end, &column_count) ||
+      column_count != table->column_count)
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  if (rows->value_count < table->column_count)
+  {
+    for (int x= 0; x < 2; x++)
+    {
+      delete[] rows->value_list[x];
+      rows->value_list[x]=
+        new (std::nothrow) drizzle_binlog_value_st[table->column_count];
+    }
+    if (rows->value_list[0] == NULL || rows->value_list[1] == NULL)
+    {
+      rows->value_count= 0;
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    rows->value_count= table->column_count;
+  }
+
+  rows->has_image[DRIZZLE_BINLOG_IMAGE_BEFORE]=
+    type != DRIZZLE_EVENT_TYPE_OBSOLETE_WRITE_ROWS &&
+    type != DRIZZLE_EVENT_TYPE_V1_WRITE_ROWS &&
+    type != DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS;
+  rows->has_image[DRIZZLE_BINLOG_IMAGE_AFTER]=
+    type != DRIZZLE_EVENT_TYPE_OBSOLETE_DELETE_ROWS &&
+    type != DRIZZLE_EVENT_TYPE_V1_DELETE_ROWS &&
+    type != DRIZZLE_EVENT_TYPE_V2_DELETE_ROWS;
+
+  /* The columns present in each image, before image first */
+  bitmap_size= (table->column_count + 7) / 8;
+  for (int x= 0; x < 2; x++)
+  {
+    rows->present_count[x]= 0;
+    if (!rows->has_image[x])
+    {
+      continue;
+    }
+    if ((size_t)(end - ptr) < bitmap_size)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    rows->present_bitmap[x]= ptr;
+    for (uint32_t column= 0; column < table->column_count; column++)
+    {
+      if (_bit(ptr, column))
+      {
+        rows->present_count[x]++;
+      }
+    }
+    ptr+= bitmap_size;
+  }
+
+  rows->table= table;
+  rows->row_ptr= ptr;
+  rows->row_end= end;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_return_t _row_image(drizzle_binlog_rows_st *rows,
+                                   drizzle_binlog_image_t image)
+{
+  drizzle_binlog_table_st *table= rows->table;
+  drizzle_binlog_value_st *value_list= rows->value_list[image];
+  const unsigned char *present= rows->present_bitmap[image];
+  const unsigned char *ptr= rows->row_ptr;
+  const unsigned char *null_bitmap;
+  uint32_t bit= 0;
+
+  /* The NULL bitmap only has bits for the columns present in the image */
+  null_bitmap= ptr;
+  if ((size_t)(rows->row_end - ptr) < (rows->present_count[image] + 7) / 8)
+  {
+    rows->table= NULL;
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+  ptr+= (rows->present_count[image] + 7) / 8;
+
+  for (uint32_t x= 0; x < table->column_count; x++)
+  {
+    drizzle_binlog_value_st *value= &value_list[x];
+
+    value->present= _bit(present, x);
+    value->null= false;
+    value->data= NULL;
+    value->size= 0;
+    if (!value->present)
+    {
+      continue;
+    }
+
+    if (_bit(null_bitmap, bit++))
+    {
+      value->null= true;
+      continue;
+    }
+
+    size_t used= _value_size(table->type_list[x], table->meta_list[x], ptr,
+                             rows->row_end, &value->data, &value->size);
+    if (used == 0 && table->type_list[x] != DRIZZLE_COLUMN_TYPE_NULL)
+    {
+      rows->table= NULL;
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+    ptr+= used;
+  }
+
+  rows->row_ptr= ptr;
+  return DRIZZLE_RETURN_OK;
+}
+
+static int _meta_size(drizzle_column_type_t type)
+{
+  switch (type)
+  {
+  case DRIZZLE_COLUMN_TYPE_TINY:
+  case DRIZZLE_COLUMN_TYPE_SHORT:
+  case DRIZZLE_COLUMN_TYPE_INT24:
+  case DRIZZLE_COLUMN_TYPE_LONG:
+  case DRIZZLE_COLUMN_TYPE_LONGLONG:
+  case DRIZZLE_COLUMN_TYPE_NULL:
+  case DRIZZLE_COLUMN_TYPE_YEAR:
+  case DRIZZLE_COLUMN_TYPE_DATE:
+  case DRIZZLE_COLUMN_TYPE_TIME:
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+  case DRIZZLE_COLUMN_TYPE_DATETIME:
+    return 0;
+
+  case DRIZZLE_COLUMN_TYPE_FLOAT:
+  case DRIZZLE_COLUMN_TYPE_DOUBLE:
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+  case DRIZZLE_COLUMN_TYPE_DATETIME2:
+  case DRIZZLE_COLUMN_TYPE_TIME2:
+  case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+  case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+  case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+  case DRIZZLE_COLUMN_TYPE_BLOB:
+  case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+  case DRIZZLE_COLUMN_TYPE_JSON:
+    return 1;
+
+  case DRIZZLE_COLUMN_TYPE_VARCHAR:
+  case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+  case DRIZZLE_COLUMN_TYPE_BIT:
+  case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+  case DRIZZLE_COLUMN_TYPE_STRING:
+  case DRIZZLE_COLUMN_TYPE_ENUM:
+  case DRIZZLE_COLUMN_TYPE_SET:
+    return 2;
+
+  /* Not written by MySQL 5.0 and later */
+  case DRIZZLE_COLUMN_TYPE_DECIMAL:
+  case DRIZZLE_COLUMN_TYPE_NEWDATE:
+  default:
+    return -1;
+  }
+}
+
+static size_t _value_size(drizzle_column_type_t type, uint16_t meta,
+                          const unsigned char *ptr, const unsigned char *end,
+                          const unsigned char **data, size_t *size)
+{
+  static const uint8_t digit_bytes[10]= { 0, 1, 1, 2, 2, 3, 3, 4, 4, 4 };
+  size_t available= (size_t)(end - ptr);
+  size_t prefix= 0;
+
+  switch (type)
+  {
+  case DRIZZLE_COLUMN_TYPE_NULL:
+    *size= 0;
+    break;
+  case DRIZZLE_COLUMN_TYPE_TINY:
+  case DRIZZLE_COLUMN_TYPE_YEAR:
+    *size= 1;
+    break;
+  case DRIZZLE_COLUMN_TYPE_SHORT:
+    *size= 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_INT24:
+  case DRIZZLE_COLUMN_TYPE_DATE:
+  case DRIZZLE_COLUMN_TYPE_TIME:
+    *size= 3;
+    break;
+  case DRIZZLE_COLUMN_TYPE_LONG:
+  case DRIZZLE_COLUMN_TYPE_FLOAT:
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+    *size= 4;
+    break;
+  case DRIZZLE_COLUMN_TYPE_LONGLONG:
+  case DRIZZLE_COLUMN_TYPE_DOUBLE:
+  case DRIZZLE_COLUMN_TYPE_DATETIME:
+    *size= 8;
+    break;
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+    *size= 4 + (meta + 1U) / 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_DATETIME2:
+    *size= 5 + (meta + 1U) / 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_TIME2:
+    *size= 3 + (meta + 1U) / 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_BIT:
+    *size= (meta >> 8) + ((meta & 0xFF) ? 1U : 0U);
+    break;
+  case DRIZZLE_COLUMN_TYPE_ENUM:
+  case DRIZZLE_COLUMN_TYPE_SET:
+    *size= meta & 0xFF;
+    break;
+  case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+    {
+      unsigned int precision= meta >> 8;
+      unsigned int scale= meta & 0xFF;
+      if (scale > precision)
+      {
+        return 0;
+      }
+      unsigned int integer= precision - scale;
+      *size= (integer / 9) * 4 + digit_bytes[integer % 9] +
+             (scale / 9) * 4 + digit_bytes[scale % 9];
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_VARCHAR:
+  case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+    prefix= meta < 256 ? 1 : 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_STRING:
+    prefix= meta < 256 ? 1 : 2;
+    break;
+  case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+  case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+  case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+  case DRIZZLE_COLUMN_TYPE_BLOB:
+  case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+  case DRIZZLE_COLUMN_TYPE_JSON:
+    prefix= meta;
+    if (prefix < 1 || prefix > 4)
+    {
+      return 0;
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_DECIMAL:
+  case DRIZZLE_COLUMN_TYPE_NEWDATE:
+  default:
+    return 0;
+  }
+
+  if (prefix > 0)
+  {
+    if (available < prefix)
+    {
+      return 0;
+    }
+    *size= (size_t)_get_le(ptr, prefix);
+    available-= prefix;
+  }
+
+  if (available < *size)
+  {
+    return 0;
+  }
+
+  *data= ptr + prefix;
+  return prefix + *size;
+}
+
+static drizzle_binlog_value_st *_value(drizzle_binlog_rows_st *rows,
+                                       drizzle_binlog_image_t image,
+                                       uint32_t column,
+                                       drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused_ret;
+  drizzle_binlog_value_st *value;
+
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  if (rows == NULL || rows->table == NULL ||
+      (image != DRIZZLE_BINLOG_IMAGE_BEFORE && image != DRIZZLE_BINLOG_IMAGE_AFTER) ||
+      !rows->has_image[image] || column >= rows->table->column_count)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  value= &rows->value_list[image][column];
+  if (!value->present)
+  {
+    *ret_ptr= DRIZZLE_RETURN_NOT_FOUND;
+    return NULL;
+  }
+
+  *ret_ptr= DRIZZLE_RETURN_OK;
+  return value;
+}
+
+static uint64_t _value_integer(drizzle_binlog_rows_st *rows,
+                               drizzle_binlog_value_st *value,
+                               uint32_t column, bool sign_extend,
+                               drizzle_return_t *ret_ptr)
+{
+  drizzle_column_type_t type= rows->table->type_list[column];
+  uint64_t val;
+
+  if (value->null)
+  {
+    *ret_ptr= DRIZZLE_RETURN_NULL_SIZE;
+    return 0;
+  }
+
+  switch (type)
+  {
+  case DRIZZLE_COLUMN_TYPE_TINY:
+    val= sign_extend ? (uint64_t)(int64_t)(int8_t)value->data[0] : value->data[0];
+    break;
+  case DRIZZLE_COLUMN_TYPE_SHORT:
+    val= drizzle_get_byte2(value->data);
+    if (sign_extend)
+    {
+      val= (uint64_t)(int64_t)(int16_t)val;
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_INT24:
+    val= drizzle_get_byte3(value->data);
+    if (sign_extend && (val & 0x800000))
+    {
+      val|= UINT64_C(0xFFFFFFFFFF000000);
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_LONG:
+    val= drizzle_get_byte4(value->data);
+    if (sign_extend)
+    {
+      val= (uint64_t)(int64_t)(int32_t)val;
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_LONGLONG:
+    val= drizzle_get_byte8(value->data);
+    break;
+  case DRIZZLE_COLUMN_TYPE_YEAR:
+    val= value->data[0] ? 1900U + value->data[0] : 0;
+    break;
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+    val= drizzle_get_byte4(value->data);
+    break;
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+    val= _get_be(value->data, 4);
+    break;
+  case DRIZZLE_COLUMN_TYPE_ENUM:
+  case DRIZZLE_COLUMN_TYPE_SET:
+    val= value->size <= 8 ? _get_le(value->data, value->size) : 0;
+    break;
+  case DRIZZLE_COLUMN_TYPE_BIT:
+    if (value->size > 8)
+    {
+      *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
+    }
+    val= _get_be(value->data, value->size > 8 ? 8 : value->size);
+    break;
+  case DRIZZLE_COLUMN_TYPE_FLOAT:
+  case DRIZZLE_COLUMN_TYPE_DOUBLE:
+  case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+    {
+      double real= _value_double(rows, value, column, ret_ptr);
+      val= sign_extend ? (uint64_t)(int64_t)real : (uint64_t)real;
+      double whole= sign_extend ? (double)(int64_t)val : (double)val;
+      if (whole < real || whole > real)
+      {
+        *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
+      }
+    }
+    break;
+  case DRIZZLE_COLUMN_TYPE_NULL:
+    *ret_ptr= DRIZZLE_RETURN_NULL_SIZE;
+    val= 0;
+    break;
+  case DRIZZLE_COLUMN_TYPE_DECIMAL:
+  case DRIZZLE_COLUMN_TYPE_DATE:
+  case DRIZZLE_COLUMN_TYPE_TIME:
+  case DRIZZLE_COLUMN_TYPE_DATETIME:
+  case DRIZZLE_COLUMN_TYPE_NEWDATE:
+  case DRIZZLE_COLUMN_TYPE_VARCHAR:
+  case DRIZZLE_COLUMN_TYPE_DATETIME2:
+  case DRIZZLE_COLUMN_TYPE_TIME2:
+  case DRIZZLE_COLUMN_TYPE_JSON:
+  case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+  case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+  case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+  case DRIZZLE_COLUMN_TYPE_BLOB:
+  case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+  case DRIZZLE_COLUMN_TYPE_STRING:
+  case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+  default:
+    *ret_ptr= DRIZZLE_RETURN_INVALID_CONVERSION;
+    val= 0;
+    break;
+  }
+
+  return val;
+}
+
+static double _value_double(drizzle_binlog_rows_st *rows,
+                            drizzle_binlog_value_st *value,
+                            uint32_t column, drizzle_return_t *ret_ptr)
+{
+  drizzle_column_type_t type= rows->table->type_list[column];
+  uint64_t integer;
+
+  if (value->null)
+  {
+    *ret_ptr= DRIZZLE_RETURN_NULL_SIZE;
+    return 0;
+  }
+
+  if (type == DRIZZLE_COLUMN_TYPE_FLOAT)
+  {
+    float val;
+    memcpy(&val, value->data, 4);
+    return (double)val;
+  }
+  else if (type == DRIZZLE_COLUMN_TYPE_DOUBLE)
+  {
+    double val;
+    memcpy(&val, value->data, 8);
+    return val;
+  }
+  else if (type == DRIZZLE_COLUMN_TYPE_NEWDECIMAL)
+  {
+    _value_decimal(rows->table->meta_list[column], value->data, value->text);
+    return strtod(value->text, NULL);
+  }
+
+  /* Integers follow the signedness of the column if it is known */
+  if (rows->table->unsigned_list != NULL &&
+      rows->table->unsigned_list[column])
+  {
+    integer= _value_integer(rows, value, column, false, ret_ptr);
+    return (double)integer;
+  }
+
+  integer= _value_integer(rows, value, column, true, ret_ptr);
+  return (double)(int64_t)integer;
+}
+
+static void _value_decimal(uint16_t meta, const unsigned char *data,
+                           char *text)
+{
+  static const uint8_t digit_bytes[10]= { 0, 1, 1, 2, 2, 3, 3, 4, 4, 4 };
+  unsigned char digits[40];
+  unsigned int precision= meta >> 8;
+  unsigned int scale= meta & 0xFF;
+  unsigned int integer= precision - scale;
+  unsigned int integer_bytes= (integer / 9) * 4 + digit_bytes[integer % 9];
+  unsigned int size= integer_bytes + (scale / 9) * 4 + digit_bytes[scale % 9];
+  const unsigned char *ptr= digits;
+  bool negative;
+  bool leading= true;
+  uint32_t group;
+  size_t used= 0;
+
+  /* _table_parse rejects anything larger than the server allows */
+  if (size > sizeof(digits))
+  {
+    text[0]= 0;
+    return;
+  }
+
+  /* The sign is the inverted top bit, negative values have all bits
+     inverted */
+  memcpy(digits, data, size);
+  negative= (digits[0] & 0x80) == 0;
+  digits[0]^= 0x80;
+  if (negative)
+  {
+    for (unsigned int x= 0; x < size; x++)
+    {
+      digits[x]= (unsigned char)~digits[x];
+    }
+    _text_append(text, &used, "-");
+  }
+
+  if (integer % 9)
+  {
+    group= (uint32_t)_get_be(ptr, digit_bytes[integer % 9]);
+    ptr+= digit_bytes[integer % 9];
+    if (group != 0)
+    {
+      _text_append(text, &used, "%" PRIu32, group);
+      leading= false;
+    }
+  }
+  for (unsigned int x= 0; x < integer / 9; x++)
+  {
+    group= (uint32_t)_get_be(ptr, 4);
+    ptr+= 4;
+    if (!leading)
+    {
+      _text_append(text, &used, "%09" PRIu32, group);
+    }
+    else if (group != 0)
+    {
+      _text_append(text, &used, "%" PRIu32, group);
+      leading= false;
+    }
+  }
+  if (leading)
+  {
+    _text_append(text, &used, "0");
+  }
+
+  if (scale > 0)
+  {
+    _text_append(text, &used, ".");
+    for (unsigned int x= 0; x < scale / 9; x++)
+    {
+      _text_append(text, &used, "%09" PRIu32, (uint32_t)_get_be(ptr, 4));
+      ptr+= 4;
+    }
+    if (scale % 9)
+    {
+      _text_append(text, &used, "%0*" PRIu32, (int)(scale % 9),
+                   (uint32_t)_get_be(ptr, digit_bytes[scale % 9]));
+    }
+  }
+}
+
+static void _text_append(char *text, size_t *used, const char *format, ...)
+{
+  va_list args;
+  int length;
+
+  if (*used + 1 >= DRIZZLE_BINLOG_TEXT_SIZE)
+  {
+    return;
+  }
+
+  va_start(args, format);
+  length= vsnprintf(text + *used, DRIZZLE_BINLOG_TEXT_SIZE - *used, format,
+                    args);
+  va_end(args);
+
+  if (length < 0)
+  {
+    return;
+  }
+  *used+= (size_t)length;
+  if (*used >= DRIZZLE_BINLOG_TEXT_SIZE)
+  {
+    *used= DRIZZLE_BINLOG_TEXT_SIZE - 1;
+  }
+}
+
+static void _value_temporal(drizzle_column_type_t type, uint16_t meta,
+                            const unsigned char *data, char *text)
+{
+  drizzle_datetime_st datetime;
+  unsigned int decimals= 0;
+  int64_t packed;
+  uint64_t val;
+  int used;
+
+  memset(&datetime, 0, sizeof(datetime));
+
+  switch (type)
+  {
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+    snprintf(text, DRIZZLE_BINLOG_TEXT_SIZE, "%" PRIu32,
+             drizzle_get_byte4(data));
+    return;
+
+  case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+    decimals= meta;
+    used= snprintf(text, DRIZZLE_BINLOG_TEXT_SIZE, "%" PRIu64,
+                   _get_be(data, 4));
+    if (decimals > 0)
+    {
+      val= _get_be(data + 4, (decimals + 1) / 2);
+      /* Fractions are stored in pairs of digits */
+      if (decimals % 2)
+      {
+        val/= 10;
+      }
+      snprintf(text + used, (size_t)(DRIZZLE_BINLOG_TEXT_SIZE - used),
+               ".%0*" PRIu64, (int)decimals, val);
+    }
+    return;
+
+  case DRIZZLE_COLUMN_TYPE_DATE:
+    val= drizzle_get_byte3(data);
+    datetime.day= (uint32_t)(val & 31);
+    datetime.month= (uint8_t)((val >> 5) & 15);
+    datetime.year= (uint16_t)(val >> 9);
+    snprintf(text, DRIZZLE_BINLOG_TEXT_SIZE, "%04" PRIu16 "-%02" PRIu8
+             "-%02" PRIu32, datetime.year, datetime.month, datetime.day);
+    return;
+
+  case DRIZZLE_COLUMN_TYPE_TIME:
+    packed= (int32_t)(drizzle_get_byte3(data) << 8) >> 8;
+    datetime.negative= packed < 0;
+    val= (uint64_t)(packed < 0 ? -packed : packed);
+    datetime.hour= (uint16_t)(val / 10000);
+    datetime.minute= (uint8_t)((val / 100) % 100);
+    datetime.second= (uint8_t)(val % 100);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_DATETIME:
+    val= drizzle_get_byte8(data);
+    datetime.year= (uint16_t)(val / UINT64_C(10000000000));
+    datetime.month= (uint8_t)((val / UINT64_C(100000000)) % 100);
+    datetime.day= (uint32_t)((val / 1000000) % 100);
+    datetime.hour= (uint16_t)((val / 10000) % 100);
+    datetime.minute= (uint8_t)((val / 100) % 100);
+    datetime.second= (uint8_t)(val % 100);
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_DATETIME2:
+    {
+      uint64_t ymd, ym, hms;
+      decimals= meta;
+      packed= (int64_t)_get_be(data, 5) - DRIZZLE_BINLOG_DATETIMEF_INT_OFS;
+      val= (uint64_t)(packed < 0 ? -packed : packed);
+      ymd= val >> 17;
+      ym= ymd >> 5;
+      hms= val % (1 << 17);
+      datetime.day= (uint32_t)(ymd % (1 << 5));
+      datetime.month= (uint8_t)(ym % 13);
+      datetime.year= (uint16_t)(ym / 13);
+      datetime.second= (uint8_t)(hms % (1 << 6));
+      datetime.minute= (uint8_t)((hms >> 6) % (1 << 6));
+      datetime.hour= (uint16_t)(hms >> 12);
+      if (decimals > 0)
+      {
+        val= _get_be(data + 5, (decimals + 1) / 2);
+        datetime.microsecond= (uint32_t)(decimals <= 2 ? val * 10000 :
+                                         decimals <= 4 ? val * 100 : val);
+      }
+    }
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_TIME2:
+    {
+      int64_t integer_part;
+      int64_t fraction;
+      uint64_t hms;
+      decimals= meta;
+      /* Same packing as the server, the integer part in the upper bits and
+         the microseconds in the lower 24 */
+      switch ((decimals + 1) / 2)
+      {
+      case 1:
+      case 2:
+        integer_part= (int64_t)_get_be(data, 3) - DRIZZLE_BINLOG_TIMEF_INT_OFS;
+        fraction= (int64_t)_get_be(data + 3, (decimals + 1) / 2);
+        if (integer_part < 0 && fraction)
+        {
+          integer_part++;
+          fraction-= decimals <= 2 ? 0x100 : 0x10000;
+        }
+        packed= integer_part * (1 << 24) +
+                fraction * (decimals <= 2 ? 10000 : 100);
+        break;
+      case 3:
+        packed= (int64_t)_get_be(data, 6) - DRIZZLE_BINLOG_TIMEF_OFS;
+        break;
+      default:
+        packed= ((int64_t)_get_be(data, 3) - DRIZZLE_BINLOG_TIMEF_INT_OFS) *
+                (1 << 24);
+        break;
+      }
+      datetime.negative= packed < 0;
+      val= (uint64_t)(packed < 0 ? -packed : packed);
+      hms= val >> 24;
+      datetime.microsecond= (uint32_t)(val % (1 << 24));
+      datetime.hour= (uint16_t)((hms >> 12) % (1 << 10));
+      datetime.minute= (uint8_t)((hms >> 6) % (1 << 6));
+      datetime.second= (uint8_t)(hms % (1 << 6));
+    }
+    break;
+
+  case DRIZZLE_COLUMN_TYPE_DECIMAL:
+  case DRIZZLE_COLUMN_TYPE_TINY:
+  case DRIZZLE_COLUMN_TYPE_SHORT:
+  case DRIZZLE_COLUMN_TYPE_LONG:
+  case DRIZZLE_COLUMN_TYPE_FLOAT:
+  case DRIZZLE_COLUMN_TYPE_DOUBLE:
+  case DRIZZLE_COLUMN_TYPE_NULL:
+  case DRIZZLE_COLUMN_TYPE_LONGLONG:
+  case DRIZZLE_COLUMN_TYPE_INT24:
+  case DRIZZLE_COLUMN_TYPE_YEAR:
+  case DRIZZLE_COLUMN_TYPE_NEWDATE:
+  case DRIZZLE_COLUMN_TYPE_VARCHAR:
+  case DRIZZLE_COLUMN_TYPE_BIT:
+  case DRIZZLE_COLUMN_TYPE_JSON:
+  case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+  case DRIZZLE_COLUMN_TYPE_ENUM:
+  case DRIZZLE_COLUMN_TYPE_SET:
+  case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+  case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+  case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+  case DRIZZLE_COLUMN_TYPE_BLOB:
+  case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+  case DRIZZLE_COLUMN_TYPE_STRING:
+  case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+  default:
+    text[0]= 0;
+    return;
+  }
+
+  if (type == DRIZZLE_COLUMN_TYPE_TIME || type == DRIZZLE_COLUMN_TYPE_TIME2)
+  {
+    used= snprintf(text, DRIZZLE_BINLOG_TEXT_SIZE, "%s%02" PRIu16 ":%02" PRIu8
+                   ":%02" PRIu8, datetime.negative ? "-" : "", datetime.hour,
+                   datetime.minute, datetime.second);
+  }
+  else
+  {
+    used= snprintf(text, DRIZZLE_BINLOG_TEXT_SIZE, "%04" PRIu16 "-%02" PRIu8
+                   "-%02" PRIu32 " %02" PRIu16 ":%02" PRIu8 ":%02" PRIu8,
+                   datetime.year, datetime.month, datetime.day, datetime.hour,
+                   datetime.minute, datetime.second);
+  }
+
+  if (decimals > 0 && decimals <= 6)
+  {
+    uint32_t fraction= datetime.microsecond;
+    for (unsigned int x= decimals; x < 6; x++)
+    {
+      fraction/= 10;
+    }
+    snprintf(text + used, (size_t)(DRIZZLE_BINLOG_TEXT_SIZE - used),
+             ".%0*" PRIu32, (int)decimals, fraction);
+  }
+}
+
+static bool _is_numeric(drizzle_column_type_t type)
+{
+  return type == DRIZZLE_COLUMN_TYPE_TINY ||
+         type == DRIZZLE_COLUMN_TYPE_SHORT ||
+         type == DRIZZLE_COLUMN_TYPE_INT24 ||
+         type == DRIZZLE_COLUMN_TYPE_LONG ||
+         type == DRIZZLE_COLUMN_TYPE_LONGLONG ||
+         type == DRIZZLE_COLUMN_TYPE_FLOAT ||
+         type == DRIZZLE_COLUMN_TYPE_DOUBLE ||
+         type == DRIZZLE_COLUMN_TYPE_NEWDECIMAL;
+}
+
+static bool _read_length(const unsigned char **ptr, const unsigned char *end,
+                         uint64_t *value)
+{
+  const unsigned char *p= *ptr;
+  size_t size;
+
+  if (p >= end)
+  {
+    return false;
+  }
+
+  if (p[0] < 251)
+  {
+    *value= p[0];
+    *ptr= p + 1;
+    return true;
+  }
+
+  if (p[0] == 252)
+  {
+    size= 2;
+  }
+  else if (p[0] == 253)
+  {
+    size= 3;
+  }
+  else if (p[0] == 254)
+  {
+    size= 8;
+  }
+  else
+  {
+    return false;
+  }
+
+  if ((size_t)(end - p) < size + 1)
+  {
+    return false;
+  }
+
+  *value= _get_le(p + 1, size);
+  *ptr= p + 1 + size;
+  return true;
+}
+
+static uint64_t _get_be(const unsigned char *ptr, size_t size)
+{
+  uint64_t value= 0;
+
+  for (size_t x= 0; x < size; x++)
+  {
+    value= (value << 8) | ptr[x];
+  }
+
+  return value;
+}
+
+static uint64_t _get_le(const unsigned char *ptr, size_t size)
+{
+  uint64_t value= 0;
+
+  for (size_t x= size; x > 0; x--)
+  {
+    value= (value << 8) | ptr[x - 1];
+  }
+
+  return value;
+}
+
+static bool _bit(const unsigned char *bitmap, uint32_t bit)
+{
+  return (bitmap[bit / 8] & (1 << (bit % 8))) != 0;
+}
@@ -268,6 +268,8 @@ const char *drizzle_column_type_str(drizzle_column_type_t type)
             return "STRING";
         case DRIZZLE_COLUMN_TYPE_GEOMETRY:
             return "GEOMETRY";
+        case DRIZZLE_COLUMN_TYPE_JSON:
+            return "JSON";
         default:
             break;
     }
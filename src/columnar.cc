@@ -0,0 +1,388 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Columnar result definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Make sure every column has room for the values of at least rows rows.
+ */
+static drizzle_return_t _columnar_reserve(drizzle_result_st *result,
+                                          uint64_t rows);
+
+/**
+ * Append a value fragment to the value buffer of a column.
+ */
+static drizzle_return_t _columnar_append(drizzle_result_st *result,
+                                         uint16_t column, const char *data,
+                                         size_t size);
+
+/**
+ * Append all fields of a complete text protocol row packet with
+ * drizzle_scan_row().
+ */
+static drizzle_return_t _columnar_scan(drizzle_result_st *result,
+                                       uint64_t row);
+
+/**
+ * Terminate the value of a column for the given row.
+ */
+static void _columnar_finish(drizzle_result_st *result, uint16_t column,
+                             uint64_t row, bool is_null);
+
+/*
+ * Client definitions
+ */
+
+drizzle_return_t drizzle_result_buffer_columnar(drizzle_result_st *result)
+{
+  if (result == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  drizzle_return_t ret;
+  drizzle_field_t field;
+  uint64_t offset;
+  size_t size;
+  uint64_t total;
+  uint64_t row= 0;
+  uint16_t column;
+  uint16_t next_column;
+  bool complete;
+
+  if (!(result->options & DRIZZLE_RESULT_BUFFER_COLUMN))
+  {
+    ret= drizzle_column_buffer(result);
+    if (ret != DRIZZLE_RETURN_OK)
+      return ret;
+  }
+
+  if (result->column_count == 0)
+  {
+    result->options = (drizzle_result_options_t)((int)result->options | (int)DRIZZLE_RESULT_BUFFER_COLUMNAR);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (result->column_values == NULL)
+  {
+    result->column_values= new (std::nothrow) drizzle_column_values_st[result->column_count];
+    if (result->column_values == NULL)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+  }
+
+  while (1)
+  {
+    if (drizzle_row_read(result, &ret) == 0 || ret != DRIZZLE_RETURN_OK)
+    {
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+
+      break;
+    }
+
+    ret= _columnar_reserve(result, row + 1);
+    if (ret != DRIZZLE_RETURN_OK)
+      return ret;
+
+    if (!result->binary_rows &&
+        result->con->buffer_size >= result->con->packet_size)
+    {
+      ret= _columnar_scan(result, row);
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+
+      row++;
+      continue;
+    }
+
+    /* Otherwise fields are appended as the field state machine exposes them
+       in the connection buffer, NULL columns skipped on the wire are filled
+       in. */
+    next_column= 0;
+    while (1)
+    {
+      field= drizzle_field_read(result, &offset, &size, &total, &ret);
+      if (ret == DRIZZLE_RETURN_ROW_END)
+        break;
+
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+
+      if (result->binary_rows)
+      {
+        column= result->field_current_read - 1;
+        complete= true;
+      }
+      else
+      {
+        complete= ((offset + size) == total);
+        column= complete ? result->field_current - 1 : result->field_current;
+      }
+
+      while (next_column < column)
+      {
+        _columnar_finish(result, next_column, row, true);
+        next_column++;
+      }
+
+      if (field != NULL && size > 0)
+      {
+        ret= _columnar_append(result, column, field, size);
+        if (ret != DRIZZLE_RETURN_OK)
+          return ret;
+      }
+
+      if (complete)
+      {
+        _columnar_finish(result, column, row, field == NULL);
+        next_column= column + 1;
+      }
+    }
+
+    while (next_column < result->column_count)
+    {
+      _columnar_finish(result, next_column, row, true);
+      next_column++;
+    }
+
+    if (result->binary_rows)
+    {
+      delete[] result->null_bitmap;
+      result->null_bitmap= NULL;
+    }
+
+    row++;
+  }
+
+  result->options = (drizzle_result_options_t)((int)result->options | (int)DRIZZLE_RESULT_BUFFER_COLUMNAR);
+  return DRIZZLE_RETURN_OK;
+}
+
+const char *drizzle_result_column_values(drizzle_result_st *result,
+                                         uint16_t column)
+{
+  if (result == NULL || result->column_values == NULL ||
+      column >= result->column_count)
+  {
+    return NULL;
+  }
+
+  return result->column_values[column].values;
+}
+
+const uint64_t *drizzle_result_column_offsets(drizzle_result_st *result,
+                                              uint16_t column)
+{
+  if (result == NULL || result->column_values == NULL ||
+      column >= result->column_count)
+  {
+    return NULL;
+  }
+
+  return result->column_values[column].offsets;
+}
+
+const uint8_t *drizzle_result_column_validity(drizzle_result_st *result,
+                                              uint16_t column)
+{
+  if (result == NULL || result->column_values == NULL ||
+      column >= result->column_count)
+  {
+    return NULL;
+  }
+
+  return result->column_values[column].validity;
+}
+
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _columnar_reserve(drizzle_result_st *result,
+                                          uint64_t rows)
+{
+  uint64_t allocation;
+  uint16_t x;
+
+  if (rows <= result->column_values_allocation)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  allocation= result->column_values_allocation * 2;
+  if (allocation < DRIZZLE_ROW_GROW_SIZE)
+  {
+    allocation= DRIZZLE_ROW_GROW_SIZE;
+  }
+
+  size_t old_bitmap_size= (size_t)((result->column_values_allocation + 7) / 8);
+  size_t bitmap_size= (size_t)((allocation + 7) / 8);
+
+  for (x= 0; x < result->column_count; x++)
+  {
+    drizzle_column_values_st *column= &result->column_values[x];
+
+    uint64_t *offsets= (uint64_t *)realloc(column->offsets,
+                                           sizeof(uint64_t) * (allocation + 1));
+    if (offsets == NULL)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to realloc offsets.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    if (column->offsets == NULL)
+    {
+      offsets[0]= 0;
+    }
+    column->offsets= offsets;
+
+    uint8_t *validity= (uint8_t *)realloc(column->validity, bitmap_size);
+    if (validity == NULL)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to realloc validity.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    memset(validity + old_bitmap_size, 0, bitmap_size - old_bitmap_size);
+    column->validity= validity;
+  }
+
+  result->column_values_allocation= allocation;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_return_t _columnar_scan(drizzle_result_st *result,
+                                       uint64_t row)
+{
+  drizzle_st *con= result->con;
+  drizzle_return_t ret;
+  uint16_t x;
+
+  ret= drizzle_scan_create(result);
+  if (ret != DRIZZLE_RETURN_OK)
+    return ret;
+
+  if (drizzle_scan_row(con->buffer_ptr, con->packet_size, result->column_count,
+                       result->view_field_offsets,
+                       result->view_field_sizes) != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "malformed row packet");
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  for (x= 0; x < result->column_count; x++)
+  {
+    if (result->view_field_offsets[x] == DRIZZLE_SCAN_NULL)
+    {
+      _columnar_finish(result, x, row, true);
+      continue;
+    }
+
+    if (result->view_field_sizes[x] > 0)
+    {
+      ret= _columnar_append(result, x,
+                            (char *)con->buffer_ptr + result->view_field_offsets[x],
+                            result->view_field_sizes[x]);
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+    }
+    _columnar_finish(result, x, row, false);
+    drizzle_scan_column_size(result, x, result->view_field_sizes[x]);
+  }
+
+  drizzle_scan_row_consume(result, con->packet_size);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_return_t _columnar_append(drizzle_result_st *result,
+                                         uint16_t column, const char *data,
+                                         size_t size)
+{
+  drizzle_column_values_st *values= &result->column_values[column];
+
+  if (values->values_size + size > values->values_allocation)
+  {
+    size_t allocation= values->values_allocation * 2;
+    if (allocation < DRIZZLE_BUFFER_COPY_THRESHOLD)
+    {
+      allocation= DRIZZLE_BUFFER_COPY_THRESHOLD;
+    }
+    while (allocation < values->values_size + size)
+    {
+      allocation*= 2;
+    }
+
+    char *buffer= (char *)realloc(values->values, allocation);
+    if (buffer == NULL)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to realloc values.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    values->values= buffer;
+    values->values_allocation= allocation;
+  }
+
+  memcpy(values->values + values->values_size, data, size);
+  values->values_size+= size;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static void _columnar_finish(drizzle_result_st *result, uint16_t column,
+                             uint64_t row, bool is_null)
+{
+  drizzle_column_values_st *values= &result->column_values[column];
+
+  values->offsets[row + 1]= values->values_size;
+  if (!is_null)
+  {
+    values->validity[row / 8]|= (uint8_t)(1 << (row % 8));
+  }
+}
@@ -45,6 +45,13 @@
 #include "config.h"
 #include "src/common.h"
 
+/**
+ * Whether the payload of the command being written is sent with a gather
+ * write instead of being copied into the write buffer. Compressed and TLS
+ * connections need the whole packet in the buffer.
+ */
+static bool _command_gather(drizzle_st *con);
+
 /*
  * State Definitions
  */
@@ -126,9 +133,23 @@ drizzle_return_t drizzle_state_command_write(drizzle_st *con)
       free_size-= 5;
 
       /* Copy as much of the data in as we can into the write buffer. */
-      if (con->command_size <= free_size)
+      if (_command_gather(con) && con->command_data != ptr)
+      {
+        /* Large payloads go out behind the header straight from the
+           caller's buffer, without a copy or a second send() */
+        con->write_data= con->command_data;
+        con->write_data_size= con->command_size;
+        con->command_offset= con->command_size;
+        con->command_data= NULL;
+        con->buffer_size+= 5;
+      }
+      else if (con->command_size <= free_size)
       {
-        memcpy(ptr, con->command_data, con->command_size);
+        /* The data may already have been packed in place */
+        if (con->command_data != ptr)
+        {
+          memcpy(ptr, con->command_data, con->command_size);
+        }
         con->command_offset= con->command_size;
         con->command_data= NULL;
         con->buffer_size+= 5 + con->command_size;
@@ -171,3 +192,19 @@ drizzle_return_t drizzle_state_command_write(drizzle_st *con)
 
   return DRIZZLE_RETURN_OK;
 }
+
+/*
+ * Static Definitions
+ */
+
+static bool _command_gather(drizzle_st *con)
+{
+#if defined(_WIN32)
+  (void)con;
+  return false;
+#else
+  return con->command_size >= DRIZZLE_BUFFER_COPY_THRESHOLD &&
+         con->compression == NULL &&
+         con->ssl_state != DRIZZLE_SSL_STATE_HANDSHAKE_COMPLETE;
+#endif
+}
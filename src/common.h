@@ -91,6 +91,12 @@ typedef struct pollfd pollfd_t;
 #include "src/column.h"
 #include "src/binlog.h"
 #include "src/handshake_client.h"
+#include "src/arena.h"
 #include "src/result.h"
+#include "src/scan.h"
+#include "src/compress.h"
+#include "src/crc32.h"
+#include "src/pool.h"
+#include "src/group.h"
 
 #include <memory.h>
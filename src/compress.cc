@@ -0,0 +1,474 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Compressed protocol definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <zlib.h>
+
+/*
+ * Private declarations
+ */
+
+static size_t _zlib_bound(size_t size);
+static bool _zlib_compress(unsigned char *destination,
+                           size_t *destination_size,
+                           const unsigned char *source, size_t source_size);
+static bool _zlib_uncompress(unsigned char *destination,
+                             size_t destination_size,
+                             const unsigned char *source, size_t source_size);
+
+/**
+ * Codecs indexed by drizzle_compression_t.
+ */
+static const drizzle_codec_st _codec_list[]=
+{
+  { "none", NULL, NULL, NULL },
+  { "zlib", _zlib_bound, _zlib_compress, _zlib_uncompress }
+};
+
+/**
+ * Make room for size more bytes after the data in the connection buffer.
+ */
+static drizzle_return_t _buffer_reserve(drizzle_st *con, size_t size);
+
+/**
+ * Make sure the write buffer can hold size more bytes after the frames
+ * waiting to be sent.
+ */
+static drizzle_return_t _write_reserve(drizzle_st *con, size_t size);
+
+/*
+ * Common definitions
+ */
+
+const drizzle_codec_st *drizzle_codec_get(drizzle_compression_t compression)
+{
+  if ((size_t)compression >= sizeof(_codec_list) / sizeof(_codec_list[0]) ||
+      _codec_list[compression].compress == NULL)
+  {
+    return NULL;
+  }
+
+  return &_codec_list[compression];
+}
+
+drizzle_return_t drizzle_compression_start(drizzle_st *con)
+{
+  const drizzle_codec_st *codec= drizzle_codec_get(con->options.compression);
+  if (codec == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "unknown compression algorithm:%d",
+                      (int)con->options.compression);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  drizzle_compression_st *compression= new (std::nothrow) drizzle_compression_st;
+  if (compression == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  compression->read_buffer= (unsigned char *)malloc(DRIZZLE_COMPRESSION_BUFFER_SIZE);
+  if (compression->read_buffer == NULL)
+  {
+    delete compression;
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  compression->read_allocation= DRIZZLE_COMPRESSION_BUFFER_SIZE;
+  compression->codec= codec;
+  con->compression= compression;
+
+  drizzle_log_debug(con, __FILE_LINE_FUNC__, "compression: %s", codec->name);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+void drizzle_compression_free(drizzle_st *con)
+{
+  if (con->compression == NULL)
+  {
+    return;
+  }
+
+  free(con->compression->read_buffer);
+  free(con->compression->write_buffer);
+  delete con->compression;
+  con->compression= NULL;
+}
+
+drizzle_return_t drizzle_compression_read_space(drizzle_st *con,
+                                                unsigned char **ptr,
+                                                size_t *available)
+{
+  drizzle_compression_st *compression= con->compression;
+  size_t needed= DRIZZLE_COMPRESSION_HEADER_SIZE;
+
+  if (compression->read_size >= DRIZZLE_COMPRESSION_HEADER_SIZE)
+  {
+    needed+= drizzle_get_byte3(compression->read_buffer);
+  }
+
+  if (needed > compression->read_allocation)
+  {
+    size_t allocation= compression->read_allocation;
+    while (allocation < needed)
+    {
+      allocation*= 2;
+    }
+
+    unsigned char *read_buffer=
+      (unsigned char *)realloc(compression->read_buffer, allocation);
+    if (read_buffer == NULL)
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__, "realloc failure");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+
+    compression->read_buffer= read_buffer;
+    compression->read_allocation= allocation;
+  }
+
+  *ptr= compression->read_buffer + compression->read_size;
+  *available= compression->read_allocation - compression->read_size;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_compression_read(drizzle_st *con, size_t size)
+{
+  drizzle_compression_st *compression= con->compression;
+  unsigned char *ptr= compression->read_buffer;
+  unsigned char *end;
+  size_t frame_size;
+  size_t payload_size;
+  drizzle_return_t ret;
+
+  compression->read_size+= size;
+  end= compression->read_buffer + compression->read_size;
+
+  /* The sequence number of received frames is not checked, the packets
+     inside them still are when they are read. */
+  while ((size_t)(end - ptr) >= DRIZZLE_COMPRESSION_HEADER_SIZE)
+  {
+    frame_size= drizzle_get_byte3(ptr);
+    payload_size= drizzle_get_byte3(ptr + 4);
+
+    if ((size_t)(end - ptr) < DRIZZLE_COMPRESSION_HEADER_SIZE + frame_size)
+    {
+      break;
+    }
+
+    ptr+= DRIZZLE_COMPRESSION_HEADER_SIZE;
+
+    if (payload_size == 0)
+    {
+      payload_size= frame_size;
+      ret= _buffer_reserve(con, payload_size);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+
+      memcpy(con->buffer_ptr + con->buffer_size, ptr, payload_size);
+    }
+    else
+    {
+      ret= _buffer_reserve(con, payload_size);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+
+      if (!compression->codec->uncompress(con->buffer_ptr + con->buffer_size,
+                                          payload_size, ptr, frame_size))
+      {
+        drizzle_set_error(con, __FILE_LINE_FUNC__,
+                          "corrupt compressed packet:%" PRIu64,
+                          (uint64_t)frame_size);
+        return DRIZZLE_RETURN_UNEXPECTED_DATA;
+      }
+    }
+
+    con->buffer_size+= payload_size;
+    ptr+= frame_size;
+  }
+
+  compression->read_size= (size_t)(end - ptr);
+  if (ptr != compression->read_buffer && compression->read_size > 0)
+  {
+    memmove(compression->read_buffer, ptr, compression->read_size);
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_compression_write(drizzle_st *con)
+{
+  drizzle_compression_st *compression= con->compression;
+  const drizzle_codec_st *codec= compression->codec;
+  unsigned char *frame;
+  size_t frame_size;
+  size_t size;
+  size_t remaining;
+  drizzle_return_t ret;
+
+  while (con->buffer_size > 0)
+  {
+    /* A packet numbered 0 starts a new command, which starts a new sequence
+       of frames. Otherwise the frame carries on with the current command,
+       up to the largest payload a frame can hold. */
+    if (compression->packet_remaining == 0 && con->buffer_size >= 4 &&
+        con->buffer_ptr[3] == 0)
+    {
+      compression->packet_number= 0;
+    }
+
+    size= 0;
+    remaining= compression->packet_remaining;
+    while (size < con->buffer_size)
+    {
+      if (remaining == 0)
+      {
+        if (con->buffer_size - size < 4)
+        {
+          size= con->buffer_size;
+          break;
+        }
+
+        if (size > 0 && con->buffer_ptr[size + 3] == 0)
+        {
+          break;
+        }
+
+        remaining= drizzle_get_byte3(con->buffer_ptr + size) + 4;
+      }
+
+      frame_size= con->buffer_size - size;
+      if (frame_size > remaining)
+      {
+        frame_size= remaining;
+      }
+      if (frame_size > DRIZZLE_MAX_PAYLOAD_SIZE - size)
+      {
+        frame_size= DRIZZLE_MAX_PAYLOAD_SIZE - size;
+      }
+
+      size+= frame_size;
+      remaining-= frame_size;
+
+      if (size == DRIZZLE_MAX_PAYLOAD_SIZE)
+      {
+        break;
+      }
+    }
+    compression->packet_remaining= remaining;
+
+    ret= _write_reserve(con, DRIZZLE_COMPRESSION_HEADER_SIZE + codec->bound(size));
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+
+    frame= compression->write_ptr + compression->write_size;
+    frame_size= 0;
+    if (size >= DRIZZLE_COMPRESSION_MIN_SIZE)
+    {
+      frame_size= codec->bound(size);
+      if (!codec->compress(frame + DRIZZLE_COMPRESSION_HEADER_SIZE,
+                           &frame_size, con->buffer_ptr, size))
+      {
+        drizzle_set_error(con, __FILE_LINE_FUNC__,
+                          "%s compression failed", codec->name);
+        return DRIZZLE_RETURN_INTERNAL_ERROR;
+      }
+    }
+
+    /* Data which does not shrink is sent as it is. */
+    if (frame_size == 0 || frame_size >= size)
+    {
+      memcpy(frame + DRIZZLE_COMPRESSION_HEADER_SIZE, con->buffer_ptr, size);
+      drizzle_set_byte3(frame, size);
+      drizzle_set_byte3(frame + 4, 0);
+      frame_size= size;
+    }
+    else
+    {
+      drizzle_set_byte3(frame, frame_size);
+      drizzle_set_byte3(frame + 4, size);
+    }
+    frame[3]= compression->packet_number;
+    compression->packet_number++;
+
+    compression->write_size+= DRIZZLE_COMPRESSION_HEADER_SIZE + frame_size;
+    con->buffer_ptr+= size;
+    con->buffer_size-= size;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/*
+ * Private definitions
+ */
+
+static size_t _zlib_bound(size_t size)
+{
+  return compressBound((uLong)size);
+}
+
+static bool _zlib_compress(unsigned char *destination,
+                           size_t *destination_size,
+                           const unsigned char *source, size_t source_size)
+{
+  uLongf size= (uLongf)*destination_size;
+
+  if (compress(destination, &size, source, (uLong)source_size) != Z_OK)
+  {
+    return false;
+  }
+
+  *destination_size= (size_t)size;
+  return true;
+}
+
+static bool _zlib_uncompress(unsigned char *destination,
+                             size_t destination_size,
+                             const unsigned char *source, size_t source_size)
+{
+  uLongf size= (uLongf)destination_size;
+
+  if (uncompress(destination, &size, source, (uLong)source_size) != Z_OK)
+  {
+    return false;
+  }
+
+  return size == destination_size;
+}
+
+static drizzle_return_t _buffer_reserve(drizzle_st *con, size_t size)
+{
+  size_t used= (size_t)(con->buffer_ptr - con->buffer) + con->buffer_size;
+  size_t allocation;
+
+  if (con->buffer_allocation - used >= size)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (con->buffer_ptr != con->buffer)
+  {
+    memmove(con->buffer, con->buffer_ptr, con->buffer_size);
+    con->buffer_ptr= con->buffer;
+    if (con->buffer_allocation - con->buffer_size >= size)
+    {
+      return DRIZZLE_RETURN_OK;
+    }
+  }
+
+  allocation= con->buffer_allocation;
+  while (allocation - con->buffer_size < size)
+  {
+    allocation*= 2;
+  }
+
+  if (allocation > con->options.max_buffer_size)
+  {
+    if (con->options.max_buffer_size - con->buffer_size < size)
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__,
+                        "buffer too small:%" PRIu64,
+                        (uint64_t)(con->buffer_size + size));
+      return DRIZZLE_RETURN_INTERNAL_ERROR;
+    }
+    allocation= con->options.max_buffer_size;
+  }
+
+  return drizzle_buffer_resize(con, allocation);
+}
+
+static drizzle_return_t _write_reserve(drizzle_st *con, size_t size)
+{
+  drizzle_compression_st *compression= con->compression;
+  size_t allocation;
+
+  if (compression->write_size == 0)
+  {
+    compression->write_ptr= compression->write_buffer;
+  }
+  else if (compression->write_ptr != compression->write_buffer)
+  {
+    memmove(compression->write_buffer, compression->write_ptr,
+            compression->write_size);
+    compression->write_ptr= compression->write_buffer;
+  }
+
+  if (compression->write_allocation - compression->write_size >= size)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  allocation= compression->write_allocation ? compression->write_allocation :
+                                              DRIZZLE_COMPRESSION_BUFFER_SIZE;
+  while (allocation - compression->write_size < size)
+  {
+    allocation*= 2;
+  }
+
+  unsigned char *write_buffer=
+    (unsigned char *)realloc(compression->write_buffer, allocation);
+  if (write_buffer == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "realloc failure");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  compression->write_buffer= write_buffer;
+  compression->write_ptr= write_buffer;
+  compression->write_allocation= allocation;
+
+  return DRIZZLE_RETURN_OK;
+}
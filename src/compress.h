@@ -0,0 +1,152 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Compressed protocol declarations
+ */
+
+#pragma once
+
+/**
+ * @addtogroup drizzle_compress_private Private Compressed Protocol
+ *
+ * Framing of the compressed client/server protocol. Once negotiated every
+ * packet sent or received is wrapped in a frame with a 7 byte header: the
+ * 3 byte length of the frame payload, a 1 byte sequence number and the 3
+ * byte length of the payload before compression, 0 meaning it was stored
+ * uncompressed. The frames are unpacked into the connection buffer, so the
+ * packet parsing code never sees them.
+ * @{
+ */
+
+#define DRIZZLE_COMPRESSION_HEADER_SIZE  7
+#define DRIZZLE_COMPRESSION_BUFFER_SIZE  (64*1024)
+/* Payloads shorter than this are not worth compressing. */
+#define DRIZZLE_COMPRESSION_MIN_SIZE     50
+
+/**
+ * A compression algorithm. Adding an algorithm means adding a
+ * drizzle_compression_t value and an entry to the codec list in compress.cc.
+ */
+struct drizzle_codec_st
+{
+  const char *name;
+  /* Largest possible compressed size of size bytes. */
+  size_t (*bound)(size_t size);
+  /* Compress source, *destination_size holds the space available on entry
+     and the compressed size on return. */
+  bool (*compress)(unsigned char *destination, size_t *destination_size,
+                   const unsigned char *source, size_t source_size);
+  /* Decompress source, which must expand to exactly destination_size bytes. */
+  bool (*uncompress)(unsigned char *destination, size_t destination_size,
+                     const unsigned char *source, size_t source_size);
+};
+
+struct drizzle_compression_st
+{
+  const drizzle_codec_st *codec;
+  uint8_t packet_number;           /* sequence number of the next frame sent */
+  size_t packet_remaining;         /* bytes of the current packet not framed yet */
+  unsigned char *read_buffer;      /* frames received, not complete yet */
+  size_t read_size;
+  size_t read_allocation;
+  unsigned char *write_buffer;     /* frames waiting to be sent */
+  unsigned char *write_ptr;
+  size_t write_size;
+  size_t write_allocation;
+
+  drizzle_compression_st() :
+    codec(NULL),
+    packet_number(0),
+    packet_remaining(0),
+    read_buffer(NULL),
+    read_size(0),
+    read_allocation(0),
+    write_buffer(NULL),
+    write_ptr(NULL),
+    write_size(0),
+    write_allocation(0)
+  { }
+};
+
+/**
+ * Look up the codec of a compression algorithm.
+ *
+ * @return The codec or NULL for DRIZZLE_COMPRESSION_NONE and unknown values.
+ */
+const drizzle_codec_st *drizzle_codec_get(drizzle_compression_t compression);
+
+/**
+ * Switch a connection to the compressed protocol with the algorithm set in
+ * its options. Called once the server accepted the handshake.
+ */
+drizzle_return_t drizzle_compression_start(drizzle_st *con);
+
+/**
+ * Switch a connection back to the uncompressed protocol and release the
+ * frame buffers.
+ */
+void drizzle_compression_free(drizzle_st *con);
+
+/**
+ * Find room to receive more frames, growing the frame buffer when the frame
+ * at its start does not fit.
+ *
+ * @param[in] con Connection structure.
+ * @param[out] ptr Where to store received data.
+ * @param[out] available Number of bytes that can be stored at ptr.
+ */
+drizzle_return_t drizzle_compression_read_space(drizzle_st *con,
+                                                unsigned char **ptr,
+                                                size_t *available);
+
+/**
+ * Account for size bytes received at the position returned by
+ * drizzle_compression_read_space() and unpack every complete frame into the
+ * connection buffer.
+ */
+drizzle_return_t drizzle_compression_read(drizzle_st *con, size_t size);
+
+/**
+ * Frame all data between con->buffer_ptr and con->buffer_size into the
+ * write buffer, leaving con->buffer_ptr after the data consumed.
+ * Each command starts a new frame sequence.
+ */
+drizzle_return_t drizzle_compression_write(drizzle_st *con);
+
+/** @} */
@@ -71,13 +71,15 @@ static drizzle_return_t _setsockopt(drizzle_st *con);
 static void connect_failed_try_next(drizzle_st *con, const char *file, uint line,
   const char *function, const char *msg);
 
-static void __closesocket(socket_t& fd)
+/* A group stops watching the socket before it goes away. */
+static void __closesocket(drizzle_st *con)
 {
-  if (fd != INVALID_SOCKET)
+  if (con->fd != INVALID_SOCKET)
   {
-    (void)shutdown(fd, SHUT_RDWR);
-    (void)closesocket(fd);
-    fd= INVALID_SOCKET;
+    drizzle_group_socket_close(con);
+    (void)shutdown(con->fd, SHUT_RDWR);
+    (void)closesocket(con->fd);
+    con->fd= INVALID_SOCKET;
   }
 }
 
@@ -109,16 +111,24 @@ void drizzle_close(drizzle_st *con)
     return;
   }
 
-  __closesocket(con->fd);
+  __closesocket(con);
 
   con->state.ready= false;
+  con->state.packet_continues= false;
   con->packet_number= 0;
   con->buffer_ptr= con->buffer;
   con->buffer_size= 0;
+  con->write_data= NULL;
+  con->write_data_size= 0;
+  delete[] con->infile_name;
+  con->infile_name= NULL;
   con->events= 0;
   con->revents= 0;
 
   con->clear_state();
+
+  drizzle_compression_free(con);
+  drizzle_stmt_cache_clear(con, false);
 }
 
 drizzle_return_t drizzle_set_events(drizzle_st *con, short events)
@@ -399,6 +409,101 @@ bool drizzle_options_get_auth_plugin(drizzle_options_st *options)
   return options->auth_plugin;
 }
 
+void drizzle_options_set_result_arena(drizzle_options_st *options, bool state)
+{
+  if (options == NULL)
+  {
+    return;
+  }
+  options->result_arena= state;
+}
+
+bool drizzle_options_get_result_arena(drizzle_options_st *options)
+{
+  if (options == NULL)
+  {
+    return false;
+  }
+  return options->result_arena;
+}
+
+void drizzle_options_set_compression(drizzle_options_st *options,
+                                     drizzle_compression_t compression)
+{
+  if (options == NULL)
+  {
+    return;
+  }
+  options->compression= compression;
+}
+
+drizzle_compression_t drizzle_options_get_compression(drizzle_options_st *options)
+{
+  if (options == NULL)
+  {
+    return DRIZZLE_COMPRESSION_NONE;
+  }
+  return options->compression;
+}
+
+void drizzle_options_set_stmt_cache_size(drizzle_options_st *options,
+                                         uint32_t size)
+{
+  if (options == NULL)
+  {
+    return;
+  }
+  options->stmt_cache_size= size;
+}
+
+uint32_t drizzle_options_get_stmt_cache_size(drizzle_options_st *options)
+{
+  if (options == NULL)
+  {
+    return 0;
+  }
+  return options->stmt_cache_size;
+}
+
+void drizzle_options_set_buffer_size(drizzle_options_st *options, size_t size)
+{
+  if (options == NULL)
+  {
+    return;
+  }
+  options->buffer_size= size < DRIZZLE_MIN_BUFFER_SIZE ?
+                        DRIZZLE_MIN_BUFFER_SIZE : size;
+}
+
+size_t drizzle_options_get_buffer_size(drizzle_options_st *options)
+{
+  if (options == NULL)
+  {
+    return DRIZZLE_DEFAULT_BUFFER_SIZE;
+  }
+  return options->buffer_size;
+}
+
+void drizzle_options_set_max_buffer_size(drizzle_options_st *options,
+                                         size_t size)
+{
+  if (options == NULL)
+  {
+    return;
+  }
+  options->max_buffer_size= size < DRIZZLE_MIN_BUFFER_SIZE ?
+                            DRIZZLE_MIN_BUFFER_SIZE : size;
+}
+
+size_t drizzle_options_get_max_buffer_size(drizzle_options_st *options)
+{
+  if (options == NULL)
+  {
+    return DRIZZLE_MAX_BUFFER_SIZE;
+  }
+  return options->max_buffer_size;
+}
+
 void drizzle_options_set_socket_owner(drizzle_options_st *options,
                    drizzle_socket_owner_t owner)
 {
@@ -796,6 +901,19 @@ drizzle_result_st *drizzle_ping(drizzle_st *con,
                                    0, ret_ptr);
 }
 
+drizzle_result_st *drizzle_reset_connection(drizzle_st *con,
+                                            drizzle_return_t *ret_ptr)
+{
+  if (con != NULL)
+  {
+    /* The reset closes every prepared statement on the server */
+    drizzle_stmt_cache_clear(con, false);
+  }
+
+  return drizzle_command_write(con, NULL, DRIZZLE_COMMAND_RESET_CONNECTION,
+                               NULL, 0, 0, ret_ptr);
+}
+
 drizzle_result_st *drizzle_command_write(drizzle_st *con,
                                              drizzle_result_st *result,
                                              drizzle_command_t command,
@@ -835,6 +953,14 @@ drizzle_result_st *drizzle_command_write(drizzle_st *con,
 
   if (con->has_state())
   {
+    /* Give back what the last command's packets made the buffer grow to.
+       Statements packed into the buffer have shrunk it before. */
+    *ret_ptr= drizzle_buffer_shrink(con);
+    if (*ret_ptr != DRIZZLE_RETURN_OK)
+    {
+      return result;
+    }
+
     if (con->state.raw_packet || con->state.no_result_read)
     {
       con->result= NULL;
@@ -893,6 +1019,49 @@ drizzle_result_st *drizzle_command_write(drizzle_st *con,
  * Local Definitions
  */
 
+drizzle_return_t drizzle_buffer_resize(drizzle_st *con, size_t size)
+{
+  assert(size >= con->buffer_size);
+
+  // Shift data to beginning of the buffer then resize
+  // This means that buffer_ptr isn't screwed up by realloc pointer move
+  if (con->buffer_ptr != con->buffer)
+  {
+    memmove(con->buffer, con->buffer_ptr, con->buffer_size);
+    con->buffer_ptr= con->buffer;
+  }
+
+  if (size == con->buffer_allocation)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  unsigned char *realloc_buffer= (unsigned char*)realloc(con->buffer, size);
+  if (realloc_buffer == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "realloc failure");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  con->buffer= realloc_buffer;
+  con->buffer_ptr= con->buffer;
+  con->buffer_allocation= size;
+  drizzle_log_debug(con, __FILE_LINE_FUNC__, "buffer resized to: %" PRIu64,
+                    (uint64_t)con->buffer_allocation);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_buffer_shrink(drizzle_st *con)
+{
+  if (con->buffer_size != 0 ||
+      con->buffer_allocation <= con->options.buffer_size)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  return drizzle_buffer_resize(con, con->options.buffer_size);
+}
+
 void drizzle_reset_addrinfo(drizzle_st *con)
 {
   if (con == NULL)
@@ -1009,7 +1178,7 @@ drizzle_return_t drizzle_state_connect(drizzle_st *con)
 
   __LOG_LOCATION__
 
-  __closesocket(con->fd);
+  __closesocket(con);
 
   if (con->socket_type == DRIZZLE_CON_SOCKET_UDS)
   {
@@ -1276,8 +1445,11 @@ drizzle_return_t drizzle_state_read(drizzle_st *con)
   {
     con->buffer_ptr= con->buffer;
   }
-  else if ((size_t)(con->buffer_ptr - con->buffer) > (con->buffer_allocation / 2))
+  else if (con->buffer_allocation -
+           ((size_t)(con->buffer_ptr - con->buffer) + con->buffer_size) <
+           con->buffer_allocation / 4)
   {
+    /* Only move the data left when there is little room after it. */
     memmove(con->buffer, con->buffer_ptr, con->buffer_size);
     con->buffer_ptr= con->buffer;
   }
@@ -1301,43 +1473,54 @@ drizzle_return_t drizzle_state_read(drizzle_st *con)
 
   while (1)
   {
-    size_t available_buffer= con->buffer_allocation - ((size_t)(con->buffer_ptr - con->buffer) + con->buffer_size);
-    if (available_buffer == 0)
+    unsigned char *read_ptr;
+    size_t available_buffer;
+
+    if (con->compression != NULL)
     {
-      if (con->buffer_allocation >= DRIZZLE_MAX_BUFFER_SIZE)
-      {
-        drizzle_set_error(con, __FILE_LINE_FUNC__,
-                          "buffer too small:%" PRIu32 , con->packet_size + 4);
-        return DRIZZLE_RETURN_INTERNAL_ERROR;
-      }
-      // Shift data to beginning of the buffer then resize
-      // This means that buffer_ptr isn't screwed up by realloc pointer move
-      if (con->buffer_ptr != con->buffer)
+      /* Frames are received separately and unpacked into the buffer. */
+      ret= drizzle_compression_read_space(con, &read_ptr, &available_buffer);
+      if (ret != DRIZZLE_RETURN_OK)
       {
-        memmove(con->buffer, con->buffer_ptr, con->buffer_size);
+        return ret;
       }
-      con->buffer_allocation= con->buffer_allocation * 2;
-      unsigned char *realloc_buffer= (unsigned char*)realloc(con->buffer, con->buffer_allocation);
-      if (realloc_buffer == NULL)
+    }
+    else
+    {
+      available_buffer= con->buffer_allocation - ((size_t)(con->buffer_ptr - con->buffer) + con->buffer_size);
+      if (available_buffer == 0)
       {
-        drizzle_set_error(con, __FILE_LINE_FUNC__, "realloc failure");
-        return DRIZZLE_RETURN_MEMORY;
+        if (con->buffer_allocation >= con->options.max_buffer_size)
+        {
+          drizzle_set_error(con, __FILE_LINE_FUNC__,
+                            "buffer too small:%" PRIu32 , con->packet_size + 4);
+          return DRIZZLE_RETURN_INTERNAL_ERROR;
+        }
+
+        size_t allocation= con->buffer_allocation * 2;
+        if (allocation > con->options.max_buffer_size)
+        {
+          allocation= con->options.max_buffer_size;
+        }
+        ret= drizzle_buffer_resize(con, allocation);
+        if (ret != DRIZZLE_RETURN_OK)
+        {
+          return ret;
+        }
+        available_buffer= con->buffer_allocation - con->buffer_size;
       }
-      con->buffer= realloc_buffer;
-      drizzle_log_debug(con, __FILE_LINE_FUNC__, "buffer resized to: %" PRIu32, con->buffer_allocation);
-      con->buffer_ptr= con->buffer;
-      available_buffer= con->buffer_allocation - con->buffer_size;
+      read_ptr= con->buffer_ptr + con->buffer_size;
     }
 
 #ifdef USE_OPENSSL
     if (con->ssl_state == DRIZZLE_SSL_STATE_HANDSHAKE_COMPLETE)
     {
-        read_size= SSL_read(con->ssl, (char*)con->buffer_ptr + con->buffer_size, (available_buffer % INT_MAX));
+        read_size= SSL_read(con->ssl, (char*)read_ptr, (available_buffer % INT_MAX));
     }
     else
 #endif
     {
-      read_size= recv(con->fd, (char *)con->buffer_ptr + con->buffer_size, available_buffer, MSG_NOSIGNAL);
+      read_size= recv(con->fd, (char *)read_ptr, available_buffer, MSG_NOSIGNAL);
     }
 
 #if defined _WIN32 || defined __CYGWIN__
@@ -1406,8 +1589,7 @@ drizzle_return_t drizzle_state_read(drizzle_st *con)
         {
           drizzle_log_debug(con, __FILE_LINE_FUNC__,
                             "EINVAL fd=%d buffer=%p available_buffer=%" PRIu64,
-                            con->fd, (char *)con->buffer_ptr + con->buffer_size,
-                            available_buffer);
+                            con->fd, (char *)read_ptr, available_buffer);
         }
         break;
 
@@ -1430,6 +1612,24 @@ drizzle_return_t drizzle_state_read(drizzle_st *con)
     {
       con->revents&= ~POLLIN;
     }
+
+    if (con->compression != NULL)
+    {
+      size_t buffer_size= con->buffer_size;
+      ret= drizzle_compression_read(con, (size_t)read_size);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+
+      /* Keep reading until at least one whole frame arrived. */
+      if (con->buffer_size == buffer_size)
+      {
+        continue;
+      }
+      break;
+    }
+
     con->buffer_size+= (size_t)read_size;
     break;
   }
@@ -1443,6 +1643,8 @@ drizzle_return_t drizzle_state_write(drizzle_st *con)
 {
   drizzle_return_t ret;
   ssize_t write_size;
+  unsigned char **send_ptr;
+  size_t *send_size;
 
   if (con == NULL)
   {
@@ -1451,17 +1653,58 @@ drizzle_return_t drizzle_state_write(drizzle_st *con)
 
   __LOG_LOCATION__
 
-  while (con->buffer_size != 0)
+  send_ptr= &con->buffer_ptr;
+  send_size= &con->buffer_size;
+
+  if (con->compression != NULL)
+  {
+    /* Everything is framed up front, what is left to send are the frames. */
+    ret= drizzle_compression_write(con);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+
+    send_ptr= &con->compression->write_ptr;
+    send_size= &con->compression->write_size;
+  }
+
+  while (*send_size != 0 || con->write_data_size != 0)
   {
 #ifdef USE_OPENSSL
     if (con->ssl_state == DRIZZLE_SSL_STATE_HANDSHAKE_COMPLETE)
     {
-      write_size= SSL_write(con->ssl, con->buffer_ptr, (con->buffer_size % INT_MAX));
+      write_size= SSL_write(con->ssl, *send_ptr, (*send_size % INT_MAX));
     }
     else
 #endif
+#if !defined(_WIN32)
+    if (con->write_data_size != 0)
     {
-      write_size= send(con->fd,(char *) con->buffer_ptr, con->buffer_size, MSG_NOSIGNAL);
+      /* Send the buffered header and the caller's data in one call */
+      struct iovec iov[2];
+      struct msghdr msg;
+      int iov_count= 0;
+
+      if (*send_size != 0)
+      {
+        iov[iov_count].iov_base= *send_ptr;
+        iov[iov_count].iov_len= *send_size;
+        iov_count++;
+      }
+      iov[iov_count].iov_base= (void *)con->write_data;
+      iov[iov_count].iov_len= con->write_data_size;
+      iov_count++;
+
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov= iov;
+      msg.msg_iovlen= iov_count;
+      write_size= sendmsg(con->fd, &msg, MSG_NOSIGNAL);
+    }
+    else
+#endif
+    {
+      write_size= send(con->fd,(char *) *send_ptr, *send_size, MSG_NOSIGNAL);
     }
 
 #if defined _WIN32 || defined __CYGWIN__
@@ -1522,12 +1765,18 @@ drizzle_return_t drizzle_state_write(drizzle_st *con)
       return DRIZZLE_RETURN_ERRNO;
     }
 
-    con->buffer_ptr+= write_size;
-    con->buffer_size-= (size_t)write_size;
-    if (con->buffer_size == 0)
-      break;
+    if ((size_t)write_size > *send_size)
+    {
+      con->write_data+= (size_t)write_size - *send_size;
+      con->write_data_size-= (size_t)write_size - *send_size;
+      write_size= (ssize_t)*send_size;
+    }
+    *send_ptr+= write_size;
+    *send_size-= (size_t)write_size;
   }
 
+  con->write_data= NULL;
+
   con->buffer_ptr= con->buffer;
 
   con->pop_state();
@@ -81,6 +81,27 @@ drizzle_result_st *drizzle_command_write(drizzle_st *con,
                                              const void *data, size_t size,
                                              size_t total,
                                              drizzle_return_t *ret_ptr);
+/**
+ * Reallocate the buffer of a connection, moving the data not consumed yet to
+ * the start of it.
+ *
+ * @param[in] con Connection structure previously initialized with
+ *  drizzle_create(), drizzle_clone(), or related functions.
+ * @param[in] size New size of the buffer, not less than the data in it.
+ * @return Standard drizzle return value.
+ */
+drizzle_return_t drizzle_buffer_resize(drizzle_st *con, size_t size);
+
+/**
+ * Shrink the buffer of a connection back to its initial size once a larger
+ * packet made it grow. Nothing is done while data is left in the buffer.
+ *
+ * @param[in] con Connection structure previously initialized with
+ *  drizzle_create(), drizzle_clone(), or related functions.
+ * @return Standard drizzle return value.
+ */
+drizzle_return_t drizzle_buffer_shrink(drizzle_st *con);
+
 /**
  * Set TCP host and port for a connection.
  *
@@ -0,0 +1,266 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief CRC32 definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <pthread.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+# define DRIZZLE_CRC32_PCLMUL 1
+# include <cpuid.h>
+# include <immintrin.h>
+#endif
+
+/* The reflected polynomial of CRC32 */
+#define DRIZZLE_CRC32_POLYNOMIAL 0xEDB88320
+
+/*
+ * Private declarations
+ */
+
+static uint32_t _crc32_slice8(uint32_t crc, const unsigned char *data,
+                              size_t size);
+#ifdef DRIZZLE_CRC32_PCLMUL
+static uint32_t _crc32_pclmul(uint32_t crc, const unsigned char *data,
+                              size_t size);
+#endif
+static void _crc32_init(void);
+
+static uint32_t _crc32_table[8][256];
+static uint32_t (*_crc32_fn)(uint32_t crc, const unsigned char *data,
+                             size_t size)= _crc32_slice8;
+static const char *_crc32_fn_name= "slicing-by-8";
+static pthread_once_t _crc32_once= PTHREAD_ONCE_INIT;
+
+/*
+ * Common definitions
+ */
+
+uint32_t drizzle_crc32(uint32_t crc, const unsigned char *data, size_t size)
+{
+  pthread_once(&_crc32_once, _crc32_init);
+
+  if (data == NULL || size == 0)
+  {
+    return crc;
+  }
+
+  return ~_crc32_fn(~crc, data, size);
+}
+
+const char *drizzle_crc32_name(void)
+{
+  pthread_once(&_crc32_once, _crc32_init);
+  return _crc32_fn_name;
+}
+
+/*
+ * Private definitions
+ */
+
+static void _crc32_init(void)
+{
+  for (uint32_t x= 0; x < 256; x++)
+  {
+    uint32_t crc= x;
+    for (uint32_t bit= 0; bit < 8; bit++)
+    {
+      crc= (crc >> 1) ^ ((crc & 1) ? DRIZZLE_CRC32_POLYNOMIAL : 0);
+    }
+    _crc32_table[0][x]= crc;
+  }
+
+  for (uint32_t x= 0; x < 256; x++)
+  {
+    for (uint32_t slice= 1; slice < 8; slice++)
+    {
+      uint32_t crc= _crc32_table[slice - 1][x];
+      _crc32_table[slice][x]= (crc >> 8) ^ _crc32_table[0][crc & 0xFF];
+    }
+  }
+
+#ifdef DRIZZLE_CRC32_PCLMUL
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+      (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1))
+  {
+    _crc32_fn= _crc32_pclmul;
+    _crc32_fn_name= "pclmulqdq";
+  }
+#endif
+}
+
+/* Eight bytes per step through eight tables, the state is not inverted */
+static uint32_t _crc32_slice8(uint32_t crc, const unsigned char *data,
+                              size_t size)
+{
+  for (; size >= 8; size-= 8, data+= 8)
+  {
+    uint32_t low= drizzle_get_byte4(data) ^ crc;
+    uint32_t high= drizzle_get_byte4(data + 4);
+
+    crc= _crc32_table[7][low & 0xFF] ^
+         _crc32_table[6][(low >> 8) & 0xFF] ^
+         _crc32_table[5][(low >> 16) & 0xFF] ^
+         _crc32_table[4][low >> 24] ^
+         _crc32_table[3][high & 0xFF] ^
+         _crc32_table[2][(high >> 8) & 0xFF] ^
+         _crc32_table[1][(high >> 16) & 0xFF] ^
+         _crc32_table[0][high >> 24];
+  }
+
+  for (; size > 0; size--, data++)
+  {
+    crc= (crc >> 8) ^ _crc32_table[0][(crc ^ *data) & 0xFF];
+  }
+
+  return crc;
+}
+
+#ifdef DRIZZLE_CRC32_PCLMUL
+/*
+ * Folds four 128 bit lanes at a time with carry-less multiplication and
+ * reduces the result with a Barrett reduction, as described in Intel's "Fast
+ * CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction". The
+ * constants are powers of x modulo the polynomial, bit reflected. Inputs
+ * shorter than 64 bytes and the tail of 15 bytes or less go through the
+ * tables.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t _crc32_pclmul(uint32_t crc, const unsigned char *data,
+                              size_t size)
+{
+  static const uint64_t k1k2[2] __attribute__((aligned(16)))=
+    { UINT64_C(0x0154442bd4), UINT64_C(0x01c6e41596) };
+  static const uint64_t k3k4[2] __attribute__((aligned(16)))=
+    { UINT64_C(0x01751997d0), UINT64_C(0x00ccaa009e) };
+  static const uint64_t k5k0[2] __attribute__((aligned(16)))=
+    { UINT64_C(0x0163cd6124), UINT64_C(0x0000000000) };
+  static const uint64_t poly[2] __attribute__((aligned(16)))=
+    { UINT64_C(0x01db710641), UINT64_C(0x01f7011641) };
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  if (size < 64)
+  {
+    return _crc32_slice8(crc, data, size);
+  }
+
+  x1= _mm_loadu_si128((const __m128i *)(data + 0x00));
+  x2= _mm_loadu_si128((const __m128i *)(data + 0x10));
+  x3= _mm_loadu_si128((const __m128i *)(data + 0x20));
+  x4= _mm_loadu_si128((const __m128i *)(data + 0x30));
+  x1= _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+  x0= _mm_load_si128((const __m128i *)k1k2);
+  data+= 64;
+  size-= 64;
+
+  // Fold 512 bits at a time
+  while (size >= 64)
+  {
+    x5= _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6= _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7= _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8= _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1= _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2= _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3= _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4= _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1= _mm_xor_si128(_mm_xor_si128(x1, x5),
+                      _mm_loadu_si128((const __m128i *)(data + 0x00)));
+    x2= _mm_xor_si128(_mm_xor_si128(x2, x6),
+                      _mm_loadu_si128((const __m128i *)(data + 0x10)));
+    x3= _mm_xor_si128(_mm_xor_si128(x3, x7),
+                      _mm_loadu_si128((const __m128i *)(data + 0x20)));
+    x4= _mm_xor_si128(_mm_xor_si128(x4, x8),
+                      _mm_loadu_si128((const __m128i *)(data + 0x30)));
+    data+= 64;
+    size-= 64;
+  }
+
+  // Fold the four lanes into one
+  x0= _mm_load_si128((const __m128i *)k3k4);
+  x5= _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1= _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1= _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5= _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1= _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1= _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5= _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1= _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1= _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // Fold the remaining whole 128 bit blocks
+  while (size >= 16)
+  {
+    x2= _mm_loadu_si128((const __m128i *)data);
+    x5= _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1= _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1= _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    data+= 16;
+    size-= 16;
+  }
+
+  // Fold 128 bits into 64
+  x2= _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3= _mm_setr_epi32(~0, 0, ~0, 0);
+  x1= _mm_srli_si128(x1, 8);
+  x1= _mm_xor_si128(x1, x2);
+  x0= _mm_loadl_epi64((const __m128i *)k5k0);
+  x2= _mm_srli_si128(x1, 4);
+  x1= _mm_and_si128(x1, x3);
+  x1= _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1= _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0= _mm_load_si128((const __m128i *)poly);
+  x2= _mm_and_si128(x1, x3);
+  x2= _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2= _mm_and_si128(x2, x3);
+  x2= _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1= _mm_xor_si128(x1, x2);
+  crc= (uint32_t)_mm_extract_epi32(x1, 1);
+
+  return _crc32_slice8(crc, data, size);
+}
+#endif
@@ -70,6 +70,12 @@ static const char *_verbose_name[DRIZZLE_VERBOSE_MAX]=
   "DEBUG",
 };
 
+/**
+ * Allocate the buffer of a new connection with the size from its options,
+ * the constructor leaves it unallocated.
+ */
+static drizzle_return_t _buffer_init(drizzle_st *con);
+
 /** @} */
 
 /*
@@ -198,6 +204,18 @@ void drizzle_set_event_watch_fn(drizzle_st *drizzle,
   drizzle->event_watch_context= context;
 }
 
+void drizzle_set_infile_fn(drizzle_st *con, drizzle_infile_fn *function,
+                           void *context)
+{
+  if (con == NULL)
+  {
+    return;
+  }
+
+  con->infile_fn= function;
+  con->infile_context= context;
+}
+
 drizzle_st *drizzle_clone(drizzle_st *drizzle, const drizzle_st *from)
 {
   drizzle= new (std::nothrow) drizzle_st;
@@ -228,6 +246,12 @@ drizzle_st *drizzle_clone(drizzle_st *drizzle, const drizzle_st *from)
     break;
   }
 
+  if (_buffer_init(drizzle) != DRIZZLE_RETURN_OK)
+  {
+    drizzle_free(drizzle);
+    return NULL;
+  }
+
   return drizzle;
 }
 
@@ -243,6 +267,8 @@ void drizzle_free(drizzle_st *con)
     con->context_free_fn(con, con->context);
   }
 
+  /* Cached statements own results in the result list */
+  drizzle_stmt_cache_clear(con, false);
   drizzle_result_free_all(con);
 
   if (con->fd != INVALID_SOCKET)
@@ -265,6 +291,7 @@ void drizzle_free(drizzle_st *con)
     drizzle_binlog_free(con->binlog);
   }
 
+  drizzle_compression_free(con);
   free(con->buffer);
   delete con;
 }
@@ -420,6 +447,12 @@ drizzle_st *drizzle_create(const char *host, in_port_t port,
     con->options= *options;
   }
 
+  if (_buffer_init(con) != DRIZZLE_RETURN_OK)
+  {
+    drizzle_free(con);
+    return NULL;
+  }
+
   return con;
 }
 
@@ -503,3 +536,17 @@ void drizzle_log(drizzle_st *con, const char *file, uint line, const char *func,
     con->log_fn(file, line, func, log_buffer, verbose, con->log_context);
   }
 }
+
+/*
+ * Static Definitions
+ */
+
+static drizzle_return_t _buffer_init(drizzle_st *con)
+{
+  if (con->options.buffer_size > con->options.max_buffer_size)
+  {
+    con->options.buffer_size= con->options.max_buffer_size;
+  }
+
+  return drizzle_buffer_resize(con, con->options.buffer_size);
+}
@@ -259,6 +259,18 @@ drizzle_return_t drizzle_state_field_read(drizzle_st *con)
   }
   __LOG_LOCATION__
 
+  /* The row goes on in the next packet. A length is joined with the bytes
+     of it in the next packet, so it can be unpacked in one piece. */
+  if (con->state.packet_continues &&
+      (con->packet_size == 0 ||
+       (con->packet_size < 9 &&
+        con->result->field_offset + con->result->field_size ==
+        con->result->field_total)))
+  {
+    con->push_state(drizzle_state_packet_continue);
+    return DRIZZLE_RETURN_OK;
+  }
+
   if (con->buffer_size == 0)
   {
     con->push_state(drizzle_state_read);
@@ -379,7 +391,21 @@ drizzle_return_t drizzle_state_binary_null_read(drizzle_st *con)
 {
   uint16_t bit_count= 0;
   con->result->null_bitmap_length= (con->result->column_count+7+2)/8;
-  con->result->null_bitmap= new uint8_t[con->result->null_bitmap_length];
+  /* Rows buffered into an arena keep their bitmap there */
+  if (con->result->arena != NULL)
+  {
+    con->result->null_bitmap= (uint8_t *)drizzle_arena_alloc(
+      con->result->arena, con->result->null_bitmap_length);
+  }
+  else
+  {
+    con->result->null_bitmap= new (std::nothrow) uint8_t[con->result->null_bitmap_length];
+  }
+  if (con->result->null_bitmap == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
   con->buffer_ptr++;
 
   memcpy(con->result->null_bitmap, con->buffer_ptr, con->result->null_bitmap_length);
@@ -463,6 +489,7 @@ drizzle_return_t drizzle_state_binary_field_read(drizzle_st *con)
     case DRIZZLE_COLUMN_TYPE_ENUM:
     case DRIZZLE_COLUMN_TYPE_SET:
     case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
     /* We do not need to support these three: they exist internally to the MySQL server, but do not appear on the wire */
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
     case DRIZZLE_COLUMN_TYPE_DATETIME2:
@@ -0,0 +1,570 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Connection group definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#ifdef HAVE_SYS_EPOLL_H
+# include <sys/epoll.h>
+#endif
+
+/* Number of events collected by one call to epoll_wait(). */
+#define DRIZZLE_GROUP_EVENT_COUNT 256
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Event watcher installed on every connection of a group. Registers the
+ * socket of the connection once, edge-triggered for both reading and
+ * writing, so later changes of interest need no system call at all.
+ */
+static drizzle_return_t _group_watch(drizzle_st *con, short events,
+                                     void *context);
+
+/**
+ * Start watching the socket of a member, if it has one.
+ */
+static drizzle_return_t _group_register(drizzle_group_member_st *member);
+
+/**
+ * Stop watching the socket of a member.
+ */
+static void _group_unregister(drizzle_group_member_st *member);
+
+static void _group_set_waiting(drizzle_group_member_st *member, bool waiting);
+
+/**
+ * Wait for events once and dispatch them to the members.
+ */
+static drizzle_return_t _group_poll(drizzle_group_st *group, int timeout);
+
+/**
+ * Pass events to a member and queue it as ready if it was waiting for them.
+ */
+static void _group_dispatch(drizzle_group_member_st *member, short revents);
+
+/*
+ * Client definitions
+ */
+
+drizzle_group_st *drizzle_group_create(void)
+{
+  drizzle_group_st *group= new (std::nothrow) drizzle_group_st;
+  if (group == NULL)
+  {
+    return NULL;
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  group->epoll_fd= epoll_create1(EPOLL_CLOEXEC);
+  if (group->epoll_fd == -1)
+  {
+    delete group;
+    return NULL;
+  }
+#endif
+
+  return group;
+}
+
+void drizzle_group_free(drizzle_group_st *group)
+{
+  if (group == NULL)
+  {
+    return;
+  }
+
+  while (group->member_list != NULL)
+  {
+    drizzle_group_remove(group, group->member_list->con);
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  close(group->epoll_fd);
+#endif
+  free(group->pfd_list);
+  free(group->pfd_member_list);
+  delete group;
+}
+
+drizzle_return_t drizzle_group_add(drizzle_group_st *group, drizzle_st *con)
+{
+  drizzle_return_t ret;
+
+  if (group == NULL || con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (con->event_watch_fn == _group_watch)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "connection already in a group");
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  drizzle_group_member_st *member= new (std::nothrow) drizzle_group_member_st;
+  if (member == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  member->group= group;
+  member->con= con;
+
+  ret= _group_register(member);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    delete member;
+    return ret;
+  }
+
+  member->event_watch_fn= con->event_watch_fn;
+  member->event_watch_context= con->event_watch_context;
+  member->non_blocking= con->options.non_blocking;
+  con->event_watch_fn= _group_watch;
+  con->event_watch_context= member;
+  con->options.non_blocking= true;
+
+  member->next= group->member_list;
+  if (group->member_list != NULL)
+  {
+    group->member_list->prev= member;
+  }
+  group->member_list= member;
+  group->count++;
+
+  _group_set_waiting(member, con->events != 0);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_group_remove(drizzle_group_st *group, drizzle_st *con)
+{
+  if (group == NULL || con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  drizzle_group_member_st *member= (drizzle_group_member_st *)con->event_watch_context;
+  if (con->event_watch_fn != _group_watch || member->group != group)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "connection not in this group");
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  _group_unregister(member);
+  _group_set_waiting(member, false);
+
+  if (member->ready)
+  {
+    drizzle_group_member_st **ptr= &group->ready_list;
+    drizzle_group_member_st *previous= NULL;
+    while (*ptr != member)
+    {
+      previous= *ptr;
+      ptr= &(*ptr)->ready_next;
+    }
+    *ptr= member->ready_next;
+    if (group->ready_end == member)
+    {
+      group->ready_end= previous;
+    }
+  }
+
+  if (member->prev == NULL)
+  {
+    group->member_list= member->next;
+  }
+  else
+  {
+    member->prev->next= member->next;
+  }
+  if (member->next != NULL)
+  {
+    member->next->prev= member->prev;
+  }
+  group->count--;
+
+  con->event_watch_fn= member->event_watch_fn;
+  con->event_watch_context= member->event_watch_context;
+  con->options.non_blocking= member->non_blocking;
+  delete member;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+uint32_t drizzle_group_count(const drizzle_group_st *group)
+{
+  if (group == NULL)
+  {
+    return 0;
+  }
+
+  return group->count;
+}
+
+drizzle_return_t drizzle_group_wait(drizzle_group_st *group, int timeout)
+{
+  drizzle_return_t ret;
+
+  if (group == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  /* Ready connections not collected yet only get the events that are
+     already pending added to them. */
+  if (group->ready_list != NULL)
+  {
+    timeout= 0;
+  }
+
+  while (1)
+  {
+    if (group->waiting_count == 0)
+    {
+      return group->ready_list == NULL ?
+             DRIZZLE_RETURN_NO_ACTIVE_CONNECTIONS : DRIZZLE_RETURN_OK;
+    }
+
+    ret= _group_poll(group, timeout);
+    if (ret == DRIZZLE_RETURN_TIMEOUT && group->ready_list != NULL)
+    {
+      return DRIZZLE_RETURN_OK;
+    }
+    else if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+
+    if (group->ready_list != NULL)
+    {
+      return DRIZZLE_RETURN_OK;
+    }
+  }
+}
+
+drizzle_st *drizzle_group_ready(drizzle_group_st *group)
+{
+  if (group == NULL)
+  {
+    return NULL;
+  }
+
+  drizzle_group_member_st *member= group->ready_list;
+  if (member == NULL)
+  {
+    return NULL;
+  }
+
+  group->ready_list= member->ready_next;
+  if (group->ready_list == NULL)
+  {
+    group->ready_end= NULL;
+  }
+  member->ready_next= NULL;
+  member->ready= false;
+
+  return member->con;
+}
+
+/*
+ * Local definitions
+ */
+
+void drizzle_group_socket_close(drizzle_st *con)
+{
+  if (con->event_watch_fn != _group_watch)
+  {
+    return;
+  }
+
+  drizzle_group_member_st *member=
+    (drizzle_group_member_st *)con->event_watch_context;
+  _group_unregister(member);
+  _group_set_waiting(member, false);
+}
+
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _group_watch(drizzle_st *con, short events,
+                                     void *context)
+{
+  drizzle_group_member_st *member= (drizzle_group_member_st *)context;
+  (void)con;
+  (void)events;
+
+  _group_set_waiting(member, true);
+
+  return _group_register(member);
+}
+
+static drizzle_return_t _group_register(drizzle_group_member_st *member)
+{
+  drizzle_st *con= member->con;
+
+  if (member->fd != INVALID_SOCKET || con->fd == INVALID_SOCKET)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+  event.events= EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.ptr= member;
+
+  if (epoll_ctl(member->group->epoll_fd, EPOLL_CTL_ADD, con->fd, &event) == -1)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "epoll_ctl:%s", strerror(errno));
+    con->last_errno= errno;
+    return DRIZZLE_RETURN_ERRNO;
+  }
+#endif
+
+  member->fd= con->fd;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static void _group_unregister(drizzle_group_member_st *member)
+{
+  if (member->fd == INVALID_SOCKET)
+  {
+    return;
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  (void)epoll_ctl(member->group->epoll_fd, EPOLL_CTL_DEL, member->fd, NULL);
+#endif
+
+  member->fd= INVALID_SOCKET;
+}
+
+static void _group_set_waiting(drizzle_group_member_st *member, bool waiting)
+{
+  if (member->waiting == waiting)
+  {
+    return;
+  }
+
+  member->waiting= waiting;
+  if (waiting)
+  {
+    member->group->waiting_count++;
+  }
+  else
+  {
+    member->group->waiting_count--;
+  }
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+
+static drizzle_return_t _group_poll(drizzle_group_st *group, int timeout)
+{
+  struct epoll_event event_list[DRIZZLE_GROUP_EVENT_COUNT];
+  int count;
+  int x;
+
+  while (1)
+  {
+    count= epoll_wait(group->epoll_fd, event_list, DRIZZLE_GROUP_EVENT_COUNT,
+                      timeout);
+    if (count == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      return DRIZZLE_RETURN_ERRNO;
+    }
+
+    break;
+  }
+
+  if (count == 0)
+  {
+    return DRIZZLE_RETURN_TIMEOUT;
+  }
+
+  for (x= 0; x < count; x++)
+  {
+    short revents= 0;
+
+    if (event_list[x].events & (EPOLLIN | EPOLLRDHUP))
+    {
+      revents|= POLLIN;
+    }
+    if (event_list[x].events & EPOLLOUT)
+    {
+      revents|= POLLOUT;
+    }
+    if (event_list[x].events & EPOLLERR)
+    {
+      revents|= POLLERR;
+    }
+    if (event_list[x].events & EPOLLHUP)
+    {
+      revents|= POLLHUP;
+    }
+
+    _group_dispatch((drizzle_group_member_st *)event_list[x].data.ptr, revents);
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+#else
+
+static drizzle_return_t _group_poll(drizzle_group_st *group, int timeout)
+{
+  drizzle_group_member_st *member;
+  uint32_t count= 0;
+  uint32_t x;
+  int ret;
+
+  if (group->pfd_list_size < group->count)
+  {
+    pollfd_t *pfd_list= (pollfd_t *)realloc(group->pfd_list,
+                                            sizeof(pollfd_t) * group->count);
+    if (pfd_list == NULL)
+    {
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    group->pfd_list= pfd_list;
+
+    drizzle_group_member_st **pfd_member_list= (drizzle_group_member_st **)
+      realloc(group->pfd_member_list,
+              sizeof(drizzle_group_member_st *) * group->count);
+    if (pfd_member_list == NULL)
+    {
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    group->pfd_member_list= pfd_member_list;
+    group->pfd_list_size= group->count;
+  }
+
+  for (member= group->member_list; member != NULL; member= member->next)
+  {
+    if (member->con->events != 0 && member->con->fd != INVALID_SOCKET)
+    {
+      group->pfd_list[count].fd= member->con->fd;
+      group->pfd_list[count].events= member->con->events;
+      group->pfd_list[count].revents= 0;
+      group->pfd_member_list[count]= member;
+      count++;
+    }
+  }
+
+  while (1)
+  {
+    ret= poll(group->pfd_list, count, timeout);
+    if (ret == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      return DRIZZLE_RETURN_ERRNO;
+    }
+
+    break;
+  }
+
+  if (ret == 0)
+  {
+    return DRIZZLE_RETURN_TIMEOUT;
+  }
+
+  for (x= 0; x < count; x++)
+  {
+    if (group->pfd_list[x].revents != 0)
+    {
+      _group_dispatch(group->pfd_member_list[x], group->pfd_list[x].revents);
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+#endif
+
+static void _group_dispatch(drizzle_group_member_st *member, short revents)
+{
+  drizzle_group_st *group= member->group;
+  drizzle_st *con= member->con;
+  short events= con->events;
+
+  /* Sockets are always watched for writing, which only matters while the
+     connection asks for it. Readability is kept until a read drains it. */
+  if (!(events & POLLOUT))
+  {
+    revents&= (short)~POLLOUT;
+  }
+  (void)drizzle_set_revents(con, (short)(con->revents | revents));
+
+  if (!member->waiting ||
+      !((events & revents) || (revents & (POLLERR | POLLHUP))))
+  {
+    return;
+  }
+
+  _group_set_waiting(member, false);
+
+  member->ready= true;
+  if (group->ready_end == NULL)
+  {
+    group->ready_list= member;
+  }
+  else
+  {
+    group->ready_end->ready_next= member;
+  }
+  group->ready_end= member;
+}
@@ -498,22 +498,39 @@ int drizzle_compile_capabilities(drizzle_st *con)
     capabilities|= DRIZZLE_CAPABILITIES_INTERACTIVE;
   }
 
+  /* Several statements in one query answer with one result each. */
   if (con->options.multi_statements)
   {
-    capabilities|= DRIZZLE_CAPABILITIES_MULTI_STATEMENTS;
+    capabilities|= DRIZZLE_CAPABILITIES_MULTI_STATEMENTS |
+                    DRIZZLE_CAPABILITIES_MULTI_RESULTS;
   }
 
   if (con->options.auth_plugin)
   {
     capabilities|= DRIZZLE_CAPABILITIES_PLUGIN_AUTH;
   }
+
+  /* Local files are only sent through the application's function. */
+  if (con->infile_fn != NULL)
+  {
+    capabilities|= DRIZZLE_CAPABILITIES_LOCAL_FILES;
+  }
 #ifdef USE_OPENSSL
   if (con->ssl)
   {
     capabilities|= DRIZZLE_CAPABILITIES_SSL;
   }
 #endif
-  capabilities&= ~DRIZZLE_CAPABILITIES_COMPRESS;
+  /* Compression is only asked for when the server offers it. */
+  if (con->options.compression != DRIZZLE_COMPRESSION_NONE &&
+      (con->capabilities & DRIZZLE_CAPABILITIES_COMPRESS))
+  {
+    capabilities|= DRIZZLE_CAPABILITIES_COMPRESS;
+  }
+  else
+  {
+    capabilities&= ~DRIZZLE_CAPABILITIES_COMPRESS;
+  }
   if (con->db[0] == 0)
     capabilities&= ~DRIZZLE_CAPABILITIES_CONNECT_WITH_DB;
 
@@ -675,7 +692,15 @@ drizzle_return_t drizzle_state_handshake_result_read(drizzle_st *con)
       }
       else
       {
-        con->state.ready= true;
+        /* Everything after the handshake is framed once compression has
+           been agreed on. */
+        if (con->options.compression != DRIZZLE_COMPRESSION_NONE &&
+            (con->capabilities & DRIZZLE_CAPABILITIES_COMPRESS))
+        {
+          ret= drizzle_compression_start(con);
+        }
+
+        con->state.ready= (ret == DRIZZLE_RETURN_OK);
       }
     }
   }
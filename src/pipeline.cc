@@ -0,0 +1,450 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Pipelined query definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <inttypes.h>
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Make sure the connection can take pipelined commands, connecting it if
+ * nothing has been sent on it yet.
+ */
+static drizzle_return_t _pipeline_ready(drizzle_pipeline_st *pipeline);
+
+/**
+ * Write queued queries back to back from the pipeline buffer while the
+ * number of queries in flight is at most half of the window. Any data
+ * already read into the connection buffer is left untouched.
+ */
+static drizzle_return_t _pipeline_send(drizzle_pipeline_st *pipeline);
+
+/**
+ * Drop everything queued or in flight after the connection failed. Every
+ * pending query then reports ret from drizzle_pipeline_result().
+ */
+static void _pipeline_abort(drizzle_pipeline_st *pipeline,
+                            drizzle_return_t ret);
+
+/*
+ * Client definitions
+ */
+
+drizzle_pipeline_st *drizzle_pipeline_create(drizzle_st *con, uint32_t window)
+{
+  if (con == NULL)
+  {
+    return NULL;
+  }
+
+  drizzle_pipeline_st *pipeline= new (std::nothrow) drizzle_pipeline_st;
+  if (pipeline == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return NULL;
+  }
+
+  pipeline->con= con;
+  pipeline->window= window ? window : DRIZZLE_DEFAULT_PIPELINE_WINDOW;
+
+  return pipeline;
+}
+
+void drizzle_pipeline_free(drizzle_pipeline_st *pipeline)
+{
+  if (pipeline == NULL)
+  {
+    return;
+  }
+
+  free(pipeline->packet_end_list);
+  free(pipeline->buffer);
+  delete pipeline;
+}
+
+drizzle_return_t drizzle_pipeline_query(drizzle_pipeline_st *pipeline,
+                                        const char *query, size_t size)
+{
+  unsigned char *ptr;
+
+  if (pipeline == NULL || query == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (size == 0)
+  {
+    size= strlen(query);
+  }
+
+  if (size >= DRIZZLE_MAX_PAYLOAD_SIZE)
+  {
+    drizzle_set_error(pipeline->con, __FILE_LINE_FUNC__,
+                      "query too large for a pipeline:%" PRIu64,
+                      (uint64_t)size);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (pipeline->packet_count == pipeline->packet_list_size)
+  {
+    uint32_t packet_list_size= pipeline->packet_list_size ?
+                               pipeline->packet_list_size * 2 :
+                               pipeline->window;
+    size_t *packet_end_list= (size_t *)realloc(pipeline->packet_end_list,
+                                 sizeof(size_t) * packet_list_size);
+    if (packet_end_list == NULL)
+    {
+      drizzle_set_error(pipeline->con, __FILE_LINE_FUNC__,
+                        "Failed to realloc packet list.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    pipeline->packet_end_list= packet_end_list;
+    pipeline->packet_list_size= packet_list_size;
+  }
+
+  if (pipeline->buffer_size + 5 + size > pipeline->buffer_allocation)
+  {
+    size_t buffer_allocation= pipeline->buffer_allocation ?
+                              pipeline->buffer_allocation :
+                              DRIZZLE_BUFFER_COPY_THRESHOLD;
+    while (pipeline->buffer_size + 5 + size > buffer_allocation)
+    {
+      buffer_allocation*= 2;
+    }
+
+    unsigned char *buffer= (unsigned char *)realloc(pipeline->buffer,
+                                                    buffer_allocation);
+    if (buffer == NULL)
+    {
+      drizzle_set_error(pipeline->con, __FILE_LINE_FUNC__,
+                        "Failed to realloc buffer.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    pipeline->buffer= buffer;
+    pipeline->buffer_allocation= buffer_allocation;
+  }
+
+  /* Every query is a command of its own, so the packet number starts at 0. */
+  ptr= pipeline->buffer + pipeline->buffer_size;
+  drizzle_set_byte3(ptr, 1 + size);
+  ptr[3]= 0;
+  ptr[4]= (unsigned char)DRIZZLE_COMMAND_QUERY;
+  memcpy(ptr + 5, query, size);
+
+  pipeline->buffer_size+= 5 + size;
+  pipeline->packet_end_list[pipeline->packet_count]= pipeline->buffer_size;
+  pipeline->packet_count++;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_pipeline_flush(drizzle_pipeline_st *pipeline)
+{
+  drizzle_return_t ret;
+
+  if (pipeline == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (pipeline->failed_count > 0)
+  {
+    return pipeline->error;
+  }
+
+  if (!pipeline->con->has_state())
+  {
+    drizzle_set_error(pipeline->con, __FILE_LINE_FUNC__,
+                      "connection busy reading a result");
+    return DRIZZLE_RETURN_NOT_READY;
+  }
+
+  ret= _pipeline_ready(pipeline);
+  if (ret == DRIZZLE_RETURN_OK)
+  {
+    ret= _pipeline_send(pipeline);
+  }
+
+  if (ret != DRIZZLE_RETURN_OK && ret != DRIZZLE_RETURN_IO_WAIT &&
+      ret != DRIZZLE_RETURN_NOT_READY)
+  {
+    _pipeline_abort(pipeline, ret);
+  }
+
+  return ret;
+}
+
+drizzle_result_st *drizzle_pipeline_result(drizzle_pipeline_st *pipeline,
+                                           drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused;
+  }
+
+  if (pipeline == NULL)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  drizzle_st *con= pipeline->con;
+
+  if (pipeline->failed_count > 0)
+  {
+    pipeline->failed_count--;
+    *ret_ptr= pipeline->error;
+    return NULL;
+  }
+
+  if (!pipeline->reading)
+  {
+    if (pipeline->in_flight == 0 && pipeline->packet_count == 0)
+    {
+      *ret_ptr= DRIZZLE_RETURN_OK;
+      return NULL;
+    }
+
+    if (!con->has_state())
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__,
+                        "connection busy reading a result");
+      *ret_ptr= DRIZZLE_RETURN_NOT_READY;
+      return NULL;
+    }
+
+    if (con->status & DRIZZLE_CON_STATUS_MORE_RESULTS_EXISTS)
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__,
+                        "previous query has more results to read");
+      *ret_ptr= DRIZZLE_RETURN_NOT_READY;
+      return NULL;
+    }
+
+    *ret_ptr= _pipeline_ready(pipeline);
+    if (*ret_ptr == DRIZZLE_RETURN_OK)
+    {
+      *ret_ptr= _pipeline_send(pipeline);
+    }
+
+    if (*ret_ptr == DRIZZLE_RETURN_IO_WAIT ||
+        *ret_ptr == DRIZZLE_RETURN_NOT_READY)
+    {
+      return NULL;
+    }
+    else if (*ret_ptr != DRIZZLE_RETURN_OK)
+    {
+      _pipeline_abort(pipeline, *ret_ptr);
+      pipeline->failed_count--;
+      return NULL;
+    }
+
+    con->result= drizzle_result_create(con);
+    if (con->result == NULL)
+    {
+      *ret_ptr= DRIZZLE_RETURN_MEMORY;
+      return NULL;
+    }
+
+    con->command= DRIZZLE_COMMAND_QUERY;
+    con->packet_number= 1;
+    con->push_state(drizzle_state_result_read);
+    con->push_state(drizzle_state_packet_read);
+
+    pipeline->in_flight--;
+    pipeline->reading= true;
+  }
+
+  *ret_ptr= drizzle_state_loop(con);
+  if (*ret_ptr == DRIZZLE_RETURN_IO_WAIT)
+  {
+    return con->result;
+  }
+
+  pipeline->reading= false;
+
+  if (*ret_ptr != DRIZZLE_RETURN_OK && *ret_ptr != DRIZZLE_RETURN_ERROR_CODE)
+  {
+    drizzle_result_free(con->result);
+    con->result= NULL;
+    _pipeline_abort(pipeline, *ret_ptr);
+    return NULL;
+  }
+
+  return con->result;
+}
+
+uint32_t drizzle_pipeline_pending(drizzle_pipeline_st *pipeline)
+{
+  if (pipeline == NULL)
+  {
+    return 0;
+  }
+
+  return pipeline->packet_count + pipeline->in_flight +
+         pipeline->failed_count + (pipeline->reading ? 1 : 0);
+}
+
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _pipeline_ready(drizzle_pipeline_st *pipeline)
+{
+  drizzle_st *con= pipeline->con;
+
+  if (con->state.ready)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (con->state.raw_packet)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "connection not ready");
+    return DRIZZLE_RETURN_NOT_READY;
+  }
+
+  /* Reconnecting would silently drop the queries already sent. */
+  if (pipeline->in_flight > 0 || pipeline->send_count > 0)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "lost connection to server");
+    return DRIZZLE_RETURN_LOST_CONNECTION;
+  }
+
+  return drizzle_connect(con);
+}
+
+static drizzle_return_t _pipeline_send(drizzle_pipeline_st *pipeline)
+{
+  drizzle_st *con= pipeline->con;
+  unsigned char *read_ptr;
+  size_t read_size;
+  size_t send_end;
+  drizzle_return_t ret;
+  uint32_t x;
+
+  if (pipeline->send_count == 0)
+  {
+    if (pipeline->packet_count == 0 ||
+        pipeline->in_flight > pipeline->window / 2)
+    {
+      return DRIZZLE_RETURN_OK;
+    }
+
+    pipeline->send_count= pipeline->window - pipeline->in_flight;
+    if (pipeline->send_count > pipeline->packet_count)
+    {
+      pipeline->send_count= pipeline->packet_count;
+    }
+    pipeline->send_offset= 0;
+  }
+
+  /* Results of earlier queries may already sit in the connection buffer, so
+     point the write state at the pipeline buffer and put the read position
+     back afterwards. */
+  send_end= pipeline->packet_end_list[pipeline->send_count - 1];
+  read_ptr= con->buffer_ptr;
+  read_size= con->buffer_size;
+
+  con->buffer_ptr= pipeline->buffer + pipeline->send_offset;
+  con->buffer_size= send_end - pipeline->send_offset;
+  con->push_state(drizzle_state_write);
+
+  ret= drizzle_state_loop(con);
+  if (ret == DRIZZLE_RETURN_IO_WAIT)
+  {
+    pipeline->send_offset= (size_t)(con->buffer_ptr - pipeline->buffer);
+    con->pop_state();
+  }
+  else if (ret != DRIZZLE_RETURN_OK)
+  {
+    /* The connection has been closed and its buffer reset. */
+    return ret;
+  }
+
+  con->buffer_ptr= read_size ? read_ptr : con->buffer;
+  con->buffer_size= read_size;
+
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
+  /* Only queries not sent yet are kept in the buffer. */
+  pipeline->in_flight+= pipeline->send_count;
+  pipeline->packet_count-= pipeline->send_count;
+  for (x= 0; x < pipeline->packet_count; x++)
+  {
+    pipeline->packet_end_list[x]=
+      pipeline->packet_end_list[x + pipeline->send_count] - send_end;
+  }
+  memmove(pipeline->buffer, pipeline->buffer + send_end,
+          pipeline->buffer_size - send_end);
+  pipeline->buffer_size-= send_end;
+  pipeline->send_count= 0;
+  pipeline->send_offset= 0;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static void _pipeline_abort(drizzle_pipeline_st *pipeline,
+                            drizzle_return_t ret)
+{
+  pipeline->failed_count= pipeline->packet_count + pipeline->in_flight;
+  if (pipeline->reading)
+  {
+    pipeline->failed_count++;
+  }
+  pipeline->error= ret;
+
+  pipeline->in_flight= 0;
+  pipeline->packet_count= 0;
+  pipeline->buffer_size= 0;
+  pipeline->send_count= 0;
+  pipeline->send_offset= 0;
+  pipeline->reading= false;
+}
@@ -0,0 +1,609 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Connection pool definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <time.h>
+
+/* Seconds the maintenance thread sleeps between its rounds. */
+#define DRIZZLE_POOL_MAINTAIN_INTERVAL 1
+
+/* ER_UNKNOWN_COM_ERROR, returned by servers without COM_RESET_CONNECTION. */
+#define DRIZZLE_POOL_UNKNOWN_COMMAND 1047
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Background thread which opens warm spare connections, closes connections
+ * idle for too long and pings the others.
+ */
+static void *_pool_maintain(void *context);
+
+static void _pool_maintain_round(drizzle_pool_st *pool);
+
+/**
+ * Open a new connection in a slot claimed by the caller.
+ */
+static drizzle_return_t _pool_connect(drizzle_pool_st *pool,
+                                      drizzle_pool_slot_st *slot);
+
+/**
+ * Close the connection of a slot claimed by the caller and give the slot up.
+ */
+static void _pool_drop(drizzle_pool_st *pool, drizzle_pool_slot_st *slot,
+                       bool quit);
+
+/**
+ * Clear the session state of a connection that is checked in.
+ */
+static drizzle_return_t _pool_reset(drizzle_pool_st *pool, drizzle_st *con);
+
+static bool _pool_claim(drizzle_pool_slot_st *slot, uint32_t from, uint32_t to);
+
+/**
+ * Account for a slot claimed, or given back, by the maintenance thread, so
+ * a checkout does not report the pool exhausted while it holds one.
+ */
+static void _pool_maintain_hold(drizzle_pool_st *pool);
+
+static void _pool_maintain_release(drizzle_pool_st *pool);
+
+static void _pool_wake(drizzle_pool_st *pool);
+
+static int64_t _pool_now(void);
+
+/*
+ * Client definitions
+ */
+
+drizzle_pool_st *drizzle_pool_create(const drizzle_st *con, uint32_t min,
+                                     uint32_t max)
+{
+  if (con == NULL || max == 0 || min > max)
+  {
+    return NULL;
+  }
+
+  drizzle_pool_st *pool= new (std::nothrow) drizzle_pool_st;
+  if (pool == NULL)
+  {
+    return NULL;
+  }
+
+  pool->min= min;
+  pool->max= max;
+  pool->con= drizzle_clone(NULL, con);
+  pool->slot_list= new (std::nothrow) drizzle_pool_slot_st[max];
+  if (pool->con == NULL || pool->slot_list == NULL)
+  {
+    drizzle_free(pool->con);
+    delete[] pool->slot_list;
+    delete pool;
+    return NULL;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+
+  if (pthread_create(&pool->thread, NULL, _pool_maintain, pool) != 0)
+  {
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    drizzle_free(pool->con);
+    delete[] pool->slot_list;
+    delete pool;
+    return NULL;
+  }
+
+  return pool;
+}
+
+void drizzle_pool_free(drizzle_pool_st *pool)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown= true;
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->lock);
+  pthread_join(pool->thread, NULL);
+
+  /* Connections still checked out belong to their holders from now on */
+  for (uint32_t x= 0; x < pool->max; x++)
+  {
+    if (pool->slot_list[x].con != NULL &&
+        pool->slot_list[x].state == DRIZZLE_POOL_SLOT_IDLE)
+    {
+      (void)drizzle_quit(pool->slot_list[x].con);
+    }
+  }
+
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->lock);
+  drizzle_free(pool->con);
+  delete[] pool->slot_list;
+  delete pool;
+}
+
+void drizzle_pool_set_spare(drizzle_pool_st *pool, uint32_t spare)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  __atomic_store_n(&pool->spare, spare, __ATOMIC_RELAXED);
+  _pool_wake(pool);
+}
+
+void drizzle_pool_set_idle_time(drizzle_pool_st *pool, uint32_t seconds)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  __atomic_store_n(&pool->idle_time, seconds, __ATOMIC_RELAXED);
+}
+
+void drizzle_pool_set_ping_time(drizzle_pool_st *pool, uint32_t seconds)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  __atomic_store_n(&pool->ping_time, seconds, __ATOMIC_RELAXED);
+}
+
+void drizzle_pool_set_reset(drizzle_pool_st *pool, bool reset)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  __atomic_store_n(&pool->reset, reset, __ATOMIC_RELAXED);
+}
+
+drizzle_st *drizzle_pool_checkout(drizzle_pool_st *pool,
+                                  drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused;
+  }
+
+  if (pool == NULL)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  while (1)
+  {
+    uint32_t released= __atomic_load_n(&pool->maintain_released,
+                                       __ATOMIC_ACQUIRE);
+
+    /* The lowest slots are reused first, so connections in the higher ones
+       go idle and are closed when traffic drops. */
+    for (uint32_t x= 0; x < pool->max; x++)
+    {
+      drizzle_pool_slot_st *slot= &pool->slot_list[x];
+      if (_pool_claim(slot, DRIZZLE_POOL_SLOT_IDLE, DRIZZLE_POOL_SLOT_BUSY))
+      {
+        uint32_t idle= __atomic_sub_fetch(&pool->idle_count, 1, __ATOMIC_RELAXED);
+        if (idle < __atomic_load_n(&pool->spare, __ATOMIC_RELAXED))
+        {
+          _pool_wake(pool);
+        }
+
+        *ret_ptr= DRIZZLE_RETURN_OK;
+        return slot->con;
+      }
+    }
+
+    /* No spare connection left, so open one here rather than wait. */
+    for (uint32_t x= 0; x < pool->max; x++)
+    {
+      drizzle_pool_slot_st *slot= &pool->slot_list[x];
+      if (_pool_claim(slot, DRIZZLE_POOL_SLOT_EMPTY, DRIZZLE_POOL_SLOT_CONNECTING))
+      {
+        *ret_ptr= _pool_connect(pool, slot);
+        if (*ret_ptr != DRIZZLE_RETURN_OK)
+        {
+          __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_EMPTY,
+                           __ATOMIC_RELEASE);
+          return NULL;
+        }
+
+        __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_BUSY,
+                         __ATOMIC_RELEASE);
+        _pool_wake(pool);
+        return slot->con;
+      }
+    }
+
+    /* A slot pinged or being connected by the maintenance thread, or
+       given back behind the scans above, is not taken for good. */
+    bool held= __atomic_load_n(&pool->maintain_held, __ATOMIC_ACQUIRE) > 0;
+    if (!held && __atomic_load_n(&pool->maintain_released, __ATOMIC_ACQUIRE) ==
+                 released)
+    {
+      break;
+    }
+    if (held)
+    {
+      struct timespec wait= { 0, 1000000 };
+      nanosleep(&wait, NULL);
+    }
+  }
+
+  *ret_ptr= DRIZZLE_RETURN_POOL_EXHAUSTED;
+  return NULL;
+}
+
+drizzle_return_t drizzle_pool_checkin(drizzle_pool_st *pool, drizzle_st *con)
+{
+  if (pool == NULL || con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  drizzle_pool_slot_st *slot= NULL;
+  for (uint32_t x= 0; x < pool->max; x++)
+  {
+    if (__atomic_load_n(&pool->slot_list[x].con, __ATOMIC_RELAXED) == con &&
+        __atomic_load_n(&pool->slot_list[x].state, __ATOMIC_ACQUIRE) ==
+        DRIZZLE_POOL_SLOT_BUSY)
+    {
+      slot= &pool->slot_list[x];
+      break;
+    }
+  }
+
+  if (slot == NULL)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "connection not checked out of this pool");
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  /* A connection in the middle of a command, or with results left to read,
+     can not be handed to anybody else. */
+  bool usable= con->fd != INVALID_SOCKET && con->state.ready &&
+               con->has_state();
+  for (drizzle_result_st *result= con->result_list;
+       usable && result != NULL; result= result->next)
+  {
+    if (!result->complete || result->more_results)
+    {
+      usable= false;
+    }
+  }
+
+  /* Cached statements own results in the result list, a reset discards
+     them on the server as well */
+  bool reset= __atomic_load_n(&pool->reset, __ATOMIC_RELAXED);
+  drizzle_stmt_cache_clear(con, usable && !reset);
+  drizzle_result_free_all(con);
+
+  /* Idle connections only hold on to their initial buffer */
+  if (usable && drizzle_buffer_shrink(con) != DRIZZLE_RETURN_OK)
+  {
+    usable= false;
+  }
+
+  if (usable && reset)
+  {
+    usable= _pool_reset(pool, con) == DRIZZLE_RETURN_OK;
+  }
+
+  if (!usable)
+  {
+    _pool_drop(pool, slot, false);
+    _pool_wake(pool);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  int64_t now= _pool_now();
+  __atomic_store_n(&slot->idle_since, now, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->checked, now, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&pool->idle_count, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_IDLE,
+                   __ATOMIC_RELEASE);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+uint32_t drizzle_pool_size(const drizzle_pool_st *pool)
+{
+  if (pool == NULL)
+  {
+    return 0;
+  }
+
+  return __atomic_load_n(&pool->open_count, __ATOMIC_RELAXED);
+}
+
+uint32_t drizzle_pool_idle(const drizzle_pool_st *pool)
+{
+  if (pool == NULL)
+  {
+    return 0;
+  }
+
+  return __atomic_load_n(&pool->idle_count, __ATOMIC_RELAXED);
+}
+
+/*
+ * Private definitions
+ */
+
+static void *_pool_maintain(void *context)
+{
+  drizzle_pool_st *pool= (drizzle_pool_st *)context;
+
+  pthread_mutex_lock(&pool->lock);
+  while (!pool->shutdown)
+  {
+    pthread_mutex_unlock(&pool->lock);
+    _pool_maintain_round(pool);
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->shutdown)
+    {
+      break;
+    }
+
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec+= DRIZZLE_POOL_MAINTAIN_INTERVAL;
+    pthread_cond_timedwait(&pool->cond, &pool->lock, &until);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+static void _pool_maintain_round(drizzle_pool_st *pool)
+{
+  int64_t now= _pool_now();
+  uint32_t idle_time= __atomic_load_n(&pool->idle_time, __ATOMIC_RELAXED);
+  uint32_t ping_time= __atomic_load_n(&pool->ping_time, __ATOMIC_RELAXED);
+
+  /* Close connections idle for too long, starting with the highest slots,
+     and ping the ones which were not used for a while. */
+  for (uint32_t x= pool->max; x > 0; x--)
+  {
+    drizzle_pool_slot_st *slot= &pool->slot_list[x - 1];
+    if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != DRIZZLE_POOL_SLOT_IDLE)
+    {
+      continue;
+    }
+
+    int64_t idle_since= __atomic_load_n(&slot->idle_since, __ATOMIC_RELAXED);
+    bool expired= idle_time > 0 && now - idle_since >= idle_time &&
+                  __atomic_load_n(&pool->open_count, __ATOMIC_RELAXED) > pool->min;
+    int64_t checked= __atomic_load_n(&slot->checked, __ATOMIC_RELAXED);
+    bool ping= !expired && ping_time > 0 && now - checked >= ping_time;
+    if (!(expired || ping) ||
+        !_pool_claim(slot, DRIZZLE_POOL_SLOT_IDLE, DRIZZLE_POOL_SLOT_BUSY))
+    {
+      continue;
+    }
+    _pool_maintain_hold(pool);
+    __atomic_sub_fetch(&pool->idle_count, 1, __ATOMIC_RELAXED);
+
+    if (ping)
+    {
+      drizzle_return_t ret;
+      drizzle_result_st *result= drizzle_ping(slot->con, &ret);
+      drizzle_result_free(result);
+      if (ret == DRIZZLE_RETURN_OK)
+      {
+        __atomic_store_n(&slot->checked, now, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pool->idle_count, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_IDLE,
+                         __ATOMIC_RELEASE);
+        _pool_maintain_release(pool);
+        continue;
+      }
+    }
+
+    _pool_drop(pool, slot, expired);
+    _pool_maintain_release(pool);
+  }
+
+  /* Open connections until the pool has its minimum size and enough spare
+     connections for the next burst of checkouts. */
+  for (uint32_t x= 0; x < pool->max; x++)
+  {
+    uint32_t open_count= __atomic_load_n(&pool->open_count, __ATOMIC_RELAXED);
+    uint32_t idle_count= __atomic_load_n(&pool->idle_count, __ATOMIC_RELAXED);
+    if (open_count >= pool->max ||
+        (open_count >= pool->min &&
+         idle_count >= __atomic_load_n(&pool->spare, __ATOMIC_RELAXED)))
+    {
+      break;
+    }
+
+    drizzle_pool_slot_st *slot= &pool->slot_list[x];
+    if (!_pool_claim(slot, DRIZZLE_POOL_SLOT_EMPTY, DRIZZLE_POOL_SLOT_CONNECTING))
+    {
+      continue;
+    }
+    _pool_maintain_hold(pool);
+
+    if (_pool_connect(pool, slot) != DRIZZLE_RETURN_OK)
+    {
+      /* The server may be down, try again in the next round. */
+      __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_EMPTY,
+                       __ATOMIC_RELEASE);
+      _pool_maintain_release(pool);
+      break;
+    }
+
+    int64_t connected= _pool_now();
+    __atomic_store_n(&slot->idle_since, connected, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->checked, connected, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->idle_count, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_IDLE,
+                     __ATOMIC_RELEASE);
+    _pool_maintain_release(pool);
+  }
+}
+
+static drizzle_return_t _pool_connect(drizzle_pool_st *pool,
+                                      drizzle_pool_slot_st *slot)
+{
+  drizzle_return_t ret;
+
+  drizzle_st *con= drizzle_clone(NULL, pool->con);
+  if (con == NULL)
+  {
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  /* Pooled connections are used by whoever checks them out, so they are
+     always connected in blocking mode. */
+  con->options.non_blocking= false;
+
+  ret= drizzle_connect(con);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    drizzle_free(con);
+    return ret;
+  }
+
+  __atomic_store_n(&slot->con, con, __ATOMIC_RELAXED);
+
+  __atomic_add_fetch(&pool->open_count, 1, __ATOMIC_RELAXED);
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static void _pool_drop(drizzle_pool_st *pool, drizzle_pool_slot_st *slot,
+                       bool quit)
+{
+  if (quit)
+  {
+    (void)drizzle_quit(slot->con);
+  }
+  else
+  {
+    drizzle_free(slot->con);
+  }
+  __atomic_store_n(&slot->con, (drizzle_st *)NULL, __ATOMIC_RELAXED);
+
+  __atomic_sub_fetch(&pool->open_count, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->state, (uint32_t)DRIZZLE_POOL_SLOT_EMPTY,
+                   __ATOMIC_RELEASE);
+}
+
+static drizzle_return_t _pool_reset(drizzle_pool_st *pool, drizzle_st *con)
+{
+  drizzle_command_t command= __atomic_load_n(&pool->reset_command,
+                                             __ATOMIC_RELAXED);
+  drizzle_result_st *result;
+  drizzle_return_t ret;
+
+  result= drizzle_command_write(con, NULL, command, NULL, 0, 0, &ret);
+  if (ret == DRIZZLE_RETURN_ERROR_CODE &&
+      command == DRIZZLE_COMMAND_RESET_CONNECTION &&
+      drizzle_result_error_code(result) == DRIZZLE_POOL_UNKNOWN_COMMAND)
+  {
+    /* Older servers only clear the session when logging in again. */
+    drizzle_result_free(result);
+    __atomic_store_n(&pool->reset_command, DRIZZLE_COMMAND_CHANGE_USER,
+                     __ATOMIC_RELAXED);
+    result= drizzle_command_write(con, NULL, DRIZZLE_COMMAND_CHANGE_USER,
+                                  NULL, 0, 0, &ret);
+  }
+  drizzle_result_free(result);
+
+  return ret;
+}
+
+static bool _pool_claim(drizzle_pool_slot_st *slot, uint32_t from, uint32_t to)
+{
+  if (__atomic_load_n(&slot->state, __ATOMIC_RELAXED) != from)
+  {
+    return false;
+  }
+
+  return __atomic_compare_exchange_n(&slot->state, &from, to, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static void _pool_maintain_hold(drizzle_pool_st *pool)
+{
+  __atomic_add_fetch(&pool->maintain_held, 1, __ATOMIC_RELEASE);
+}
+
+static void _pool_maintain_release(drizzle_pool_st *pool)
+{
+  /* Counted before the slot is no longer held, so a checkout which saw
+     neither still sees the release */
+  __atomic_add_fetch(&pool->maintain_released, 1, __ATOMIC_RELEASE);
+  __atomic_sub_fetch(&pool->maintain_held, 1, __ATOMIC_RELEASE);
+}
+
+static void _pool_wake(drizzle_pool_st *pool)
+{
+  /* Signalling without the mutex may lose a wake up, which only delays
+     the maintenance thread until its next round. */
+  pthread_cond_signal(&pool->cond);
+}
+
+static int64_t _pool_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec;
+}
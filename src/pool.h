@@ -0,0 +1,116 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Connection pool declarations
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+/**
+ * @addtogroup drizzle_pool_private Private Connection Pool
+ *
+ * A pool keeps its connections in a fixed array of slots. The state of a
+ * slot is only ever changed with a compare-and-swap, so checking a
+ * connection out or in needs no lock; the mutex of the pool only puts the
+ * maintenance thread to sleep between its rounds.
+ * @{
+ */
+
+enum drizzle_pool_slot_state_t
+{
+  DRIZZLE_POOL_SLOT_EMPTY,       /* no connection */
+  DRIZZLE_POOL_SLOT_CONNECTING,  /* claimed for a new connection */
+  DRIZZLE_POOL_SLOT_IDLE,        /* connected, ready to be checked out */
+  DRIZZLE_POOL_SLOT_BUSY         /* checked out or being maintained */
+};
+
+struct drizzle_pool_slot_st
+{
+  uint32_t state;                /* drizzle_pool_slot_state_t, atomic */
+  drizzle_st *con;
+  int64_t idle_since;            /* seconds, atomic */
+  int64_t checked;               /* seconds of the last health check, atomic */
+  drizzle_pool_slot_st() :
+    state(DRIZZLE_POOL_SLOT_EMPTY),
+    con(NULL),
+    idle_since(0),
+    checked(0)
+  { }
+};
+
+struct drizzle_pool_st
+{
+  drizzle_st *con;               /* cloned for every new connection */
+  drizzle_pool_slot_st *slot_list;
+  uint32_t min;
+  uint32_t max;
+  uint32_t spare;                /* settings, atomic */
+  uint32_t idle_time;
+  uint32_t ping_time;
+  bool reset;
+  drizzle_command_t reset_command;
+  uint32_t open_count;           /* atomic */
+  uint32_t idle_count;           /* atomic */
+  uint32_t maintain_held;        /* slots claimed by the maintenance thread, atomic */
+  uint32_t maintain_released;    /* slots it gave back so far, atomic */
+  bool shutdown;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+  drizzle_pool_st() :
+    con(NULL),
+    slot_list(NULL),
+    min(0),
+    max(0),
+    spare(DRIZZLE_DEFAULT_POOL_SPARE),
+    idle_time(DRIZZLE_DEFAULT_POOL_IDLE_TIME),
+    ping_time(DRIZZLE_DEFAULT_POOL_PING_TIME),
+    reset(true),
+    reset_command(DRIZZLE_COMMAND_RESET_CONNECTION),
+    open_count(0),
+    idle_count(0),
+    maintain_held(0),
+    maintain_released(0),
+    shutdown(false)
+  { }
+};
+
+/** @} */
@@ -207,3 +207,76 @@ bool drizzle_mysql_password_hash(char *to, const char *from, const size_t from_s
 
   return drizzle_hex_string(to, hash_tmp2, SHA1_DIGEST_LENGTH);
 }
+
+/*
+ * Internal state functions.
+ */
+
+drizzle_return_t drizzle_state_infile_write(drizzle_st *con)
+{
+  drizzle_return_t ret;
+  size_t buffer_size;
+  size_t read_size= 0;
+
+  if (con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  __LOG_LOCATION__
+
+  /* The data is sent one packet at a time, so no more than a packet of it
+     is ever held by the connection. */
+  buffer_size= con->buffer_allocation - 4;
+  if (buffer_size > DRIZZLE_MAX_PAYLOAD_SIZE)
+  {
+    buffer_size= DRIZZLE_MAX_PAYLOAD_SIZE;
+  }
+
+  if (con->infile_fn != NULL)
+  {
+    ret= con->infile_fn(con, con->infile_name, con->buffer + 4, buffer_size,
+                        &read_size, con->infile_context);
+    if (ret == DRIZZLE_RETURN_IO_WAIT)
+    {
+      return ret;
+    }
+
+    if (ret != DRIZZLE_RETURN_OK || read_size > buffer_size)
+    {
+      /* Ending the file early would load what was sent so far, closing the
+         connection makes the server abort the statement instead. */
+      drizzle_set_error(con, __FILE_LINE_FUNC__,
+                        "failed to read local file '%s'", con->infile_name);
+      drizzle_close(con);
+      return ret == DRIZZLE_RETURN_OK ? DRIZZLE_RETURN_INTERNAL_ERROR : ret;
+    }
+  }
+
+  drizzle_set_byte3(con->buffer, read_size);
+  con->buffer[3]= con->packet_number;
+  con->packet_number++;
+  con->buffer_ptr= con->buffer;
+  con->buffer_size= 4 + read_size;
+
+  /* Frames carry on with the sequence the server's request ended. */
+  if (con->compression != NULL)
+  {
+    con->compression->packet_number= con->buffer[3];
+  }
+
+  /* An empty packet ends the file, the result of the statement follows. */
+  if (read_size == 0)
+  {
+    delete[] con->infile_name;
+    con->infile_name= NULL;
+
+    con->pop_state();
+    con->push_state(drizzle_state_result_read);
+    con->push_state(drizzle_state_packet_read);
+  }
+
+  con->push_state(drizzle_state_write);
+
+  return DRIZZLE_RETURN_OK;
+}
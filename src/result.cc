@@ -92,7 +92,15 @@ void drizzle_result_free(drizzle_result_st *result)
 
   delete[] result->column_buffer;
 
-  if (result->options & DRIZZLE_RESULT_BUFFER_ROW)
+  if (result->arena != NULL)
+  {
+    /* Rows, field sizes and NULL bitmaps all live in the arena. */
+    free(result->null_bitmap_list);
+    free(result->row_list);
+    free(result->field_sizes_list);
+    drizzle_arena_free(result->arena);
+  }
+  else if (result->options & DRIZZLE_RESULT_BUFFER_ROW)
   {
     uint64_t x;
 
@@ -127,6 +135,21 @@ void drizzle_result_free(drizzle_result_st *result)
     delete[] result->field_buffer_sizes;
   }
   delete[] result->row;
+  delete[] result->view_row;
+  delete[] result->view_field_sizes;
+  delete[] result->view_field_offsets;
+  delete[] result->column_index;
+
+  if (result->column_values != NULL)
+  {
+    for (y= 0; y < result->column_count; y++)
+    {
+      free(result->column_values[y].values);
+      free(result->column_values[y].offsets);
+      free(result->column_values[y].validity);
+    }
+    delete[] result->column_values;
+  }
 
   if (result->con)
   {
@@ -260,6 +283,26 @@ uint64_t drizzle_result_row_count(drizzle_result_st *result)
   return result->row_count;
 }
 
+uint64_t drizzle_result_arena_size(drizzle_result_st *result)
+{
+  if (result == NULL || result->arena == NULL)
+  {
+    return 0;
+  }
+
+  return result->arena->allocated;
+}
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Read the fields of the row most recently started by drizzle_row_read()
+ * straight into the result arena and store it in the row list.
+ */
+static drizzle_return_t _result_buffer_arena_row(drizzle_result_st *result);
+
 /*
  * Client definitions
  */
@@ -296,6 +339,69 @@ drizzle_result_st *drizzle_result_read(drizzle_st *con,
   return con->result;
 }
 
+drizzle_result_st *drizzle_result_next(drizzle_result_st *result,
+                                       drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused;
+  }
+
+  if (result == NULL)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  drizzle_st *con= result->con;
+
+  if (!result->complete)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "result not read completely");
+    *ret_ptr= DRIZZLE_RETURN_NOT_READY;
+    return NULL;
+  }
+
+  if (!result->more_results)
+  {
+    *ret_ptr= DRIZZLE_RETURN_OK;
+    return NULL;
+  }
+
+  /* The packet numbers of the next result continue from this one. */
+  if (con->has_state())
+  {
+    con->result= drizzle_result_create(con);
+    if (con->result == NULL)
+    {
+      *ret_ptr= DRIZZLE_RETURN_MEMORY;
+      return NULL;
+    }
+
+    con->push_state(drizzle_state_result_read);
+    con->push_state(drizzle_state_packet_read);
+  }
+
+  *ret_ptr= drizzle_state_loop(con);
+  if (*ret_ptr != DRIZZLE_RETURN_IO_WAIT)
+  {
+    result->more_results= false;
+  }
+
+  return con->result;
+}
+
+bool drizzle_result_more_results(drizzle_result_st *result)
+{
+  if (result == NULL)
+  {
+    return false;
+  }
+
+  return result->more_results;
+}
+
 drizzle_return_t drizzle_result_buffer(drizzle_result_st *result)
 {
   if (result == NULL)
@@ -321,15 +427,40 @@ drizzle_return_t drizzle_result_buffer(drizzle_result_st *result)
     return DRIZZLE_RETURN_OK;
   }
 
+  if (result->con->options.result_arena && result->arena == NULL)
+  {
+    result->arena= drizzle_arena_create();
+    if (result->arena == NULL)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+  }
+
   while (1)
   {
     uint16_t x;
-    row= drizzle_row_buffer(result, &ret);
-    if (ret != DRIZZLE_RETURN_OK)
-      return ret;
+    if (result->arena != NULL)
+    {
+      /* The fields are read into the arena once the row list has room */
+      row= NULL;
+      if (drizzle_row_read(result, &ret) == 0 || ret != DRIZZLE_RETURN_OK)
+      {
+        if (ret != DRIZZLE_RETURN_OK)
+          return ret;
 
-    if (row == NULL)
-      break;
+        break;
+      }
+    }
+    else
+    {
+      row= drizzle_row_buffer(result, &ret);
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+
+      if (row == NULL)
+        break;
+    }
 
     if (result->row_list_size < result->row_count)
     {
@@ -368,6 +499,15 @@ drizzle_return_t drizzle_result_buffer(drizzle_result_st *result)
       result->row_list_size= new_row_list_size;
     }
 
+    if (result->arena != NULL)
+    {
+      ret= _result_buffer_arena_row(result);
+      if (ret != DRIZZLE_RETURN_OK)
+        return ret;
+
+      continue;
+    }
+
     if (result->binary_rows)
     {
       result->null_bitmap_list[result->row_current - 1]= result->null_bitmap;
@@ -399,6 +539,95 @@ size_t drizzle_result_row_size(drizzle_result_st *result)
   return result->con->packet_size;
 }
 
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _result_buffer_arena_row(drizzle_result_st *result)
+{
+  uint64_t index= result->row_current - 1;
+  drizzle_return_t ret;
+  drizzle_field_t field;
+  uint64_t offset;
+  uint64_t total;
+  size_t size;
+  uint16_t current_field;
+
+  drizzle_row_t arena_row= (drizzle_row_t)drizzle_arena_alloc(result->arena,
+    sizeof(drizzle_field_t) * result->column_count);
+  size_t *field_sizes= (size_t *)drizzle_arena_alloc(result->arena,
+    sizeof(size_t) * result->column_count);
+  if (arena_row == NULL || field_sizes == NULL)
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  memset(arena_row, 0, sizeof(drizzle_field_t) * result->column_count);
+  memset(field_sizes, 0, sizeof(size_t) * result->column_count);
+
+  /* Fields arrive in pieces no larger than the connection buffer, each piece
+     is copied once, to its place in the arena */
+  while (1)
+  {
+    field= drizzle_field_read(result, &offset, &size, &total, &ret);
+    if (ret == DRIZZLE_RETURN_ROW_END)
+      break;
+
+    if (ret != DRIZZLE_RETURN_OK)
+      return ret;
+
+#if SIZE_MAX < UINT64_MAX
+    if (total >= SIZE_MAX)
+    {
+      drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Field is larger than memory.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+#endif
+
+    /* The current field is only counted once all of it was read */
+    if ((result->field_offset + result->field_size) != result->field_total)
+    {
+      current_field= result->field_current;
+    }
+    else
+    {
+      current_field= result->field_current - 1;
+    }
+
+    if (field == NULL || total == 0)
+    {
+      continue;
+    }
+
+    if (offset == 0)
+    {
+      arena_row[current_field]= (drizzle_field_t)drizzle_arena_alloc(
+        result->arena, (size_t)total + 1);
+      if (arena_row[current_field] == NULL)
+      {
+        drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+        return DRIZZLE_RETURN_MEMORY;
+      }
+      arena_row[current_field][total]= 0;
+      field_sizes[current_field]= (size_t)total;
+    }
+
+    memcpy(arena_row[current_field] + offset, field, size);
+  }
+
+  if (result->binary_rows)
+  {
+    /* Read into the arena by drizzle_state_binary_null_read() */
+    result->null_bitmap_list[index]= result->null_bitmap;
+  }
+
+  result->field_sizes= field_sizes;
+  result->field_sizes_list[index]= field_sizes;
+  result->row_list[index]= arena_row;
+
+  return DRIZZLE_RETURN_OK;
+}
+
 /*
  * Internal state functions.
  */
@@ -444,6 +673,7 @@ drizzle_return_t drizzle_state_result_read(drizzle_st *con)
       con->buffer_ptr+= 4;
       con->buffer_size-= 5;
       con->packet_size-= 5;
+      drizzle_result_set_complete(con->result, con->status);
     }
     if (con->packet_size > 0)
     {
@@ -462,10 +692,38 @@ drizzle_return_t drizzle_state_result_read(drizzle_st *con)
     con->buffer_ptr+= 5;
     con->buffer_size-= 5;
     con->packet_size-= 5;
+    drizzle_result_set_complete(con->result, con->status);
     ret= DRIZZLE_RETURN_OK;
   }
+  else if (con->buffer_ptr[0] == 251 &&
+           con->command == DRIZZLE_COMMAND_QUERY)
+  {
+    /* LOAD DATA LOCAL INFILE, the server waits for the file to be sent
+       before it answers with the result. */
+    delete[] con->infile_name;
+    con->infile_name= new (std::nothrow) char[con->packet_size];
+    if (con->infile_name == NULL)
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__, "Failed to allocate.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    memcpy(con->infile_name, con->buffer_ptr + 1, con->packet_size - 1);
+    con->infile_name[con->packet_size - 1]= 0;
+    con->buffer_ptr+= con->packet_size;
+    con->buffer_size-= con->packet_size;
+    con->packet_size= 0;
+
+    con->pop_state();
+    con->push_state(drizzle_state_infile_write);
+    return DRIZZLE_RETURN_OK;
+  }
   else if (drizzle_check_unpack_error(con))
   {
+    /* An error ends a multi-result response. */
+    con->status= (drizzle_status_t)((int)con->status &
+                                    ~(int)DRIZZLE_CON_STATUS_MORE_RESULTS_EXISTS);
+    drizzle_result_set_complete(con->result, con->status);
+    con->result->error_code= con->error_code;
     memcpy(con->result->sqlstate, con->sqlstate,
            DRIZZLE_MAX_SQLSTATE_SIZE);
     con->result->sqlstate[DRIZZLE_MAX_SQLSTATE_SIZE]= 0;
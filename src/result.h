@@ -38,6 +38,28 @@
 
 #pragma once
 
+/**
+ * @ingroup drizzle_result
+ * Values of one column of a result buffered with
+ * drizzle_result_buffer_columnar().
+ */
+struct drizzle_column_values_st
+{
+  char *values;
+  size_t values_size;
+  size_t values_allocation;
+  uint64_t *offsets;
+  uint8_t *validity;
+
+  drizzle_column_values_st() :
+    values(NULL),
+    values_size(0),
+    values_allocation(0),
+    offsets(NULL),
+    validity(NULL)
+  { }
+};
+
 /**
  * @ingroup drizzle_result
  */
@@ -85,6 +107,17 @@ struct drizzle_result_st
   uint16_t null_bitmap_length;
   uint16_t null_bitcount;
   bool binary_rows;
+  drizzle_arena_st *arena;
+  drizzle_row_t view_row;
+  size_t *view_field_sizes;
+  size_t *view_field_offsets;
+  drizzle_column_values_st *column_values;
+  uint64_t column_values_allocation;
+  bool complete;                  /* final OK, EOF or error packet read */
+  bool more_results;              /* server announced another result */
+  uint16_t *column_index;         /* open addressing table of column names,
+                                     slots hold the column number + 1 */
+  uint32_t column_index_size;
 
   drizzle_result_st() :
     con(NULL),
@@ -120,7 +153,17 @@ struct drizzle_result_st
     null_bitmap(NULL),
     null_bitmap_length(0),
     null_bitcount(0),
-    binary_rows(false)
+    binary_rows(false),
+    arena(NULL),
+    view_row(NULL),
+    view_field_sizes(NULL),
+    view_field_offsets(NULL),
+    column_values(NULL),
+    column_values_allocation(0),
+    complete(false),
+    more_results(false),
+    column_index(NULL),
+    column_index_size(0)
   {
     info[0]= '\0';
     sqlstate[0]= '\0';
@@ -146,3 +189,14 @@ struct drizzle_result_st
     return false;
   }
 };
+
+/**
+ * Mark a result as read up to its final OK, EOF or error packet, and note
+ * whether the server announced another result after it.
+ */
+static inline void drizzle_result_set_complete(drizzle_result_st *result,
+                                               drizzle_status_t status)
+{
+  result->complete= true;
+  result->more_results= (status & DRIZZLE_CON_STATUS_MORE_RESULTS_EXISTS) != 0;
+}
@@ -44,6 +44,32 @@
 #include "config.h"
 #include "src/common.h"
 
+/*
+ * Private declarations
+ */
+
+/**
+ * Decode the fields of a text protocol row packet in place with
+ * drizzle_scan_row(). Fields point into the packet, NULL fields are set to
+ * NULL.
+ */
+static drizzle_return_t _row_scan(drizzle_result_st *result,
+                                  unsigned char *ptr, size_t size,
+                                  drizzle_row_t fields, size_t *sizes);
+
+/**
+ * Read the fields of the current row through drizzle_field_buffer(), used
+ * when the row packet is not contiguous in the connection buffer.
+ */
+static drizzle_return_t _row_view_copy(drizzle_result_st *result);
+
+/**
+ * Read the start of the next row. Text protocol rows larger than the
+ * initial buffer are read as their fields are, unless whole is set.
+ */
+static uint64_t _row_read(drizzle_result_st *result, bool whole,
+                          drizzle_return_t *ret_ptr);
+
 /*
  * Client definitions
  */
@@ -62,23 +88,8 @@ uint64_t drizzle_row_read(drizzle_result_st *result, drizzle_return_t *ret_ptr)
     return 0;
   }
 
-  if ((result->column_current != result->column_count) && (!(result->options & DRIZZLE_RESULT_BUFFER_COLUMN)))
-  {
-    drizzle_set_error(result->con, __FILE_LINE_FUNC__,
-                      "cannot retrieve rows until all columns are retrieved");
-    *ret_ptr= DRIZZLE_RETURN_NOT_READY;
-    return 0;
-  }
-
-  if (result->has_state())
-  {
-    result->push_state(drizzle_state_row_read);
-    result->push_state(drizzle_state_packet_read);
-  }
-
-  *ret_ptr= drizzle_state_loop(result->con);
-
-  return result->row_current;
+  /* Binary rows are decoded from the whole packet */
+  return _row_read(result, result->binary_rows, ret_ptr);
 }
 
 drizzle_row_t drizzle_row_buffer(drizzle_result_st *result,
@@ -157,6 +168,198 @@ drizzle_row_t drizzle_row_buffer(drizzle_result_st *result,
   return row;
 }
 
+drizzle_row_t drizzle_row_view(drizzle_result_st *result, size_t **field_sizes,
+                               drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  if (result == NULL)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  if (result->binary_rows)
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__,
+                      "row views are not supported for binary results");
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  if (drizzle_row_read(result, ret_ptr) == 0 || *ret_ptr != DRIZZLE_RETURN_OK)
+  {
+    return NULL;
+  }
+
+  *ret_ptr= drizzle_scan_create(result);
+  if (*ret_ptr != DRIZZLE_RETURN_OK)
+  {
+    return NULL;
+  }
+
+  if (result->con->buffer_size >= result->con->packet_size)
+  {
+    *ret_ptr= _row_scan(result, result->con->buffer_ptr,
+                        result->con->packet_size, result->view_row,
+                        result->view_field_sizes);
+    if (*ret_ptr == DRIZZLE_RETURN_OK)
+    {
+      drizzle_scan_row_consume(result, result->con->packet_size);
+    }
+  }
+  else
+  {
+    *ret_ptr= _row_view_copy(result);
+  }
+
+  if (*ret_ptr != DRIZZLE_RETURN_OK)
+  {
+    return NULL;
+  }
+
+  if (field_sizes != NULL)
+  {
+    *field_sizes= result->view_field_sizes;
+  }
+
+  return result->view_row;
+}
+
+uint64_t drizzle_row_read_many(drizzle_result_st *result, uint64_t max_rows,
+                               const char **data, size_t *offsets,
+                               size_t *lengths, bool *nulls,
+                               drizzle_return_t *ret_ptr)
+{
+  drizzle_return_t unused_ret;
+  if (ret_ptr == NULL)
+  {
+    ret_ptr= &unused_ret;
+  }
+
+  if (result == NULL || max_rows == 0 || data == NULL || offsets == NULL ||
+      lengths == NULL)
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return 0;
+  }
+
+  if (result->binary_rows)
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__,
+                      "batch row reads are not supported for binary results");
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return 0;
+  }
+
+  /* The first row goes through the state machine, which takes care of
+     reading from the socket as well as EOF and error packets. */
+  if (_row_read(result, true, ret_ptr) == 0 || *ret_ptr != DRIZZLE_RETURN_OK)
+  {
+    return 0;
+  }
+
+  /* The row is decoded in place, so the rest of a packet which spans a
+     buffer refill is read first. The buffer grows to fit it if needed. */
+  drizzle_st *con= result->con;
+  while (con->buffer_size < con->packet_size)
+  {
+    con->push_state(drizzle_state_read);
+    *ret_ptr= drizzle_state_loop(con);
+    if (*ret_ptr != DRIZZLE_RETURN_OK)
+    {
+      return 0;
+    }
+  }
+
+  unsigned char *base= con->buffer_ptr;
+  size_t packet_size= con->packet_size;
+  uint64_t rows= 0;
+  uint16_t x;
+
+  *data= (const char *)base;
+
+  while (1)
+  {
+    size_t *row_offsets= offsets + (rows * result->column_count);
+    size_t *row_lengths= lengths + (rows * result->column_count);
+
+    if (drizzle_scan_row(con->buffer_ptr, packet_size, result->column_count,
+                         row_offsets, row_lengths) != DRIZZLE_RETURN_OK)
+    {
+      drizzle_set_error(con, __FILE_LINE_FUNC__, "malformed row packet");
+      *ret_ptr= DRIZZLE_RETURN_UNEXPECTED_DATA;
+      return rows;
+    }
+
+    size_t delta= (size_t)(con->buffer_ptr - base);
+    for (x= 0; x < result->column_count; x++)
+    {
+      bool is_null= (row_offsets[x] == DRIZZLE_SCAN_NULL);
+      if (is_null)
+      {
+        row_offsets[x]= 0;
+      }
+      else
+      {
+        row_offsets[x]+= delta;
+        drizzle_scan_column_size(result, x, row_lengths[x]);
+      }
+
+      if (nulls != NULL)
+      {
+        nulls[(rows * result->column_count) + x]= is_null;
+      }
+    }
+    drizzle_scan_row_consume(result, packet_size);
+
+    rows++;
+    if (rows == max_rows)
+    {
+      break;
+    }
+
+    /* Decode the following rows straight from the buffer for as long as
+       complete packets are available. EOF and error packets, partial packets
+       and anything unexpected are left for the next drizzle_row_read(). */
+    if (con->buffer_size < 4)
+    {
+      break;
+    }
+
+    packet_size= drizzle_get_byte3(con->buffer_ptr);
+    if (packet_size == 0 || packet_size == DRIZZLE_MAX_PAYLOAD_SIZE ||
+        con->buffer_size < (packet_size + 4) ||
+        con->packet_number != con->buffer_ptr[3])
+    {
+      break;
+    }
+
+    if (con->buffer_ptr[4] == 255 ||
+        (packet_size == 5 && con->buffer_ptr[4] == 254))
+    {
+      break;
+    }
+
+    con->packet_number++;
+    con->buffer_ptr+= 4;
+    con->buffer_size-= 4;
+    con->packet_size= (uint32_t)packet_size;
+
+    result->row_count++;
+    result->row_current++;
+    result->field_current= 0;
+    result->field_current_read= 0;
+  }
+
+  *ret_ptr= DRIZZLE_RETURN_OK;
+  return rows;
+}
+
 void drizzle_row_free(drizzle_result_st *result, drizzle_row_t row)
 {
   if (result == NULL)
@@ -164,6 +367,12 @@ void drizzle_row_free(drizzle_result_st *result, drizzle_row_t row)
     return;
   }
 
+  /* Rows read into an arena are released with the result. */
+  if (result->arena != NULL)
+  {
+    return;
+  }
+
   delete[] row;
   if (!(result->options & DRIZZLE_RESULT_BUFFER_ROW))
   {
@@ -260,6 +469,93 @@ uint64_t drizzle_row_current(drizzle_result_st *result)
   return result->row_current;
 }
 
+/*
+ * Private definitions
+ */
+
+static drizzle_return_t _row_scan(drizzle_result_st *result,
+                                  unsigned char *ptr, size_t size,
+                                  drizzle_row_t fields, size_t *sizes)
+{
+  uint16_t x;
+
+  if (drizzle_scan_row(ptr, size, result->column_count,
+                       result->view_field_offsets, sizes) != DRIZZLE_RETURN_OK)
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__, "malformed row packet");
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  for (x= 0; x < result->column_count; x++)
+  {
+    if (result->view_field_offsets[x] == DRIZZLE_SCAN_NULL)
+    {
+      fields[x]= NULL;
+    }
+    else
+    {
+      fields[x]= (drizzle_field_t)(ptr + result->view_field_offsets[x]);
+      drizzle_scan_column_size(result, x, sizes[x]);
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_return_t _row_view_copy(drizzle_result_st *result)
+{
+  drizzle_return_t ret;
+  drizzle_field_t field;
+  size_t total;
+
+  memset(result->view_row, 0, sizeof(drizzle_field_t) * result->column_count);
+  memset(result->view_field_sizes, 0, sizeof(size_t) * result->column_count);
+
+  while (1)
+  {
+    field= drizzle_field_buffer(result, &total, &ret);
+    if (ret == DRIZZLE_RETURN_ROW_END)
+      break;
+
+    if (ret != DRIZZLE_RETURN_OK)
+      return ret;
+
+    result->view_row[result->field_current - 1]= field;
+    result->view_field_sizes[result->field_current - 1]= total;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static uint64_t _row_read(drizzle_result_st *result, bool whole,
+                          drizzle_return_t *ret_ptr)
+{
+  if ((result->column_current != result->column_count) && (!(result->options & DRIZZLE_RESULT_BUFFER_COLUMN)))
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__,
+                      "cannot retrieve rows until all columns are retrieved");
+    *ret_ptr= DRIZZLE_RETURN_NOT_READY;
+    return 0;
+  }
+
+  if (result->has_state())
+  {
+    result->push_state(drizzle_state_row_read);
+    if (whole)
+    {
+      result->push_state(drizzle_state_packet_read);
+    }
+    else
+    {
+      result->push_state(drizzle_state_packet_header_read);
+    }
+  }
+
+  *ret_ptr= drizzle_state_loop(result->con);
+
+  return result->row_current;
+}
+
 /*
  * Internal state functions.
  */
@@ -288,6 +584,7 @@ drizzle_return_t drizzle_state_row_read(drizzle_st *con)
     con->status= (drizzle_status_t)drizzle_get_byte2(con->buffer_ptr + 3);
     con->buffer_ptr+= 5;
     con->buffer_size-= 5;
+    drizzle_result_set_complete(con->result, con->status);
   }
   else if (con->buffer_ptr[0] == 255)
   {
@@ -0,0 +1,175 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Row scanner definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+/*
+ * Common definitions
+ */
+
+drizzle_return_t drizzle_scan_row(const unsigned char *packet, size_t size,
+                                  uint16_t column_count, size_t *offsets,
+                                  size_t *lengths)
+{
+  const unsigned char *ptr= packet;
+  const unsigned char *end= packet + size;
+  uint64_t length;
+  size_t bytes;
+  uint16_t x= 0;
+
+  while (x < column_count)
+  {
+    /* A field with a one byte length prefix spans at most 251 bytes, so as
+       long as that much of the packet is left a run of short fields can be
+       walked without any bounds checks. */
+    while (x < column_count && (end - ptr) > 251 && ptr[0] < 251)
+    {
+      offsets[x]= (size_t)(ptr - packet) + 1;
+      lengths[x]= ptr[0];
+      ptr+= 1 + ptr[0];
+      x++;
+    }
+
+    if (x == column_count)
+    {
+      break;
+    }
+
+    if (ptr >= end)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+
+    if (ptr[0] < 251)
+    {
+      length= ptr[0];
+      bytes= 1;
+    }
+    else if (ptr[0] == 251)
+    {
+      offsets[x]= DRIZZLE_SCAN_NULL;
+      lengths[x]= 0;
+      ptr++;
+      x++;
+      continue;
+    }
+    else if (ptr[0] == 252 && (end - ptr) > 2)
+    {
+      length= drizzle_get_byte2(ptr + 1);
+      bytes= 3;
+    }
+    else if (ptr[0] == 253 && (end - ptr) > 3)
+    {
+      length= drizzle_get_byte3(ptr + 1);
+      bytes= 4;
+    }
+    else if (ptr[0] == 254 && (end - ptr) > 8)
+    {
+      length= drizzle_get_byte8(ptr + 1);
+      bytes= 9;
+    }
+    else
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+
+    if (length > (uint64_t)(end - ptr) - bytes)
+    {
+      return DRIZZLE_RETURN_UNEXPECTED_DATA;
+    }
+
+    offsets[x]= (size_t)(ptr - packet) + bytes;
+    lengths[x]= (size_t)length;
+    ptr+= bytes + length;
+    x++;
+  }
+
+  if (ptr != end)
+  {
+    return DRIZZLE_RETURN_UNEXPECTED_DATA;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_scan_create(drizzle_result_st *result)
+{
+  if (result->view_row != NULL)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  result->view_row= new (std::nothrow) drizzle_field_t[result->column_count];
+  result->view_field_sizes= new (std::nothrow) size_t[result->column_count];
+  result->view_field_offsets= new (std::nothrow) size_t[result->column_count];
+  if (result->view_row == NULL || result->view_field_sizes == NULL ||
+      result->view_field_offsets == NULL)
+  {
+    delete[] result->view_row;
+    delete[] result->view_field_sizes;
+    delete[] result->view_field_offsets;
+    result->view_row= NULL;
+    result->view_field_sizes= NULL;
+    result->view_field_offsets= NULL;
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+void drizzle_scan_row_consume(drizzle_result_st *result, size_t size)
+{
+  drizzle_st *con= result->con;
+
+  con->buffer_ptr+= size;
+  con->buffer_size-= size;
+  con->packet_size= 0;
+
+  result->field_current= result->column_count;
+  result->field_current_read= result->column_count;
+  result->field_offset= 0;
+  result->field_size= 0;
+  result->field_total= 0;
+  result->field= NULL;
+}
@@ -0,0 +1,102 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Row scanner declarations
+ */
+
+#pragma once
+
+/**
+ * @addtogroup drizzle_scan_private Private Row Scanner
+ *
+ * One pass decoder for complete text protocol row packets, used by the
+ * functions which read rows without going through the field state machine.
+ * @{
+ */
+
+/**
+ * Offset stored by drizzle_scan_row() for NULL fields.
+ */
+#define DRIZZLE_SCAN_NULL SIZE_MAX
+
+/**
+ * Compute the offsets and lengths of all fields of a text protocol row
+ * packet. Offsets are relative to the start of the packet, NULL fields get
+ * an offset of DRIZZLE_SCAN_NULL and a length of 0.
+ *
+ * @param[in] packet The row packet, without the packet header.
+ * @param[in] size The size of the packet.
+ * @param[in] column_count The number of fields in the row.
+ * @param[out] offsets Array of column_count field offsets.
+ * @param[out] lengths Array of column_count field lengths.
+ * @return DRIZZLE_RETURN_OK, or DRIZZLE_RETURN_UNEXPECTED_DATA if the packet
+ *         does not hold exactly column_count fields.
+ */
+drizzle_return_t drizzle_scan_row(const unsigned char *packet, size_t size,
+                                  uint16_t column_count, size_t *offsets,
+                                  size_t *lengths);
+
+/**
+ * Allocate the per-result scratch arrays used to scan rows, if they do not
+ * exist yet.
+ */
+drizzle_return_t drizzle_scan_create(drizzle_result_st *result);
+
+/**
+ * Mark the current row packet of a result as consumed after it was decoded
+ * with drizzle_scan_row(), leaving the field state as if every field had
+ * been read through the state machine.
+ */
+void drizzle_scan_row_consume(drizzle_result_st *result, size_t size);
+
+/**
+ * Keep track of the largest value seen in a column, like
+ * drizzle_state_field_read() does for fields read through the state machine.
+ */
+static inline void drizzle_scan_column_size(drizzle_result_st *result,
+                                            uint16_t column, size_t size)
+{
+  if (result->column_buffer != NULL &&
+      result->column_buffer[column].size < size)
+  {
+    result->column_buffer[column].size= (uint32_t)size;
+  }
+}
+
+/** @} */
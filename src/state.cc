@@ -44,6 +44,19 @@
 #include "config.h"
 #include "src/common.h"
 
+/**
+ * Read the header of the next packet. When whole is set the payload is
+ * read into the buffer as well, joined with the packets it goes on in.
+ */
+static drizzle_return_t _packet_read(drizzle_st *con, bool whole);
+
+/**
+ * Remove the header of the packet following the current one from the
+ * buffer, so its payload continues what is left of the current payload.
+ * joined is false when the header has not been read yet.
+ */
+static drizzle_return_t _packet_splice(drizzle_st *con, bool *joined);
+
 drizzle_return_t drizzle_state_loop(drizzle_st *con)
 {
   if (con == NULL)
@@ -78,15 +91,124 @@ drizzle_return_t drizzle_state_packet_read(drizzle_st *con)
 
   __LOG_LOCATION__
 
+  return _packet_read(con, true);
+}
+
+drizzle_return_t drizzle_state_packet_header_read(drizzle_st *con)
+{
+  if (con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  __LOG_LOCATION__
+
+  return _packet_read(con, false);
+}
+
+drizzle_return_t drizzle_state_packet_join(drizzle_st *con)
+{
+  drizzle_return_t ret;
+  bool joined;
+
+  if (con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  __LOG_LOCATION__
+
+  while (con->state.packet_continues)
+  {
+    ret= _packet_splice(con, &joined);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+
+    if (!joined)
+    {
+      con->push_state(drizzle_state_read);
+      return DRIZZLE_RETURN_OK;
+    }
+  }
+
+  if (con->buffer_size < con->packet_size)
+  {
+    con->push_state(drizzle_state_read);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  con->pop_state();
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_state_packet_continue(drizzle_st *con)
+{
+  drizzle_return_t ret;
+  bool joined;
+
+  if (con == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  __LOG_LOCATION__
+
+  ret= _packet_splice(con, &joined);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
+  if (!joined)
+  {
+    con->push_state(drizzle_state_read);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  con->pop_state();
+
+  return DRIZZLE_RETURN_OK;
+}
+
+/*
+ * Static Definitions
+ */
+
+static drizzle_return_t _packet_read(drizzle_st *con, bool whole)
+{
   if (con->buffer_size < 4)
   {
     con->push_state(drizzle_state_read);
     return DRIZZLE_RETURN_OK;
   }
 
+  /* A payload of a multiple of DRIZZLE_MAX_PAYLOAD_SIZE bytes ends with an
+     empty packet, which is left over when the payload ended where its last
+     packet did. */
+  if (con->state.packet_continues)
+  {
+    con->state.packet_continues= false;
+    if (drizzle_get_byte3(con->buffer_ptr) == 0 &&
+        con->buffer_ptr[3] == con->packet_number)
+    {
+      con->packet_number++;
+      con->buffer_ptr+= 4;
+      con->buffer_size-= 4;
+      return DRIZZLE_RETURN_OK;
+    }
+  }
+
   con->packet_size= drizzle_get_byte3(con->buffer_ptr);
 
-  if (con->buffer_size < (con->packet_size + 4))
+  /* Payloads larger than the initial buffer are left to be read as they are
+     consumed, unless the whole payload is needed. Payloads going on in the
+     next packet are waited for when they are joined. */
+  if (con->buffer_size < (con->packet_size + 4) &&
+      (whole || con->packet_size + 4 <= con->options.buffer_size) &&
+      con->packet_size != DRIZZLE_MAX_PAYLOAD_SIZE)
   {
     con->push_state(drizzle_state_read);
     return DRIZZLE_RETURN_OK;
@@ -105,11 +227,73 @@ drizzle_return_t drizzle_state_packet_read(drizzle_st *con)
     con->buffer_size, con->packet_size, con->packet_number);
 
   con->packet_number++;
+  con->state.packet_continues= (con->packet_size == DRIZZLE_MAX_PAYLOAD_SIZE);
 
   con->buffer_ptr+= 4;
   con->buffer_size-= 4;
 
   con->pop_state();
 
+  if (whole && con->state.packet_continues)
+  {
+    con->push_state(drizzle_state_packet_join);
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_return_t _packet_splice(drizzle_st *con, bool *joined)
+{
+  unsigned char *header;
+  size_t after;
+  uint32_t size;
+
+  *joined= false;
+
+  /* The header of the next packet has to follow what is left of this one */
+  if (con->buffer_size < (size_t)con->packet_size + 4)
+  {
+    return DRIZZLE_RETURN_OK;
+  }
+
+  header= con->buffer_ptr + con->packet_size;
+  if (con->packet_number != header[3])
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "bad packet number:%u:%u", con->packet_number,
+                      header[3]);
+    return DRIZZLE_RETURN_BAD_PACKET_NUMBER;
+  }
+
+  size= drizzle_get_byte3(header);
+  if (size > UINT32_MAX - con->packet_size)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "packet too large:%" PRIu64,
+                      (uint64_t)con->packet_size + size);
+    return DRIZZLE_RETURN_INTERNAL_ERROR;
+  }
+
+  /* Remove the header by moving whichever side of it is smaller over it */
+  after= con->buffer_size - con->packet_size - 4;
+  if (con->packet_size <= after)
+  {
+    memmove(con->buffer_ptr + 4, con->buffer_ptr, con->packet_size);
+    con->buffer_ptr+= 4;
+  }
+  else
+  {
+    memmove(header, header + 4, after);
+  }
+  con->buffer_size-= 4;
+  con->packet_size+= size;
+  con->packet_number++;
+  con->state.packet_continues= (size == DRIZZLE_MAX_PAYLOAD_SIZE);
+  *joined= true;
+
+  drizzle_log_debug(con, __FILE_LINE_FUNC__,
+    "buffer_size= %" PRIu64 ", packet_size= %" PRIu32 ", packet_number= %" PRIu8,
+    con->buffer_size, con->packet_size, con->packet_number);
+
   return DRIZZLE_RETURN_OK;
 }
@@ -66,6 +66,9 @@ drizzle_return_t drizzle_state_loop(drizzle_st *con);
 
 /* Functions in state.c */
 drizzle_return_t drizzle_state_packet_read(drizzle_st *con);
+drizzle_return_t drizzle_state_packet_header_read(drizzle_st *con);
+drizzle_return_t drizzle_state_packet_join(drizzle_st *con);
+drizzle_return_t drizzle_state_packet_continue(drizzle_st *con);
 
 /* Functions in conn.c */
 drizzle_return_t drizzle_state_addrinfo(drizzle_st *con);
@@ -85,6 +88,9 @@ drizzle_return_t drizzle_state_handshake_result_read(drizzle_st *con);
 /* Functions in command.c */
 drizzle_return_t drizzle_state_command_write(drizzle_st *con);
 
+/* Functions in query.c */
+drizzle_return_t drizzle_state_infile_write(drizzle_st *con);
+
 /* Functions in result.c */
 drizzle_return_t drizzle_state_result_read(drizzle_st *con);
 
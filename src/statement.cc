@@ -38,9 +38,46 @@
 #include "config.h"
 #include "src/common.h"
 
+/* Statement cache helpers */
+static uint64_t _stmt_cache_hash(const char *db, const char *statement,
+                                 size_t size);
+static drizzle_stmt_st *_stmt_cache_find(drizzle_st *con, const char *statement,
+                                         size_t size, uint64_t hash);
+static void _stmt_cache_add(drizzle_st *con, drizzle_stmt_st *stmt,
+                            const char *statement, size_t size, uint64_t hash);
+static void _stmt_cache_remove(drizzle_st *con, drizzle_stmt_st *stmt);
+static void _stmt_cache_touch(drizzle_st *con, drizzle_stmt_st *stmt);
+static drizzle_return_t _stmt_cache_release(drizzle_stmt_st *stmt);
+static void _stmt_free(drizzle_stmt_st *stmt);
+
+/* Read the next row of an open cursor, fetching a new batch when needed */
+static drizzle_row_t _stmt_cursor_row(drizzle_stmt_st *stmt,
+                                      drizzle_return_t *ret_ptr);
+
+/* Read what is left of a fetched batch so the connection can be reused */
+static drizzle_return_t _stmt_cursor_close(drizzle_stmt_st *stmt);
+
 drizzle_stmt_st *drizzle_stmt_prepare(drizzle_st *con, const char *statement, size_t size, drizzle_return_t *ret_ptr)
 {
-  drizzle_stmt_st *stmt= new (std::nothrow) drizzle_stmt_st;
+  uint64_t hash= 0;
+  drizzle_stmt_st *stmt;
+
+  if (con->options.stmt_cache_size > 0)
+  {
+    hash= _stmt_cache_hash(con->db, statement, size);
+    stmt= _stmt_cache_find(con, statement, size, hash);
+    if (stmt != NULL && !stmt->in_use)
+    {
+      /* Already prepared on the server, skip the round trip */
+      stmt->in_use= true;
+      _stmt_cache_touch(con, stmt);
+      con->stmt= stmt;
+      *ret_ptr= DRIZZLE_RETURN_OK;
+      return stmt;
+    }
+  }
+
+  stmt= new (std::nothrow) drizzle_stmt_st;
   if (stmt == NULL)
   {
     *ret_ptr= DRIZZLE_RETURN_MEMORY;
@@ -99,6 +136,14 @@ drizzle_stmt_st *drizzle_stmt_prepare(drizzle_st *con, const char *statement, si
   stmt->state= DRIZZLE_STMT_PREPARED;
   stmt->fields= stmt->prepare_result->column_buffer;
 
+  /* The same statement may be prepared twice while the first one is in use,
+     only the first one is cached */
+  if (con->options.stmt_cache_size > 0 &&
+      _stmt_cache_find(con, statement, size, hash) == NULL)
+  {
+    _stmt_cache_add(con, stmt, statement, size, hash);
+  }
+
   return stmt;
 }
 
@@ -109,54 +154,184 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
     return DRIZZLE_RETURN_INVALID_ARGUMENT;
   }
 
-  uint16_t current_param;
-  uint16_t param_count = stmt->param_count;
-  drizzle_bind_st *param_ptr;
-  size_t param_lengths= 0;
-  size_t buffer_size= 0;
+  drizzle_st *con= stmt->con;
+  bool send_types;
+  size_t buffer_size;
   unsigned char *buffer;
-  unsigned char *buffer_pos;
-  unsigned char *data_pos;
+  unsigned char *buffer_end;
   drizzle_return_t ret;
 
-  /* Calculate param lengths */
-  for (current_param= 0; current_param < stmt->param_count; current_param++)
+  for (uint16_t current_param= 0; current_param < stmt->param_count;
+       current_param++)
   {
-    if (!stmt->query_params[current_param].is_bound)
+    if (stmt->query_params[current_param].array_data != NULL)
     {
-      drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "parameter %d has not been bound", current_param);
+      drizzle_set_error(con, __FILE_LINE_FUNC__,
+                        "parameter %d is bound to an array", current_param);
       return DRIZZLE_RETURN_STMT_ERROR;
     }
-    /* Don't count NULLs */
-    if (stmt->query_params[current_param].type == DRIZZLE_COLUMN_TYPE_NULL)
+  }
+
+  ret= drizzle_stmt_execute_size(stmt, &send_types, &buffer_size);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
+  /* Executing again closes the cursor of the last execution */
+  ret= _stmt_cursor_close(stmt);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+  drizzle_stmt_result_clear(stmt);
+
+  /* An idle connection has an empty write buffer, so the packet can be
+   * packed straight into it after the packet header and the command byte.
+   * drizzle_state_command_write() then has nothing left to copy. The buffer
+   * is shrunk first, drizzle_command_write() would move it otherwise. */
+  if (con->state.ready && con->has_state())
+  {
+    ret= drizzle_buffer_shrink(con);
+    if (ret != DRIZZLE_RETURN_OK)
     {
-      param_count--;
-      continue;
+      return ret;
     }
-    /* parameter length + 8 byte header */
-    param_lengths+= stmt->query_params[current_param].length + 8;
   }
 
-  buffer_size= 4 /* Statement ID */
-             + 1 /* Flags */
-             + 4 /* Reserved (always set to 1) */
-             + stmt->null_bitmap_length /* Null bitmap length */
-             + 1 /* New parameters bound flag */
-             + (param_count * 2) /* Parameter type data */
-             + param_lengths; /* Parameter data */
+  if (con->state.ready && con->has_state() && con->buffer_size == 0 &&
+      buffer_size + 5 <= con->buffer_allocation)
+  {
+    buffer= con->buffer + 5;
+  }
+  else
+  {
+    /* Otherwise use the buffer of the statement, which only grows */
+    ret= drizzle_stmt_buffer_reserve(stmt, buffer_size);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+    buffer= stmt->execute_buffer;
+  }
 
-  buffer = new (std::nothrow) unsigned char[buffer_size];
-  if (buffer == NULL)
+  buffer_end= drizzle_stmt_execute_pack(stmt, send_types, buffer, &ret);
+  if (buffer_end == NULL)
   {
-    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "new");
-    return DRIZZLE_RETURN_MEMORY;
+    return ret;
+  }
+
+  /* Set buffer size to what we actually used */
+  buffer_size= (size_t)(buffer_end - buffer);
+
+  stmt->execute_result= drizzle_command_write(con, NULL, DRIZZLE_COMMAND_STMT_EXECUTE, buffer, buffer_size, buffer_size, &ret);
+
+  if (ret == DRIZZLE_RETURN_OK)
+  {
+    stmt->state= DRIZZLE_STMT_EXECUTED;
+  }
+  else
+  {
+    return ret;
   }
-  buffer_pos= buffer;
+
+  drizzle_stmt_execute_sent(stmt, send_types);
+
+  stmt->execute_result->binary_rows= true;
+
+  stmt->execute_result->options= (drizzle_result_options_t)((uint8_t)stmt->execute_result->options | (uint8_t)DRIZZLE_RESULT_BINARY_ROWS);
+
+  if (stmt->execute_result->column_count > 0)
+  {
+    ret= drizzle_column_buffer(stmt->execute_result);
+    stmt->result_params= new (std::nothrow) drizzle_bind_st[stmt->execute_result->column_count];
+
+    /* With a cursor the rows stay on the server until they are fetched */
+    if (ret == DRIZZLE_RETURN_OK &&
+        (con->status & DRIZZLE_CON_STATUS_CURSOR_EXISTS))
+    {
+      stmt->cursor_open= true;
+    }
+  }
+
+  return ret;
+}
+
+drizzle_return_t drizzle_stmt_execute_size(drizzle_stmt_st *stmt,
+                                           bool *send_types,
+                                           size_t *buffer_size)
+{
+  size_t param_lengths= 0;
+
+  *send_types= stmt->new_bind;
+
+  /* Calculate the largest size of the param data, and whether the server
+   * still knows the param types from the last execution */
+  for (uint16_t current_param= 0; current_param < stmt->param_count;
+       current_param++)
+  {
+    drizzle_bind_st *param_ptr= &stmt->query_params[current_param];
+    if (!param_ptr->is_bound)
+    {
+      drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "parameter %d has not been bound", current_param);
+      return DRIZZLE_RETURN_STMT_ERROR;
+    }
+
+    uint16_t type= (uint16_t)param_ptr->type;
+    if (param_ptr->options.is_unsigned)
+    {
+      /* Set the unsigned bit flag on the type data */
+      type|= 0x8000;
+    }
+    if (type != param_ptr->sent_type)
+    {
+      *send_types= true;
+    }
+
+    if (param_ptr->type == DRIZZLE_COLUMN_TYPE_NULL ||
+        param_ptr->options.is_null || param_ptr->options.is_long_data)
+    {
+      continue;
+    }
+
+    if (param_ptr->type == DRIZZLE_COLUMN_TYPE_TIME ||
+        param_ptr->type == DRIZZLE_COLUMN_TYPE_DATE ||
+        param_ptr->type == DRIZZLE_COLUMN_TYPE_DATETIME ||
+        param_ptr->type == DRIZZLE_COLUMN_TYPE_TIMESTAMP)
+    {
+      /* length byte + up to 12 bytes of packed time */
+      param_lengths+= 13;
+    }
+    else
+    {
+      /* parameter length + up to 9 bytes of length encoding */
+      param_lengths+= param_ptr->length + 9;
+    }
+  }
+
+  *buffer_size= 4 /* Statement ID */
+              + 1 /* Flags */
+              + 4 /* Reserved (always set to 1) */
+              + stmt->null_bitmap_length /* Null bitmap length */
+              + 1 /* New parameters bound flag */
+              + (*send_types ? stmt->param_count * 2 : 0) /* Parameter type data */
+              + param_lengths; /* Parameter data */
+
+  return DRIZZLE_RETURN_OK;
+}
+
+unsigned char *drizzle_stmt_execute_pack(drizzle_stmt_st *stmt,
+                                         bool send_types,
+                                         unsigned char *buffer,
+                                         drizzle_return_t *ret_ptr)
+{
+  unsigned char *buffer_pos= buffer;
+  unsigned char *data_pos;
 
   /* Statement ID */
   drizzle_set_byte4(buffer, stmt->id);
-  /* Flags (not currently used) */
-  buffer[4]= 0;
+  /* Flags, CURSOR_TYPE_READ_ONLY when rows are fetched in batches */
+  buffer[4]= stmt->prefetch_rows > 0 ? 0x01 : 0x00;
   /* Reserved, protocol specifies set to 1 */
   drizzle_set_byte4(&buffer[5], 1);
   buffer_pos+= 9;
@@ -167,13 +342,13 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
    * and the actually data, so we keep track of a second pointer in the
    * buffer for this
    * */
-  if (stmt->new_bind)
+  if (send_types)
   {
     *buffer_pos= 1;
     buffer_pos++;
     /* Each param has a 2 byte data type header so the data pointer should be
      * moved to this */
-    data_pos= buffer_pos + (param_count * 2);
+    data_pos= buffer_pos + (stmt->param_count * 2);
   }
   else
   {
@@ -182,29 +357,25 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
     data_pos= buffer_pos;
   }
   memset(stmt->null_bitmap, 0, stmt->null_bitmap_length);
-  /* Go through each param copying to buffer
-   * In an ideal world we would do this without the copy
-   * */
-  for (current_param= 0; current_param < stmt->param_count; current_param++)
+  /* Go through each param packing it into the buffer */
+  for (uint16_t current_param= 0; current_param < stmt->param_count;
+       current_param++)
   {
     uint16_t short_value;
     uint32_t long_value;
     uint64_t longlong_value;
-    param_ptr= &stmt->query_params[current_param];
+    drizzle_bind_st *param_ptr= &stmt->query_params[current_param];
 
-    if (stmt->new_bind)
+    if (send_types)
     {
+      /* The server expects a type for every param, NULLs included */
       uint16_t type= (uint16_t)param_ptr->type;
-      if (type != DRIZZLE_COLUMN_TYPE_NULL)
+      if (param_ptr->options.is_unsigned)
       {
-        if (param_ptr->options.is_unsigned)
-        {
-          /* Set the unsigned bit flag on the type data */
-          type |= 0x8000;
-        }
-        drizzle_set_byte2(buffer_pos, type);
-        buffer_pos+= 2;
+        type|= 0x8000;
       }
+      drizzle_set_byte2(buffer_pos, type);
+      buffer_pos+= 2;
     }
 
     if (param_ptr->options.is_long_data)
@@ -213,6 +384,13 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
       continue;
     }
 
+    if (param_ptr->options.is_null)
+    {
+      /* A NULL row of an array keeps the type of its param */
+      stmt->null_bitmap[current_param/8] |= (1 << (current_param % 8));
+      continue;
+    }
+
     switch(param_ptr->type)
     {
       case DRIZZLE_COLUMN_TYPE_NULL:
@@ -273,6 +451,7 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
       case DRIZZLE_COLUMN_TYPE_ENUM:
       case DRIZZLE_COLUMN_TYPE_SET:
       case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+      case DRIZZLE_COLUMN_TYPE_JSON:
       case DRIZZLE_COLUMN_TYPE_BIT:
       /* We do not need to support these three: they exist internally to the MySQL server, but do not appear on the wire */
       case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
@@ -280,50 +459,94 @@ drizzle_return_t drizzle_stmt_execute(drizzle_stmt_st *stmt)
       case DRIZZLE_COLUMN_TYPE_TIME2:
       default:
         drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "unknown type when filling buffer");
-        delete[] buffer;
-        return DRIZZLE_RETURN_UNEXPECTED_DATA;
-        break;
+        *ret_ptr= DRIZZLE_RETURN_UNEXPECTED_DATA;
+        return NULL;
     }
   }
   /* Copy NULL bitmap */
   memcpy(&buffer[9], stmt->null_bitmap, stmt->null_bitmap_length);
-  if (stmt->execute_result)
-  {
-    drizzle_result_free(stmt->execute_result);
-    stmt->execute_result= NULL;
-  }
 
-  /* Set buffer size to what we actually used */
-  buffer_size= data_pos - buffer;
-
-  stmt->execute_result= drizzle_command_write(stmt->con, stmt->execute_result, DRIZZLE_COMMAND_STMT_EXECUTE, buffer, buffer_size, buffer_size, &ret);
+  *ret_ptr= DRIZZLE_RETURN_OK;
+  return data_pos;
+}
 
-  if (ret == DRIZZLE_RETURN_OK)
+void drizzle_stmt_execute_sent(drizzle_stmt_st *stmt, bool send_types)
+{
+  if (send_types)
   {
-    stmt->state= DRIZZLE_STMT_EXECUTED;
+    /* Later executions only send the types again when one of them changes */
+    for (uint16_t current_param= 0; current_param < stmt->param_count;
+         current_param++)
+    {
+      drizzle_bind_st *param_ptr= &stmt->query_params[current_param];
+      param_ptr->sent_type= (uint16_t)param_ptr->type;
+      if (param_ptr->options.is_unsigned)
+      {
+        param_ptr->sent_type|= 0x8000;
+      }
+    }
   }
-  else
+  stmt->new_bind= false;
+}
+
+drizzle_return_t drizzle_stmt_buffer_reserve(drizzle_stmt_st *stmt, size_t size)
+{
+  if (stmt->execute_buffer_size >= size)
   {
-    delete[] buffer;
-    return ret;
+    return DRIZZLE_RETURN_OK;
   }
 
-  stmt->new_bind= false;
+  size_t buffer_size= stmt->execute_buffer_size ? stmt->execute_buffer_size :
+                      DRIZZLE_BUFFER_COPY_THRESHOLD;
+  while (buffer_size < size)
+  {
+    buffer_size*= 2;
+  }
 
-  stmt->execute_result->binary_rows= true;
+  unsigned char *buffer= (unsigned char *)realloc(stmt->execute_buffer,
+                                                  buffer_size);
+  if (buffer == NULL)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "Failed to realloc execute buffer.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  stmt->execute_buffer= buffer;
+  stmt->execute_buffer_size= buffer_size;
 
-  stmt->execute_result->options= (drizzle_result_options_t)((uint8_t)stmt->execute_result->options | (uint8_t)DRIZZLE_RESULT_BINARY_ROWS);
+  return DRIZZLE_RETURN_OK;
+}
 
-  if (stmt->execute_result->column_count > 0)
+drizzle_return_t drizzle_stmt_state_loop(drizzle_st *con)
+{
+  drizzle_return_t ret= drizzle_state_loop(con);
+  while (ret == DRIZZLE_RETURN_IO_WAIT)
   {
-    ret= drizzle_column_buffer(stmt->execute_result);
-    stmt->result_params= new (std::nothrow) drizzle_bind_st[stmt->execute_result->column_count];
+    ret= drizzle_wait(con);
+    if (ret == DRIZZLE_RETURN_OK)
+    {
+      ret= drizzle_state_loop(con);
+    }
   }
 
-  delete[] buffer;
   return ret;
 }
 
+void drizzle_stmt_result_clear(drizzle_stmt_st *stmt)
+{
+  if (stmt->execute_result)
+  {
+    for (uint16_t x= 0; x < stmt->execute_result->column_count; x++)
+    {
+      delete[] stmt->result_params[x].data_buffer;
+    }
+    delete[] stmt->result_params;
+    stmt->result_params= NULL;
+    drizzle_result_free(stmt->execute_result);
+    stmt->execute_result= NULL;
+  }
+}
+
 drizzle_return_t drizzle_stmt_send_long_data(drizzle_stmt_st *stmt, uint16_t param_num, unsigned char *data, size_t len)
 {
   drizzle_return_t ret;
@@ -376,22 +599,43 @@ drizzle_return_t drizzle_stmt_reset(drizzle_stmt_st *stmt)
     stmt->query_params[current_param].options.is_long_data= false;
   }
 
+  ret= _stmt_cursor_close(stmt);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
   drizzle_set_byte4(buffer, stmt->id);
   stmt->con->state.no_result_read= true;
   drizzle_command_write(stmt->con, NULL, DRIZZLE_COMMAND_STMT_RESET, buffer, 4,
                         4, &ret);
   stmt->con->state.no_result_read= false;
-  if (stmt->execute_result)
-  {
-    drizzle_result_free(stmt->execute_result);
-    stmt->execute_result= NULL;
-  }
+  drizzle_stmt_result_clear(stmt);
   stmt->state= DRIZZLE_STMT_PREPARED;
-  delete[] stmt->result_params;
 
   return ret;
 }
 
+drizzle_return_t drizzle_stmt_set_cursor(drizzle_stmt_st *stmt,
+                                         uint32_t prefetch_rows)
+{
+  if (stmt == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (stmt->cursor_open)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "cannot change the batch size of an open cursor");
+    return DRIZZLE_RETURN_NOT_READY;
+  }
+
+  stmt->prefetch_rows= prefetch_rows;
+
+  return DRIZZLE_RETURN_OK;
+}
+
 drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
 {
   drizzle_return_t ret= DRIZZLE_RETURN_OK;
@@ -417,6 +661,19 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
   {
     row= drizzle_row_next(stmt->execute_result);
   }
+  else if (stmt->cursor_open)
+  {
+    row= _stmt_cursor_row(stmt, &ret);
+    if (row == NULL && ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+  }
+  else if (stmt->execute_result->complete)
+  {
+    /* Every row has been read, including the last batch of a cursor */
+    row= NULL;
+  }
   else
   {
     row= drizzle_row_buffer(stmt->execute_result, &ret);
@@ -441,16 +698,12 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
     }
     else
     {
-      uint16_t short_data;
-      uint32_t long_data;
-      uint64_t longlong_data;
+      /* Values are decoded from the row by the getters when asked for */
       param->type= column->type;
       param->options.is_null= false;
+      param->options.is_unsigned= (column->flags & DRIZZLE_COLUMN_FLAGS_UNSIGNED);
       param->length= stmt->execute_result->field_sizes[current_column];
-      if (column->flags & DRIZZLE_COLUMN_FLAGS_UNSIGNED)
-      {
-        param->options.is_unsigned= true;
-      }
+      param->data= row[current_column];
 
       switch(column->type)
       {
@@ -459,44 +712,17 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
           param->length= 0;
           break;
         case DRIZZLE_COLUMN_TYPE_TINY:
-          param->data= param->data_buffer;
-          *(uint8_t*)param->data= *row[current_column];
-          break;
         case DRIZZLE_COLUMN_TYPE_SHORT:
         case DRIZZLE_COLUMN_TYPE_YEAR:
-          param->data= param->data_buffer;
-          short_data= drizzle_get_byte2(row[current_column]);
-          memcpy(param->data, &short_data, 2);
-          break;
         case DRIZZLE_COLUMN_TYPE_INT24:
         case DRIZZLE_COLUMN_TYPE_LONG:
-          param->data= param->data_buffer;
-          long_data= drizzle_get_byte4(row[current_column]);
-          memcpy(param->data, &long_data, 4);
-          break;
         case DRIZZLE_COLUMN_TYPE_LONGLONG:
-          param->data= param->data_buffer;
-          longlong_data= drizzle_get_byte8(row[current_column]);
-          memcpy(param->data, &longlong_data, 8);
-          break;
         case DRIZZLE_COLUMN_TYPE_FLOAT:
-          param->data= param->data_buffer;
-          memcpy(param->data, row[current_column], 4);
-          break;
         case DRIZZLE_COLUMN_TYPE_DOUBLE:
-          param->data= param->data_buffer;
-          memcpy(param->data, row[current_column], 8);
-          break;
         case DRIZZLE_COLUMN_TYPE_TIME:
-          param->data= param->data_buffer;
-          drizzle_unpack_time(row[current_column], param->length, (drizzle_datetime_st *)param->data, stmt->execute_result->column_buffer[current_column].decimals);
-          break;
         case DRIZZLE_COLUMN_TYPE_DATE:
         case DRIZZLE_COLUMN_TYPE_DATETIME:
         case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
-          param->data= param->data_buffer;
-          drizzle_unpack_datetime(row[current_column], param->length, (drizzle_datetime_st *)param->data, stmt->execute_result->column_buffer[current_column].decimals);
-          break;
         case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
         case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
         case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
@@ -507,13 +733,13 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
         case DRIZZLE_COLUMN_TYPE_DECIMAL:
         case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
         case DRIZZLE_COLUMN_TYPE_NEWDATE:
-          param->data= row[current_column];
           break;
         /* These types aren't handled yet, most are for older MySQL versions */
         case DRIZZLE_COLUMN_TYPE_VARCHAR:
         case DRIZZLE_COLUMN_TYPE_ENUM:
         case DRIZZLE_COLUMN_TYPE_SET:
         case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+        case DRIZZLE_COLUMN_TYPE_JSON:
         /* We do not need to support these three: they exist internally to the MySQL server, but do not appear on the wire */
         case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
         case DRIZZLE_COLUMN_TYPE_DATETIME2:
@@ -531,6 +757,10 @@ drizzle_return_t drizzle_stmt_fetch(drizzle_stmt_st *stmt)
     }
 
   }
+  if (ret == DRIZZLE_RETURN_OK && stmt->output_binds != NULL)
+  {
+    ret= drizzle_stmt_output_store(stmt);
+  }
   stmt->state= DRIZZLE_STMT_FETCHED;
   if (!(stmt->execute_result->options & DRIZZLE_RESULT_BUFFER_ROW))
   {
@@ -551,6 +781,12 @@ drizzle_return_t drizzle_stmt_buffer(drizzle_stmt_st *stmt)
     drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "data set has already been read");
     return DRIZZLE_RETURN_UNEXPECTED_DATA;
   }
+  if (stmt->cursor_open)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "rows of a cursor must be read with drizzle_stmt_fetch");
+    return DRIZZLE_RETURN_NOT_READY;
+  }
 
   stmt->con->result= stmt->execute_result;
   stmt->state= DRIZZLE_STMT_FETCHED;
@@ -568,33 +804,184 @@ drizzle_return_t drizzle_stmt_close(drizzle_stmt_st *stmt)
     return DRIZZLE_RETURN_INVALID_ARGUMENT;
   }
 
-  delete[] stmt->null_bitmap;
-  for (uint16_t x= 0; x < stmt->param_count; x++)
+  /* The statement is closed whether or not the batch could be read */
+  (void)_stmt_cursor_close(stmt);
+
+  if (stmt->cached)
   {
-    delete[] stmt->query_params[x].data_buffer;
+    /* Keep the statement prepared unless rows are left to read */
+    if (stmt->execute_result == NULL || stmt->execute_result->complete)
+    {
+      return _stmt_cache_release(stmt);
+    }
+
+    _stmt_cache_remove(stmt->con, stmt);
   }
-  delete[] stmt->query_params;
-  if (stmt->execute_result)
+
+  drizzle_set_byte4(buffer, stmt->id);
+  stmt->con->state.no_result_read= true;
+  drizzle_command_write(stmt->con, NULL, DRIZZLE_COMMAND_STMT_CLOSE, buffer, 4,
+                        4, &ret);
+  stmt->con->state.no_result_read= false;
+  _stmt_free(stmt);
+  return ret;
+}
+
+void drizzle_stmt_cache_clear(drizzle_st *con, bool server_close)
+{
+  drizzle_stmt_st *stmt= con->stmt_cache.lru_first;
+  while (stmt != NULL)
   {
-    for (uint16_t x= 0; x < stmt->execute_result->column_count; x++)
+    drizzle_stmt_st *next= stmt->lru_next;
+    _stmt_cache_remove(con, stmt);
+    /* Statements in use are freed by drizzle_stmt_close() */
+    if (!stmt->in_use)
     {
-      delete[] stmt->result_params[x].data_buffer;
+      if (server_close)
+      {
+        (void)drizzle_stmt_close(stmt);
+      }
+      else
+      {
+        _stmt_free(stmt);
+      }
     }
-    delete[] stmt->result_params;
-    drizzle_result_free(stmt->execute_result);
+    stmt= next;
   }
+
+  delete[] con->stmt_cache.bucket_list;
+  con->stmt_cache.bucket_list= NULL;
+  con->stmt_cache.bucket_count= 0;
+}
+
+static drizzle_row_t _stmt_cursor_row(drizzle_stmt_st *stmt,
+                                      drizzle_return_t *ret_ptr)
+{
+  drizzle_st *con= stmt->con;
+  drizzle_result_st *result= stmt->execute_result;
+  unsigned char buffer[8];
+  drizzle_row_t row;
+
+  while (1)
+  {
+    if (!stmt->cursor_fetching)
+    {
+      if (!con->has_state())
+      {
+        drizzle_set_error(con, __FILE_LINE_FUNC__,
+                          "connection is busy with another command");
+        *ret_ptr= DRIZZLE_RETURN_NOT_READY;
+        return NULL;
+      }
+
+      drizzle_set_byte4(buffer, stmt->id);
+      drizzle_set_byte4(buffer + 4, stmt->prefetch_rows);
+      con->state.no_result_read= true;
+      drizzle_command_write(con, NULL, DRIZZLE_COMMAND_STMT_FETCH, buffer, 8,
+                            8, ret_ptr);
+      con->state.no_result_read= false;
+      if (*ret_ptr == DRIZZLE_RETURN_IO_WAIT)
+      {
+        *ret_ptr= drizzle_stmt_state_loop(con);
+      }
+      if (*ret_ptr != DRIZZLE_RETURN_OK)
+      {
+        return NULL;
+      }
+
+      /* The batch is read into the executed result like streamed rows */
+      con->result= result;
+      con->command= DRIZZLE_COMMAND_STMT_FETCH;
+      con->packet_number= 1;
+      result->complete= false;
+      stmt->cursor_fetching= true;
+    }
+
+    row= drizzle_row_buffer(result, ret_ptr);
+    if (*ret_ptr != DRIZZLE_RETURN_OK)
+    {
+      stmt->cursor_fetching= false;
+      stmt->cursor_open= false;
+      return NULL;
+    }
+
+    /* Only the EOF packet follows a full batch. It is read right away so
+       the connection is free for other commands until the next fetch */
+    if (row != NULL && result->row_current < stmt->prefetch_rows)
+    {
+      return row;
+    }
+    if (row != NULL && drizzle_row_read(result, ret_ptr) != 0)
+    {
+      if (*ret_ptr == DRIZZLE_RETURN_OK)
+      {
+        drizzle_set_error(con, __FILE_LINE_FUNC__,
+                          "server sent more rows than requested");
+        *ret_ptr= DRIZZLE_RETURN_UNEXPECTED_DATA;
+      }
+      drizzle_row_free(result, row);
+      stmt->cursor_fetching= false;
+      stmt->cursor_open= false;
+      return NULL;
+    }
+
+    /* End of this batch, the EOF status tells whether more rows remain */
+    stmt->cursor_fetching= false;
+    if ((con->status & DRIZZLE_CON_STATUS_LAST_ROW_SENT) ||
+        !(con->status & DRIZZLE_CON_STATUS_CURSOR_EXISTS))
+    {
+      stmt->cursor_open= false;
+    }
+    if (row != NULL || !stmt->cursor_open)
+    {
+      return row;
+    }
+  }
+}
+
+static drizzle_return_t _stmt_cursor_close(drizzle_stmt_st *stmt)
+{
+  drizzle_return_t ret= DRIZZLE_RETURN_OK;
+  drizzle_row_t row;
+
+  if (stmt->cursor_fetching)
+  {
+    stmt->con->result= stmt->execute_result;
+    while ((row= drizzle_row_buffer(stmt->execute_result, &ret)) != NULL)
+    {
+      drizzle_row_free(stmt->execute_result, row);
+    }
+  }
+
+  stmt->cursor_open= false;
+  stmt->cursor_fetching= false;
+
+  return ret;
+}
+
+static void _stmt_free(drizzle_stmt_st *stmt)
+{
+  if (stmt->con->stmt == stmt)
+  {
+    stmt->con->stmt= NULL;
+  }
+
+  delete[] stmt->null_bitmap;
+  for (uint16_t x= 0; x < stmt->param_count; x++)
+  {
+    delete[] stmt->query_params[x].data_buffer;
+  }
+  delete[] stmt->query_params;
+  delete[] stmt->output_binds;
+  drizzle_stmt_result_clear(stmt);
   if (stmt->prepare_result)
   {
     drizzle_result_free(stmt->prepare_result);
   }
 
-  drizzle_set_byte4(buffer, stmt->id);
-  stmt->con->state.no_result_read= true;
-  drizzle_command_write(stmt->con, NULL, DRIZZLE_COMMAND_STMT_CLOSE, buffer, 4,
-                        4, &ret);
-  stmt->con->state.no_result_read= false;
+  delete[] stmt->cache_sql;
+  free(stmt->execute_buffer);
   delete stmt;
-  return ret;
 }
 
 uint16_t drizzle_stmt_column_count(drizzle_stmt_st *stmt)
@@ -646,3 +1033,222 @@ uint64_t drizzle_stmt_row_count(drizzle_stmt_st *stmt)
 
   return UINT64_MAX;
 }
+
+static uint64_t _stmt_cache_hash(const char *db, const char *statement,
+                                 size_t size)
+{
+  /* 64 bit FNV-1a over the default schema, its terminator and the SQL text.
+     The server resolves unqualified names against the schema selected at
+     prepare time, so the same text prepared under two schemas differs */
+  uint64_t hash= UINT64_C(14695981039346656037);
+  size_t db_size= strlen(db) + 1;
+  for (size_t x= 0; x < db_size; x++)
+  {
+    hash^= (unsigned char)db[x];
+    hash*= UINT64_C(1099511628211);
+  }
+  for (size_t x= 0; x < size; x++)
+  {
+    hash^= (unsigned char)statement[x];
+    hash*= UINT64_C(1099511628211);
+  }
+
+  return hash;
+}
+
+static drizzle_stmt_st *_stmt_cache_find(drizzle_st *con, const char *statement,
+                                         size_t size, uint64_t hash)
+{
+  drizzle_stmt_cache_st *cache= &con->stmt_cache;
+  if (cache->bucket_list == NULL)
+  {
+    return NULL;
+  }
+
+  drizzle_stmt_st *stmt= cache->bucket_list[hash & (cache->bucket_count - 1)];
+  for (; stmt != NULL; stmt= stmt->cache_next)
+  {
+    if (stmt->cache_hash == hash && stmt->cache_sql_size == size &&
+        memcmp(stmt->cache_sql, statement, size) == 0 &&
+        strcmp(stmt->cache_db, con->db) == 0)
+    {
+      return stmt;
+    }
+  }
+
+  return NULL;
+}
+
+static void _stmt_cache_add(drizzle_st *con, drizzle_stmt_st *stmt,
+                            const char *statement, size_t size, uint64_t hash)
+{
+  drizzle_stmt_cache_st *cache= &con->stmt_cache;
+
+  if (cache->bucket_list == NULL)
+  {
+    uint32_t bucket_count= 1;
+    while (bucket_count < con->options.stmt_cache_size * 2)
+    {
+      bucket_count*= 2;
+    }
+
+    cache->bucket_list= new (std::nothrow) drizzle_stmt_st*[bucket_count]();
+    if (cache->bucket_list == NULL)
+    {
+      return;
+    }
+    cache->bucket_count= bucket_count;
+  }
+
+  /* Make room by closing the least recently used idle statement */
+  if (cache->count >= con->options.stmt_cache_size)
+  {
+    drizzle_stmt_st *victim= cache->lru_last;
+    while (victim != NULL && victim->in_use)
+    {
+      victim= victim->lru_prev;
+    }
+
+    if (victim == NULL)
+    {
+      return;
+    }
+
+    _stmt_cache_remove(con, victim);
+    (void)drizzle_stmt_close(victim);
+    con->stmt= stmt;
+  }
+
+  stmt->cache_sql= new (std::nothrow) char[size];
+  if (stmt->cache_sql == NULL)
+  {
+    return;
+  }
+  memcpy(stmt->cache_sql, statement, size);
+  stmt->cache_sql_size= size;
+  memcpy(stmt->cache_db, con->db, DRIZZLE_MAX_DB_SIZE);
+  stmt->cache_hash= hash;
+  stmt->cached= true;
+  stmt->in_use= true;
+
+  drizzle_stmt_st **bucket= &cache->bucket_list[hash & (cache->bucket_count - 1)];
+  stmt->cache_next= *bucket;
+  *bucket= stmt;
+  cache->count++;
+
+  stmt->lru_prev= NULL;
+  stmt->lru_next= cache->lru_first;
+  if (cache->lru_first != NULL)
+  {
+    cache->lru_first->lru_prev= stmt;
+  }
+  cache->lru_first= stmt;
+  if (cache->lru_last == NULL)
+  {
+    cache->lru_last= stmt;
+  }
+}
+
+static void _stmt_cache_remove(drizzle_st *con, drizzle_stmt_st *stmt)
+{
+  drizzle_stmt_cache_st *cache= &con->stmt_cache;
+
+  drizzle_stmt_st **ptr= &cache->bucket_list[stmt->cache_hash & (cache->bucket_count - 1)];
+  while (*ptr != stmt)
+  {
+    ptr= &(*ptr)->cache_next;
+  }
+  *ptr= stmt->cache_next;
+  stmt->cache_next= NULL;
+
+  if (stmt->lru_prev == NULL)
+  {
+    cache->lru_first= stmt->lru_next;
+  }
+  else
+  {
+    stmt->lru_prev->lru_next= stmt->lru_next;
+  }
+  if (stmt->lru_next == NULL)
+  {
+    cache->lru_last= stmt->lru_prev;
+  }
+  else
+  {
+    stmt->lru_next->lru_prev= stmt->lru_prev;
+  }
+  stmt->lru_prev= NULL;
+  stmt->lru_next= NULL;
+
+  cache->count--;
+  stmt->cached= false;
+}
+
+static void _stmt_cache_touch(drizzle_st *con, drizzle_stmt_st *stmt)
+{
+  drizzle_stmt_cache_st *cache= &con->stmt_cache;
+
+  if (cache->lru_first == stmt)
+  {
+    return;
+  }
+
+  stmt->lru_prev->lru_next= stmt->lru_next;
+  if (stmt->lru_next == NULL)
+  {
+    cache->lru_last= stmt->lru_prev;
+  }
+  else
+  {
+    stmt->lru_next->lru_prev= stmt->lru_prev;
+  }
+
+  stmt->lru_prev= NULL;
+  stmt->lru_next= cache->lru_first;
+  cache->lru_first->lru_prev= stmt;
+  cache->lru_first= stmt;
+}
+
+static drizzle_return_t _stmt_cache_release(drizzle_stmt_st *stmt)
+{
+  drizzle_return_t ret= DRIZZLE_RETURN_OK;
+  bool long_data= false;
+
+  /* Leave the statement as a freshly prepared one */
+  for (uint16_t x= 0; x < stmt->param_count; x++)
+  {
+    if (stmt->query_params[x].options.is_long_data)
+    {
+      long_data= true;
+    }
+    stmt->query_params[x].options.is_long_data= false;
+    stmt->query_params[x].is_bound= false;
+  }
+
+  /* Long data already sent is only discarded by the server on reset */
+  if (long_data)
+  {
+    unsigned char buffer[4];
+    drizzle_set_byte4(buffer, stmt->id);
+    stmt->con->state.no_result_read= true;
+    drizzle_command_write(stmt->con, NULL, DRIZZLE_COMMAND_STMT_RESET, buffer, 4,
+                          4, &ret);
+    stmt->con->state.no_result_read= false;
+  }
+
+  drizzle_stmt_result_clear(stmt);
+  delete[] stmt->output_binds;
+  stmt->output_binds= NULL;
+  stmt->output_bind_count= 0;
+  stmt->prefetch_rows= 0;
+
+  stmt->state= DRIZZLE_STMT_PREPARED;
+  stmt->new_bind= true;
+  stmt->in_use= false;
+  if (stmt->con->stmt == stmt)
+  {
+    stmt->con->stmt= NULL;
+  }
+
+  return ret;
+}
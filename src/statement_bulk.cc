@@ -0,0 +1,373 @@
+/* vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ * Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012-2013 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @file
+ * @brief Prepared statement array execution definitions
+ */
+
+#include "config.h"
+#include "src/common.h"
+
+#include <inttypes.h>
+
+/*
+ * Private declarations
+ */
+
+/**
+ * Get the size of one value in an array of type, 0 for types whose array
+ * holds pointers to the values. Returns false for types arrays can not hold.
+ */
+static bool _stmt_array_value_size(drizzle_column_type_t type, size_t *size);
+
+/**
+ * Point the params bound to arrays at the values of a row.
+ */
+static void _stmt_array_row(drizzle_stmt_st *stmt, uint32_t row);
+
+/**
+ * Write size bytes of packets from the execute buffer of the statement in
+ * one go. Any data already read into the connection buffer is left alone.
+ */
+static drizzle_return_t _stmt_array_send(drizzle_stmt_st *stmt, size_t size);
+
+/*
+ * Client definitions
+ */
+
+drizzle_return_t drizzle_stmt_set_array(drizzle_stmt_st *stmt, uint16_t param_num,
+                                        drizzle_column_type_t type,
+                                        const void *values, const size_t *lengths,
+                                        const bool *nulls, bool is_unsigned)
+{
+  drizzle_bind_st *param;
+  drizzle_return_t ret;
+  size_t size;
+
+  if ((stmt == NULL) || (param_num >= stmt->param_count) || (values == NULL))
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (!_stmt_array_value_size(type, &size))
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "type %d can not be bound to an array", (int)type);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (size == 0 && lengths == NULL)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "lengths are required for type %d", (int)type);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  ret= drizzle_stmt_set_param(stmt, param_num, type, NULL, 0, is_unsigned);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    return ret;
+  }
+
+  param= &stmt->query_params[param_num];
+  param->array_data= values;
+  param->array_lengths= lengths;
+  param->array_nulls= nulls;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_stmt_execute_array(drizzle_stmt_st *stmt,
+                                            uint32_t rows,
+                                            uint64_t *affected_rows)
+{
+  drizzle_st *con;
+  drizzle_return_t ret;
+  bool failed= false;
+  uint32_t row;
+
+  if (stmt == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  con= stmt->con;
+
+  if (stmt->state < DRIZZLE_STMT_PREPARED)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "stmt object has not been prepared");
+    return DRIZZLE_RETURN_STMT_ERROR;
+  }
+
+  if (stmt->prepare_result->column_count > 0)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "statements returning a result set can not be executed for an array");
+    return DRIZZLE_RETURN_STMT_ERROR;
+  }
+
+  if (!con->has_state())
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__,
+                      "connection busy reading a result");
+    return DRIZZLE_RETURN_NOT_READY;
+  }
+
+  /* Reconnecting would lose the statement prepared on the server */
+  if (!con->state.ready)
+  {
+    drizzle_set_error(con, __FILE_LINE_FUNC__, "lost connection to server");
+    return DRIZZLE_RETURN_LOST_CONNECTION;
+  }
+
+  drizzle_stmt_result_clear(stmt);
+
+  for (row= 0; row < rows;)
+  {
+    uint32_t count= rows - row;
+    size_t used= 0;
+    uint32_t x;
+
+    if (count > DRIZZLE_DEFAULT_PIPELINE_WINDOW)
+    {
+      count= DRIZZLE_DEFAULT_PIPELINE_WINDOW;
+    }
+
+    /* Every execution is a command of its own, so the packet number
+       starts at 0 for each of them */
+    for (x= row; x < row + count; x++)
+    {
+      unsigned char *ptr;
+      unsigned char *end;
+      bool send_types;
+      size_t size;
+
+      _stmt_array_row(stmt, x);
+      ret= drizzle_stmt_execute_size(stmt, &send_types, &size);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+
+      ret= drizzle_stmt_buffer_reserve(stmt, used + 5 + size);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+
+      ptr= stmt->execute_buffer + used;
+      end= drizzle_stmt_execute_pack(stmt, send_types, ptr + 5, &ret);
+      if (end == NULL)
+      {
+        return ret;
+      }
+
+      if ((size_t)(end - ptr) - 4 >= DRIZZLE_MAX_PAYLOAD_SIZE)
+      {
+        drizzle_set_error(con, __FILE_LINE_FUNC__,
+                          "row %" PRIu32 " too large for a single packet", x);
+        return DRIZZLE_RETURN_INVALID_ARGUMENT;
+      }
+
+      drizzle_set_byte3(ptr, (size_t)(end - ptr) - 4);
+      ptr[3]= 0;
+      ptr[4]= (unsigned char)DRIZZLE_COMMAND_STMT_EXECUTE;
+      used= (size_t)(end - stmt->execute_buffer);
+
+      drizzle_stmt_execute_sent(stmt, send_types);
+    }
+
+    ret= _stmt_array_send(stmt, used);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+
+    /* Read the result of every execution, the last one is kept for
+       drizzle_stmt_affected_rows() and drizzle_stmt_insert_id() */
+    for (x= row; x < row + count; x++)
+    {
+      con->result= drizzle_result_create(con);
+      if (con->result == NULL)
+      {
+        return DRIZZLE_RETURN_MEMORY;
+      }
+
+      con->command= DRIZZLE_COMMAND_STMT_EXECUTE;
+      con->packet_number= 1;
+      con->push_state(drizzle_state_result_read);
+      con->push_state(drizzle_state_packet_read);
+
+      ret= drizzle_stmt_state_loop(con);
+      if (ret != DRIZZLE_RETURN_OK && ret != DRIZZLE_RETURN_ERROR_CODE)
+      {
+        drizzle_result_free(con->result);
+        con->result= NULL;
+        return ret;
+      }
+
+      if (affected_rows != NULL)
+      {
+        affected_rows[x]= ret == DRIZZLE_RETURN_OK ?
+                          con->result->affected_rows : UINT64_MAX;
+      }
+      if (ret == DRIZZLE_RETURN_ERROR_CODE)
+      {
+        failed= true;
+      }
+
+      drizzle_stmt_result_clear(stmt);
+      stmt->execute_result= con->result;
+    }
+
+    row+= count;
+  }
+
+  stmt->state= DRIZZLE_STMT_EXECUTED;
+
+  return failed ? DRIZZLE_RETURN_ERROR_CODE : DRIZZLE_RETURN_OK;
+}
+
+/*
+ * Private definitions
+ */
+
+static bool _stmt_array_value_size(drizzle_column_type_t type, size_t *size)
+{
+  switch (type)
+  {
+    case DRIZZLE_COLUMN_TYPE_TINY:
+      *size= 1;
+      return true;
+    case DRIZZLE_COLUMN_TYPE_SHORT:
+      *size= 2;
+      return true;
+    case DRIZZLE_COLUMN_TYPE_LONG:
+    case DRIZZLE_COLUMN_TYPE_FLOAT:
+      *size= 4;
+      return true;
+    case DRIZZLE_COLUMN_TYPE_LONGLONG:
+    case DRIZZLE_COLUMN_TYPE_DOUBLE:
+      *size= 8;
+      return true;
+    case DRIZZLE_COLUMN_TYPE_TIME:
+    case DRIZZLE_COLUMN_TYPE_DATE:
+    case DRIZZLE_COLUMN_TYPE_DATETIME:
+    case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+      *size= sizeof(drizzle_datetime_st);
+      return true;
+    case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+    case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+    case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+    case DRIZZLE_COLUMN_TYPE_BLOB:
+    case DRIZZLE_COLUMN_TYPE_VARCHAR:
+    case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+    case DRIZZLE_COLUMN_TYPE_STRING:
+    case DRIZZLE_COLUMN_TYPE_DECIMAL:
+    case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+      *size= 0;
+      return true;
+    case DRIZZLE_COLUMN_TYPE_NULL:
+    case DRIZZLE_COLUMN_TYPE_INT24:
+    case DRIZZLE_COLUMN_TYPE_YEAR:
+    case DRIZZLE_COLUMN_TYPE_NEWDATE:
+    case DRIZZLE_COLUMN_TYPE_ENUM:
+    case DRIZZLE_COLUMN_TYPE_SET:
+    case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
+    case DRIZZLE_COLUMN_TYPE_BIT:
+    case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+    case DRIZZLE_COLUMN_TYPE_DATETIME2:
+    case DRIZZLE_COLUMN_TYPE_TIME2:
+    default:
+      return false;
+  }
+}
+
+static void _stmt_array_row(drizzle_stmt_st *stmt, uint32_t row)
+{
+  for (uint16_t x= 0; x < stmt->param_count; x++)
+  {
+    drizzle_bind_st *param= &stmt->query_params[x];
+    size_t size;
+
+    if (param->array_data == NULL)
+    {
+      continue;
+    }
+
+    (void)_stmt_array_value_size(param->type, &size);
+    if (size > 0)
+    {
+      param->data= (void *)((const unsigned char *)param->array_data +
+                            size * row);
+      param->length= size;
+    }
+    else
+    {
+      param->data= (void *)((const char *const *)param->array_data)[row];
+      param->length= param->array_lengths[row];
+    }
+    param->options.is_null= param->array_nulls != NULL &&
+                            param->array_nulls[row];
+  }
+}
+
+static drizzle_return_t _stmt_array_send(drizzle_stmt_st *stmt, size_t size)
+{
+  drizzle_st *con= stmt->con;
+  unsigned char *read_ptr= con->buffer_ptr;
+  size_t read_size= con->buffer_size;
+  drizzle_return_t ret;
+
+  con->buffer_ptr= stmt->execute_buffer;
+  con->buffer_size= size;
+  con->push_state(drizzle_state_write);
+
+  ret= drizzle_stmt_state_loop(con);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    /* The connection has been closed and its buffer reset. */
+    return ret;
+  }
+
+  con->buffer_ptr= read_size ? read_ptr : con->buffer;
+  con->buffer_size= read_size;
+
+  return DRIZZLE_RETURN_OK;
+}
@@ -53,8 +53,36 @@ char *time_to_string(drizzle_bind_st *param, drizzle_datetime_st *time);
 
 char *timestamp_to_string(drizzle_bind_st *param, drizzle_datetime_st *timestamp);
 
+/* Copy the columns of the fetched row into the output bindings */
+drizzle_return_t drizzle_stmt_output_store(drizzle_stmt_st *stmt);
+
 uint16_t drizzle_stmt_column_lookup(drizzle_result_st *result, const char *column_name, drizzle_return_t *ret_ptr);
 
+/* Drop the cached statements of a connection. COM_STMT_CLOSE is only sent
+   for them when server_close is set, otherwise the server has already
+   discarded them */
+void drizzle_stmt_cache_clear(drizzle_st *con, bool server_close);
+
+/* COM_STMT_EXECUTE packing shared with drizzle_stmt_execute_array() */
+drizzle_return_t drizzle_stmt_execute_size(drizzle_stmt_st *stmt,
+                                           bool *send_types,
+                                           size_t *buffer_size);
+
+unsigned char *drizzle_stmt_execute_pack(drizzle_stmt_st *stmt,
+                                         bool send_types,
+                                         unsigned char *buffer,
+                                         drizzle_return_t *ret_ptr);
+
+void drizzle_stmt_execute_sent(drizzle_stmt_st *stmt, bool send_types);
+
+drizzle_return_t drizzle_stmt_buffer_reserve(drizzle_stmt_st *stmt, size_t size);
+
+void drizzle_stmt_result_clear(drizzle_stmt_st *stmt);
+
+/* Run the state loop to completion, waiting for I/O in between when the
+   connection is non-blocking */
+drizzle_return_t drizzle_stmt_state_loop(drizzle_st *con);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,22 @@
   return DRIZZLE_RETURN_INVALID_ARGUMENT; } \
 while(0)
 
+/* Result values are decoded on demand from the row sent by the server, where
+   they are little endian and not necessarily aligned */
+static float _stmt_get_float(const drizzle_bind_st *param);
+static double _stmt_get_double(const drizzle_bind_st *param);
+static drizzle_return_t _stmt_get_int64(const drizzle_bind_st *param,
+                                        int64_t *val);
+
+/* Index of the column names of a result for drizzle_stmt_column_lookup() */
+static uint32_t _stmt_column_hash(const char *column_name);
+static drizzle_return_t _stmt_column_index_build(drizzle_result_st *result);
+
+/* Convert one column of the current row into its output binding */
+static drizzle_return_t _stmt_output_store_column(drizzle_stmt_st *stmt,
+                                                  uint16_t column_number,
+                                                  drizzle_output_bind_st *bind);
+
 /* Internal function */
 drizzle_return_t drizzle_stmt_set_param(drizzle_stmt_st *stmt, uint16_t param_num, drizzle_column_type_t type, const void *data, size_t length, bool is_unsigned)
 {
@@ -63,6 +79,8 @@ drizzle_return_t drizzle_stmt_set_param(drizzle_stmt_st *stmt, uint16_t param_nu
   stmt->query_params[param_num].data= (void*)data;
   stmt->query_params[param_num].length= length;
   stmt->query_params[param_num].options.is_unsigned= is_unsigned;
+  stmt->query_params[param_num].options.is_null= false;
+  stmt->query_params[param_num].array_data= NULL;
   stmt->query_params[param_num].is_bound= true;
 
   return DRIZZLE_RETURN_OK;
@@ -254,6 +272,7 @@ const char *drizzle_stmt_get_string(drizzle_stmt_st *stmt, uint16_t column_numbe
 {
   char *val;
   drizzle_bind_st *param;
+  drizzle_datetime_st datetime;
   if ((stmt == NULL) || (stmt->result_params == NULL) || (column_number >= stmt->execute_result->column_count))
   {
     *len= 0;
@@ -275,34 +294,38 @@ const char *drizzle_stmt_get_string(drizzle_stmt_st *stmt, uint16_t column_numbe
       break;
     case DRIZZLE_COLUMN_TYPE_SHORT:
     case DRIZZLE_COLUMN_TYPE_YEAR:
-      val= long_to_string(param, (uint32_t)(*(uint16_t*)param->data));
+      val= long_to_string(param, (uint32_t)drizzle_get_byte2(param->data));
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_INT24:
     case DRIZZLE_COLUMN_TYPE_LONG:
-      val= long_to_string(param, *(uint32_t*)param->data);
+      val= long_to_string(param, drizzle_get_byte4(param->data));
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_LONGLONG:
-      val= longlong_to_string(param, *(uint64_t*)param->data);
+      val= longlong_to_string(param, drizzle_get_byte8(param->data));
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_FLOAT:
-      val= double_to_string(param, (double) (*(float*)param->data));
+      val= double_to_string(param, (double) _stmt_get_float(param));
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_DOUBLE:
-      val= double_to_string(param, *(double*)param->data);
+      val= double_to_string(param, _stmt_get_double(param));
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_TIME:
-      val= time_to_string(param, (drizzle_datetime_st*)param->data);
+      drizzle_unpack_time((drizzle_field_t)param->data, param->length, &datetime,
+                          stmt->execute_result->column_buffer[column_number].decimals);
+      val= time_to_string(param, &datetime);
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_DATE:
     case DRIZZLE_COLUMN_TYPE_DATETIME:
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
-      val= timestamp_to_string(param, (drizzle_datetime_st*)param->data);
+      drizzle_unpack_datetime((drizzle_field_t)param->data, param->length, &datetime,
+                              stmt->execute_result->column_buffer[column_number].decimals);
+      val= timestamp_to_string(param, &datetime);
       *len= strlen(val);
       break;
     case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
@@ -324,6 +347,7 @@ const char *drizzle_stmt_get_string(drizzle_stmt_st *stmt, uint16_t column_numbe
     case DRIZZLE_COLUMN_TYPE_ENUM:
     case DRIZZLE_COLUMN_TYPE_SET:
     case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
 
     /* We do not need to support these three: they exist internally to the MySQL server, but do not appear on the wire */
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
@@ -378,14 +402,14 @@ uint32_t drizzle_stmt_get_int(drizzle_stmt_st *stmt, uint16_t column_number, dri
       break;
     case DRIZZLE_COLUMN_TYPE_SHORT:
     case DRIZZLE_COLUMN_TYPE_YEAR:
-      val= (uint32_t) (*(uint16_t*)param->data);
+      val= (uint32_t) drizzle_get_byte2(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_INT24:
     case DRIZZLE_COLUMN_TYPE_LONG:
-      val= (uint32_t) (*(uint32_t*)param->data);
+      val= (uint32_t) drizzle_get_byte4(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_LONGLONG:
-      val= (uint32_t) (*(uint64_t*)param->data);
+      val= (uint32_t) drizzle_get_byte8(param->data);
       if (val > UINT32_MAX)
       {
         *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
@@ -393,11 +417,11 @@ uint32_t drizzle_stmt_get_int(drizzle_stmt_st *stmt, uint16_t column_number, dri
       break;
     case DRIZZLE_COLUMN_TYPE_FLOAT:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (uint32_t) (*(float*)param->data);
+      val= (uint32_t) _stmt_get_float(param);
       break;
     case DRIZZLE_COLUMN_TYPE_DOUBLE:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (uint32_t) (*(double*)param->data);
+      val= (uint32_t) _stmt_get_double(param);
       break;
     case DRIZZLE_COLUMN_TYPE_TIME:
     case DRIZZLE_COLUMN_TYPE_DATE:
@@ -417,6 +441,7 @@ uint32_t drizzle_stmt_get_int(drizzle_stmt_st *stmt, uint16_t column_number, dri
     case DRIZZLE_COLUMN_TYPE_ENUM:
     case DRIZZLE_COLUMN_TYPE_SET:
     case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
     case DRIZZLE_COLUMN_TYPE_DATETIME2:
     case DRIZZLE_COLUMN_TYPE_TIME2:
@@ -468,22 +493,22 @@ uint64_t drizzle_stmt_get_bigint(drizzle_stmt_st *stmt, uint16_t column_number,
       break;
     case DRIZZLE_COLUMN_TYPE_SHORT:
     case DRIZZLE_COLUMN_TYPE_YEAR:
-      val= (uint64_t) (*(uint16_t*)param->data);
+      val= (uint64_t) drizzle_get_byte2(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_INT24:
     case DRIZZLE_COLUMN_TYPE_LONG:
-      val= (uint64_t) (*(uint32_t*)param->data);
+      val= (uint64_t) drizzle_get_byte4(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_LONGLONG:
-      val= (uint64_t) (*(uint64_t*)param->data);
+      val= (uint64_t) drizzle_get_byte8(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_FLOAT:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (uint64_t) (*(float*)param->data);
+      val= (uint64_t) _stmt_get_float(param);
       break;
     case DRIZZLE_COLUMN_TYPE_DOUBLE:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (uint64_t) (*(double*)param->data);
+      val= (uint64_t) _stmt_get_double(param);
       break;
     case DRIZZLE_COLUMN_TYPE_TIME:
     case DRIZZLE_COLUMN_TYPE_DATE:
@@ -503,6 +528,7 @@ uint64_t drizzle_stmt_get_bigint(drizzle_stmt_st *stmt, uint16_t column_number,
     case DRIZZLE_COLUMN_TYPE_ENUM:
     case DRIZZLE_COLUMN_TYPE_SET:
     case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
     case DRIZZLE_COLUMN_TYPE_DATETIME2:
     case DRIZZLE_COLUMN_TYPE_TIME2:
@@ -554,22 +580,22 @@ double drizzle_stmt_get_double(drizzle_stmt_st *stmt, uint16_t column_number, dr
     case DRIZZLE_COLUMN_TYPE_SHORT:
     case DRIZZLE_COLUMN_TYPE_YEAR:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (double) (*(uint16_t*)param->data);
+      val= (double) drizzle_get_byte2(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_INT24:
     case DRIZZLE_COLUMN_TYPE_LONG:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (double) (*(uint32_t*)param->data);
+      val= (double) drizzle_get_byte4(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_LONGLONG:
       *ret_ptr= DRIZZLE_RETURN_TRUNCATED;
-      val= (double) (*(uint64_t*)param->data);
+      val= (double) drizzle_get_byte8(param->data);
       break;
     case DRIZZLE_COLUMN_TYPE_FLOAT:
-      val= (double) (*(float*)param->data);
+      val= (double) _stmt_get_float(param);
       break;
     case DRIZZLE_COLUMN_TYPE_DOUBLE:
-      val= (*(double*)param->data);
+      val= _stmt_get_double(param);
       break;
     case DRIZZLE_COLUMN_TYPE_TIME:
     case DRIZZLE_COLUMN_TYPE_DATE:
@@ -589,6 +615,7 @@ double drizzle_stmt_get_double(drizzle_stmt_st *stmt, uint16_t column_number, dr
     case DRIZZLE_COLUMN_TYPE_ENUM:
     case DRIZZLE_COLUMN_TYPE_SET:
     case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
     case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
     case DRIZZLE_COLUMN_TYPE_DATETIME2:
     case DRIZZLE_COLUMN_TYPE_TIME2:
@@ -686,9 +713,20 @@ char *timestamp_to_string(drizzle_bind_st *param, drizzle_datetime_st *timestamp
 
 uint16_t drizzle_stmt_column_lookup(drizzle_result_st *result, const char *column_name, drizzle_return_t *ret_ptr)
 {
-  uint16_t current_column;
-  for (current_column= 0; current_column < result->column_count; current_column++)
+  uint32_t mask;
+  uint32_t slot;
+
+  if (result->column_index == NULL && _stmt_column_index_build(result) != DRIZZLE_RETURN_OK)
   {
+    *ret_ptr= DRIZZLE_RETURN_MEMORY;
+    return 0;
+  }
+
+  mask= result->column_index_size - 1;
+  for (slot= _stmt_column_hash(column_name) & mask;
+       result->column_index[slot] != 0; slot= (slot + 1) & mask)
+  {
+    uint16_t current_column= result->column_index[slot] - 1;
     if (strncmp(column_name, result->column_buffer[current_column].name, DRIZZLE_MAX_COLUMN_NAME_SIZE) == 0)
     {
       *ret_ptr= DRIZZLE_RETURN_OK;
@@ -698,3 +736,396 @@ uint16_t drizzle_stmt_column_lookup(drizzle_result_st *result, const char *colum
   *ret_ptr= DRIZZLE_RETURN_NOT_FOUND;
   return 0;
 }
+
+uint16_t drizzle_stmt_column_number(drizzle_stmt_st *stmt, const char *column_name, drizzle_return_t *ret_ptr)
+{
+  if ((stmt == NULL) || (stmt->prepare_result == NULL) || (column_name == NULL))
+  {
+    *ret_ptr= DRIZZLE_RETURN_INVALID_ARGUMENT;
+    return 0;
+  }
+
+  return drizzle_stmt_column_lookup(stmt->prepare_result, column_name, ret_ptr);
+}
+
+static uint32_t _stmt_column_hash(const char *column_name)
+{
+  /* 32 bit FNV-1a over the name as compared by drizzle_stmt_column_lookup() */
+  uint32_t hash= UINT32_C(2166136261);
+  for (size_t x= 0; x < DRIZZLE_MAX_COLUMN_NAME_SIZE && column_name[x] != '\0'; x++)
+  {
+    hash^= (uint8_t)column_name[x];
+    hash*= UINT32_C(16777619);
+  }
+
+  return hash;
+}
+
+static drizzle_return_t _stmt_column_index_build(drizzle_result_st *result)
+{
+  uint32_t size= 4;
+  uint32_t mask;
+  uint16_t current_column;
+
+  /* Keep the table at most half full so probe sequences stay short */
+  while (size < (uint32_t)result->column_count * 2)
+  {
+    size*= 2;
+  }
+
+  result->column_index= new (std::nothrow) uint16_t[size]();
+  if (result->column_index == NULL)
+  {
+    drizzle_set_error(result->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+    return DRIZZLE_RETURN_MEMORY;
+  }
+  result->column_index_size= size;
+  mask= size - 1;
+
+  for (current_column= 0; current_column < result->column_count; current_column++)
+  {
+    const char *name= result->column_buffer[current_column].name;
+    uint32_t slot= _stmt_column_hash(name) & mask;
+    bool duplicate= false;
+
+    while (result->column_index[slot] != 0)
+    {
+      /* The first of several columns with the same name wins */
+      if (strncmp(name, result->column_buffer[result->column_index[slot] - 1].name, DRIZZLE_MAX_COLUMN_NAME_SIZE) == 0)
+      {
+        duplicate= true;
+        break;
+      }
+      slot= (slot + 1) & mask;
+    }
+    if (!duplicate)
+    {
+      result->column_index[slot]= current_column + 1;
+    }
+  }
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_stmt_bind_result(drizzle_stmt_st *stmt,
+                                          uint16_t column_number,
+                                          drizzle_column_type_t type,
+                                          void *buffer, size_t buffer_length,
+                                          size_t *length, bool *is_null)
+{
+  uint16_t column_count;
+  size_t width= 0;
+
+  if (stmt == NULL)
+  {
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  column_count= drizzle_stmt_column_count(stmt);
+  if (column_number >= column_count)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "column %d does not exist", column_number);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (type == DRIZZLE_COLUMN_TYPE_TINY)
+  {
+    width= 1;
+  }
+  else if (type == DRIZZLE_COLUMN_TYPE_SHORT)
+  {
+    width= 2;
+  }
+  else if (type == DRIZZLE_COLUMN_TYPE_LONG || type == DRIZZLE_COLUMN_TYPE_FLOAT)
+  {
+    width= 4;
+  }
+  else if (type == DRIZZLE_COLUMN_TYPE_LONGLONG || type == DRIZZLE_COLUMN_TYPE_DOUBLE)
+  {
+    width= 8;
+  }
+  else if (type != DRIZZLE_COLUMN_TYPE_STRING &&
+           type != DRIZZLE_COLUMN_TYPE_VAR_STRING &&
+           type != DRIZZLE_COLUMN_TYPE_BLOB &&
+           type != DRIZZLE_COLUMN_TYPE_NONE)
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "cannot bind column %d to type %d", column_number, type);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (type != DRIZZLE_COLUMN_TYPE_NONE &&
+      (buffer == NULL || buffer_length < width))
+  {
+    drizzle_set_error(stmt->con, __FILE_LINE_FUNC__,
+                      "buffer of column %d is too small", column_number);
+    return DRIZZLE_RETURN_INVALID_ARGUMENT;
+  }
+
+  if (stmt->output_binds == NULL)
+  {
+    stmt->output_binds= new (std::nothrow) drizzle_output_bind_st[column_count];
+    if (stmt->output_binds == NULL)
+    {
+      drizzle_set_error(stmt->con, __FILE_LINE_FUNC__, "Failed to allocate.");
+      return DRIZZLE_RETURN_MEMORY;
+    }
+    stmt->output_bind_count= column_count;
+  }
+
+  drizzle_output_bind_st *bind= &stmt->output_binds[column_number];
+  bind->type= type;
+  bind->buffer= buffer;
+  bind->buffer_length= buffer_length;
+  bind->length= length;
+  bind->is_null= is_null;
+
+  return DRIZZLE_RETURN_OK;
+}
+
+drizzle_return_t drizzle_stmt_output_store(drizzle_stmt_st *stmt)
+{
+  drizzle_return_t ret= DRIZZLE_RETURN_OK;
+  drizzle_return_t column_ret;
+  uint16_t column_number;
+
+  for (column_number= 0; column_number < stmt->output_bind_count &&
+       column_number < stmt->execute_result->column_count; column_number++)
+  {
+    drizzle_output_bind_st *bind= &stmt->output_binds[column_number];
+    drizzle_bind_st *param= &stmt->result_params[column_number];
+
+    if (bind->type == DRIZZLE_COLUMN_TYPE_NONE)
+    {
+      continue;
+    }
+
+    if (bind->is_null != NULL)
+    {
+      *bind->is_null= param->options.is_null;
+    }
+    if (param->options.is_null)
+    {
+      if (bind->length != NULL)
+      {
+        *bind->length= 0;
+      }
+      continue;
+    }
+
+    column_ret= _stmt_output_store_column(stmt, column_number, bind);
+    if (column_ret != DRIZZLE_RETURN_OK)
+    {
+      /* A conversion error outweighs truncation in another column */
+      if (ret == DRIZZLE_RETURN_OK || column_ret != DRIZZLE_RETURN_TRUNCATED)
+      {
+        ret= column_ret;
+      }
+    }
+  }
+
+  return ret;
+}
+
+static float _stmt_get_float(const drizzle_bind_st *param)
+{
+  float val;
+  memcpy(&val, param->data, 4);
+  return val;
+}
+
+static double _stmt_get_double(const drizzle_bind_st *param)
+{
+  double val;
+  memcpy(&val, param->data, 8);
+  return val;
+}
+
+static drizzle_return_t _stmt_get_int64(const drizzle_bind_st *param,
+                                        int64_t *val)
+{
+  bool is_unsigned= param->options.is_unsigned;
+
+  switch(param->type)
+  {
+    case DRIZZLE_COLUMN_TYPE_TINY:
+      *val= is_unsigned ? (int64_t)*(uint8_t*)param->data
+                        : (int64_t)*(int8_t*)param->data;
+      return DRIZZLE_RETURN_OK;
+    case DRIZZLE_COLUMN_TYPE_SHORT:
+    case DRIZZLE_COLUMN_TYPE_YEAR:
+      *val= is_unsigned ? (int64_t)drizzle_get_byte2(param->data)
+                        : (int64_t)(int16_t)drizzle_get_byte2(param->data);
+      return DRIZZLE_RETURN_OK;
+    case DRIZZLE_COLUMN_TYPE_INT24:
+    case DRIZZLE_COLUMN_TYPE_LONG:
+      *val= is_unsigned ? (int64_t)drizzle_get_byte4(param->data)
+                        : (int64_t)(int32_t)drizzle_get_byte4(param->data);
+      return DRIZZLE_RETURN_OK;
+    case DRIZZLE_COLUMN_TYPE_LONGLONG:
+      *val= (int64_t)drizzle_get_byte8(param->data);
+      return DRIZZLE_RETURN_OK;
+    case DRIZZLE_COLUMN_TYPE_FLOAT:
+      *val= (int64_t)_stmt_get_float(param);
+      return DRIZZLE_RETURN_TRUNCATED;
+    case DRIZZLE_COLUMN_TYPE_DOUBLE:
+      *val= (int64_t)_stmt_get_double(param);
+      return DRIZZLE_RETURN_TRUNCATED;
+    case DRIZZLE_COLUMN_TYPE_NULL:
+    case DRIZZLE_COLUMN_TYPE_TIME:
+    case DRIZZLE_COLUMN_TYPE_DATE:
+    case DRIZZLE_COLUMN_TYPE_DATETIME:
+    case DRIZZLE_COLUMN_TYPE_TIMESTAMP:
+    case DRIZZLE_COLUMN_TYPE_TINY_BLOB:
+    case DRIZZLE_COLUMN_TYPE_MEDIUM_BLOB:
+    case DRIZZLE_COLUMN_TYPE_LONG_BLOB:
+    case DRIZZLE_COLUMN_TYPE_BLOB:
+    case DRIZZLE_COLUMN_TYPE_BIT:
+    case DRIZZLE_COLUMN_TYPE_STRING:
+    case DRIZZLE_COLUMN_TYPE_VAR_STRING:
+    case DRIZZLE_COLUMN_TYPE_DECIMAL:
+    case DRIZZLE_COLUMN_TYPE_NEWDECIMAL:
+    case DRIZZLE_COLUMN_TYPE_NEWDATE:
+    case DRIZZLE_COLUMN_TYPE_VARCHAR:
+    case DRIZZLE_COLUMN_TYPE_ENUM:
+    case DRIZZLE_COLUMN_TYPE_SET:
+    case DRIZZLE_COLUMN_TYPE_GEOMETRY:
+    case DRIZZLE_COLUMN_TYPE_JSON:
+    case DRIZZLE_COLUMN_TYPE_TIMESTAMP2:
+    case DRIZZLE_COLUMN_TYPE_DATETIME2:
+    case DRIZZLE_COLUMN_TYPE_TIME2:
+    default:
+      *val= 0;
+      return DRIZZLE_RETURN_INVALID_CONVERSION;
+  }
+}
+
+static drizzle_return_t _stmt_output_store_column(drizzle_stmt_st *stmt,
+                                                  uint16_t column_number,
+                                                  drizzle_output_bind_st *bind)
+{
+  drizzle_bind_st *param= &stmt->result_params[column_number];
+  drizzle_return_t ret;
+  int64_t int_val;
+  double double_val;
+  const char *string_val;
+  size_t length;
+  size_t width;
+
+  if (bind->type == DRIZZLE_COLUMN_TYPE_STRING ||
+      bind->type == DRIZZLE_COLUMN_TYPE_VAR_STRING ||
+      bind->type == DRIZZLE_COLUMN_TYPE_BLOB)
+  {
+    string_val= drizzle_stmt_get_string(stmt, column_number, &length, &ret);
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      return ret;
+    }
+    if (bind->length != NULL)
+    {
+      *bind->length= length;
+    }
+    if (length > bind->buffer_length)
+    {
+      memcpy(bind->buffer, string_val, bind->buffer_length);
+      return DRIZZLE_RETURN_TRUNCATED;
+    }
+    memcpy(bind->buffer, string_val, length);
+    return DRIZZLE_RETURN_OK;
+  }
+
+  if (bind->type == DRIZZLE_COLUMN_TYPE_FLOAT ||
+      bind->type == DRIZZLE_COLUMN_TYPE_DOUBLE)
+  {
+    ret= DRIZZLE_RETURN_OK;
+    if (param->type == DRIZZLE_COLUMN_TYPE_FLOAT)
+    {
+      double_val= _stmt_get_float(param);
+    }
+    else if (param->type == DRIZZLE_COLUMN_TYPE_DOUBLE)
+    {
+      double_val= _stmt_get_double(param);
+    }
+    else
+    {
+      ret= _stmt_get_int64(param, &int_val);
+      if (ret != DRIZZLE_RETURN_OK)
+      {
+        return ret;
+      }
+      if (param->type == DRIZZLE_COLUMN_TYPE_LONGLONG && param->options.is_unsigned)
+      {
+        double_val= (double)(uint64_t)int_val;
+      }
+      else
+      {
+        double_val= (double)int_val;
+      }
+    }
+
+    if (bind->type == DRIZZLE_COLUMN_TYPE_FLOAT)
+    {
+      float float_val= (float)double_val;
+      memcpy(bind->buffer, &float_val, 4);
+    }
+    else
+    {
+      memcpy(bind->buffer, &double_val, 8);
+    }
+    if (bind->length != NULL)
+    {
+      *bind->length= bind->type == DRIZZLE_COLUMN_TYPE_FLOAT ? 4 : 8;
+    }
+    return ret;
+  }
+
+  /* Integers are stored in host byte order at the width of the bound type */
+  ret= _stmt_get_int64(param, &int_val);
+  if (ret == DRIZZLE_RETURN_INVALID_CONVERSION)
+  {
+    return ret;
+  }
+
+  if (bind->type == DRIZZLE_COLUMN_TYPE_TINY)
+  {
+    uint8_t val= (uint8_t)int_val;
+    width= 1;
+    memcpy(bind->buffer, &val, width);
+    if (int_val < INT8_MIN || int_val > UINT8_MAX)
+    {
+      ret= DRIZZLE_RETURN_TRUNCATED;
+    }
+  }
+  else if (bind->type == DRIZZLE_COLUMN_TYPE_SHORT)
+  {
+    uint16_t val= (uint16_t)int_val;
+    width= 2;
+    memcpy(bind->buffer, &val, width);
+    if (int_val < INT16_MIN || int_val > UINT16_MAX)
+    {
+      ret= DRIZZLE_RETURN_TRUNCATED;
+    }
+  }
+  else if (bind->type == DRIZZLE_COLUMN_TYPE_LONG)
+  {
+    uint32_t val= (uint32_t)int_val;
+    width= 4;
+    memcpy(bind->buffer, &val, width);
+    if (int_val < INT32_MIN || int_val > UINT32_MAX)
+    {
+      ret= DRIZZLE_RETURN_TRUNCATED;
+    }
+  }
+  else
+  {
+    width= 8;
+    memcpy(bind->buffer, &int_val, width);
+  }
+  if (bind->length != NULL)
+  {
+    *bind->length= width;
+  }
+
+  return ret;
+}
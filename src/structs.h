@@ -110,6 +110,7 @@ enum drizzle_command_t
   DRIZZLE_COMMAND_STMT_FETCH,
   DRIZZLE_COMMAND_DAEMON,              /* Not used currently. */
   DRIZZLE_COMMAND_BINLOG_DUMP_GTID,
+  DRIZZLE_COMMAND_RESET_CONNECTION,
   DRIZZLE_COMMAND_END                  /* Not used currently. */
 };
 
@@ -117,6 +118,9 @@ enum drizzle_command_t
 typedef enum drizzle_command_t drizzle_command_t;
 #endif
 
+/* Defined in src/compress.h */
+struct drizzle_compression_st;
+
 
 /**
  * @ingroup drizzle_con
@@ -159,7 +163,12 @@ struct drizzle_options_st
   bool interactive;
   bool multi_statements;
   bool auth_plugin;
+  bool result_arena;
+  drizzle_compression_t compression;
+  uint32_t stmt_cache_size;
   drizzle_socket_owner_t socket_owner;
+  size_t buffer_size;       /* allocation the buffer starts and shrinks to */
+  size_t max_buffer_size;   /* largest allocation the buffer grows to */
   int wait_timeout;
   int keepidle;  // default value under linux: 7200
   int keepcnt;   // default value under linux: 75
@@ -172,7 +181,12 @@ struct drizzle_options_st
     interactive(false),
     multi_statements(false),
     auth_plugin(false),
+    result_arena(false),
+    compression(DRIZZLE_COMPRESSION_NONE),
+    stmt_cache_size(0),
     socket_owner(DRIZZLE_SOCKET_OWNER_NATIVE),
+    buffer_size(DRIZZLE_DEFAULT_BUFFER_SIZE),
+    max_buffer_size(DRIZZLE_MAX_BUFFER_SIZE),
     wait_timeout(DRIZZLE_DEFAULT_SOCKET_TIMEOUT),
     keepidle(7200),
     keepcnt(75),
@@ -180,6 +194,27 @@ struct drizzle_options_st
   { }
 };
 
+/**
+ * @ingroup drizzle_statement
+ * Prepared statements of a connection kept for reuse, keyed by SQL text.
+ */
+struct drizzle_stmt_cache_st
+{
+  drizzle_stmt_st **bucket_list;
+  uint32_t bucket_count;           /* power of two */
+  uint32_t count;
+  drizzle_stmt_st *lru_first;      /* most recently used */
+  drizzle_stmt_st *lru_last;
+
+  drizzle_stmt_cache_st() :
+    bucket_list(NULL),
+    bucket_count(0),
+    count(0),
+    lru_first(NULL),
+    lru_last(NULL)
+  { }
+};
+
 struct drizzle_st
 {
   struct flags_t{
@@ -202,12 +237,14 @@ struct drizzle_st
     bool no_result_read;
     bool io_ready;
     bool raw_packet;
+    bool packet_continues; /* payload goes on in the next packet */
 
     state_t() :
       ready(false),
       no_result_read(false),
       io_ready(false),
-      raw_packet(false)
+      raw_packet(false),
+      packet_continues(false)
     { }
   } state;
 
@@ -228,6 +265,8 @@ struct drizzle_st
   unsigned char *buffer_ptr;       /* cursor pointing into 'buffer' */
   unsigned char *command_buffer;
   unsigned char *command_data;
+  const unsigned char *write_data; /* caller data sent right after 'buffer' */
+  size_t write_data_size;
   void *context;
   drizzle_context_free_fn *context_free_fn;
   void *event_watch_context; /* context for custom callback function  */
@@ -262,11 +301,16 @@ struct drizzle_st
   int timeout;
   drizzle_log_fn *log_fn;
   void *log_context;
+  drizzle_infile_fn *infile_fn;
+  void *infile_context;
+  char *infile_name; /* file the server asked for, while it is being sent */
   pollfd_t pfds[1];
   char sqlstate[DRIZZLE_MAX_SQLSTATE_SIZE + 1];
   char last_error[DRIZZLE_MAX_ERROR_SIZE];
   drizzle_stmt_st *stmt;
+  drizzle_stmt_cache_st stmt_cache;
   drizzle_binlog_st *binlog;
+  drizzle_compression_st *compression; /* set while the compressed protocol is in use */
 private:
   size_t _state_stack_count;
   Packet *_state_stack_list;
@@ -298,6 +342,8 @@ public:
     addrinfo_next(NULL),
     command_buffer(NULL),
     command_data(NULL),
+    write_data(NULL),
+    write_data_size(0),
     context(NULL),
     context_free_fn(NULL),
     event_watch_context(NULL),
@@ -305,7 +351,7 @@ public:
     result(NULL),
     result_list(NULL),
     scramble(NULL),
-    buffer_allocation(DRIZZLE_DEFAULT_BUFFER_SIZE),
+    buffer_allocation(0),
     ssl_context(NULL),
     ssl(NULL),
     ssl_state(DRIZZLE_SSL_STATE_NONE),
@@ -315,8 +361,12 @@ public:
     timeout(-1),
     log_fn(NULL),
     log_context(NULL),
+    infile_fn(NULL),
+    infile_context(NULL),
+    infile_name(NULL),
     stmt(NULL),
     binlog(NULL),
+    compression(NULL),
     _state_stack_count(0),
     _state_stack_list(NULL),
     _free_packet_count(0),
@@ -328,8 +378,9 @@ public:
     user[0]= '\0';
     sqlstate[0]= '\0';
     last_error[0]= '\0';
-    buffer= (unsigned char*)malloc(DRIZZLE_DEFAULT_BUFFER_SIZE);
-    buffer_ptr= buffer;
+    /* Allocated with the size from the options once they are known */
+    buffer= NULL;
+    buffer_ptr= NULL;
 
     assert(DRIZZLE_STATE_STACK_SIZE);
     for (size_t x= 0; x < DRIZZLE_STATE_STACK_SIZE; ++x)
@@ -435,22 +486,157 @@ struct drizzle_binlog_event_st
   { }
 };
 
+/* The transactions of one server in a GTID set, as ranges [start, end) */
+struct drizzle_binlog_gtid_interval_st
+{
+  uint64_t start;
+  uint64_t end;
+};
+
+struct drizzle_binlog_gtid_sid_st
+{
+  unsigned char uuid[DRIZZLE_BINLOG_UUID_SIZE];
+  drizzle_binlog_gtid_interval_st *interval_list;
+  uint32_t interval_count;
+  uint32_t interval_size;
+  drizzle_binlog_gtid_sid_st() :
+    interval_list(NULL),
+    interval_count(0),
+    interval_size(0)
+  {
+    memset(uuid, 0, DRIZZLE_BINLOG_UUID_SIZE);
+  }
+};
+
+/* A GTID set, with the servers in the order they were first seen */
+struct drizzle_binlog_gtid_set_st
+{
+  drizzle_binlog_gtid_sid_st *sid_list;
+  uint32_t sid_count;
+  uint32_t sid_size;
+  drizzle_binlog_gtid_set_st() :
+    sid_list(NULL),
+    sid_count(0),
+    sid_size(0)
+  { }
+};
+
 struct drizzle_binlog_st
 {
   drizzle_binlog_fn *binlog_fn;
   drizzle_binlog_error_fn *error_fn;
   void *binlog_context;
   drizzle_binlog_event_st event;
+  drizzle_binlog_ring_st *ring;
   bool verify_checksums;
   bool has_checksums;
+  bool from_file;
   drizzle_st *con;
+  drizzle_binlog_gtid_set_st gtid_set;
+  bool gtid_pending;
+  unsigned char gtid_pending_uuid[DRIZZLE_BINLOG_UUID_SIZE];
+  uint64_t gtid_pending_gno;
+  uint64_t gtid_commit_gno;        /* committed by the current event, or 0 */
   drizzle_binlog_st() :
     binlog_fn(NULL),
     error_fn(NULL),
     binlog_context(NULL),
+    ring(NULL),
     verify_checksums(false),
     has_checksums(false),
-    con(NULL)
+    from_file(false),
+    con(NULL),
+    gtid_pending(false),
+    gtid_pending_gno(0),
+    gtid_commit_gno(0)
+  {
+    memset(gtid_pending_uuid, 0, DRIZZLE_BINLOG_UUID_SIZE);
+  }
+};
+
+struct drizzle_pipeline_st
+{
+  drizzle_st *con;
+  uint32_t window;
+  uint32_t in_flight;
+  uint32_t failed_count;
+  uint32_t packet_count;
+  uint32_t packet_list_size;
+  uint32_t send_count;
+  size_t send_offset;
+  size_t *packet_end_list;
+  unsigned char *buffer;
+  size_t buffer_size;
+  size_t buffer_allocation;
+  drizzle_return_t error;
+  bool reading;
+  drizzle_pipeline_st() :
+    con(NULL),
+    window(0),
+    in_flight(0),
+    failed_count(0),
+    packet_count(0),
+    packet_list_size(0),
+    send_count(0),
+    send_offset(0),
+    packet_end_list(NULL),
+    buffer(NULL),
+    buffer_size(0),
+    buffer_allocation(0),
+    error(DRIZZLE_RETURN_OK),
+    reading(false)
+  { }
+};
+
+struct drizzle_group_member_st
+{
+  drizzle_group_st *group;
+  drizzle_st *con;
+  drizzle_group_member_st *next;
+  drizzle_group_member_st *prev;
+  drizzle_group_member_st *ready_next;
+  drizzle_event_watch_fn *event_watch_fn;  /* restored on removal */
+  void *event_watch_context;
+  socket_t fd;                             /* socket registered for events */
+  bool non_blocking;                       /* restored on removal */
+  bool waiting;
+  bool ready;
+  drizzle_group_member_st() :
+    group(NULL),
+    con(NULL),
+    next(NULL),
+    prev(NULL),
+    ready_next(NULL),
+    event_watch_fn(NULL),
+    event_watch_context(NULL),
+    fd(INVALID_SOCKET),
+    non_blocking(false),
+    waiting(false),
+    ready(false)
+  { }
+};
+
+struct drizzle_group_st
+{
+  int epoll_fd;
+  uint32_t count;
+  uint32_t waiting_count;
+  drizzle_group_member_st *member_list;
+  drizzle_group_member_st *ready_list;
+  drizzle_group_member_st *ready_end;
+  pollfd_t *pfd_list;                      /* used without epoll */
+  drizzle_group_member_st **pfd_member_list;
+  uint32_t pfd_list_size;
+  drizzle_group_st() :
+    epoll_fd(-1),
+    count(0),
+    waiting_count(0),
+    member_list(NULL),
+    ready_list(NULL),
+    ready_end(NULL),
+    pfd_list(NULL),
+    pfd_member_list(NULL),
+    pfd_list_size(0)
   { }
 };
 
@@ -499,6 +685,23 @@ struct drizzle_column_st
   }
 };
 
+struct drizzle_output_bind_st
+{
+  drizzle_column_type_t type; /* DRIZZLE_COLUMN_TYPE_NONE when not bound */
+  void *buffer;
+  size_t buffer_length;
+  size_t *length;
+  bool *is_null;
+
+  drizzle_output_bind_st() :
+    type(DRIZZLE_COLUMN_TYPE_NONE),
+    buffer(NULL),
+    buffer_length(0),
+    length(NULL),
+    is_null(NULL)
+  { }
+};
+
 struct drizzle_stmt_st
 {
   drizzle_st *con;
@@ -507,12 +710,29 @@ struct drizzle_stmt_st
   uint16_t param_count;
   drizzle_bind_st *query_params;
   drizzle_bind_st *result_params;
+  drizzle_output_bind_st *output_binds; /* set by drizzle_stmt_bind_result() */
+  uint16_t output_bind_count;
   uint16_t null_bitmap_length;
   uint8_t *null_bitmap;
   bool new_bind;
   drizzle_result_st *prepare_result;
   drizzle_result_st *execute_result;
   drizzle_column_st *fields;
+  unsigned char *execute_buffer;   /* grows to the largest execute packet */
+  size_t execute_buffer_size;
+  uint32_t prefetch_rows;          /* rows per COM_STMT_FETCH, 0 for no cursor */
+  bool cursor_open;
+  bool cursor_fetching;            /* rows of a COM_STMT_FETCH left to read */
+  /* Statement cache entry, see drizzle_stmt_cache_st */
+  bool cached;
+  bool in_use;
+  uint64_t cache_hash;
+  char *cache_sql;
+  size_t cache_sql_size;
+  char cache_db[DRIZZLE_MAX_DB_SIZE]; /* default schema at prepare time */
+  drizzle_stmt_st *cache_next;     /* next in the hash bucket */
+  drizzle_stmt_st *lru_prev;
+  drizzle_stmt_st *lru_next;
 
   drizzle_stmt_st() :
     con(NULL),
@@ -521,13 +741,30 @@ struct drizzle_stmt_st
     param_count(0),
     query_params(NULL),
     result_params(NULL),
+    output_binds(NULL),
+    output_bind_count(0),
     null_bitmap_length(0),
     null_bitmap(NULL),
     new_bind(true),
     prepare_result(NULL),
     execute_result(NULL),
-    fields(NULL)
-  { }
+    fields(NULL),
+    execute_buffer(NULL),
+    execute_buffer_size(0),
+    prefetch_rows(0),
+    cursor_open(false),
+    cursor_fetching(false),
+    cached(false),
+    in_use(false),
+    cache_hash(0),
+    cache_sql(NULL),
+    cache_sql_size(0),
+    cache_next(NULL),
+    lru_prev(NULL),
+    lru_next(NULL)
+  {
+    cache_db[0]= '\0';
+  }
 };
 
 struct drizzle_bind_st
@@ -537,6 +774,10 @@ struct drizzle_bind_st
   char *data_buffer;
   size_t length;  /* amount of data in 'data' */
   bool is_bound;
+  uint16_t sent_type; /* type and unsigned flag the server knows */
+  const void *array_data; /* set by drizzle_stmt_set_array() */
+  const size_t *array_lengths;
+  const bool *array_nulls;
   struct options_t
   {
     bool is_null;
@@ -553,7 +794,11 @@ struct drizzle_bind_st
     type(DRIZZLE_COLUMN_TYPE_NONE),
     data(NULL),
     length(0),
-    is_bound(false)
+    is_bound(false),
+    sent_type(0),
+    array_data(NULL),
+    array_lengths(NULL),
+    array_nulls(NULL)
   {
     data_buffer= new (std::nothrow) char[128];
   }
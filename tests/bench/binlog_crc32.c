@@ -0,0 +1,140 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Benchmark of the binlog checksum. For events of 1KB, 8KB and 64KB it
+ * reports the throughput of zlib's crc32(), which the checksums used to be
+ * verified with, and of drizzle_binlog_crc32(), over the same buffer of
+ * events laid out back to back.
+ */
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+#define BENCH_BUFFER_SIZE (16 * 1024 * 1024)
+#define BENCH_BYTES (UINT64_C(2) * 1024 * 1024 * 1024)
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / (double)1000000000;
+}
+
+static uint32_t zlib_crc32(const unsigned char *data, size_t size)
+{
+  return (uint32_t)crc32(0, data, (uInt)size);
+}
+
+static uint32_t library_crc32(const unsigned char *data, size_t size)
+{
+  return drizzle_binlog_crc32(0, data, size);
+}
+
+/* Checksum every event of the buffer until BENCH_BYTES were processed */
+static double run(uint32_t (*fn)(const unsigned char *, size_t),
+                  const unsigned char *data, size_t event_size,
+                  uint32_t *sum)
+{
+  uint64_t bytes= 0;
+  double start;
+  size_t offset;
+
+  start= now();
+  while (bytes < BENCH_BYTES)
+  {
+    for (offset= 0; offset + event_size <= BENCH_BUFFER_SIZE;
+         offset+= event_size)
+    {
+      /* The checksum covers the event without its last 4 bytes */
+      *sum+= fn(data + offset, event_size - 4);
+    }
+    bytes+= BENCH_BUFFER_SIZE;
+  }
+
+  return (double)bytes / (now() - start) / (1024 * 1024 * 1024);
+}
+
+int main(int argc, char *argv[])
+{
+  static const size_t event_sizes[]= { 1024, 8 * 1024, 64 * 1024 };
+  unsigned char *data;
+  uint32_t zlib_sum= 0;
+  uint32_t library_sum= 0;
+  double zlib_rate;
+  double library_rate;
+  size_t x;
+
+  (void)argc;
+  (void)argv;
+
+  data= malloc(BENCH_BUFFER_SIZE);
+  if (data == NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  for (x= 0; x < BENCH_BUFFER_SIZE; x++)
+  {
+    data[x]= (unsigned char)((x * 2654435761u) >> 13);
+  }
+
+  for (x= 0; x < sizeof(event_sizes) / sizeof(event_sizes[0]); x++)
+  {
+    zlib_rate= run(zlib_crc32, data, event_sizes[x], &zlib_sum);
+    library_rate= run(library_crc32, data, event_sizes[x], &library_sum);
+    printf("%6zu byte events: zlib %6.2f GB/s, drizzle_binlog_crc32 %6.2f GB/s"
+           " (%4.1fx)\n", event_sizes[x], zlib_rate, library_rate,
+           library_rate / zlib_rate);
+  }
+
+  free(data);
+
+  /* Both went over the same events */
+  if (zlib_sum != library_sum)
+  {
+    printf("checksums differ\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,542 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Micro benchmark for decoding row based binlog events. A server thread on
+ * the loopback interface streams a recorded set of TABLE_MAP and
+ * WRITE_ROWS events, which are kept in a binlog ring and then decoded
+ * repeatedly, once only splitting the rows and once reading every value.
+ */
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define BENCH_EVENT_PAIRS 1000
+#define BENCH_EVENT_ROWS 100
+#define BENCH_COLUMNS 8
+#define BENCH_RING_DATA (32 * 1024 * 1024)
+#define BENCH_ITERATIONS 20
+
+typedef struct
+{
+  unsigned char *data;
+  size_t size;
+  size_t allocation;
+  uint8_t sequence;
+} bench_buffer_st;
+
+/* INT, BIGINT, VARCHAR(64), DECIMAL(10,2), DATETIME, DOUBLE, INT NULL, BLOB */
+static const unsigned char column_types[BENCH_COLUMNS]= { 3, 8, 15, 246, 18,
+                                                          5, 3, 252 };
+static const unsigned char column_meta[]= { 64, 0, 10, 2, 0, 8, 2 };
+
+static void buffer_append(bench_buffer_st *buffer, const void *data,
+                          size_t size)
+{
+  if (buffer->size + size > buffer->allocation)
+  {
+    while (buffer->size + size > buffer->allocation)
+    {
+      buffer->allocation= buffer->allocation ? buffer->allocation * 2 : 4096;
+    }
+    buffer->data= realloc(buffer->data, buffer->allocation);
+    if (buffer->data == NULL)
+    {
+      abort();
+    }
+  }
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size+= size;
+}
+
+static void buffer_packet(bench_buffer_st *buffer, const unsigned char *payload,
+                          size_t size)
+{
+  unsigned char header[4];
+  header[0]= (unsigned char)(size & 0xFF);
+  header[1]= (unsigned char)((size >> 8) & 0xFF);
+  header[2]= (unsigned char)((size >> 16) & 0xFF);
+  header[3]= buffer->sequence++;
+  buffer_append(buffer, header, 4);
+  buffer_append(buffer, payload, size);
+}
+
+static void put_le(unsigned char *ptr, uint64_t value, size_t size)
+{
+  size_t x;
+  for (x= 0; x < size; x++)
+  {
+    ptr[x]= (unsigned char)(value >> (8 * x));
+  }
+}
+
+static void put_be(unsigned char *ptr, uint64_t value, size_t size)
+{
+  size_t x;
+  for (x= 0; x < size; x++)
+  {
+    ptr[x]= (unsigned char)(value >> (8 * (size - x - 1)));
+  }
+}
+
+/* Wraps an event body into a packet with the OK byte and event header */
+static void buffer_event(bench_buffer_st *buffer, unsigned char *payload,
+                         size_t body_size, unsigned char type,
+                         uint32_t *position)
+{
+  uint32_t event_size= (uint32_t)(19 + body_size);
+  *position+= event_size;
+  payload[0]= 0;
+  put_le(payload + 1, 1500000000, 4);
+  payload[5]= type;
+  put_le(payload + 6, 1, 4);
+  put_le(payload + 10, event_size, 4);
+  put_le(payload + 14, *position, 4);
+  put_le(payload + 18, 0, 2);
+  buffer_packet(buffer, payload, 1 + event_size);
+}
+
+static size_t build_table_map(unsigned char *ptr)
+{
+  unsigned char *start= ptr;
+
+  put_le(ptr, 42, 6); ptr+= 6;
+  put_le(ptr, 1, 2); ptr+= 2;
+  *ptr++= 5; memcpy(ptr, "bench", 6); ptr+= 6;
+  *ptr++= 2; memcpy(ptr, "t1", 3); ptr+= 3;
+  *ptr++= BENCH_COLUMNS;
+  memcpy(ptr, column_types, BENCH_COLUMNS); ptr+= BENCH_COLUMNS;
+  *ptr++= sizeof(column_meta);
+  memcpy(ptr, column_meta, sizeof(column_meta)); ptr+= sizeof(column_meta);
+  *ptr++= 0xC0;                                   /* nullable */
+
+  return (size_t)(ptr - start);
+}
+
+static size_t build_write_rows(unsigned char *ptr, uint64_t first_row)
+{
+  unsigned char *start= ptr;
+  uint64_t row;
+
+  put_le(ptr, 42, 6); ptr+= 6;
+  put_le(ptr, 1, 2); ptr+= 2;
+  put_le(ptr, 2, 2); ptr+= 2;                     /* extra data */
+  *ptr++= BENCH_COLUMNS;
+  *ptr++= 0xFF;                                   /* present */
+
+  for (row= first_row; row < first_row + BENCH_EVENT_ROWS; row++)
+  {
+    char text[64];
+    size_t size;
+    double real= (double)row / 4;
+
+    *ptr++= (row % 3) ? 0x00 : 0x40;              /* NULL bitmap */
+    put_le(ptr, row, 4); ptr+= 4;
+    put_le(ptr, row * 1000003, 8); ptr+= 8;
+    size= (size_t)snprintf(text, sizeof(text), "customer-%" PRIu64, row);
+    *ptr++= (unsigned char)size; memcpy(ptr, text, size); ptr+= size;
+    /* DECIMAL(10,2): 8 integer digits in 4 bytes, 2 fraction digits in 1 */
+    put_be(ptr, (row % 100000) | UINT64_C(0x80000000), 4); ptr+= 4;
+    *ptr++= (unsigned char)(row % 100);
+    put_be(ptr, (((((UINT64_C(2017) * 13 + 3) << 5) | 4) << 17) |
+                (row % 86400 / 3600) << 12 | (row % 60) << 6 | (row % 60)) +
+                UINT64_C(0x8000000000), 5); ptr+= 5;
+    memcpy(ptr, &real, 8); ptr+= 8;
+    if (row % 3)
+    {
+      put_le(ptr, row * 7, 4); ptr+= 4;
+    }
+    put_le(ptr, 16, 2); ptr+= 2;
+    memset(ptr, 'b', 16); ptr+= 16;
+  }
+
+  return (size_t)(ptr - start);
+}
+
+static void build_stream(bench_buffer_st *buffer)
+{
+  unsigned char *payload= malloc(64 * 1024);
+  uint32_t position= 4;
+  uint64_t pair;
+
+  if (payload == NULL)
+  {
+    abort();
+  }
+
+  buffer->size= 0;
+  buffer->sequence= 1;
+
+  /* Servers start with an artificial ROTATE event, which is read as the
+     result of the command */
+  put_le(payload + 20, 4, 8);
+  memcpy(payload + 28, "bench-bin.000001", 16);
+  buffer_event(buffer, payload, 24, 4, &position);
+  position= 4;
+
+  for (pair= 0; pair < BENCH_EVENT_PAIRS; pair++)
+  {
+    buffer_event(buffer, payload, build_table_map(payload + 20), 19, &position);
+    buffer_event(buffer, payload,
+                 build_write_rows(payload + 20, pair * BENCH_EVENT_ROWS), 30,
+                 &position);
+  }
+
+  payload[0]= 0xFE; payload[1]= 0; payload[2]= 0; payload[3]= 2; payload[4]= 0;
+  buffer_packet(buffer, payload, 5);
+  free(payload);
+}
+
+static int read_packet(int fd, unsigned char *payload, size_t max_size)
+{
+  unsigned char header[4];
+  size_t size;
+  size_t done= 0;
+  ssize_t ret;
+
+  while (done < 4)
+  {
+    ret= recv(fd, header + done, 4 - done, 0);
+    if (ret <= 0)
+      return -1;
+    done+= (size_t)ret;
+  }
+
+  size= header[0] | (header[1] << 8) | (header[2] << 16);
+  if (size > max_size)
+    return -1;
+
+  done= 0;
+  while (done < size)
+  {
+    ret= recv(fd, payload + done, size - done, 0);
+    if (ret <= 0)
+      return -1;
+    done+= (size_t)ret;
+  }
+
+  return payload[0];
+}
+
+static int send_all(int fd, const unsigned char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t ret= send(fd, data, size, 0);
+    if (ret <= 0)
+      return -1;
+    data+= ret;
+    size-= (size_t)ret;
+  }
+  return 0;
+}
+
+static void send_ok(int fd, uint8_t sequence)
+{
+  bench_buffer_st ok= { NULL, 0, 0, 0 };
+  unsigned char payload[7];
+
+  ok.sequence= sequence;
+  memset(payload, 0, 7);
+  payload[3]= 2;
+  buffer_packet(&ok, payload, 7);
+  send_all(fd, ok.data, ok.size);
+  free(ok.data);
+}
+
+static void *server_thread(void *context)
+{
+  int listen_fd= *(int *)context;
+  bench_buffer_st handshake= { NULL, 0, 0, 0 };
+  bench_buffer_st stream= { NULL, 0, 0, 1 };
+  unsigned char payload[4096];
+  unsigned char *ptr= payload;
+  int command= 0;
+  int fd;
+
+  *ptr++= 10;
+  memcpy(ptr, "5.7.0-bench", 12); ptr+= 12;
+  *ptr++= 1; *ptr++= 0; *ptr++= 0; *ptr++= 0;
+  memcpy(ptr, "abcdefgh", 8); ptr+= 8;
+  *ptr++= 0;
+  *ptr++= 0xFF; *ptr++= 0xF7;
+  *ptr++= 33;
+  *ptr++= 2; *ptr++= 0;
+  *ptr++= 0x0F; *ptr++= 0x80;
+  *ptr++= 21;
+  memset(ptr, 0, 10); ptr+= 10;
+  memcpy(ptr, "ijklmnopqrst", 13); ptr+= 13;
+  memcpy(ptr, "mysql_native_password", 22); ptr+= 22;
+  buffer_packet(&handshake, payload, (size_t)(ptr - payload));
+
+  build_stream(&stream);
+
+  /* The client closes the connection at the end of the stream, so
+     drizzle_quit() comes in on a new one */
+  while (command != 0x01 && (fd= accept(listen_fd, NULL, NULL)) >= 0)
+  {
+    send_all(fd, handshake.data, handshake.size);
+    if (read_packet(fd, payload, sizeof(payload)) >= 0)
+    {
+      send_ok(fd, 2);
+      while ((command= read_packet(fd, payload, sizeof(payload))) >= 0)
+      {
+        if (command == 0x03)                       /* COM_QUERY */
+        {
+          send_ok(fd, 1);
+        }
+        else if (command == 0x12)                  /* COM_BINLOG_DUMP */
+        {
+          send_all(fd, stream.data, stream.size);
+        }
+        else
+        {
+          break;
+        }
+      }
+    }
+    close(fd);
+  }
+
+  free(handshake.data);
+  free(stream.data);
+  return NULL;
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  (void)event;
+  (void)context;
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)ret;
+  (void)connection;
+  (void)context;
+}
+
+static double now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / (double)1000000;
+}
+
+static uint64_t decode(drizzle_binlog_rows_st *rows,
+                       drizzle_binlog_event_st **event_list,
+                       uint32_t event_count, int read_values,
+                       uint64_t *checksum)
+{
+  drizzle_return_t ret;
+  uint64_t row_count= 0;
+  uint32_t event;
+  uint32_t column;
+
+  for (event= 0; event < event_count; event++)
+  {
+    if (drizzle_binlog_rows_decode(rows, event_list[event]) != DRIZZLE_RETURN_OK)
+    {
+      return 0;
+    }
+
+    while (drizzle_binlog_rows_next(rows) == DRIZZLE_RETURN_OK)
+    {
+      row_count++;
+      if (!read_values)
+      {
+        continue;
+      }
+
+      for (column= 0; column < BENCH_COLUMNS; column++)
+      {
+        size_t size;
+        switch (column_types[column])
+        {
+        case DRIZZLE_COLUMN_TYPE_LONG:
+        case DRIZZLE_COLUMN_TYPE_LONGLONG:
+          *checksum+= (uint64_t)drizzle_binlog_rows_get_int(rows,
+            DRIZZLE_BINLOG_IMAGE_AFTER, column, &ret);
+          break;
+        case DRIZZLE_COLUMN_TYPE_DOUBLE:
+          {
+            double real= drizzle_binlog_rows_get_double(rows,
+              DRIZZLE_BINLOG_IMAGE_AFTER, column, &ret);
+            *checksum+= (uint64_t)real;
+          }
+          break;
+        default:
+          drizzle_binlog_rows_get_string(rows, DRIZZLE_BINLOG_IMAGE_AFTER,
+                                         column, &size, &ret);
+          *checksum+= size;
+          break;
+        }
+      }
+    }
+  }
+
+  return row_count;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_binlog_event_st **event_list;
+  drizzle_binlog_ring_st *ring;
+  drizzle_binlog_rows_st *rows;
+  drizzle_binlog_st *binlog;
+  drizzle_options_st *opts;
+  struct sockaddr_in addr;
+  socklen_t addr_size= sizeof(addr);
+  pthread_t thread;
+  drizzle_return_t ret;
+  uint32_t event_count;
+  uint64_t event_bytes= 0;
+  uint32_t x;
+  int listen_fd;
+  int method;
+
+  listen_fd= socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family= AF_INET;
+  addr.sin_addr.s_addr= htonl(INADDR_LOOPBACK);
+  if (listen_fd < 0 ||
+      bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(listen_fd, 1) != 0 ||
+      getsockname(listen_fd, (struct sockaddr *)&addr, &addr_size) != 0)
+  {
+    perror("listen");
+    return EXIT_FAILURE;
+  }
+
+  pthread_create(&thread, NULL, server_thread, &listen_fd);
+
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  drizzle_st *con= drizzle_create("127.0.0.1", ntohs(addr.sin_port), "bench",
+                                  "", "", opts);
+  ret= drizzle_connect(con);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    printf("drizzle_connect(): %s\n", drizzle_error(con));
+    return EXIT_FAILURE;
+  }
+
+  /* The ring holds the whole stream, so nothing has to consume it while the
+     events are recorded */
+  ring= drizzle_binlog_ring_create(BENCH_EVENT_PAIRS * 2, BENCH_RING_DATA, 64);
+  event_list= malloc(sizeof(drizzle_binlog_event_st *) * BENCH_EVENT_PAIRS * 2);
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, NULL, false);
+  if (ring == NULL || event_list == NULL || binlog == NULL ||
+      drizzle_binlog_set_ring(binlog, ring) != DRIZZLE_RETURN_OK)
+  {
+    printf("could not set up the binlog ring\n");
+    return EXIT_FAILURE;
+  }
+
+  ret= drizzle_binlog_start(binlog, 0, "bench-bin.000001", 4);
+  if (ret != DRIZZLE_RETURN_EOF)
+  {
+    printf("drizzle_binlog_start(): %s\n", drizzle_strerror(ret));
+    return EXIT_FAILURE;
+  }
+
+  event_count= drizzle_binlog_ring_read(ring, event_list,
+                                        BENCH_EVENT_PAIRS * 2, &ret);
+  if (event_count != BENCH_EVENT_PAIRS * 2)
+  {
+    printf("recorded %u events: %s\n", event_count, drizzle_strerror(ret));
+    return EXIT_FAILURE;
+  }
+  for (x= 0; x < event_count; x++)
+  {
+    event_bytes+= drizzle_binlog_event_raw_length(event_list[x]);
+  }
+
+  rows= drizzle_binlog_rows_create();
+  for (method= 0; method < 2; method++)
+  {
+    static const char *names[]= { "split rows", "read every value" };
+    uint64_t row_count= 0;
+    uint64_t checksum= 0;
+    double start;
+    double elapsed;
+    int iteration;
+
+    start= now();
+    for (iteration= 0; iteration < BENCH_ITERATIONS; iteration++)
+    {
+      row_count+= decode(rows, event_list, event_count, method, &checksum);
+    }
+    elapsed= now() - start;
+
+    if (row_count != (uint64_t)BENCH_ITERATIONS * BENCH_EVENT_PAIRS *
+                     BENCH_EVENT_ROWS)
+    {
+      printf("decoded %" PRIu64 " rows\n", row_count);
+      return EXIT_FAILURE;
+    }
+
+    printf("%-18s %12.0f rows/sec %8.1f MB/sec (%" PRIu64 ")\n", names[method],
+           (double)row_count / elapsed,
+           (double)event_bytes * BENCH_ITERATIONS / elapsed / (1024 * 1024),
+           checksum);
+  }
+
+  drizzle_binlog_rows_free(rows);
+  drizzle_binlog_ring_release(ring, event_count);
+  drizzle_quit(con);
+  drizzle_options_destroy(opts);
+  drizzle_binlog_ring_free(ring);
+  free(event_list);
+  pthread_join(thread, NULL);
+  close(listen_fd);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,490 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Benchmark of the compressed protocol. A server thread on the loopback
+ * interface answers every query with the same pre-built result set, sent
+ * either as it is or in zlib frames compressed up front. For a table of
+ * typical mixed columns and one of integers only it reports the bytes sent
+ * over the wire and the client CPU time spent per MB of result data.
+ */
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define BENCH_RESULT_BYTES (4 * 1024 * 1024)
+#define BENCH_FRAME_SIZE (16 * 1024)
+#define BENCH_ITERATIONS 10
+
+typedef struct
+{
+  unsigned char *data;
+  size_t size;
+  size_t allocation;
+  uint8_t sequence;
+} bench_buffer_st;
+
+typedef struct
+{
+  int listen_fd;
+  int table;
+  uint64_t result_bytes;
+  uint64_t wire_bytes;
+} bench_server_st;
+
+static void buffer_append(bench_buffer_st *buffer, const void *data,
+                          size_t size)
+{
+  if (buffer->size + size > buffer->allocation)
+  {
+    while (buffer->size + size > buffer->allocation)
+    {
+      buffer->allocation= buffer->allocation ? buffer->allocation * 2 : 4096;
+    }
+    buffer->data= realloc(buffer->data, buffer->allocation);
+    if (buffer->data == NULL)
+    {
+      abort();
+    }
+  }
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size+= size;
+}
+
+static void buffer_packet(bench_buffer_st *buffer, const unsigned char *payload,
+                          size_t size)
+{
+  unsigned char header[4];
+  header[0]= (unsigned char)(size & 0xFF);
+  header[1]= (unsigned char)((size >> 8) & 0xFF);
+  header[2]= (unsigned char)((size >> 16) & 0xFF);
+  header[3]= buffer->sequence++;
+  buffer_append(buffer, header, 4);
+  buffer_append(buffer, payload, size);
+}
+
+static size_t pack_string(unsigned char *ptr, const char *string)
+{
+  size_t size= strlen(string);
+  ptr[0]= (unsigned char)size;
+  memcpy(ptr + 1, string, size);
+  return size + 1;
+}
+
+/*
+ * Wrap a packet stream in compressed protocol frames, as a server flushing
+ * its 16KiB network buffer would.
+ */
+static void buffer_compress(bench_buffer_st *frames, const bench_buffer_st *packets)
+{
+  unsigned char *compressed= malloc(compressBound(BENCH_FRAME_SIZE));
+  unsigned char header[7];
+  size_t offset;
+
+  frames->size= 0;
+  frames->sequence= 1;
+
+  for (offset= 0; offset < packets->size; offset+= BENCH_FRAME_SIZE)
+  {
+    size_t size= packets->size - offset;
+    uLongf compressed_size= compressBound(BENCH_FRAME_SIZE);
+
+    if (size > BENCH_FRAME_SIZE)
+    {
+      size= BENCH_FRAME_SIZE;
+    }
+
+    if (compress(compressed, &compressed_size, packets->data + offset,
+                 (uLong)size) != Z_OK)
+    {
+      abort();
+    }
+
+    header[0]= (unsigned char)(compressed_size & 0xFF);
+    header[1]= (unsigned char)((compressed_size >> 8) & 0xFF);
+    header[2]= (unsigned char)((compressed_size >> 16) & 0xFF);
+    header[3]= frames->sequence++;
+    header[4]= (unsigned char)(size & 0xFF);
+    header[5]= (unsigned char)((size >> 8) & 0xFF);
+    header[6]= (unsigned char)((size >> 16) & 0xFF);
+    buffer_append(frames, header, 7);
+    buffer_append(frames, compressed, compressed_size);
+  }
+
+  free(compressed);
+}
+
+static const char *names[]= { "Smith", "Jones", "Taylor", "Brown", "Williams",
+                              "Wilson", "Johnson", "Davies", "Robinson" };
+static const char *states[]= { "active", "pending", "closed" };
+
+/*
+ * Table 0 looks like a typical application table: ids, timestamps, names,
+ * e-mail addresses, a status and an amount. Table 1 holds integers only.
+ */
+static size_t build_row(unsigned char *ptr, int table, uint64_t row)
+{
+  unsigned char *start= ptr;
+  char value[64];
+  int column;
+
+  if (table == 1)
+  {
+    for (column= 0; column < 10; column++)
+    {
+      snprintf(value, sizeof(value), "%" PRIu64,
+               (row * 2654435761u + (uint64_t)column * 40503u) % 100000000);
+      ptr+= pack_string(ptr, value);
+    }
+    return (size_t)(ptr - start);
+  }
+
+  snprintf(value, sizeof(value), "%" PRIu64, row + 1);
+  ptr+= pack_string(ptr, value);
+  snprintf(value, sizeof(value), "%" PRIu64, (row * 7919) % 5000);
+  ptr+= pack_string(ptr, value);
+  snprintf(value, sizeof(value), "2016-%02u-%02u %02u:%02u:%02u",
+           (unsigned)(row / 40000 % 12 + 1), (unsigned)(row / 1500 % 28 + 1),
+           (unsigned)(row / 60 % 24), (unsigned)(row % 60),
+           (unsigned)(row * 13 % 60));
+  ptr+= pack_string(ptr, value);
+  ptr+= pack_string(ptr, names[row % 9]);
+  snprintf(value, sizeof(value), "%s.%" PRIu64 "@example.com",
+           names[(row / 9) % 9], row % 1000);
+  ptr+= pack_string(ptr, value);
+  ptr+= pack_string(ptr, states[(row * 31) % 3]);
+  snprintf(value, sizeof(value), "%" PRIu64 ".%02u", (row * 104729) % 10000,
+           (unsigned)(row % 100));
+  ptr+= pack_string(ptr, value);
+  if (row % 5 == 0)
+  {
+    *ptr++= 0xFB;
+  }
+  else
+  {
+    ptr+= pack_string(ptr, "order shipped to customer");
+  }
+
+  return (size_t)(ptr - start);
+}
+
+static void build_result(bench_buffer_st *buffer, int table)
+{
+  unsigned char payload[1024];
+  unsigned char *ptr;
+  uint16_t column_count= table == 1 ? 10 : 8;
+  char name[16];
+  uint64_t row;
+  uint16_t column;
+
+  buffer->size= 0;
+  buffer->sequence= 1;
+
+  payload[0]= (unsigned char)column_count;
+  buffer_packet(buffer, payload, 1);
+
+  for (column= 0; column < column_count; column++)
+  {
+    snprintf(name, sizeof(name), "c%u", column);
+    ptr= payload;
+    ptr+= pack_string(ptr, "def");
+    ptr+= pack_string(ptr, "bench");
+    ptr+= pack_string(ptr, "t1");
+    ptr+= pack_string(ptr, "t1");
+    ptr+= pack_string(ptr, name);
+    ptr+= pack_string(ptr, name);
+    *ptr++= 0x0c;
+    *ptr++= 33; *ptr++= 0;                          /* charset */
+    *ptr++= 255; *ptr++= 0; *ptr++= 0; *ptr++= 0;   /* length */
+    *ptr++= DRIZZLE_COLUMN_TYPE_VAR_STRING;
+    *ptr++= 0; *ptr++= 0;                           /* flags */
+    *ptr++= 0;                                      /* decimals */
+    *ptr++= 0; *ptr++= 0;
+    buffer_packet(buffer, payload, (size_t)(ptr - payload));
+  }
+
+  payload[0]= 0xFE; payload[1]= 0; payload[2]= 0; payload[3]= 2; payload[4]= 0;
+  buffer_packet(buffer, payload, 5);
+
+  for (row= 0; buffer->size < BENCH_RESULT_BYTES; row++)
+  {
+    buffer_packet(buffer, payload, build_row(payload, table, row));
+  }
+
+  payload[0]= 0xFE; payload[1]= 0; payload[2]= 0; payload[3]= 2; payload[4]= 0;
+  buffer_packet(buffer, payload, 5);
+}
+
+static int recv_all(int fd, unsigned char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t ret= recv(fd, data, size, 0);
+    if (ret <= 0)
+      return -1;
+    data+= ret;
+    size-= (size_t)ret;
+  }
+  return 0;
+}
+
+static int send_all(int fd, const unsigned char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t ret= send(fd, data, size, 0);
+    if (ret <= 0)
+      return -1;
+    data+= ret;
+    size-= (size_t)ret;
+  }
+  return 0;
+}
+
+/*
+ * Read one packet, unwrapping it from its frame when compressed is set.
+ * The client sends short commands uncompressed, one per frame.
+ */
+static int read_packet(int fd, unsigned char *payload, size_t max_size,
+                       int compressed)
+{
+  unsigned char header[7];
+  size_t size;
+
+  if (compressed)
+  {
+    if (recv_all(fd, header, 7) < 0 || header[4] || header[5] || header[6])
+      return -1;
+  }
+
+  if (recv_all(fd, header, 4) < 0)
+    return -1;
+
+  size= header[0] | (header[1] << 8) | (header[2] << 16);
+  if (size > max_size || recv_all(fd, payload, size) < 0)
+    return -1;
+
+  return payload[0];
+}
+
+static void *server_thread(void *context)
+{
+  bench_server_st *server= (bench_server_st *)context;
+  bench_buffer_st handshake= { NULL, 0, 0, 0 };
+  bench_buffer_st ok= { NULL, 0, 0, 2 };
+  bench_buffer_st result= { NULL, 0, 0, 1 };
+  bench_buffer_st frames= { NULL, 0, 0, 1 };
+  bench_buffer_st *reply= &result;
+  unsigned char payload[4096];
+  unsigned char *ptr= payload;
+  int compressed;
+  int fd;
+
+  fd= accept(server->listen_fd, NULL, NULL);
+  if (fd < 0)
+    return NULL;
+
+  *ptr++= 10;
+  memcpy(ptr, "5.7.0-bench", 12); ptr+= 12;
+  *ptr++= 1; *ptr++= 0; *ptr++= 0; *ptr++= 0;
+  memcpy(ptr, "abcdefgh", 8); ptr+= 8;
+  *ptr++= 0;
+  *ptr++= 0xFF; *ptr++= 0xF7;                       /* includes COMPRESS */
+  *ptr++= 33;
+  *ptr++= 2; *ptr++= 0;
+  *ptr++= 0x0F; *ptr++= 0x80;
+  *ptr++= 21;
+  memset(ptr, 0, 10); ptr+= 10;
+  memcpy(ptr, "ijklmnopqrst", 13); ptr+= 13;
+  memcpy(ptr, "mysql_native_password", 22); ptr+= 22;
+  buffer_packet(&handshake, payload, (size_t)(ptr - payload));
+  send_all(fd, handshake.data, handshake.size);
+
+  if (read_packet(fd, payload, sizeof(payload), 0) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  compressed= (payload[0] & DRIZZLE_CAPABILITIES_COMPRESS) != 0;
+
+  memset(payload, 0, 7);
+  payload[3]= 2;
+  buffer_packet(&ok, payload, 7);
+  send_all(fd, ok.data, ok.size);
+
+  build_result(&result, server->table);
+  server->result_bytes= result.size;
+  if (compressed)
+  {
+    buffer_compress(&frames, &result);
+    reply= &frames;
+  }
+
+  while (read_packet(fd, payload, sizeof(payload), compressed) == 0x03)  /* COM_QUERY */
+  {
+    if (send_all(fd, reply->data, reply->size) < 0)
+      break;
+    server->wire_bytes+= reply->size;
+  }
+
+  close(fd);
+  free(handshake.data);
+  free(ok.data);
+  free(result.data);
+  free(frames.data);
+  return NULL;
+}
+
+static double cpu_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / (double)1000000000;
+}
+
+static int run(int table, drizzle_compression_t compression)
+{
+  static const char *table_names[]= { "mixed", "integers" };
+  bench_server_st server;
+  struct sockaddr_in addr;
+  socklen_t addr_size= sizeof(addr);
+  pthread_t thread;
+  drizzle_options_st *options;
+  drizzle_return_t ret;
+  size_t *sizes;
+  double start;
+  double elapsed;
+  int iteration;
+
+  memset(&server, 0, sizeof(server));
+  server.table= table;
+
+  server.listen_fd= socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family= AF_INET;
+  addr.sin_addr.s_addr= htonl(INADDR_LOOPBACK);
+  if (server.listen_fd < 0 ||
+      bind(server.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(server.listen_fd, 1) != 0 ||
+      getsockname(server.listen_fd, (struct sockaddr *)&addr, &addr_size) != 0)
+  {
+    perror("listen");
+    return EXIT_FAILURE;
+  }
+
+  pthread_create(&thread, NULL, server_thread, &server);
+
+  options= drizzle_options_create();
+  drizzle_options_set_compression(options, compression);
+  drizzle_st *con= drizzle_create("127.0.0.1", ntohs(addr.sin_port), "bench",
+                                  "", "", options);
+  ret= drizzle_connect(con);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    printf("drizzle_connect(): %s\n", drizzle_error(con));
+    return EXIT_FAILURE;
+  }
+
+  start= cpu_now();
+  for (iteration= 0; iteration < BENCH_ITERATIONS; iteration++)
+  {
+    drizzle_result_st *result= drizzle_query(con, "SELECT", 0, &ret);
+    if (ret != DRIZZLE_RETURN_OK ||
+        drizzle_column_buffer(result) != DRIZZLE_RETURN_OK)
+    {
+      printf("query failed: %s\n", drizzle_error(con));
+      return EXIT_FAILURE;
+    }
+
+    while (drizzle_row_view(result, &sizes, &ret) != NULL)
+    { }
+
+    if (ret != DRIZZLE_RETURN_OK)
+    {
+      printf("row read failed: %s\n", drizzle_error(con));
+      return EXIT_FAILURE;
+    }
+    drizzle_result_free(result);
+  }
+  elapsed= cpu_now() - start;
+
+  drizzle_quit(con);
+  drizzle_options_destroy(options);
+  pthread_join(thread, NULL);
+  close(server.listen_fd);
+
+  printf("%-8s %-4s %10" PRIu64 " bytes/result %10" PRIu64 " on wire (%5.1f%%) %8.2f ms CPU/MB\n",
+         table_names[table],
+         compression == DRIZZLE_COMPRESSION_NONE ? "none" : "zlib",
+         server.result_bytes, server.wire_bytes / BENCH_ITERATIONS,
+         (double)server.wire_bytes * 100 /
+           (double)(server.result_bytes * BENCH_ITERATIONS),
+         elapsed * 1000 /
+           ((double)(server.result_bytes * BENCH_ITERATIONS) / (1024 * 1024)));
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+  int table;
+
+  (void)argc;
+  (void)argv;
+
+  for (table= 0; table < 2; table++)
+  {
+    if (run(table, DRIZZLE_COMPRESSION_NONE) != EXIT_SUCCESS ||
+        run(table, DRIZZLE_COMPRESSION_ZLIB) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
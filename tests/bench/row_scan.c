@@ -0,0 +1,430 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Micro benchmark for reading text protocol rows. A server thread on the
+ * loopback interface answers every query with the same pre-built result
+ * set, which is read with drizzle_row_buffer(), drizzle_row_view() and
+ * drizzle_row_read_many() for tables of 10, 50 and 200 columns.
+ */
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define BENCH_ROW_BYTES (4 * 1024 * 1024)
+#define BENCH_BATCH_SIZE 256
+
+typedef struct
+{
+  unsigned char *data;
+  size_t size;
+  size_t allocation;
+  uint8_t sequence;
+} bench_buffer_st;
+
+typedef struct
+{
+  int listen_fd;
+  uint16_t column_count;
+  uint64_t row_count;
+} bench_server_st;
+
+static void buffer_append(bench_buffer_st *buffer, const void *data,
+                          size_t size)
+{
+  if (buffer->size + size > buffer->allocation)
+  {
+    while (buffer->size + size > buffer->allocation)
+    {
+      buffer->allocation= buffer->allocation ? buffer->allocation * 2 : 4096;
+    }
+    buffer->data= realloc(buffer->data, buffer->allocation);
+    if (buffer->data == NULL)
+    {
+      abort();
+    }
+  }
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size+= size;
+}
+
+static void buffer_packet(bench_buffer_st *buffer, const unsigned char *payload,
+                          size_t size)
+{
+  unsigned char header[4];
+  header[0]= (unsigned char)(size & 0xFF);
+  header[1]= (unsigned char)((size >> 8) & 0xFF);
+  header[2]= (unsigned char)((size >> 16) & 0xFF);
+  header[3]= buffer->sequence++;
+  buffer_append(buffer, header, 4);
+  buffer_append(buffer, payload, size);
+}
+
+static size_t pack_string(unsigned char *ptr, const char *string)
+{
+  size_t size= strlen(string);
+  ptr[0]= (unsigned char)size;
+  memcpy(ptr + 1, string, size);
+  return size + 1;
+}
+
+static void build_result(bench_buffer_st *buffer, uint16_t column_count,
+                         uint64_t row_count)
+{
+  unsigned char payload[16 * 1024];
+  unsigned char *ptr;
+  char name[16];
+  uint64_t row;
+  uint16_t column;
+
+  buffer->size= 0;
+  buffer->sequence= 1;
+
+  payload[0]= (unsigned char)column_count;
+  buffer_packet(buffer, payload, 1);
+
+  for (column= 0; column < column_count; column++)
+  {
+    snprintf(name, sizeof(name), "c%u", column);
+    ptr= payload;
+    ptr+= pack_string(ptr, "def");
+    ptr+= pack_string(ptr, "bench");
+    ptr+= pack_string(ptr, "t1");
+    ptr+= pack_string(ptr, "t1");
+    ptr+= pack_string(ptr, name);
+    ptr+= pack_string(ptr, name);
+    *ptr++= 0x0c;
+    *ptr++= 33; *ptr++= 0;                          /* charset */
+    *ptr++= 255; *ptr++= 0; *ptr++= 0; *ptr++= 0;   /* length */
+    *ptr++= DRIZZLE_COLUMN_TYPE_VAR_STRING;
+    *ptr++= 0; *ptr++= 0;                           /* flags */
+    *ptr++= 0;                                      /* decimals */
+    *ptr++= 0; *ptr++= 0;
+    buffer_packet(buffer, payload, (size_t)(ptr - payload));
+  }
+
+  payload[0]= 0xFE; payload[1]= 0; payload[2]= 0; payload[3]= 2; payload[4]= 0;
+  buffer_packet(buffer, payload, 5);
+
+  for (row= 0; row < row_count; row++)
+  {
+    ptr= payload;
+    for (column= 0; column < column_count; column++)
+    {
+      if ((row + column) % 7 == 0)
+      {
+        *ptr++= 0xFB;
+      }
+      else
+      {
+        char value[32];
+        snprintf(value, sizeof(value), "%" PRIu64,
+                 row * column_count + column);
+        ptr+= pack_string(ptr, value);
+      }
+    }
+    buffer_packet(buffer, payload, (size_t)(ptr - payload));
+  }
+
+  payload[0]= 0xFE; payload[1]= 0; payload[2]= 0; payload[3]= 2; payload[4]= 0;
+  buffer_packet(buffer, payload, 5);
+}
+
+static int read_packet(int fd, unsigned char *payload, size_t max_size)
+{
+  unsigned char header[4];
+  size_t size;
+  size_t done= 0;
+  ssize_t ret;
+
+  while (done < 4)
+  {
+    ret= recv(fd, header + done, 4 - done, 0);
+    if (ret <= 0)
+      return -1;
+    done+= (size_t)ret;
+  }
+
+  size= header[0] | (header[1] << 8) | (header[2] << 16);
+  if (size > max_size)
+    return -1;
+
+  done= 0;
+  while (done < size)
+  {
+    ret= recv(fd, payload + done, size - done, 0);
+    if (ret <= 0)
+      return -1;
+    done+= (size_t)ret;
+  }
+
+  return payload[0];
+}
+
+static int send_all(int fd, const unsigned char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t ret= send(fd, data, size, 0);
+    if (ret <= 0)
+      return -1;
+    data+= ret;
+    size-= (size_t)ret;
+  }
+  return 0;
+}
+
+static void *server_thread(void *context)
+{
+  bench_server_st *server= (bench_server_st *)context;
+  bench_buffer_st handshake= { NULL, 0, 0, 0 };
+  bench_buffer_st ok= { NULL, 0, 0, 2 };
+  bench_buffer_st result= { NULL, 0, 0, 1 };
+  unsigned char payload[4096];
+  unsigned char *ptr= payload;
+  int fd;
+
+  fd= accept(server->listen_fd, NULL, NULL);
+  if (fd < 0)
+    return NULL;
+
+  *ptr++= 10;
+  memcpy(ptr, "5.7.0-bench", 12); ptr+= 12;
+  *ptr++= 1; *ptr++= 0; *ptr++= 0; *ptr++= 0;
+  memcpy(ptr, "abcdefgh", 8); ptr+= 8;
+  *ptr++= 0;
+  *ptr++= 0xFF; *ptr++= 0xF7;
+  *ptr++= 33;
+  *ptr++= 2; *ptr++= 0;
+  *ptr++= 0x0F; *ptr++= 0x80;
+  *ptr++= 21;
+  memset(ptr, 0, 10); ptr+= 10;
+  memcpy(ptr, "ijklmnopqrst", 13); ptr+= 13;
+  memcpy(ptr, "mysql_native_password", 22); ptr+= 22;
+  buffer_packet(&handshake, payload, (size_t)(ptr - payload));
+  send_all(fd, handshake.data, handshake.size);
+
+  if (read_packet(fd, payload, sizeof(payload)) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  memset(payload, 0, 7);
+  payload[3]= 2;
+  buffer_packet(&ok, payload, 7);
+  send_all(fd, ok.data, ok.size);
+
+  build_result(&result, server->column_count, server->row_count);
+
+  while (read_packet(fd, payload, sizeof(payload)) == 0x03)  /* COM_QUERY */
+  {
+    if (send_all(fd, result.data, result.size) < 0)
+      break;
+  }
+
+  close(fd);
+  free(handshake.data);
+  free(ok.data);
+  free(result.data);
+  return NULL;
+}
+
+static double now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / (double)1000000;
+}
+
+static uint64_t read_buffer(drizzle_result_st *result)
+{
+  drizzle_return_t ret;
+  drizzle_row_t row;
+  uint64_t rows= 0;
+
+  while ((row= drizzle_row_buffer(result, &ret)) != NULL)
+  {
+    rows++;
+    drizzle_row_free(result, row);
+  }
+
+  return rows;
+}
+
+static uint64_t read_view(drizzle_result_st *result)
+{
+  drizzle_return_t ret;
+  size_t *sizes;
+  uint64_t rows= 0;
+
+  while (drizzle_row_view(result, &sizes, &ret) != NULL)
+  {
+    rows++;
+  }
+
+  return rows;
+}
+
+static uint64_t read_many(drizzle_result_st *result)
+{
+  uint16_t column_count= drizzle_result_column_count(result);
+  size_t *offsets= malloc(sizeof(size_t) * BENCH_BATCH_SIZE * column_count);
+  size_t *lengths= malloc(sizeof(size_t) * BENCH_BATCH_SIZE * column_count);
+  const char *data;
+  drizzle_return_t ret;
+  uint64_t rows= 0;
+  uint64_t count;
+
+  while ((count= drizzle_row_read_many(result, BENCH_BATCH_SIZE, &data,
+                                       offsets, lengths, NULL, &ret)) > 0)
+  {
+    rows+= count;
+  }
+
+  free(offsets);
+  free(lengths);
+  return rows;
+}
+
+static int run(uint16_t column_count)
+{
+  bench_server_st server;
+  struct sockaddr_in addr;
+  socklen_t addr_size= sizeof(addr);
+  pthread_t thread;
+  drizzle_return_t ret;
+  int method;
+
+  /* Every row holds about column_count short fields. */
+  server.column_count= column_count;
+  server.row_count= BENCH_ROW_BYTES / (column_count * 6);
+
+  server.listen_fd= socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family= AF_INET;
+  addr.sin_addr.s_addr= htonl(INADDR_LOOPBACK);
+  if (server.listen_fd < 0 ||
+      bind(server.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(server.listen_fd, 1) != 0 ||
+      getsockname(server.listen_fd, (struct sockaddr *)&addr, &addr_size) != 0)
+  {
+    perror("listen");
+    return EXIT_FAILURE;
+  }
+
+  pthread_create(&thread, NULL, server_thread, &server);
+
+  drizzle_st *con= drizzle_create("127.0.0.1", ntohs(addr.sin_port), "bench",
+                                  "", "", NULL);
+  ret= drizzle_connect(con);
+  if (ret != DRIZZLE_RETURN_OK)
+  {
+    printf("drizzle_connect(): %s\n", drizzle_error(con));
+    return EXIT_FAILURE;
+  }
+
+  for (method= 0; method < 3; method++)
+  {
+    static const char *names[]= { "drizzle_row_buffer", "drizzle_row_view",
+                                  "drizzle_row_read_many" };
+    uint64_t rows= 0;
+    double start;
+    double elapsed;
+    int iteration;
+
+    start= now();
+    for (iteration= 0; iteration < 5; iteration++)
+    {
+      drizzle_result_st *result= drizzle_query(con, "SELECT", 0, &ret);
+      if (ret != DRIZZLE_RETURN_OK ||
+          drizzle_column_buffer(result) != DRIZZLE_RETURN_OK)
+      {
+        printf("query failed: %s\n", drizzle_error(con));
+        return EXIT_FAILURE;
+      }
+
+      switch (method)
+      {
+      case 0:
+        rows+= read_buffer(result);
+        break;
+      case 1:
+        rows+= read_view(result);
+        break;
+      default:
+        rows+= read_many(result);
+        break;
+      }
+      drizzle_result_free(result);
+    }
+    elapsed= now() - start;
+
+    printf("%4u columns %-22s %12.0f rows/sec\n", column_count, names[method],
+           (double)rows / elapsed);
+  }
+
+  drizzle_quit(con);
+  pthread_join(thread, NULL);
+  close(server.listen_fd);
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+
+  if (run(10) != EXIT_SUCCESS || run(50) != EXIT_SUCCESS ||
+      run(200) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
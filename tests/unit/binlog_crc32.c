@@ -0,0 +1,104 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdlib.h>
+#include <zlib.h>
+
+#define DATA_SIZE (64 * 1024 + 64)
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  static const size_t sizes[]= { 63, 64, 65, 79, 80, 127, 128, 129, 1024,
+                                 8 * 1024, 64 * 1024 - 1, 64 * 1024 };
+  unsigned char *data;
+  uint32_t crc;
+  size_t offset;
+  size_t size;
+  size_t x;
+
+  data= (unsigned char *)malloc(DATA_SIZE);
+  ASSERT_NOT_NULL_(data, "Could not allocate the data");
+  for (x= 0; x < DATA_SIZE; x++)
+  {
+    data[x]= (unsigned char)((x * 2654435761u) >> 13);
+  }
+
+  ASSERT_EQ(0U, drizzle_binlog_crc32(0, NULL, 0));
+  ASSERT_EQ(0x12345678U, drizzle_binlog_crc32(0x12345678, data, 0));
+  ASSERT_EQ(0xCBF43926U,
+            drizzle_binlog_crc32(0, (const unsigned char *)"123456789", 9));
+
+  /* Every size up to a few folds, at every alignment of a vector */
+  for (offset= 0; offset < 16; offset++)
+  {
+    for (size= 0; size <= 300; size++)
+    {
+      ASSERT_EQ_((uint32_t)crc32(0, data + offset, (uInt)size),
+                 drizzle_binlog_crc32(0, data + offset, size),
+                 "offset %zu size %zu", offset, size);
+    }
+  }
+
+  for (x= 0; x < sizeof(sizes) / sizeof(sizes[0]); x++)
+  {
+    ASSERT_EQ_((uint32_t)crc32(0, data + 3, (uInt)sizes[x]),
+               drizzle_binlog_crc32(0, data + 3, sizes[x]),
+               "size %zu", sizes[x]);
+  }
+
+  /* Continued over pieces of any size */
+  for (size= 1; size < 200; size+= 7)
+  {
+    crc= 0;
+    for (offset= 0; offset < 8 * 1024; offset+= size)
+    {
+      crc= drizzle_binlog_crc32(crc, data + offset,
+                                offset + size > 8 * 1024 ? 8 * 1024 - offset
+                                                         : size);
+    }
+    ASSERT_EQ_((uint32_t)crc32(0, data, 8 * 1024), crc, "pieces of %zu",
+               size);
+  }
+
+  free(data);
+  return EXIT_SUCCESS;
+}
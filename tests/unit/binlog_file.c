@@ -0,0 +1,370 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILE_COUNT 2
+#define FILE_EVENTS 500
+#define FILE_DATA_SIZE (1024 * 1024)
+#define HEADER_SIZE 19
+#define FDE_DATA_SIZE 96
+
+/* Small enough for the reader to wait on a full ring */
+#define RING_EVENTS 8
+#define RING_DATA_SIZE (64 * 1024)
+#define RING_BATCH 4
+
+struct consumer_st
+{
+  drizzle_binlog_ring_st *ring;
+  uint32_t count;
+  uint64_t data_sum;
+  drizzle_return_t ret;
+};
+
+static char directory[]= "/tmp/drizzle_binlog_file_XXXXXX";
+static uint32_t callback_count;
+static uint64_t callback_data_sum;
+static drizzle_return_t error_ret;
+static uint64_t file_data_sum;
+static bool file_checksums= true;
+
+static void set_byte2(unsigned char *buffer, uint16_t value)
+{
+  buffer[0]= (unsigned char)value;
+  buffer[1]= (unsigned char)(value >> 8);
+}
+
+static void set_byte4(unsigned char *buffer, uint32_t value)
+{
+  set_byte2(buffer, (uint16_t)value);
+  set_byte2(buffer + 2, (uint16_t)(value >> 16));
+}
+
+/* Appends an event, with a checksum if asked for, the data is filled with
+   'seed' */
+static size_t add_event(unsigned char *buffer, size_t position,
+                        drizzle_binlog_event_types_t type, uint32_t data_size,
+                        uint32_t seed, bool checksum)
+{
+  unsigned char *event= buffer + position;
+  uint32_t length= HEADER_SIZE + data_size + (checksum ? 4 : 0);
+  uint32_t x;
+
+  set_byte4(event, 1400000000 + seed);
+  event[4]= (unsigned char)type;
+  set_byte4(event + 5, 1);
+  set_byte4(event + 9, length);
+  set_byte4(event + 13, (uint32_t)(position + length));
+  set_byte2(event + 17, 0);
+  for (x= 0; x < data_size; x++)
+  {
+    event[HEADER_SIZE + x]= (unsigned char)(seed * 31 + x);
+  }
+  if (checksum)
+  {
+    set_byte4(event + length - 4,
+              drizzle_binlog_crc32(0, event, length - 4));
+  }
+
+  return position + length;
+}
+
+/* Writes a binlog file with a format description and FILE_EVENTS queries */
+static void write_binlog(const char *name, uint32_t file, bool checksums,
+                         size_t *size)
+{
+  unsigned char *binlog;
+  char path[128];
+  size_t position;
+  FILE *output;
+  uint32_t x;
+
+  binlog= (unsigned char *)calloc(1, FILE_DATA_SIZE);
+  ASSERT_NOT_NULL_(binlog, "Could not allocate the binlog");
+  memcpy(binlog, DRIZZLE_BINLOG_MAGIC, 4);
+
+  /* The format description has a checksum even when the events do not */
+  position= add_event(binlog, 4, DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION,
+                      FDE_DATA_SIZE, 0, true);
+  set_byte2(binlog + 4 + HEADER_SIZE, 4);
+  memset(binlog + 4 + HEADER_SIZE + 2, 0, 50);
+  strcpy((char *)binlog + 4 + HEADER_SIZE + 2, "5.6.1-log");
+  /* The checksum algorithm of the events, CRC32 or none */
+  binlog[position - 4 - 1]= checksums ? 1 : 0;
+  /* The checksum covers the fields written above */
+  set_byte4(binlog + position - 4,
+            drizzle_binlog_crc32(0, binlog + 4, position - 4 - 4));
+
+  for (x= 0; x < FILE_EVENTS; x++)
+  {
+    position= add_event(binlog, position, DRIZZLE_EVENT_TYPE_QUERY,
+                        16 + (x * 37) % 1200, file * FILE_EVENTS + x,
+                        checksums);
+  }
+  for (x= 4; x < position; x++)
+  {
+    file_data_sum+= binlog[x];
+  }
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  output= fopen(path, "w");
+  ASSERT_NOT_NULL_(output, "Could not create %s", path);
+  ASSERT_EQ(position, fwrite(binlog, 1, position, output));
+  fclose(output);
+
+  *size= position;
+  free(binlog);
+}
+
+static void write_file(const char *name, const char *content)
+{
+  char path[128];
+  FILE *output;
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  output= fopen(path, "w");
+  ASSERT_NOT_NULL_(output, "Could not create %s", path);
+  fputs(content, output);
+  fclose(output);
+}
+
+static void remove_file(const char *name)
+{
+  char path[128];
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  unlink(path);
+}
+
+static uint64_t event_sum(drizzle_binlog_event_st *event)
+{
+  const unsigned char *data= drizzle_binlog_event_raw_data(event);
+  uint64_t sum= 0;
+  uint32_t x;
+
+  for (x= 0; x < drizzle_binlog_event_raw_length(event); x++)
+  {
+    sum+= data[x];
+  }
+
+  return sum;
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)connection;
+  (void)context;
+  error_ret= ret;
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  (void)context;
+  if (file_checksums ||
+      drizzle_binlog_event_type(event) == DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION)
+  {
+    ASSERT_EQ(drizzle_binlog_event_raw_length(event),
+              HEADER_SIZE + drizzle_binlog_event_length(event) + 4);
+  }
+  else
+  {
+    ASSERT_EQ(drizzle_binlog_event_raw_length(event),
+              HEADER_SIZE + drizzle_binlog_event_length(event));
+  }
+  callback_count++;
+  callback_data_sum+= event_sum(event);
+}
+
+static void *consume(void *context)
+{
+  struct consumer_st *consumer= (struct consumer_st *)context;
+  drizzle_binlog_event_st *event_list[RING_EVENTS];
+  uint32_t count;
+  uint32_t x;
+
+  while ((count= drizzle_binlog_ring_read(consumer->ring, event_list,
+                                          RING_EVENTS, &consumer->ret)) > 0)
+  {
+    ASSERT_EQ(DRIZZLE_RETURN_OK, consumer->ret);
+    for (x= 0; x < count; x++)
+    {
+      consumer->data_sum+= event_sum(event_list[x]);
+    }
+    consumer->count+= count;
+    drizzle_binlog_ring_release(consumer->ring, count);
+  }
+
+  return NULL;
+}
+
+static drizzle_return_t read_binlog(const char *name,
+                                    drizzle_binlog_ring_st *ring)
+{
+  drizzle_binlog_st *binlog;
+  drizzle_return_t ret;
+  drizzle_st *con;
+  char path[128];
+
+  /* The connection is only there for the errors, nothing listens on it */
+  snprintf(path, sizeof(path), "%s/mysql.sock", directory);
+  con= drizzle_create(path, 0, "root", NULL, NULL, NULL);
+  ASSERT_NOT_NULL_(con, "Drizzle connection object creation error");
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, NULL, true);
+  ASSERT_NOT_NULL_(binlog, "Binlog object creation error");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_set_ring(binlog, ring));
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  callback_count= 0;
+  callback_data_sum= 0;
+  error_ret= DRIZZLE_RETURN_OK;
+  ret= drizzle_binlog_start_file(binlog, path);
+  ASSERT_EQ(ret, error_ret);
+  ASSERT_TRUE(ret == DRIZZLE_RETURN_EOF || drizzle_error(con)[0] != '\0');
+
+  /* Only a binlog started from a server is freed with the connection */
+  drizzle_binlog_free(binlog);
+  drizzle_quit(con);
+
+  return ret;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  struct consumer_st consumer;
+  size_t size[FILE_COUNT];
+  size_t plain_size;
+  uint64_t first_data_sum;
+  pthread_t thread;
+  char path[128];
+  FILE *file;
+
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_file(NULL, "binlog.000001"));
+  ASSERT_NOT_NULL_(mkdtemp(directory), "Could not create %s", directory);
+
+  write_binlog("binlog.000001", 0, true, &size[0]);
+  first_data_sum= file_data_sum;
+  write_binlog("binlog.000002", 1, true, &size[1]);
+  write_file("binlog.index", "./binlog.000001\nbinlog.000002\n");
+
+  /* One file, every event with its header and checksum */
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, read_binlog("binlog.000001", NULL));
+  ASSERT_EQ(1U + FILE_EVENTS, callback_count);
+  ASSERT_EQ(first_data_sum, callback_data_sum);
+
+  /* The files listed in the index, and the index found in the directory */
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, read_binlog("binlog.index", NULL));
+  ASSERT_EQ(FILE_COUNT * (1U + FILE_EVENTS), callback_count);
+  ASSERT_EQ(file_data_sum, callback_data_sum);
+
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, read_binlog("", NULL));
+  ASSERT_EQ(FILE_COUNT * (1U + FILE_EVENTS), callback_count);
+  ASSERT_EQ(file_data_sum, callback_data_sum);
+
+  /* The same events through the ring */
+  consumer.ring= drizzle_binlog_ring_create(RING_EVENTS, RING_DATA_SIZE,
+                                            RING_BATCH);
+  ASSERT_NOT_NULL_(consumer.ring, "Could not create the ring");
+  consumer.count= 0;
+  consumer.data_sum= 0;
+  consumer.ret= DRIZZLE_RETURN_OK;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, consume, &consumer));
+
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, read_binlog("binlog.index", consumer.ring));
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, consumer.ret);
+  ASSERT_EQ(0U, callback_count);
+  ASSERT_EQ(FILE_COUNT * (1U + FILE_EVENTS), consumer.count);
+  ASSERT_EQ(file_data_sum, consumer.data_sum);
+  drizzle_binlog_ring_free(consumer.ring);
+
+  /* A file written with binlog_checksum=NONE */
+  first_data_sum= file_data_sum;
+  write_binlog("binlog.000005", 2, false, &plain_size);
+  file_checksums= false;
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, read_binlog("binlog.000005", NULL));
+  file_checksums= true;
+  ASSERT_EQ(1U + FILE_EVENTS, callback_count);
+  ASSERT_EQ(file_data_sum - first_data_sum, callback_data_sum);
+
+  /* An event cut off by the end of the file */
+  snprintf(path, sizeof(path), "%s/binlog.000002", directory);
+  ASSERT_EQ(0, truncate(path, (off_t)size[1] - 10));
+  ASSERT_EQ(DRIZZLE_RETURN_UNEXPECTED_DATA,
+            read_binlog("binlog.000002", NULL));
+  ASSERT_EQ(FILE_EVENTS, callback_count);
+
+  /* A damaged event */
+  file= fopen(path, "r+");
+  ASSERT_NOT_NULL_(file, "Could not open %s", path);
+  fseek(file, 4 + HEADER_SIZE + FDE_DATA_SIZE + 4 + HEADER_SIZE + 1,
+        SEEK_SET);
+  fputc('!', file);
+  fclose(file);
+  ASSERT_EQ(DRIZZLE_RETURN_BINLOG_CRC, read_binlog("binlog.000002", NULL));
+  ASSERT_EQ(1U, callback_count);
+
+  /* Neither a binlog nor an index of them */
+  write_file("binlog.index", "binlog.000003\n");
+  ASSERT_EQ(DRIZZLE_RETURN_ERRNO, read_binlog("binlog.index", NULL));
+  write_file("binlog.index", "\n");
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, read_binlog("binlog.index", NULL));
+  write_file("binlog.000003", "not a binlog");
+  write_file("binlog.index", "binlog.000003\n");
+  ASSERT_EQ(DRIZZLE_RETURN_UNEXPECTED_DATA, read_binlog("", NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_ERRNO, read_binlog("binlog.000004", NULL));
+
+  remove_file("binlog.000001");
+  remove_file("binlog.000002");
+  remove_file("binlog.000003");
+  remove_file("binlog.000005");
+  remove_file("binlog.index");
+  rmdir(directory);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include "tests/unit/common.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#define SCHEMA "test_binlog_gtid"
+
+struct gtid_context_st
+{
+  drizzle_binlog_st *binlog;
+  char *first_set;
+  uint32_t gtid_count;
+};
+
+/* The text form of a GTID set as the library writes it */
+static void normalize(char *gtid_set)
+{
+  char *ptr= gtid_set;
+
+  for (; *gtid_set != '\0'; gtid_set++)
+  {
+    if (!isspace((unsigned char)*gtid_set))
+    {
+      *ptr++= (char)tolower((unsigned char)*gtid_set);
+    }
+  }
+  *ptr= '\0';
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)context;
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, ret, "%s(%s)", drizzle_error(connection),
+             drizzle_strerror(ret));
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  struct gtid_context_st *gtid_context= (struct gtid_context_st *)context;
+  drizzle_return_t ret;
+
+  if (gtid_context->first_set == NULL)
+  {
+    ret= drizzle_binlog_get_gtid_set(gtid_context->binlog,
+                                     &gtid_context->first_set);
+    ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  }
+
+  if (drizzle_binlog_event_type(event) == DRIZZLE_EVENT_TYPE_GTID)
+  {
+    gtid_context->gtid_count++;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  struct gtid_context_st gtid_context;
+  drizzle_return_t driz_ret;
+  char *start_set;
+  char *end_set;
+  char *gtid_set;
+
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(NULL, 0, ""));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_get_gtid_set(NULL, &gtid_set));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_get_gtid_executed(NULL, &gtid_set));
+
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  set_up_connection();
+
+  driz_ret= drizzle_binlog_get_gtid_executed(con, &start_set);
+  SKIP_IF_(driz_ret != DRIZZLE_RETURN_OK, "GTIDs are not available: %s(%s)",
+           drizzle_error(con), drizzle_strerror(driz_ret));
+  SKIP_IF_(start_set[0] == '\0', "gtid_mode is not enabled");
+
+  set_up_schema(SCHEMA);
+  CHECKED_QUERY("CREATE TABLE " SCHEMA ".t1 (a INT)");
+  drizzle_result_free(result);
+  CHECKED_QUERY("INSERT INTO " SCHEMA ".t1 VALUES (1)");
+  drizzle_result_free(result);
+  CHECKED_QUERY("INSERT INTO " SCHEMA ".t1 VALUES (2)");
+  drizzle_result_free(result);
+  tear_down_schema(SCHEMA);
+
+  driz_ret= drizzle_binlog_get_gtid_executed(con, &end_set);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  close_connection_on_exit();
+
+  /* Stream what was just logged, starting from the checkpoint */
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  set_up_connection();
+
+  memset(&gtid_context, 0, sizeof(gtid_context));
+  gtid_context.binlog= drizzle_binlog_init(con, binlog_event, binlog_error,
+                                           &gtid_context, true);
+  ASSERT_NOT_NULL_(gtid_context.binlog, "Binlog object creation error");
+
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(gtid_context.binlog, 0, NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(gtid_context.binlog, 0, "not a set"));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(gtid_context.binlog, 0,
+                                      "3e11fa47-71ca-11e1-9e33-c80aa9429562:0"));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(gtid_context.binlog, 0,
+                                      "3e11fa47-71ca-11e1-9e33-c80aa9429562:5-3"));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(gtid_context.binlog, 0,
+                                      "3e11fa47-71ca-11e1-9e33-c80aa9429562:1,"));
+
+  driz_ret= drizzle_binlog_start_gtid(gtid_context.binlog, 0, start_set);
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, driz_ret, "Drizzle binlog start failure: %s(%s)",
+             drizzle_error(con), drizzle_strerror(driz_ret));
+
+  /* CREATE SCHEMA, CREATE TABLE, two INSERTs and DROP SCHEMA */
+  ASSERT_TRUE(gtid_context.gtid_count >= 5);
+
+  /* The set sent is the one tracked before the first transaction arrives,
+     and the one tracked at the end is what the server has executed */
+  normalize(start_set);
+  ASSERT_NOT_NULL_(gtid_context.first_set, "No event received");
+  ASSERT_STREQ(start_set, gtid_context.first_set);
+
+  driz_ret= drizzle_binlog_get_gtid_set(gtid_context.binlog, &gtid_set);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  normalize(end_set);
+  ASSERT_STREQ(end_set, gtid_set);
+
+  free(gtid_context.first_set);
+  free(gtid_set);
+  free(start_set);
+  free(end_set);
+  return EXIT_SUCCESS;
+}
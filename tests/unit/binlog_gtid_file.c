@@ -0,0 +1,299 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILE_DATA_SIZE 4096
+#define HEADER_SIZE 19
+#define FDE_DATA_SIZE 96
+#define UUID_1 "3e111111-1111-1111-1111-111111111111"
+#define UUID_2 "4e111111-1111-1111-1111-111111111111"
+
+struct gtid_case_st
+{
+  const char *gtid_set;
+  const char *expected;
+};
+
+/* Sets passed to drizzle_binlog_start_gtid() and how they are formatted,
+   intervals end inclusively in the text and exclusively in the set */
+static const struct gtid_case_st gtid_cases[]=
+{
+  { "", "" },
+  { UUID_1 ":1-5:7-9," UUID_2 ":3", UUID_1 ":1-5:7-9," UUID_2 ":3" },
+  /* Out of order, with 1-3 and 4-5 touching */
+  { " 3E111111-1111-1111-1111-111111111111 : 7-9 : 1-3 , " UUID_1 ":4-5, "
+    UUID_2 ":3 ", UUID_1 ":1-5:7-9," UUID_2 ":3" },
+  { UUID_1 ":1-3:5", UUID_1 ":1-3:5" },
+  { UUID_1 ":1-5:3-8", UUID_1 ":1-8" },
+  { UUID_1 ":1-5:1-5:2", UUID_1 ":1-5" },
+  { UUID_1 ":1:3:5:7:2-6", UUID_1 ":1-7" },
+  { UUID_1 ":5-6:1-2:9:3-4", UUID_1 ":1-6:9" }
+};
+
+/* The set after each event written by write_binlog() */
+static const char *expected_set[]=
+{
+  "",                                     /* FORMAT_DESCRIPTION */
+  "",                                     /* GTID 1:6 */
+  "",                                     /* BEGIN */
+  UUID_1 ":6",                            /* XID */
+  UUID_1 ":6",                            /* GTID 1:4 */
+  UUID_1 ":4:6",                          /* CREATE TABLE */
+  UUID_1 ":4:6",                          /* ANONYMOUS_GTID */
+  UUID_1 ":4:6",                          /* BEGIN */
+  UUID_1 ":4:6",                          /* XID */
+  UUID_1 ":4:6",                          /* GTID 2:1 */
+  UUID_1 ":4:6",                          /* BEGIN */
+  UUID_1 ":4:6," UUID_2 ":1",             /* XID */
+  UUID_1 ":4:6," UUID_2 ":1",             /* GTID 1:5 */
+  UUID_1 ":4:6," UUID_2 ":1",             /* BEGIN */
+  UUID_1 ":4-6," UUID_2 ":1"              /* XID */
+};
+
+static char directory[]= "/tmp/drizzle_binlog_gtid_file_XXXXXX";
+static unsigned char binlog_data[FILE_DATA_SIZE];
+static size_t binlog_size;
+static drizzle_binlog_st *binlog;
+static uint32_t event_count;
+
+static void put_le(unsigned char *ptr, uint64_t value, size_t size)
+{
+  size_t x;
+  for (x= 0; x < size; x++)
+  {
+    ptr[x]= (unsigned char)(value >> (8 * x));
+  }
+}
+
+/* Appends an event with its header and checksum */
+static void add_event(drizzle_binlog_event_types_t type,
+                      const unsigned char *body, size_t body_size)
+{
+  unsigned char *event= binlog_data + binlog_size;
+  uint32_t length= (uint32_t)(HEADER_SIZE + body_size + 4);
+
+  ASSERT_TRUE(binlog_size + length <= FILE_DATA_SIZE);
+  put_le(event, 1500000000, 4);
+  event[4]= (unsigned char)type;
+  put_le(event + 5, 1, 4);
+  put_le(event + 9, length, 4);
+  put_le(event + 13, binlog_size + length, 4);
+  put_le(event + 17, 0, 2);
+  memcpy(event + HEADER_SIZE, body, body_size);
+  put_le(event + length - 4, drizzle_binlog_crc32(0, event, length - 4), 4);
+  binlog_size+= length;
+}
+
+static void add_gtid(unsigned char first_byte, uint64_t gno)
+{
+  unsigned char body[1 + 16 + 8];
+
+  body[0]= 1;                                     /* commit flag */
+  memset(body + 1, 0x11, 16);
+  body[1]= first_byte;
+  put_le(body + 17, gno, 8);
+  add_event(DRIZZLE_EVENT_TYPE_GTID, body, sizeof(body));
+}
+
+/* A query event without status variables in the schema "test" */
+static void add_query(const char *query)
+{
+  unsigned char body[128];
+  size_t size= strlen(query);
+
+  memset(body, 0, 13);
+  body[8]= 4;                                     /* schema length */
+  memcpy(body + 13, "test", 5);
+  memcpy(body + 18, query, size);
+  add_event(DRIZZLE_EVENT_TYPE_QUERY, body, 18 + size);
+}
+
+static void add_xid(void)
+{
+  unsigned char body[8];
+
+  put_le(body, 1, 8);
+  add_event(DRIZZLE_EVENT_TYPE_XID, body, sizeof(body));
+}
+
+/* Transactions of two servers, one of them a statement committing itself
+   and one without a GTID */
+static void write_binlog(const char *name)
+{
+  unsigned char body[FDE_DATA_SIZE];
+  char path[128];
+  FILE *output;
+
+  memcpy(binlog_data, DRIZZLE_BINLOG_MAGIC, 4);
+  binlog_size= 4;
+
+  memset(body, 0, sizeof(body));
+  put_le(body, 4, 2);
+  strcpy((char *)body + 2, "5.6.1-log");
+  body[FDE_DATA_SIZE - 1]= 1;                     /* CRC32 */
+  add_event(DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION, body, FDE_DATA_SIZE);
+
+  add_gtid(0x3e, 6);
+  add_query("BEGIN");
+  add_xid();
+  add_gtid(0x3e, 4);
+  add_query("CREATE TABLE t (a INT)");
+  memset(body, 0, 25);
+  add_event(DRIZZLE_EVENT_TYPE_ANONYMOUS_GTID, body, 25);
+  add_query("BEGIN");
+  add_xid();
+  add_gtid(0x4e, 1);
+  add_query("BEGIN");
+  add_xid();
+  add_gtid(0x3e, 5);
+  add_query("BEGIN");
+  add_xid();
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  output= fopen(path, "wb");
+  ASSERT_NOT_NULL_(output, "Could not create %s", path);
+  ASSERT_EQ(binlog_size, fwrite(binlog_data, 1, binlog_size, output));
+  fclose(output);
+}
+
+static void check_set(const char *expected)
+{
+  char *gtid_set;
+
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_get_gtid_set(binlog, &gtid_set));
+  ASSERT_STREQ(expected, gtid_set);
+  free(gtid_set);
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)ret;
+  (void)connection;
+  (void)context;
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  (void)event;
+  (void)context;
+
+  ASSERT_TRUE(event_count < sizeof(expected_set) / sizeof(expected_set[0]));
+  check_set(expected_set[event_count]);
+  event_count++;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_binlog_ring_st *ring;
+  drizzle_binlog_event_st *event;
+  drizzle_return_t ret;
+  drizzle_st *con;
+  char path[128];
+  size_t x;
+
+  ASSERT_NOT_NULL_(mkdtemp(directory), "Could not create %s", directory);
+  write_binlog("binlog.000001");
+
+  /* The connection is only there for the errors, nothing listens on it */
+  snprintf(path, sizeof(path), "%s/mysql.sock", directory);
+  con= drizzle_create(path, 0, "root", NULL, NULL, NULL);
+  ASSERT_NOT_NULL_(con, "Drizzle connection object creation error");
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, NULL, true);
+  ASSERT_NOT_NULL_(binlog, "Binlog object creation error");
+
+  /* The set is parsed before the server is contacted and kept when that
+     fails */
+  for (x= 0; x < sizeof(gtid_cases) / sizeof(gtid_cases[0]); x++)
+  {
+    ASSERT_EQ(DRIZZLE_RETURN_COULD_NOT_CONNECT,
+              drizzle_binlog_start_gtid(binlog, 0, gtid_cases[x].gtid_set));
+    check_set(gtid_cases[x].expected);
+  }
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(binlog, 0, UUID_1 ":0"));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(binlog, 0, UUID_1 ":5-3"));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_start_gtid(binlog, 0, UUID_1 ":1,"));
+
+  /* Reading a file tracks the transactions it commits from an empty set */
+  snprintf(path, sizeof(path), "%s/binlog.000001", directory);
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, drizzle_binlog_start_file(binlog, path));
+  ASSERT_EQ(sizeof(expected_set) / sizeof(expected_set[0]), event_count);
+  check_set(UUID_1 ":4-6," UUID_2 ":1");
+
+  /* With a ring the set follows the events the consumer released, not the
+     ones the reader pushed */
+  ring= drizzle_binlog_ring_create(64, 64 * 1024, 1);
+  ASSERT_NOT_NULL_(ring, "Could not create the ring");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_set_ring(binlog, ring));
+  ASSERT_EQ(DRIZZLE_RETURN_COULD_NOT_CONNECT,
+            drizzle_binlog_start_gtid(binlog, 0, UUID_2 ":2"));
+  check_set(UUID_2 ":2");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_set_ring(binlog, ring));
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, drizzle_binlog_start_file(binlog, path));
+  check_set("");
+  for (x= 0; x < sizeof(expected_set) / sizeof(expected_set[0]); x++)
+  {
+    ASSERT_EQ(1, drizzle_binlog_ring_read(ring, &event, 1, &ret));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+    check_set(x == 0 ? "" : expected_set[x - 1]);
+    drizzle_binlog_ring_release(ring, 1);
+    check_set(expected_set[x]);
+  }
+  ASSERT_EQ(0, drizzle_binlog_ring_read(ring, &event, 1, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, ret);
+
+  drizzle_binlog_free(binlog);
+  drizzle_binlog_ring_free(ring);
+  drizzle_quit(con);
+
+  unlink(path);
+  rmdir(directory);
+
+  return EXIT_SUCCESS;
+}
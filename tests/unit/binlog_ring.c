@@ -0,0 +1,222 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include "tests/unit/common.h"
+
+#include <pthread.h>
+
+/* Small enough for the reader to wait on a full ring */
+#define RING_EVENTS 8
+#define RING_DATA_SIZE (4 * 1024 * 1024)
+#define RING_BATCH 4
+
+struct consumer_st
+{
+  drizzle_binlog_ring_st *ring;
+  uint32_t count;
+  uint64_t data_sum;
+  drizzle_return_t ret;
+};
+
+static uint32_t callback_count;
+static uint64_t callback_data_sum;
+
+static uint64_t event_sum(drizzle_binlog_event_st *event)
+{
+  const unsigned char *data= drizzle_binlog_event_raw_data(event);
+  uint64_t sum= 0;
+  uint32_t x;
+
+  for (x= 0; x < drizzle_binlog_event_raw_length(event); x++)
+  {
+    sum+= data[x];
+  }
+
+  return sum;
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)connection;
+  (void)context;
+  (void)ret;
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  (void)context;
+  callback_count++;
+  callback_data_sum+= event_sum(event);
+}
+
+static void *consume(void *context)
+{
+  struct consumer_st *consumer= (struct consumer_st *)context;
+  drizzle_binlog_event_st *event_list[RING_EVENTS];
+  uint32_t count;
+  uint32_t x;
+
+  while ((count= drizzle_binlog_ring_read(consumer->ring, event_list,
+                                          RING_EVENTS, &consumer->ret)) > 0)
+  {
+    ASSERT_EQ(DRIZZLE_RETURN_OK, consumer->ret);
+    for (x= 0; x < count; x++)
+    {
+      ASSERT_TRUE(drizzle_binlog_event_type(event_list[x]) <
+                  DRIZZLE_EVENT_TYPE_END);
+      /* Only the events also seen by the callback, the binlog may grow */
+      if (consumer->count + x < callback_count)
+      {
+        consumer->data_sum+= event_sum(event_list[x]);
+      }
+    }
+    consumer->count+= count;
+    drizzle_binlog_ring_release(consumer->ring, count);
+  }
+
+  return NULL;
+}
+
+static drizzle_return_t read_binlog(const char *file,
+                                    drizzle_binlog_ring_st *ring)
+{
+  drizzle_binlog_st *binlog;
+  drizzle_return_t ret;
+
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  set_up_connection();
+
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, NULL, true);
+  ASSERT_NOT_NULL_(binlog, "Binlog object creation error");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_set_ring(binlog, ring));
+  /* The binlog object is freed with the connection */
+  ret= drizzle_binlog_start(binlog, 0, file, 0);
+
+  close_connection_on_exit();
+  opts= NULL;
+
+  return ret;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  struct consumer_st consumer;
+  drizzle_binlog_event_st *event;
+  pthread_t thread;
+  char *binlog_file;
+  uint32_t end_position;
+  uint32_t event_count;
+  drizzle_return_t ret;
+
+  ASSERT_NULL_(drizzle_binlog_ring_create(0, RING_DATA_SIZE, RING_BATCH),
+               "A ring without events was created");
+  ASSERT_NULL_(drizzle_binlog_ring_create(RING_EVENTS, 0, RING_BATCH),
+               "A ring without data was created");
+  ASSERT_EQ(0U, drizzle_binlog_ring_read(NULL, &event, 1, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT, ret);
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_set_ring(NULL, NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_ring_set_verify_checksums(NULL, true));
+
+  set_up_connection();
+  ret= drizzle_binlog_get_filename(con, &binlog_file, &end_position, -1);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, ret, "Couldn't retrieve binlog filename: %s(%s)",
+             drizzle_error(con), drizzle_strerror(ret));
+  close_connection_on_exit();
+  opts= NULL;
+
+  /* The same events through the callback and through the ring */
+  ret= read_binlog(binlog_file, NULL);
+  SKIP_IF_(ret == DRIZZLE_RETURN_ERROR_CODE, "Binlog is not open?: %s",
+           drizzle_strerror(ret));
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, ret, "Drizzle binlog start failure: %s",
+             drizzle_strerror(ret));
+  ASSERT_TRUE(callback_count > 0);
+  event_count= callback_count;
+
+  consumer.ring= drizzle_binlog_ring_create(RING_EVENTS, RING_DATA_SIZE,
+                                            RING_BATCH);
+  ASSERT_NOT_NULL_(consumer.ring, "Could not create the ring");
+  consumer.count= 0;
+  consumer.data_sum= 0;
+  consumer.ret= DRIZZLE_RETURN_OK;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, consume, &consumer));
+
+  ret= read_binlog(binlog_file, consumer.ring);
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, ret, "Drizzle binlog start failure: %s",
+             drizzle_strerror(ret));
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, consumer.ret);
+  ASSERT_TRUE(consumer.count >= callback_count);
+
+  /* The callback is not called while a ring is set */
+  ASSERT_EQ(event_count, callback_count);
+  ASSERT_EQ(callback_data_sum, consumer.data_sum);
+
+  /* Again with the checksums verified by the consumer */
+  drizzle_binlog_ring_free(consumer.ring);
+  consumer.ring= drizzle_binlog_ring_create(RING_EVENTS, RING_DATA_SIZE,
+                                            RING_BATCH);
+  ASSERT_NOT_NULL_(consumer.ring, "Could not create the ring");
+  ASSERT_EQ(DRIZZLE_RETURN_OK,
+            drizzle_binlog_ring_set_verify_checksums(consumer.ring, true));
+  consumer.count= 0;
+  consumer.data_sum= 0;
+  consumer.ret= DRIZZLE_RETURN_OK;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, consume, &consumer));
+
+  ret= read_binlog(binlog_file, consumer.ring);
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, ret, "Drizzle binlog start failure: %s",
+             drizzle_strerror(ret));
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, consumer.ret);
+  ASSERT_TRUE(consumer.count >= callback_count);
+  ASSERT_EQ(callback_data_sum, consumer.data_sum);
+
+  drizzle_binlog_ring_free(consumer.ring);
+  free(binlog_file);
+  return EXIT_SUCCESS;
+}
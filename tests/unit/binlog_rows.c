@@ -0,0 +1,242 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include "tests/unit/common.h"
+
+#include <string.h>
+
+#define SCHEMA "test_binlog_rows"
+
+struct rows_context_st
+{
+  drizzle_binlog_rows_st *rows;
+  uint32_t write_count;
+  uint32_t update_count;
+  uint32_t delete_count;
+};
+
+static void check_string(drizzle_binlog_rows_st *rows,
+                         drizzle_binlog_image_t image, uint32_t column,
+                         const char *expected)
+{
+  drizzle_return_t ret;
+  const char *value;
+  size_t size;
+
+  value= drizzle_binlog_rows_get_string(rows, image, column, &size, &ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, ret, "column %u: %s", column,
+             drizzle_strerror(ret));
+  ASSERT_EQ(strlen(expected), size);
+  ASSERT_EQ(0, memcmp(expected, value, size));
+}
+
+/* The first row written by main(), before or after the update */
+static void check_row(drizzle_binlog_rows_st *rows,
+                      drizzle_binlog_image_t image, bool updated)
+{
+  drizzle_return_t ret;
+  double real;
+
+  ASSERT_EQ(updated ? 7 : -5, drizzle_binlog_rows_get_int(rows, image, 0, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  ASSERT_EQ(UINT64_MAX, drizzle_binlog_rows_get_uint(rows, image, 1, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  check_string(rows, image, 2, updated ? "world" : "hello");
+  check_string(rows, image, 3, "-123.450");
+  check_string(rows, image, 4, "2017-03-04 05:06:07.890");
+  real= drizzle_binlog_rows_get_double(rows, image, 5, &ret);
+  ASSERT_TRUE(!(real < 2.5f) && !(real > 2.5f));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  ASSERT_EQ(2, drizzle_binlog_rows_get_int(rows, image, 5, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_TRUNCATED, ret);
+  ASSERT_TRUE(drizzle_binlog_rows_is_null(rows, image, 6, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  drizzle_binlog_rows_get_int(rows, image, 6, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NULL_SIZE, ret);
+  drizzle_binlog_rows_get_string(rows, image, 2, NULL, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  drizzle_binlog_rows_get_int(rows, image, 2, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_CONVERSION, ret);
+  drizzle_binlog_rows_get_int(rows, image, 7, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT, ret);
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)context;
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, ret, "%s(%s)", drizzle_error(connection),
+             drizzle_strerror(ret));
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  struct rows_context_st *rows_context= (struct rows_context_st *)context;
+  drizzle_binlog_rows_st *rows= rows_context->rows;
+  const drizzle_binlog_table_st *table;
+  drizzle_return_t ret;
+  bool before;
+  bool after;
+
+  ret= drizzle_binlog_rows_decode(rows, event);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, ret, "%s event: %s",
+             drizzle_binlog_event_type_str(drizzle_binlog_event_type(event)),
+             drizzle_strerror(ret));
+
+  table= drizzle_binlog_rows_table(rows);
+  if (table == NULL || strcmp(drizzle_binlog_table_schema(table), SCHEMA))
+  {
+    return;
+  }
+
+  ASSERT_STREQ("t1", drizzle_binlog_table_name(table));
+  ASSERT_EQ(7U, drizzle_binlog_table_column_count(table));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_LONG, drizzle_binlog_table_column_type(table, 0));
+  ASSERT_FALSE(drizzle_binlog_table_column_nullable(table, 0));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_VARCHAR,
+            drizzle_binlog_table_column_type(table, 2));
+  ASSERT_EQ(32U, drizzle_binlog_table_column_meta(table, 2));
+  ASSERT_TRUE(drizzle_binlog_table_column_nullable(table, 6));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_NONE, drizzle_binlog_table_column_type(table, 7));
+
+  before= drizzle_binlog_rows_has_image(rows, DRIZZLE_BINLOG_IMAGE_BEFORE);
+  after= drizzle_binlog_rows_has_image(rows, DRIZZLE_BINLOG_IMAGE_AFTER);
+  ASSERT_TRUE(before || after);
+
+  while ((ret= drizzle_binlog_rows_next(rows)) == DRIZZLE_RETURN_OK)
+  {
+    if (before && after)
+    {
+      check_row(rows, DRIZZLE_BINLOG_IMAGE_BEFORE, false);
+      check_row(rows, DRIZZLE_BINLOG_IMAGE_AFTER, true);
+      rows_context->update_count++;
+    }
+    else if (after)
+    {
+      check_row(rows, DRIZZLE_BINLOG_IMAGE_AFTER, false);
+      rows_context->write_count++;
+    }
+    else
+    {
+      check_row(rows, DRIZZLE_BINLOG_IMAGE_BEFORE, true);
+      drizzle_binlog_rows_get_int(rows, DRIZZLE_BINLOG_IMAGE_AFTER, 0, &ret);
+      ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT, ret);
+      rows_context->delete_count++;
+    }
+  }
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, ret);
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  struct rows_context_st rows_context;
+  drizzle_binlog_st *binlog;
+  drizzle_return_t driz_ret;
+  char *binlog_file;
+  uint32_t end_position;
+
+  memset(&rows_context, 0, sizeof(rows_context));
+  rows_context.rows= drizzle_binlog_rows_create();
+  ASSERT_NOT_NULL_(rows_context.rows, "Could not create the row decoder");
+
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_binlog_rows_decode(rows_context.rows, NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT, drizzle_binlog_rows_next(NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_binlog_rows_next(rows_context.rows));
+  ASSERT_NULL_(drizzle_binlog_rows_table(rows_context.rows),
+               "A table without a ROWS event");
+  drizzle_binlog_rows_get_int(rows_context.rows, DRIZZLE_BINLOG_IMAGE_AFTER, 0,
+                              &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT, driz_ret);
+
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  set_up_connection();
+
+  result= drizzle_query(con, "SET SESSION binlog_format= 'ROW'", 0, &driz_ret);
+  SKIP_IF_(driz_ret == DRIZZLE_RETURN_ERROR_CODE,
+           "Row based logging is not available: %s", drizzle_error(con));
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  drizzle_result_free(result);
+
+  driz_ret= drizzle_binlog_get_filename(con, &binlog_file, &end_position, -1);
+  SKIP_IF_(driz_ret != DRIZZLE_RETURN_OK, "Binlog is not open?: %s(%s)",
+           drizzle_error(con), drizzle_strerror(driz_ret));
+
+  set_up_schema(SCHEMA);
+  CHECKED_QUERY("CREATE TABLE " SCHEMA ".t1 (a INT NOT NULL, b BIGINT UNSIGNED,"
+                " c VARCHAR(32) CHARACTER SET latin1, d DECIMAL(10,3),"
+                " e DATETIME(3), f DOUBLE, g INT)");
+  drizzle_result_free(result);
+  CHECKED_QUERY("INSERT INTO " SCHEMA ".t1 VALUES (-5, 18446744073709551615,"
+                " 'hello', -123.45, '2017-03-04 05:06:07.890', 2.5, NULL)");
+  drizzle_result_free(result);
+  CHECKED_QUERY("UPDATE " SCHEMA ".t1 SET a= 7, c= 'world'");
+  drizzle_result_free(result);
+  CHECKED_QUERY("DELETE FROM " SCHEMA ".t1");
+  drizzle_result_free(result);
+  tear_down_schema(SCHEMA);
+  close_connection_on_exit();
+
+  /* Read back what was just logged */
+  opts= drizzle_options_create();
+  drizzle_options_set_socket_owner(opts, DRIZZLE_SOCKET_OWNER_NATIVE);
+  set_up_connection();
+
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, &rows_context,
+                              true);
+  ASSERT_NOT_NULL_(binlog, "Binlog object creation error");
+  driz_ret= drizzle_binlog_start(binlog, 0, binlog_file, end_position);
+  SKIP_IF_(driz_ret == DRIZZLE_RETURN_ERROR_CODE, "Binlog is not open?: %s(%s)",
+           drizzle_error(con), drizzle_strerror(driz_ret));
+  ASSERT_EQ_(DRIZZLE_RETURN_EOF, driz_ret, "Drizzle binlog start failure: %s(%s)",
+             drizzle_error(con), drizzle_strerror(driz_ret));
+
+  ASSERT_EQ(1U, rows_context.write_count);
+  ASSERT_EQ(1U, rows_context.update_count);
+  ASSERT_EQ(1U, rows_context.delete_count);
+
+  drizzle_binlog_rows_free(rows_context.rows);
+  free(binlog_file);
+  return EXIT_SUCCESS;
+}
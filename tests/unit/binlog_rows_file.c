@@ -0,0 +1,623 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILE_DATA_SIZE (1024 * 1024)
+#define HEADER_SIZE 19
+#define FDE_DATA_SIZE 96
+#define COLUMNS 12
+#define CHAR_SIZE 300
+#define TEXT_SIZE 70000
+#define DECIMAL_TEXT "-12345678901234567890123456789012345." \
+                     "123456789012345678901234567890"
+/* Table maps the decoder keeps */
+#define TABLE_LIMIT 4096
+
+/*
+ * TIME2(3), TIMESTAMP2(6), DATE, BIT(10), ENUM, SET, a CHAR of 600 bytes,
+ * CHAR(10), BLOB, MEDIUMTEXT, DECIMAL(65,30), INT
+ */
+static const unsigned char column_types[COLUMNS]= { 19, 17, 10, 16, 254, 254,
+                                                    254, 254, 252, 252, 246, 3 };
+/* The top bits of the length of a long CHAR are stored inverted in its real
+   type, 0xDE is STRING with a length of 0x258 */
+static const unsigned char column_meta[]= { 3, 6, 2, 1, 0xF7, 1, 0xF8, 2,
+                                            0xDE, 0x58, 0xFE, 10, 2, 3,
+                                            65, 30 };
+
+/* The decoder results of the events written by write_binlog() */
+static const drizzle_return_t expected_ret[]=
+{
+  DRIZZLE_RETURN_OK,                  /* FORMAT_DESCRIPTION */
+  DRIZZLE_RETURN_OK,                  /* TABLE_MAP */
+  DRIZZLE_RETURN_OK,                  /* V2 WRITE_ROWS */
+  DRIZZLE_RETURN_OK,                  /* V1 UPDATE_ROWS */
+  DRIZZLE_RETURN_OK,                  /* V2 UPDATE_ROWS */
+  DRIZZLE_RETURN_UNEXPECTED_DATA,     /* DECIMAL(66,2) */
+  DRIZZLE_RETURN_UNEXPECTED_DATA,     /* DECIMAL(65,31) */
+  DRIZZLE_RETURN_UNEXPECTED_DATA,     /* DECIMAL(10,11) */
+  DRIZZLE_RETURN_UNEXPECTED_DATA,     /* no NULL bitmap */
+  DRIZZLE_RETURN_NOT_FOUND            /* rows of a rejected map */
+};
+
+static char directory[]= "/tmp/drizzle_binlog_rows_file_XXXXXX";
+static unsigned char *binlog_data;
+static size_t binlog_size;
+static drizzle_binlog_rows_st *rows;
+static uint32_t event_count;
+static bool checking_limit;
+
+static void put_le(unsigned char *ptr, uint64_t value, size_t size)
+{
+  size_t x;
+  for (x= 0; x < size; x++)
+  {
+    ptr[x]= (unsigned char)(value >> (8 * x));
+  }
+}
+
+static void put_be(unsigned char *ptr, uint64_t value, size_t size)
+{
+  size_t x;
+  for (x= 0; x < size; x++)
+  {
+    ptr[x]= (unsigned char)(value >> (8 * (size - x - 1)));
+  }
+}
+
+/* Appends an event with its header and checksum */
+static void add_event(drizzle_binlog_event_types_t type,
+                      const unsigned char *body, size_t body_size)
+{
+  unsigned char *event= binlog_data + binlog_size;
+  uint32_t length= (uint32_t)(HEADER_SIZE + body_size + 4);
+
+  ASSERT_TRUE(binlog_size + length <= FILE_DATA_SIZE);
+  put_le(event, 1500000000, 4);
+  event[4]= (unsigned char)type;
+  put_le(event + 5, 1, 4);
+  put_le(event + 9, length, 4);
+  put_le(event + 13, binlog_size + length, 4);
+  put_le(event + 17, 0, 2);
+  memcpy(event + HEADER_SIZE, body, body_size);
+  put_le(event + length - 4, drizzle_binlog_crc32(0, event, length - 4), 4);
+  binlog_size+= length;
+}
+
+static size_t table_map(unsigned char *ptr, uint64_t table_id,
+                        const unsigned char *types, uint32_t column_count,
+                        const unsigned char *meta, size_t meta_size)
+{
+  unsigned char *start= ptr;
+
+  put_le(ptr, table_id, 6); ptr+= 6;
+  put_le(ptr, 1, 2); ptr+= 2;
+  *ptr++= 4; memcpy(ptr, "test", 5); ptr+= 5;
+  *ptr++= 2; memcpy(ptr, "t1", 3); ptr+= 3;
+  *ptr++= (unsigned char)column_count;
+  memcpy(ptr, types, column_count); ptr+= column_count;
+  *ptr++= (unsigned char)meta_size;
+  memcpy(ptr, meta, meta_size); ptr+= meta_size;
+  memset(ptr, 0xFF, (column_count + 7) / 8);       /* nullable */
+  ptr+= (column_count + 7) / 8;
+
+  return (size_t)(ptr - start);
+}
+
+static unsigned char *rows_header(unsigned char *ptr, uint64_t table_id,
+                                  bool version_2)
+{
+  put_le(ptr, table_id, 6); ptr+= 6;
+  put_le(ptr, 1, 2); ptr+= 2;
+  if (version_2)
+  {
+    put_le(ptr, 2, 2); ptr+= 2;                   /* extra data */
+  }
+  *ptr++= COLUMNS;
+
+  return ptr;
+}
+
+static unsigned char *put_string(unsigned char *ptr, size_t prefix,
+                                 const void *data, size_t size)
+{
+  put_le(ptr, size, prefix);
+  memcpy(ptr + prefix, data, size);
+
+  return ptr + prefix + size;
+}
+
+/* DECIMAL(65,30) is a group of 8 integer digits in 4 bytes, 27 in three
+   groups of 4 bytes, 27 fraction digits in three more and 3 in 2 bytes */
+static unsigned char *put_decimal(unsigned char *ptr, const uint32_t *groups,
+                                  bool negative)
+{
+  static const size_t group_size[8]= { 4, 4, 4, 4, 4, 4, 4, 2 };
+  unsigned char *start= ptr;
+  size_t x;
+
+  for (x= 0; x < 8; x++)
+  {
+    put_be(ptr, groups[x], group_size[x]);
+    ptr+= group_size[x];
+  }
+  for (x= 0; negative && start + x < ptr; x++)
+  {
+    start[x]= (unsigned char)~start[x];
+  }
+  start[0]^= 0x80;
+
+  return ptr;
+}
+
+static void save_binlog(const char *name)
+{
+  char path[128];
+  FILE *output;
+
+  snprintf(path, sizeof(path), "%s/%s", directory, name);
+  output= fopen(path, "w");
+  ASSERT_NOT_NULL_(output, "Could not create %s", path);
+  ASSERT_EQ(binlog_size, fwrite(binlog_data, 1, binlog_size, output));
+  fclose(output);
+
+  free(binlog_data);
+}
+
+/* Writes a format description, a table map and events using it, then maps
+   the decoder has to reject */
+static void write_binlog(const char *name)
+{
+  static const uint32_t decimal[8]= { 12345678, 901234567, 890123456,
+                                      789012345, 123456789, 12345678,
+                                      901234567, 890 };
+  static const uint32_t zero[8]= { 0, 0, 0, 0, 0, 0, 0, 0 };
+  static const unsigned char decimal_type[1]= { 246 };
+  static const unsigned char bad_meta[3][2]= { { 66, 2 }, { 65, 31 },
+                                              { 10, 11 } };
+  unsigned char *body;
+  unsigned char *ptr;
+  size_t x;
+
+  binlog_data= (unsigned char *)calloc(1, FILE_DATA_SIZE);
+  body= (unsigned char *)calloc(1, FILE_DATA_SIZE);
+  ASSERT_NOT_NULL_(binlog_data, "Could not allocate the binlog");
+  ASSERT_NOT_NULL_(body, "Could not allocate the event");
+  memcpy(binlog_data, DRIZZLE_BINLOG_MAGIC, 4);
+  binlog_size= 4;
+
+  put_le(body, 4, 2);
+  strcpy((char *)body + 2, "5.6.1-log");
+  body[FDE_DATA_SIZE - 1]= 1;                     /* CRC32 */
+  add_event(DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION, body, FDE_DATA_SIZE);
+
+  add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+            table_map(body, 1, column_types, COLUMNS, column_meta,
+                      sizeof(column_meta)));
+
+  /* Every column */
+  ptr= rows_header(body, 1, true);
+  *ptr++= 0xFF; *ptr++= 0x0F;                     /* present */
+  *ptr++= 0x00; *ptr++= 0x00;                     /* NULL bitmap */
+  /* 12:34:56.789 */
+  put_be(ptr, 0x800000 + (12 << 12 | 34 << 6 | 56), 3); ptr+= 3;
+  put_be(ptr, 7890, 2); ptr+= 2;
+  put_be(ptr, 1500000000, 4); ptr+= 4;
+  put_be(ptr, 123456, 3); ptr+= 3;
+  put_le(ptr, 4 | 3 << 5 | 2017 << 9, 3); ptr+= 3;
+  put_be(ptr, 0x2A5, 2); ptr+= 2;
+  *ptr++= 3;
+  put_le(ptr, 0x105, 2); ptr+= 2;
+  memset(body + FILE_DATA_SIZE / 2, 'c', TEXT_SIZE);
+  ptr= put_string(ptr, 2, body + FILE_DATA_SIZE / 2, CHAR_SIZE);
+  ptr= put_string(ptr, 1, "abc", 3);
+  ptr= put_string(ptr, 2, "blob\0value", 10);
+  ptr= put_string(ptr, 3, body + FILE_DATA_SIZE / 2, TEXT_SIZE);
+  ptr= put_decimal(ptr, decimal, true);
+  put_le(ptr, 1, 4); ptr+= 4;
+  add_event(DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS, body, (size_t)(ptr - body));
+
+  /* The long CHAR and the id before, the TIME2, a NULL DATE and the id
+     after */
+  ptr= rows_header(body, 1, false);
+  *ptr++= 0x40; *ptr++= 0x08;
+  *ptr++= 0x05; *ptr++= 0x08;
+  *ptr++= 0x00;
+  ptr= put_string(ptr, 2, body + FILE_DATA_SIZE / 2, CHAR_SIZE);
+  put_le(ptr, 1, 4); ptr+= 4;
+  *ptr++= 0x02;
+  /* -01:02:03.250, negative values borrow from the integer part */
+  put_be(ptr, 0x800000 - 4228, 3); ptr+= 3;
+  put_be(ptr, 0x10000 - 2500, 2); ptr+= 2;
+  put_le(ptr, 1, 4); ptr+= 4;
+  add_event(DRIZZLE_EVENT_TYPE_V1_UPDATE_ROWS, body, (size_t)(ptr - body));
+
+  /* Two rows, the id before and the DECIMAL and the id after */
+  ptr= rows_header(body, 1, true);
+  *ptr++= 0x00; *ptr++= 0x08;
+  *ptr++= 0x00; *ptr++= 0x0C;
+  for (x= 1; x <= 2; x++)
+  {
+    *ptr++= 0x00;
+    put_le(ptr, x, 4); ptr+= 4;
+    *ptr++= 0x00;
+    ptr= put_decimal(ptr, x == 1 ? decimal : zero, false);
+    put_le(ptr, x, 4); ptr+= 4;
+  }
+  add_event(DRIZZLE_EVENT_TYPE_V2_UPDATE_ROWS, body, (size_t)(ptr - body));
+
+  for (x= 0; x < 3; x++)
+  {
+    add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+              table_map(body, 2, decimal_type, 1, bad_meta[x], 2));
+  }
+  add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+            table_map(body, 2, column_types, COLUMNS, column_meta,
+                      sizeof(column_meta)) - 2);
+
+  ptr= rows_header(body, 2, true);
+  *ptr++= 0xFF; *ptr++= 0x0F;
+  add_event(DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS, body, (size_t)(ptr - body));
+
+  save_binlog(name);
+  free(body);
+}
+
+/* Fills the table map cache, then logs a statement on a cached table and a
+   new one, whose map pushes the least recently used one out */
+static void write_limit_binlog(const char *name)
+{
+  static const unsigned char int_type[1]= { 3 };
+  static const uint64_t row_table[3]= { 1, TABLE_LIMIT + 1, 2 };
+  unsigned char body[FDE_DATA_SIZE];
+  uint64_t table_id;
+  size_t x;
+
+  binlog_data= (unsigned char *)calloc(1, FILE_DATA_SIZE);
+  ASSERT_NOT_NULL_(binlog_data, "Could not allocate the binlog");
+  memcpy(binlog_data, DRIZZLE_BINLOG_MAGIC, 4);
+  binlog_size= 4;
+
+  memset(body, 0, sizeof(body));
+  put_le(body, 4, 2);
+  strcpy((char *)body + 2, "5.6.1-log");
+  body[FDE_DATA_SIZE - 1]= 1;                     /* CRC32 */
+  add_event(DRIZZLE_EVENT_TYPE_FORMAT_DESCRIPTION, body, FDE_DATA_SIZE);
+
+  for (table_id= 1; table_id <= TABLE_LIMIT; table_id++)
+  {
+    add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+              table_map(body, table_id, int_type, 1, int_type, 0));
+  }
+  add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+            table_map(body, 1, int_type, 1, int_type, 0));
+  add_event(DRIZZLE_EVENT_TYPE_TABLE_MAP, body,
+            table_map(body, TABLE_LIMIT + 1, int_type, 1, int_type, 0));
+
+  for (x= 0; x < 3; x++)
+  {
+    unsigned char *ptr= body;
+    put_le(ptr, row_table[x], 6); ptr+= 6;
+    put_le(ptr, 1, 2); ptr+= 2;
+    put_le(ptr, 2, 2); ptr+= 2;                   /* extra data */
+    *ptr++= 1;
+    *ptr++= 0x01;                                 /* present */
+    *ptr++= 0x00;                                 /* NULL bitmap */
+    put_le(ptr, row_table[x], 4); ptr+= 4;
+    add_event(DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS, body, (size_t)(ptr - body));
+  }
+
+  save_binlog(name);
+}
+
+static void check_string(drizzle_binlog_image_t image, uint32_t column,
+                         const char *expected, size_t expected_size)
+{
+  drizzle_return_t ret;
+  const char *value;
+  size_t size;
+
+  value= drizzle_binlog_rows_get_string(rows, image, column, &size, &ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, ret, "column %u: %s", column,
+             drizzle_strerror(ret));
+  ASSERT_EQ_(expected_size, size, "column %u", column);
+  ASSERT_EQ(0, memcmp(expected, value, size));
+}
+
+static void check_filled(drizzle_binlog_image_t image, uint32_t column,
+                         size_t expected_size)
+{
+  drizzle_return_t ret;
+  const char *value;
+  size_t size;
+  size_t x;
+
+  value= drizzle_binlog_rows_get_string(rows, image, column, &size, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  ASSERT_EQ_(expected_size, size, "column %u", column);
+  for (x= 0; x < size; x++)
+  {
+    ASSERT_EQ('c', value[x]);
+  }
+}
+
+static void check_table(void)
+{
+  const drizzle_binlog_table_st *table= drizzle_binlog_rows_table(rows);
+
+  ASSERT_NOT_NULL_(table, "No table for the rows");
+  ASSERT_EQ(1U, drizzle_binlog_table_id(table));
+  ASSERT_STREQ("test", drizzle_binlog_table_schema(table));
+  ASSERT_STREQ("t1", drizzle_binlog_table_name(table));
+  ASSERT_EQ((uint32_t)COLUMNS, drizzle_binlog_table_column_count(table));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_TIME2,
+            drizzle_binlog_table_column_type(table, 0));
+  ASSERT_EQ(3U, drizzle_binlog_table_column_meta(table, 0));
+  ASSERT_EQ(0x0102U, drizzle_binlog_table_column_meta(table, 3));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_ENUM,
+            drizzle_binlog_table_column_type(table, 4));
+  ASSERT_EQ(1U, drizzle_binlog_table_column_meta(table, 4));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_SET,
+            drizzle_binlog_table_column_type(table, 5));
+  ASSERT_EQ(2U, drizzle_binlog_table_column_meta(table, 5));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_STRING,
+            drizzle_binlog_table_column_type(table, 6));
+  ASSERT_EQ(600U, drizzle_binlog_table_column_meta(table, 6));
+  ASSERT_EQ(DRIZZLE_COLUMN_TYPE_STRING,
+            drizzle_binlog_table_column_type(table, 7));
+  ASSERT_EQ(10U, drizzle_binlog_table_column_meta(table, 7));
+  ASSERT_EQ(65U << 8 | 30U, drizzle_binlog_table_column_meta(table, 10));
+  ASSERT_TRUE(drizzle_binlog_table_column_nullable(table, 11));
+}
+
+static void check_write(void)
+{
+  drizzle_binlog_image_t after= DRIZZLE_BINLOG_IMAGE_AFTER;
+  drizzle_return_t ret;
+  double real;
+
+  check_table();
+  ASSERT_FALSE(drizzle_binlog_rows_has_image(rows, DRIZZLE_BINLOG_IMAGE_BEFORE));
+  ASSERT_TRUE(drizzle_binlog_rows_has_image(rows, after));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_rows_next(rows));
+
+  check_string(after, 0, "12:34:56.789", 12);
+  check_string(after, 1, "1500000000.123456", 17);
+  ASSERT_EQ(1500000000U, drizzle_binlog_rows_get_uint(rows, after, 1, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  check_string(after, 2, "2017-03-04", 10);
+  check_string(after, 3, "\x02\xA5", 2);
+  ASSERT_EQ(0x2A5U, drizzle_binlog_rows_get_uint(rows, after, 3, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  check_string(after, 4, "3", 1);
+  ASSERT_EQ(0x105U, drizzle_binlog_rows_get_uint(rows, after, 5, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  check_filled(after, 6, CHAR_SIZE);
+  check_string(after, 7, "abc", 3);
+  check_string(after, 8, "blob\0value", 10);
+  check_filled(after, 9, TEXT_SIZE);
+  check_string(after, 10, DECIMAL_TEXT, strlen(DECIMAL_TEXT));
+  real= drizzle_binlog_rows_get_double(rows, after, 10, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  ASSERT_TRUE(real < -1.23e34f && real > -1.24e34f);
+  ASSERT_EQ(1, drizzle_binlog_rows_get_int(rows, after, 11, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+
+  /* The return pointer is optional */
+  ASSERT_EQ(0, drizzle_binlog_rows_get_int(rows, after, 6, NULL));
+  ASSERT_EQ(0U, drizzle_binlog_rows_get_uint(rows, after, 6, NULL));
+  real= drizzle_binlog_rows_get_double(rows, after, 7, NULL);
+  ASSERT_TRUE(real > -1 && real < 1);
+  ASSERT_NOT_NULL_(drizzle_binlog_rows_get_string(rows, after, 0, NULL, NULL),
+                   "No text for the TIME2 column");
+
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_binlog_rows_next(rows));
+}
+
+static void check_update_v1(void)
+{
+  drizzle_binlog_image_t before= DRIZZLE_BINLOG_IMAGE_BEFORE;
+  drizzle_binlog_image_t after= DRIZZLE_BINLOG_IMAGE_AFTER;
+  drizzle_return_t ret;
+
+  ASSERT_TRUE(drizzle_binlog_rows_has_image(rows, before));
+  ASSERT_TRUE(drizzle_binlog_rows_has_image(rows, after));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_rows_next(rows));
+
+  check_filled(before, 6, CHAR_SIZE);
+  ASSERT_EQ(1, drizzle_binlog_rows_get_int(rows, before, 11, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  drizzle_binlog_rows_get_string(rows, before, 0, NULL, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, ret);
+
+  check_string(after, 0, "-01:02:03.250", 13);
+  ASSERT_TRUE(drizzle_binlog_rows_is_null(rows, after, 2, &ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  ASSERT_NULL_(drizzle_binlog_rows_get_string(rows, after, 2, NULL, &ret),
+               "Text for a NULL DATE");
+  ASSERT_EQ(DRIZZLE_RETURN_NULL_SIZE, ret);
+  ASSERT_EQ(0, drizzle_binlog_rows_get_int(rows, after, 2, NULL));
+  drizzle_binlog_rows_get_string(rows, after, 6, NULL, &ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, ret);
+  ASSERT_EQ(1, drizzle_binlog_rows_get_int(rows, after, 11, &ret));
+
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_binlog_rows_next(rows));
+}
+
+static void check_update_v2(void)
+{
+  drizzle_binlog_image_t before= DRIZZLE_BINLOG_IMAGE_BEFORE;
+  drizzle_binlog_image_t after= DRIZZLE_BINLOG_IMAGE_AFTER;
+  drizzle_return_t ret;
+  const char *text;
+  int64_t x;
+
+  for (x= 1; x <= 2; x++)
+  {
+    ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_rows_next(rows));
+    ASSERT_EQ(x, drizzle_binlog_rows_get_int(rows, before, 11, &ret));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+    drizzle_binlog_rows_get_string(rows, before, 10, NULL, &ret);
+    ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, ret);
+    text= x == 1 ? DECIMAL_TEXT + 1 : "0.000000000000000000000000000000";
+    check_string(after, 10, text, strlen(text));
+    ASSERT_EQ(x, drizzle_binlog_rows_get_int(rows, after, 11, &ret));
+  }
+
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_binlog_rows_next(rows));
+}
+
+static void binlog_error(drizzle_return_t ret, drizzle_st *connection,
+                         void *context)
+{
+  (void)ret;
+  (void)connection;
+  (void)context;
+}
+
+/* Every map is kept until the cache is full, then the rows of the tables
+   mapped last are found and those of the table used least recently not */
+static void check_limit(drizzle_binlog_event_st *event)
+{
+  drizzle_return_t ret;
+
+  ret= drizzle_binlog_rows_decode(rows, event);
+  if (event_count < 1 + TABLE_LIMIT + 2 + 2)
+  {
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, ret, "event %u: %s", event_count,
+               drizzle_strerror(ret));
+  }
+  else
+  {
+    ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, ret);
+  }
+
+  if (drizzle_binlog_event_type(event) == DRIZZLE_EVENT_TYPE_V2_WRITE_ROWS &&
+      ret == DRIZZLE_RETURN_OK)
+  {
+    uint64_t table_id= drizzle_binlog_table_id(drizzle_binlog_rows_table(rows));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, drizzle_binlog_rows_next(rows));
+    ASSERT_EQ((int64_t)table_id,
+              drizzle_binlog_rows_get_int(rows, DRIZZLE_BINLOG_IMAGE_AFTER, 0,
+                                          &ret));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, ret);
+  }
+  event_count++;
+}
+
+static void binlog_event(drizzle_binlog_event_st *event, void *context)
+{
+  drizzle_return_t ret;
+  (void)context;
+
+  if (checking_limit)
+  {
+    check_limit(event);
+    return;
+  }
+
+  ASSERT_TRUE(event_count < sizeof(expected_ret) / sizeof(expected_ret[0]));
+  ret= drizzle_binlog_rows_decode(rows, event);
+  ASSERT_EQ_(expected_ret[event_count], ret, "event %u: %s", event_count,
+             drizzle_strerror(ret));
+
+  switch (event_count)
+  {
+  case 2:
+    check_write();
+    break;
+  case 3:
+    check_update_v1();
+    break;
+  case 4:
+    check_update_v2();
+    break;
+  default:
+    break;
+  }
+  event_count++;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_binlog_st *binlog;
+  drizzle_st *con;
+  char path[128];
+
+  ASSERT_NOT_NULL_(mkdtemp(directory), "Could not create %s", directory);
+  write_binlog("binlog.000001");
+
+  rows= drizzle_binlog_rows_create();
+  ASSERT_NOT_NULL_(rows, "Could not create the decoder");
+
+  /* The connection is only there for the errors, nothing listens on it */
+  snprintf(path, sizeof(path), "%s/mysql.sock", directory);
+  con= drizzle_create(path, 0, "root", NULL, NULL, NULL);
+  ASSERT_NOT_NULL_(con, "Drizzle connection object creation error");
+  binlog= drizzle_binlog_init(con, binlog_event, binlog_error, NULL, true);
+  ASSERT_NOT_NULL_(binlog, "Binlog object creation error");
+
+  snprintf(path, sizeof(path), "%s/binlog.000001", directory);
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, drizzle_binlog_start_file(binlog, path));
+  ASSERT_EQ(sizeof(expected_ret) / sizeof(expected_ret[0]), event_count);
+  unlink(path);
+
+  write_limit_binlog("binlog.000002");
+  checking_limit= true;
+  event_count= 0;
+  snprintf(path, sizeof(path), "%s/binlog.000002", directory);
+  ASSERT_EQ(DRIZZLE_RETURN_EOF, drizzle_binlog_start_file(binlog, path));
+  ASSERT_EQ(1 + TABLE_LIMIT + 2 + 3, event_count);
+  unlink(path);
+
+  drizzle_binlog_free(binlog);
+  drizzle_quit(con);
+  drizzle_binlog_rows_free(rows);
+
+  rmdir(directory);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BUFFER_SIZE (256 * 1024)
+
+#ifdef __GLIBC__
+/* Tracks the largest allocation made while connecting. The hooks are
+   exported to take the place of the allocator in the library. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static bool track_allocations= false;
+static size_t largest_allocation= 0;
+
+static void track(size_t size)
+{
+  if (track_allocations && size > largest_allocation)
+  {
+    largest_allocation= size;
+  }
+}
+
+__attribute__((visibility("default")))
+void *malloc(size_t size)
+{
+  track(size);
+  return __libc_malloc(size);
+}
+
+__attribute__((visibility("default")))
+void *calloc(size_t count, size_t size)
+{
+  track(count * size);
+  return __libc_calloc(count, size);
+}
+
+__attribute__((visibility("default")))
+void *realloc(void *ptr, size_t size)
+{
+  track(size);
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+/* Values that make the buffer grow, each followed by a small one after which
+   it has shrunk back */
+static const size_t sizes[]= { 100, 64 * 1024, 100, 200 * 1024, 100 };
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_row_t row;
+  size_t *field_sizes;
+  size_t length;
+  size_t x;
+  char *query;
+
+  opts= drizzle_options_create();
+  ASSERT_NOT_NULL_(opts, "Could not create the options");
+  ASSERT_EQ(DRIZZLE_DEFAULT_BUFFER_SIZE, drizzle_options_get_buffer_size(opts));
+  ASSERT_EQ(DRIZZLE_MAX_BUFFER_SIZE, drizzle_options_get_max_buffer_size(opts));
+
+  drizzle_options_set_buffer_size(opts, 1);
+  ASSERT_EQ(DRIZZLE_MIN_BUFFER_SIZE, drizzle_options_get_buffer_size(opts));
+  drizzle_options_set_max_buffer_size(opts, MAX_BUFFER_SIZE);
+  ASSERT_EQ(MAX_BUFFER_SIZE, drizzle_options_get_max_buffer_size(opts));
+
+#ifdef __GLIBC__
+  track_allocations= true;
+#endif
+  set_up_connection();
+#ifdef __GLIBC__
+  track_allocations= false;
+  /* The buffer never takes the default size before the configured one */
+  ASSERT_TRUE_(largest_allocation < DRIZZLE_DEFAULT_BUFFER_SIZE,
+               "%zu bytes allocated while connecting", largest_allocation);
+#endif
+
+  for (x= 0; x < sizeof(sizes) / sizeof(sizes[0]); x++)
+  {
+    length= sizes[x];
+    query= (char *)malloc(length + 10);
+    ASSERT_NOT_NULL_(query, "Could not allocate the query");
+    memcpy(query, "SELECT '", 8);
+    memset(query + 8, 'a' + (int)x, length);
+    memcpy(query + 8 + length, "'", 2);
+
+    result= drizzle_query(con, query, 0, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "Query of %zu bytes: %s", length,
+               drizzle_error(con));
+    CHECK(drizzle_result_buffer(result));
+    row= drizzle_row_next(result);
+    ASSERT_NOT_NULL_(row, "Could not get the next row");
+    field_sizes= drizzle_row_field_sizes(result);
+    ASSERT_EQ(length, field_sizes[0]);
+    ASSERT_EQ(0, memcmp(row[0], query + 8, length));
+    drizzle_result_free(result);
+    free(query);
+  }
+
+  /* A text row larger than the maximum is read in pieces */
+  length= MAX_BUFFER_SIZE * 2;
+  query= (char *)malloc(length + 10);
+  ASSERT_NOT_NULL_(query, "Could not allocate the query");
+  memcpy(query, "SELECT '", 8);
+  memset(query + 8, 'z', length);
+  memcpy(query + 8 + length, "'", 2);
+
+  result= drizzle_query(con, query, 0, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  CHECK(drizzle_result_buffer(result));
+  row= drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  field_sizes= drizzle_row_field_sizes(result);
+  ASSERT_EQ(length, field_sizes[0]);
+  ASSERT_EQ(0, memcmp(row[0], query + 8, length));
+  drizzle_result_free(result);
+  free(query);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLUMNAR_TEST_ROWS 50
+
+#define IS_VALID(__validity, __row) \
+  (((__validity)[(__row) / 8] >> ((__row) % 8)) & 1)
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  const char *values;
+  const uint64_t *offsets;
+  const uint8_t *validity;
+  char buf[16];
+  int i;
+
+  set_up_connection();
+  set_up_schema("test_columnar");
+
+  CHECKED_QUERY("CREATE TABLE test_columnar.t1 (a INT, b VARCHAR(32))");
+  for (i = 0; i < COLUMNAR_TEST_ROWS; i++)
+  {
+    char query[128];
+    if (i % 5 == 0)
+    {
+      snprintf(query, sizeof(query),
+               "INSERT INTO test_columnar.t1 VALUES (%d, NULL)", i);
+    }
+    else
+    {
+      snprintf(query, sizeof(query),
+               "INSERT INTO test_columnar.t1 VALUES (%d, 'v%d')", i, i);
+    }
+    CHECKED_QUERY(query);
+  }
+
+  CHECKED_QUERY("SELECT a, b FROM test_columnar.t1 ORDER BY a");
+  CHECK(drizzle_result_buffer_columnar(result));
+  ASSERT_EQ(drizzle_result_row_count(result), COLUMNAR_TEST_ROWS);
+
+  /* Column a */
+  values = drizzle_result_column_values(result, 0);
+  offsets = drizzle_result_column_offsets(result, 0);
+  validity = drizzle_result_column_validity(result, 0);
+  ASSERT_NOT_NULL_(values, "No values for column a");
+  ASSERT_NOT_NULL_(offsets, "No offsets for column a");
+  ASSERT_NOT_NULL_(validity, "No validity for column a");
+  ASSERT_EQ(offsets[0], 0);
+  for (i = 0; i < COLUMNAR_TEST_ROWS; i++)
+  {
+    snprintf(buf, sizeof(buf), "%d", i);
+    ASSERT_TRUE_(IS_VALID(validity, i), "Unexpected NULL in column a");
+    ASSERT_EQ(offsets[i + 1] - offsets[i], strlen(buf));
+    ASSERT_EQ_(memcmp(values + offsets[i], buf, strlen(buf)), 0,
+               "Retrieved bad value in column a");
+  }
+
+  /* Column b */
+  values = drizzle_result_column_values(result, 1);
+  offsets = drizzle_result_column_offsets(result, 1);
+  validity = drizzle_result_column_validity(result, 1);
+  for (i = 0; i < COLUMNAR_TEST_ROWS; i++)
+  {
+    if (i % 5 == 0)
+    {
+      ASSERT_FALSE_(IS_VALID(validity, i), "Expected NULL in column b");
+      ASSERT_EQ(offsets[i + 1], offsets[i]);
+      continue;
+    }
+
+    snprintf(buf, sizeof(buf), "v%d", i);
+    ASSERT_TRUE_(IS_VALID(validity, i), "Unexpected NULL in column b");
+    ASSERT_EQ(offsets[i + 1] - offsets[i], strlen(buf));
+    ASSERT_EQ_(memcmp(values + offsets[i], buf, strlen(buf)), 0,
+               "Retrieved bad value in column b");
+  }
+
+  ASSERT_NULL_(drizzle_result_column_offsets(result, 2),
+               "Offsets returned for a missing column");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_columnar.t1");
+
+  tear_down_schema("test_columnar");
+
+  return EXIT_SUCCESS;
+}
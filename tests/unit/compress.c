@@ -0,0 +1,137 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_VALUE_SIZE (256 * 1024)
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  size_t *field_sizes;
+  char *query;
+  size_t query_size;
+  size_t x;
+
+  opts = drizzle_options_create();
+  ASSERT_EQ(drizzle_options_get_compression(opts), DRIZZLE_COMPRESSION_NONE);
+  drizzle_options_set_compression(opts, DRIZZLE_COMPRESSION_ZLIB);
+  ASSERT_EQ(drizzle_options_get_compression(opts), DRIZZLE_COMPRESSION_ZLIB);
+
+  set_up_connection();
+  set_up_schema("test_compress");
+
+  CHECKED_QUERY("SHOW SESSION STATUS LIKE 'Compression'");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[1], "ON", "Compressed protocol not in use");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("CREATE TABLE test_compress.t1 (a INT, b LONGBLOB)");
+
+  /* A query which compresses well and one which does not, both spanning
+     many frames */
+  query = malloc(TEST_VALUE_SIZE + 64);
+  ASSERT_NOT_NULL_(query, "malloc() failed");
+
+  query_size = (size_t)snprintf(query, 64,
+                                "INSERT INTO test_compress.t1 VALUES (1, '");
+  memset(query + query_size, 'x', TEST_VALUE_SIZE);
+  query_size += TEST_VALUE_SIZE;
+  memcpy(query + query_size, "')", 2);
+  result = drizzle_query(con, query, query_size + 2, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  drizzle_result_free(result);
+
+  query_size = (size_t)snprintf(query, 64,
+                                "INSERT INTO test_compress.t1 VALUES (2, '");
+  srand(1);
+  for (x = 0; x < TEST_VALUE_SIZE; x++)
+  {
+    query[query_size + x] = (char)('a' + rand() % 26);
+  }
+  query_size += TEST_VALUE_SIZE;
+  memcpy(query + query_size, "')", 2);
+  result = drizzle_query(con, query, query_size + 2, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("SELECT a, b FROM test_compress.t1 ORDER BY a");
+  CHECK(drizzle_result_buffer(result));
+  ASSERT_EQ(drizzle_result_row_count(result), 2);
+
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  field_sizes = drizzle_row_field_sizes(result);
+  ASSERT_EQ(field_sizes[1], TEST_VALUE_SIZE);
+  ASSERT_EQ(row[1][0], 'x');
+  ASSERT_EQ(row[1][TEST_VALUE_SIZE - 1], 'x');
+
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  field_sizes = drizzle_row_field_sizes(result);
+  ASSERT_EQ(field_sizes[1], TEST_VALUE_SIZE);
+  ASSERT_EQ_(0, memcmp(row[1], query + query_size - TEST_VALUE_SIZE,
+                       TEST_VALUE_SIZE), "Retrieved bad value");
+  drizzle_result_free(result);
+  free(query);
+
+  /* Many small results */
+  CHECKED_QUERY("SELECT a FROM test_compress.t1 WHERE a = 2");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[0], "2", "Retrieved bad row");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_compress.t1");
+
+  tear_down_schema("test_compress");
+
+  return EXIT_SUCCESS;
+}
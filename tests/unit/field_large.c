@@ -0,0 +1,144 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BUFFER_SIZE (1024 * 1024)
+
+/* Fields that end a row exactly at the end of a packet, that leave the
+   length or the data of the next field in the next packet, and that take
+   a few packets */
+static const size_t sizes[]= { DRIZZLE_MAX_PAYLOAD_SIZE - 9,
+                               DRIZZLE_MAX_PAYLOAD_SIZE - 5,
+                               DRIZZLE_MAX_PAYLOAD_SIZE - 4,
+                               DRIZZLE_MAX_PAYLOAD_SIZE + 100,
+                               (DRIZZLE_MAX_PAYLOAD_SIZE * 2) - 14 };
+
+/* Streams the large field of a row in chunks, the buffer of the connection
+   never holds more than MAX_BUFFER_SIZE of it */
+static void read_streamed(drizzle_result_st *result, size_t length)
+{
+  drizzle_return_t driz_ret;
+  drizzle_field_t field;
+  uint64_t offset;
+  uint64_t total;
+  uint64_t next= 0;
+  size_t size;
+  size_t x;
+
+  ASSERT_EQ(1, drizzle_row_read(result, &driz_ret));
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+
+  do
+  {
+    field= drizzle_field_read(result, &offset, &size, &total, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+    ASSERT_EQ((uint64_t)length, total);
+    ASSERT_EQ(next, offset);
+    ASSERT_TRUE(size <= MAX_BUFFER_SIZE);
+    for (x= 0; x < size; x++)
+    {
+      ASSERT_EQ('x', field[x]);
+    }
+    next+= size;
+  } while (next < total);
+
+  field= drizzle_field_read(result, &offset, &size, &total, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  ASSERT_EQ(UINT64_C(4), total);
+  ASSERT_EQ(4U, size);
+  ASSERT_EQ(0, memcmp(field, "tail", 4));
+
+  drizzle_field_read(result, NULL, NULL, NULL, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, driz_ret);
+
+  ASSERT_EQ(0, drizzle_row_read(result, &driz_ret));
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_row_t row;
+  size_t *field_sizes;
+  char query[64];
+  size_t x;
+
+  opts= drizzle_options_create();
+  ASSERT_NOT_NULL_(opts, "Could not create the options");
+  drizzle_options_set_buffer_size(opts, 64 * 1024);
+  drizzle_options_set_max_buffer_size(opts, MAX_BUFFER_SIZE);
+
+  set_up_connection();
+
+  for (x= 0; x < sizeof(sizes) / sizeof(sizes[0]); x++)
+  {
+    snprintf(query, sizeof(query), "SELECT REPEAT('x', %zu), 'tail'",
+             sizes[x]);
+
+    result= drizzle_query(con, query, 0, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+    CHECK(drizzle_column_buffer(result));
+    read_streamed(result, sizes[x]);
+    drizzle_result_free(result);
+  }
+
+  /* Buffered rows are put together from the same chunks */
+  snprintf(query, sizeof(query), "SELECT REPEAT('x', %zu), 'tail'", sizes[3]);
+  result= drizzle_query(con, query, 0, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  CHECK(drizzle_result_buffer(result));
+  row= drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  field_sizes= drizzle_row_field_sizes(result);
+  ASSERT_EQ(sizes[3], field_sizes[0]);
+  ASSERT_EQ('x', row[0][sizes[3] - 1]);
+  ASSERT_EQ(4U, field_sizes[1]);
+  ASSERT_STREQ("tail", row[1]);
+  drizzle_result_free(result);
+
+  return EXIT_SUCCESS;
+}
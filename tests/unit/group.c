@@ -0,0 +1,177 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GROUP_CONNECTIONS 16
+
+typedef struct
+{
+  drizzle_st *con;
+  drizzle_result_st *result;
+  int stage;
+} group_job_t;
+
+static group_job_t jobs[GROUP_CONNECTIONS];
+
+/* Carry on with the operation of a job until it has to wait for I/O.
+ * Returns 1 once the result of its query has been read. */
+static int job_step(group_job_t *job)
+{
+  drizzle_return_t driz_ret;
+  char query[64];
+
+  if (job->stage == 0)
+  {
+    driz_ret = drizzle_connect(job->con);
+    if (driz_ret == DRIZZLE_RETURN_IO_WAIT)
+      return 0;
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_connect(): %s",
+               drizzle_error(job->con));
+    job->stage = 1;
+  }
+
+  if (job->stage == 1)
+  {
+    snprintf(query, sizeof(query), "SELECT SLEEP(0.1), %d",
+             (int)(job - jobs));
+    job->result = drizzle_query(job->con, query, 0, &driz_ret);
+    if (driz_ret == DRIZZLE_RETURN_IO_WAIT)
+      return 0;
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+               drizzle_error(job->con));
+    job->stage = 2;
+  }
+
+  driz_ret = drizzle_result_buffer(job->result);
+  if (driz_ret == DRIZZLE_RETURN_IO_WAIT)
+    return 0;
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_result_buffer(): %s",
+             drizzle_error(job->con));
+  job->stage = 3;
+  return 1;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_return_t driz_ret;
+  drizzle_group_st *group;
+  drizzle_st *ready;
+  char buf[10];
+  int done = 0;
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  group = drizzle_group_create();
+  ASSERT_NOT_NULL_(group, "drizzle_group_create() failed");
+
+  for (i = 0; i < GROUP_CONNECTIONS; i++)
+  {
+    jobs[i].con = drizzle_create(drizzle_host(con), drizzle_port(con),
+                                 drizzle_user(con),
+                                 getenv("MYSQL_PASSWORD"),
+                                 drizzle_db(con), opts);
+    ASSERT_NOT_NULL_(jobs[i].con, "Drizzle connection object creation error");
+    CHECK(drizzle_group_add(group, jobs[i].con));
+    done += job_step(&jobs[i]);
+  }
+  ASSERT_EQ(drizzle_group_count(group), GROUP_CONNECTIONS);
+  ASSERT_EQ_(DRIZZLE_RETURN_INVALID_ARGUMENT,
+             drizzle_group_add(group, jobs[0].con),
+             "A connection was added to a group twice");
+
+  /* The queries sleep concurrently, so waiting for all of them takes about
+   * as long as one of them */
+  while (done < GROUP_CONNECTIONS)
+  {
+    driz_ret = drizzle_group_wait(group, 10000);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_group_wait(): %s",
+               drizzle_strerror(driz_ret));
+
+    while ((ready = drizzle_group_ready(group)) != NULL)
+    {
+      for (i = 0; jobs[i].con != ready; i++)
+      {
+        ASSERT_TRUE_(i < GROUP_CONNECTIONS - 1,
+                     "Unknown connection returned by drizzle_group_ready()");
+      }
+      ASSERT_TRUE_(jobs[i].stage != 3, "Finished connection returned again");
+      done += job_step(&jobs[i]);
+    }
+  }
+
+  ASSERT_EQ_(DRIZZLE_RETURN_NO_ACTIVE_CONNECTIONS,
+             drizzle_group_wait(group, 0),
+             "Idle group reported active connections");
+
+  for (i = 0; i < GROUP_CONNECTIONS; i++)
+  {
+    ASSERT_EQ(drizzle_result_row_count(jobs[i].result), 1);
+    row = drizzle_row_next(jobs[i].result);
+    ASSERT_NOT_NULL_(row, "Could not get the next row");
+    snprintf(buf, sizeof(buf), "%d", i);
+    ASSERT_STREQ_(row[1], buf, "Result returned to the wrong connection");
+    drizzle_result_free(jobs[i].result);
+
+    CHECK(drizzle_group_remove(group, jobs[i].con));
+
+    /* Out of the group the connection blocks again */
+    jobs[i].result = drizzle_query(jobs[i].con, "SELECT SLEEP(0.1), 0", 0,
+                                   &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+               drizzle_error(jobs[i].con));
+    CHECK(drizzle_result_buffer(jobs[i].result));
+    drizzle_result_free(jobs[i].result);
+    drizzle_quit(jobs[i].con);
+  }
+  ASSERT_EQ(drizzle_group_count(group), 0);
+
+  drizzle_group_free(group);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Enough rows to span several packets of the default buffer */
+#define ROW_COUNT 100000
+
+struct generator_st
+{
+  unsigned row;       /* next row to generate */
+  char line[32];      /* current row, not sent completely yet */
+  size_t line_size;
+  size_t line_offset;
+  unsigned calls;
+  unsigned fail_at;   /* call to fail, 0 to never fail */
+};
+
+/* Generates the rows of the file as they are asked for, with every second
+   call reporting the data is not ready yet. */
+static drizzle_return_t generate(drizzle_st *connection, const char *filename,
+                                 unsigned char *buffer, size_t buffer_size,
+                                 size_t *read_size, void *context)
+{
+  struct generator_st *gen= (struct generator_st *)context;
+  size_t size= 0;
+  size_t copy;
+  (void)connection;
+
+  ASSERT_STREQ("generated.tsv", filename);
+  ASSERT_TRUE(buffer_size > 0);
+
+  gen->calls++;
+  if (gen->calls == gen->fail_at)
+  {
+    return DRIZZLE_RETURN_ERRNO;
+  }
+  if (gen->calls % 2 == 1)
+  {
+    return DRIZZLE_RETURN_IO_WAIT;
+  }
+
+  while (size < buffer_size)
+  {
+    if (gen->line_offset == gen->line_size)
+    {
+      if (gen->row == (unsigned)ROW_COUNT)
+      {
+        break;
+      }
+      gen->line_size= (size_t)snprintf(gen->line, sizeof(gen->line),
+                                       "%u\trow %u\n", gen->row, gen->row);
+      gen->line_offset= 0;
+      gen->row++;
+    }
+
+    copy= gen->line_size - gen->line_offset;
+    if (copy > buffer_size - size)
+    {
+      copy= buffer_size - size;
+    }
+    memcpy(buffer + size, gen->line + gen->line_offset, copy);
+    gen->line_offset+= copy;
+    size+= copy;
+  }
+
+  *read_size= size;
+  return DRIZZLE_RETURN_OK;
+}
+
+static drizzle_result_st *load(drizzle_return_t *ret_ptr)
+{
+  const char *query= "LOAD DATA LOCAL INFILE 'generated.tsv' "
+                     "INTO TABLE test_infile.t1";
+  drizzle_result_st *result;
+
+  do
+  {
+    result= drizzle_query(con, query, 0, ret_ptr);
+  } while (*ret_ptr == DRIZZLE_RETURN_IO_WAIT);
+
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  struct generator_st gen;
+
+  set_up_connection();
+  set_up_schema("test_infile");
+
+  CHECKED_QUERY("CREATE TABLE test_infile.t1 (a INT, b VARCHAR(32))");
+  drizzle_result_free(result);
+
+  /* The capability is only sent when connecting */
+  memset(&gen, 0, sizeof(gen));
+  drizzle_set_infile_fn(con, generate, &gen);
+  drizzle_close(con);
+
+  result= load(&driz_ret);
+  SKIP_IF_(driz_ret == DRIZZLE_RETURN_ERROR_CODE &&
+           (drizzle_error_code(con) == 1148 || drizzle_error_code(con) == 3948),
+           "LOAD DATA LOCAL INFILE is disabled on the server: %s",
+           drizzle_error(con));
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  ASSERT_EQ((uint64_t)ROW_COUNT, drizzle_result_affected_rows(result));
+  ASSERT_EQ(ROW_COUNT, (int)gen.row);
+  ASSERT_TRUE(gen.calls > 4);
+  drizzle_result_free(result);
+
+  /* A failing source aborts the statement */
+  memset(&gen, 0, sizeof(gen));
+  gen.fail_at= 5;
+  result= load(&driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_ERRNO, driz_ret, "%s", drizzle_error(con));
+  ASSERT_NULL_(result, "Result of an aborted statement");
+
+  /* The connection is opened again for the next query */
+  CHECKED_QUERY("SELECT 1");
+  CHECK(drizzle_result_buffer(result));
+  drizzle_result_free(result);
+
+  tear_down_schema("test_infile");
+
+  return EXIT_SUCCESS;
+}
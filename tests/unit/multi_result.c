@@ -0,0 +1,135 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_result_st *next;
+  drizzle_return_t driz_ret;
+  size_t *sizes;
+  int rows;
+
+  opts = drizzle_options_create();
+  drizzle_options_set_multi_statements(opts, true);
+
+  set_up_connection();
+  set_up_schema("test_multi_result");
+
+  CHECKED_QUERY("CREATE TABLE test_multi_result.t1 (a INT)");
+
+  /* A result set, an OK packet and a result set read in one round trip */
+  CHECKED_QUERY("SELECT 1, 2; "
+                "INSERT INTO test_multi_result.t1 VALUES (1), (2), (3); "
+                "SELECT a FROM test_multi_result.t1 ORDER BY a");
+  ASSERT_FALSE_(drizzle_result_more_results(result),
+                "More results known before the result was read");
+  next = drizzle_result_next(result, &driz_ret);
+  ASSERT_NULL_(next, "Next result read before the result was read");
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_READY, driz_ret);
+
+  CHECK(drizzle_result_buffer(result));
+  ASSERT_EQ(drizzle_result_column_count(result), 2);
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[1], "2", "Retrieved bad row value");
+  ASSERT_TRUE_(drizzle_result_more_results(result), "No more results");
+
+  next = drizzle_result_next(result, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_result_next(): %s",
+             drizzle_error(con));
+  ASSERT_NOT_NULL_(next, "No result for the INSERT");
+  drizzle_result_free(result);
+  result = next;
+  ASSERT_EQ(drizzle_result_column_count(result), 0);
+  ASSERT_EQ(drizzle_result_affected_rows(result), 3);
+  ASSERT_TRUE_(drizzle_result_more_results(result), "No more results");
+
+  /* Stream the last result set without buffering it */
+  next = drizzle_result_next(result, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_result_next(): %s",
+             drizzle_error(con));
+  drizzle_result_free(result);
+  result = next;
+  CHECK(drizzle_column_buffer(result));
+  rows = 0;
+  while ((row = drizzle_row_view(result, &sizes, &driz_ret)) != NULL)
+  {
+    rows++;
+  }
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  ASSERT_EQ_(rows, 3, "Retrieved bad number of rows");
+  ASSERT_FALSE_(drizzle_result_more_results(result), "Unexpected result");
+
+  next = drizzle_result_next(result, &driz_ret);
+  ASSERT_NULL_(next, "Result returned after the last one");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  drizzle_result_free(result);
+
+  /* An error ends the response, statements after it are not run */
+  CHECKED_QUERY("SELECT 1; SELECT a FROM test_multi_result.t2; SELECT 3");
+  CHECK(drizzle_result_buffer(result));
+  next = drizzle_result_next(result, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_ERROR_CODE, driz_ret);
+  ASSERT_EQ(drizzle_result_error_code(next), 1146);
+  ASSERT_FALSE_(drizzle_result_more_results(next), "Result after an error");
+  drizzle_result_free(next);
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("SELECT COUNT(*) FROM test_multi_result.t1");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[0], "3", "Retrieved bad row count");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_multi_result.t1");
+
+  tear_down_schema("test_multi_result");
+
+  return EXIT_SUCCESS;
+}
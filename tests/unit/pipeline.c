@@ -0,0 +1,133 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_pipeline_st *pipeline;
+  char query[64];
+  char buf[10];
+  int i;
+
+  set_up_connection();
+  set_up_schema("test_pipeline");
+
+  CHECKED_QUERY("CREATE TABLE test_pipeline.t1 (a INT)");
+
+  /* More queries than the window, with a failing query in the middle */
+  pipeline = drizzle_pipeline_create(con, 4);
+  ASSERT_NOT_NULL_(pipeline, "drizzle_pipeline_create() failed");
+
+  for (i = 1; i <= 10; i++)
+  {
+    snprintf(query, sizeof(query), "INSERT INTO test_pipeline.t1 VALUES (%d)",
+             i);
+    CHECK(drizzle_pipeline_query(pipeline, query, 0));
+  }
+  CHECK(drizzle_pipeline_query(pipeline, "SELECT * FROM test_pipeline.t2", 0));
+  for (i = 1; i <= 10; i++)
+  {
+    snprintf(query, sizeof(query),
+             "SELECT a FROM test_pipeline.t1 WHERE a = %d", i);
+    CHECK(drizzle_pipeline_query(pipeline, query, 0));
+  }
+  ASSERT_EQ(drizzle_pipeline_pending(pipeline), 21);
+  CHECK(drizzle_pipeline_flush(pipeline));
+
+  for (i = 1; i <= 10; i++)
+  {
+    result = drizzle_pipeline_result(pipeline, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_pipeline_result(): %s",
+               drizzle_error(con));
+    ASSERT_EQ(drizzle_result_affected_rows(result), 1);
+    drizzle_result_free(result);
+  }
+
+  result = drizzle_pipeline_result(pipeline, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_ERROR_CODE, driz_ret,
+             "Query on a missing table did not fail: %s",
+             drizzle_strerror(driz_ret));
+  ASSERT_NOT_NULL_(result, "No result for the failed query");
+  ASSERT_EQ(drizzle_result_error_code(result), 1146);
+  drizzle_result_free(result);
+
+  for (i = 1; i <= 10; i++)
+  {
+    result = drizzle_pipeline_result(pipeline, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_pipeline_result(): %s",
+               drizzle_error(con));
+    CHECK(drizzle_result_buffer(result));
+    ASSERT_EQ(drizzle_result_row_count(result), 1);
+    row = drizzle_row_next(result);
+    ASSERT_NOT_NULL_(row, "Could not get the next row");
+    snprintf(buf, sizeof(buf), "%d", i);
+    ASSERT_STREQ_(row[0], buf, "Result returned out of order");
+    drizzle_result_free(result);
+  }
+
+  ASSERT_EQ(drizzle_pipeline_pending(pipeline), 0);
+  result = drizzle_pipeline_result(pipeline, &driz_ret);
+  ASSERT_NULL_(result, "Result returned from an empty pipeline");
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  drizzle_pipeline_free(pipeline);
+
+  /* The connection must still be usable for ordinary queries */
+  CHECKED_QUERY("SELECT COUNT(*) FROM test_pipeline.t1");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[0], "10", "Retrieved bad row count");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_pipeline.t1");
+
+  tear_down_schema("test_pipeline");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_MAX 4
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_pool_st *pool;
+  drizzle_st *pooled[POOL_MAX];
+  drizzle_st *extra;
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  pool = drizzle_pool_create(con, 1, POOL_MAX);
+  ASSERT_NOT_NULL_(pool, "drizzle_pool_create() failed");
+  ASSERT_NULL_(drizzle_pool_create(con, 2, 1),
+               "Pool created with a minimum size above its maximum");
+
+  /* Check out more connections than the pool may hold */
+  for (i = 0; i < POOL_MAX; i++)
+  {
+    pooled[i] = drizzle_pool_checkout(pool, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_pool_checkout(): %s",
+               drizzle_strerror(driz_ret));
+  }
+  ASSERT_EQ(drizzle_pool_size(pool), POOL_MAX);
+  extra = drizzle_pool_checkout(pool, &driz_ret);
+  ASSERT_NULL_(extra, "Checked out more connections than the pool holds");
+  ASSERT_EQ(DRIZZLE_RETURN_POOL_EXHAUSTED, driz_ret);
+
+  /* Session state must not leak to the next user of a connection */
+  for (i = 0; i < POOL_MAX; i++)
+  {
+    result = drizzle_query(pooled[i], "SET @pool_var = 1", 0, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+               drizzle_error(pooled[i]));
+    drizzle_result_free(result);
+    CHECK(drizzle_pool_checkin(pool, pooled[i]));
+  }
+  ASSERT_EQ(drizzle_pool_idle(pool), POOL_MAX);
+  ASSERT_EQ_(DRIZZLE_RETURN_INVALID_ARGUMENT,
+             drizzle_pool_checkin(pool, pooled[0]),
+             "Connection checked in twice");
+
+  extra = drizzle_pool_checkout(pool, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  ASSERT_TRUE_(extra == pooled[0] || extra == pooled[1] ||
+               extra == pooled[2] || extra == pooled[3],
+               "Idle connection was not reused");
+  result = drizzle_query(extra, "SELECT @pool_var", 0, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+             drizzle_error(extra));
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_NULL_(row[0], "Session variable survived the checkin");
+  drizzle_result_free(result);
+
+  /* A closed connection is replaced instead of reused */
+  drizzle_close(extra);
+  CHECK(drizzle_pool_checkin(pool, extra));
+  ASSERT_EQ(drizzle_pool_size(pool), POOL_MAX - 1);
+  extra = drizzle_pool_checkout(pool, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  result = drizzle_query(extra, "SELECT 1", 0, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+             drizzle_error(extra));
+  drizzle_result_free(result);
+  CHECK(drizzle_pool_checkin(pool, extra));
+
+  /* A connection checked out when the pool is freed stays open */
+  extra = drizzle_pool_checkout(pool, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  drizzle_pool_free(pool);
+  result = drizzle_query(extra, "SELECT 1", 0, &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_query(): %s",
+             drizzle_error(extra));
+  drizzle_result_free(result);
+  drizzle_quit(extra);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Queries around the copy threshold and larger than the write buffer */
+static const size_t sizes[]= { DRIZZLE_BUFFER_COPY_THRESHOLD - 16,
+                               DRIZZLE_BUFFER_COPY_THRESHOLD,
+                               200 * 1024,
+                               DRIZZLE_DEFAULT_BUFFER_SIZE * 2 };
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_row_t row;
+  size_t *field_sizes;
+  size_t length;
+  size_t x;
+  char *query;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  for (x= 0; x < sizeof(sizes) / sizeof(sizes[0]); x++)
+  {
+    length= sizes[x];
+    query= (char *)malloc(length + 10);
+    ASSERT_NOT_NULL_(query, "Could not allocate the query");
+    memcpy(query, "SELECT '", 8);
+    memset(query + 8, 'a' + (int)x, length);
+    memcpy(query + 8 + length, "'", 2);
+
+    result= drizzle_query(con, query, 0, &driz_ret);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "Query of %zu bytes: %s", length,
+               drizzle_error(con));
+    CHECK(drizzle_result_buffer(result));
+    row= drizzle_row_next(result);
+    ASSERT_NOT_NULL_(row, "Could not get the next row");
+    field_sizes= drizzle_row_field_sizes(result);
+    ASSERT_EQ(length, field_sizes[0]);
+    ASSERT_EQ(0, memcmp(row[0], query + 8, length));
+    drizzle_result_free(result);
+    free(query);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_TEST_ROWS 2000
+
+/* Buffering into the arena takes a few chunks, never memory per row */
+#define ARENA_TEST_MAX_SIZE (1024 * 1024)
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  size_t *sizes;
+  uint64_t arena_size;
+  char buf[32];
+  int i;
+
+  opts = drizzle_options_create();
+  ASSERT_FALSE_(drizzle_options_get_result_arena(opts),
+                "Result arena should be disabled by default");
+  drizzle_options_set_result_arena(opts, true);
+  ASSERT_TRUE_(drizzle_options_get_result_arena(opts),
+               "Result arena option was not set");
+  ASSERT_EQ(drizzle_result_arena_size(NULL), 0);
+
+  set_up_connection();
+  set_up_schema("test_result_arena");
+
+  CHECKED_QUERY("CREATE TABLE test_result_arena.t1 (a INT PRIMARY KEY, "
+                "b VARCHAR(255), c LONGTEXT)");
+  drizzle_result_free(result);
+
+  for (i = 1; i <= ARENA_TEST_ROWS; i++)
+  {
+    char query[128];
+    snprintf(query, sizeof(query),
+             "INSERT INTO test_result_arena.t1 VALUES (%d, %s, NULL)", i,
+             (i % 3) == 0 ? "NULL" : ((i % 3) == 1 ? "'arena'" : "''"));
+    CHECKED_QUERY(query);
+    drizzle_result_free(result);
+  }
+
+  /* A value larger than an arena chunk */
+  CHECKED_QUERY("UPDATE test_result_arena.t1 SET c = REPEAT('x', 300000) "
+                "WHERE a = 1");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("SELECT a, b, c FROM test_result_arena.t1 ORDER BY a");
+  ASSERT_EQ_(drizzle_result_arena_size(result), 0,
+             "Arena created before the result was buffered");
+  CHECK(drizzle_result_buffer(result));
+  ASSERT_EQ(drizzle_result_row_count(result), ARENA_TEST_ROWS);
+
+  /* Every row, its field sizes and the large value must be in the arena */
+  arena_size = drizzle_result_arena_size(result);
+  ASSERT_TRUE_(arena_size >= ARENA_TEST_ROWS * 3 *
+                             (sizeof(drizzle_field_t) + sizeof(size_t)) + 300000,
+               "%" PRIu64 " arena bytes buffering %d rows", arena_size,
+               ARENA_TEST_ROWS);
+  ASSERT_TRUE_(arena_size < ARENA_TEST_MAX_SIZE,
+               "%" PRIu64 " arena bytes buffering %d rows", arena_size,
+               ARENA_TEST_ROWS);
+
+  i = 0;
+  while ((row = drizzle_row_next(result)))
+  {
+    i++;
+    sizes = drizzle_row_field_sizes(result);
+    snprintf(buf, sizeof(buf), "%d", i);
+    ASSERT_STREQ_(row[0], buf, "Retrieved bad row value");
+    ASSERT_EQ(sizes[0], strlen(buf));
+
+    if ((i % 3) == 1)
+    {
+      ASSERT_STREQ_(row[1], "arena", "Retrieved bad row value");
+      ASSERT_EQ(sizes[1], 5);
+    }
+    else
+    {
+      ASSERT_NULL_(row[1], "Expected NULL or empty field");
+      ASSERT_EQ(sizes[1], 0);
+    }
+
+    if (i == 1)
+    {
+      ASSERT_EQ(sizes[2], 300000);
+      ASSERT_EQ(strlen(row[2]), 300000);
+    }
+    else
+    {
+      ASSERT_NULL_(row[2], "Expected NULL field");
+    }
+  }
+  ASSERT_EQ_(i, ARENA_TEST_ROWS, "Retrieved bad number of rows");
+
+  /* Rows are owned by the arena, freeing them individually is a no-op */
+  row = drizzle_row_index(result, 1);
+  ASSERT_NOT_NULL_(row, "Could not get indexed row");
+  drizzle_row_free(result, row);
+  ASSERT_STREQ_(row[0], "2", "Arena row freed individually");
+
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_result_arena.t1");
+  drizzle_result_free(result);
+
+  tear_down_schema("test_result_arena");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_TEST_ROWS 100
+#define BATCH_SIZE 16
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  const char *data;
+  size_t offsets[BATCH_SIZE * 2];
+  size_t lengths[BATCH_SIZE * 2];
+  bool nulls[BATCH_SIZE * 2];
+  uint64_t rows;
+  uint64_t row;
+  char buf[16];
+  int i;
+
+  set_up_connection();
+  set_up_schema("test_row_read_many");
+
+  CHECKED_QUERY("CREATE TABLE test_row_read_many.t1 (a INT, b VARCHAR(32))");
+  for (i = 1; i <= BATCH_TEST_ROWS; i++)
+  {
+    char query[128];
+    if (i % 2)
+    {
+      snprintf(query, sizeof(query),
+               "INSERT INTO test_row_read_many.t1 VALUES (%d, 'row%d')", i, i);
+    }
+    else
+    {
+      snprintf(query, sizeof(query),
+               "INSERT INTO test_row_read_many.t1 VALUES (%d, NULL)", i);
+    }
+    CHECKED_QUERY(query);
+  }
+
+  CHECKED_QUERY("SELECT a, b FROM test_row_read_many.t1 ORDER BY a");
+  CHECK(drizzle_column_buffer(result));
+  ASSERT_EQ(drizzle_result_column_count(result), 2);
+
+  i = 0;
+  while ((rows = drizzle_row_read_many(result, BATCH_SIZE, &data, offsets,
+                                       lengths, nulls, &driz_ret)))
+  {
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_row_read_many(): %s",
+               drizzle_strerror(driz_ret));
+    ASSERT_TRUE_(rows <= BATCH_SIZE, "Too many rows in batch");
+
+    for (row = 0; row < rows; row++)
+    {
+      i++;
+      snprintf(buf, sizeof(buf), "%d", i);
+      ASSERT_FALSE_(nulls[row * 2], "Unexpected NULL field");
+      ASSERT_EQ(lengths[row * 2], strlen(buf));
+      ASSERT_EQ_(memcmp(data + offsets[row * 2], buf, lengths[row * 2]), 0,
+                 "Retrieved bad row value");
+
+      if (i % 2)
+      {
+        snprintf(buf, sizeof(buf), "row%d", i);
+        ASSERT_FALSE_(nulls[row * 2 + 1], "Unexpected NULL field");
+        ASSERT_EQ(lengths[row * 2 + 1], strlen(buf));
+        ASSERT_EQ_(memcmp(data + offsets[row * 2 + 1], buf,
+                          lengths[row * 2 + 1]), 0,
+                   "Retrieved bad field value");
+      }
+      else
+      {
+        ASSERT_TRUE_(nulls[row * 2 + 1], "Expected NULL field");
+        ASSERT_EQ(lengths[row * 2 + 1], 0);
+      }
+    }
+  }
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_row_read_many(): %s",
+             drizzle_strerror(driz_ret));
+  ASSERT_EQ_(i, BATCH_TEST_ROWS, "Retrieved bad number of rows");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_row_read_many.t1");
+
+  tear_down_schema("test_row_read_many");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_row_t row;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  size_t *sizes;
+  char buf[10];
+  int i;
+
+  set_up_connection();
+  set_up_schema("test_row_view");
+
+  CHECKED_QUERY("CREATE TABLE test_row_view.t1 (a INT, b VARCHAR(255))");
+  CHECKED_QUERY("INSERT INTO test_row_view.t1 VALUES (1, 'one'), (2, NULL), "
+                "(3, ''), (4, REPEAT('x', 1000))");
+
+  CHECKED_QUERY("SELECT a, b FROM test_row_view.t1 ORDER BY a");
+  CHECK(drizzle_column_buffer(result));
+  ASSERT_EQ(drizzle_result_column_count(result), 2);
+
+  i = 0;
+  while ((row = drizzle_row_view(result, &sizes, &driz_ret)))
+  {
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_row_view(): %s",
+               drizzle_strerror(driz_ret));
+    i++;
+    snprintf(buf, sizeof(buf), "%d", i);
+    ASSERT_EQ(sizes[0], strlen(buf));
+    ASSERT_EQ_(memcmp(row[0], buf, sizes[0]), 0, "Retrieved bad row value");
+
+    switch (i)
+    {
+    case 1:
+      ASSERT_EQ(sizes[1], 3);
+      ASSERT_EQ_(memcmp(row[1], "one", 3), 0, "Retrieved bad field value");
+      break;
+    case 2:
+      ASSERT_NULL_(row[1], "Expected NULL field");
+      ASSERT_EQ(sizes[1], 0);
+      break;
+    case 3:
+      ASSERT_NOT_NULL_(row[1], "Empty field returned as NULL");
+      ASSERT_EQ(sizes[1], 0);
+      break;
+    case 4:
+      ASSERT_EQ(sizes[1], 1000);
+      ASSERT_EQ_(row[1][0], 'x', "Retrieved bad field value");
+      ASSERT_EQ_(row[1][999], 'x', "Retrieved bad field value");
+      break;
+    }
+  }
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_row_view(): %s",
+             drizzle_strerror(driz_ret));
+  ASSERT_EQ_(i, 4, "Retrieved bad number of rows");
+  drizzle_result_free(result);
+
+  /* The connection must still be usable after viewing rows */
+  CHECKED_QUERY("SELECT COUNT(*) FROM test_row_view.t1");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ_(row[0], "4", "Retrieved bad row count");
+  drizzle_result_free(result);
+
+  CHECKED_QUERY("DROP TABLE test_row_view.t1");
+
+  tear_down_schema("test_row_view");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* More rows than are sent in one go */
+#define ROWS 200
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_stmt_st *stmt;
+  drizzle_row_t row;
+  uint32_t ids[ROWS];
+  const char *names[ROWS];
+  size_t lengths[ROWS];
+  bool nulls[ROWS];
+  uint64_t affected[ROWS];
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+  set_up_schema("test_stmt_array");
+
+  CHECKED_QUERY("CREATE TABLE test_stmt_array.t1 (a INT PRIMARY KEY, b VARCHAR(16), c INT)");
+  drizzle_result_free(result);
+
+  const char *query = "INSERT INTO test_stmt_array.t1 VALUES (?, ?, ?)";
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+
+  for (i = 0; i < ROWS; i++)
+  {
+    ids[i] = i + 1;
+    names[i] = (i % 2) ? "odd" : "even";
+    lengths[i] = strlen(names[i]);
+    nulls[i] = (i % 10) == 0;
+  }
+
+  /* Single values are repeated for every row */
+  CHECK(drizzle_stmt_set_array(stmt, 0, DRIZZLE_COLUMN_TYPE_LONG, ids, NULL,
+                               NULL, false));
+  CHECK(drizzle_stmt_set_array(stmt, 1, DRIZZLE_COLUMN_TYPE_STRING, names,
+                               lengths, nulls, false));
+  CHECK(drizzle_stmt_set_int(stmt, 2, 7, false));
+  ASSERT_EQ(DRIZZLE_RETURN_STMT_ERROR, drizzle_stmt_execute(stmt));
+
+  CHECK(drizzle_stmt_execute_array(stmt, ROWS, affected));
+  for (i = 0; i < ROWS; i++)
+  {
+    ASSERT_EQ_(1, affected[i], "Row %d affected %" PRIu64 " rows", i,
+               affected[i]);
+  }
+
+  /* A failing row does not stop the others */
+  for (i = 0; i < 5; i++)
+  {
+    ids[i] = ROWS + 1 + i;
+  }
+  ids[3] = ids[0];
+  driz_ret = drizzle_stmt_execute_array(stmt, 5, affected);
+  ASSERT_EQ_(DRIZZLE_RETURN_ERROR_CODE, driz_ret, "%s",
+             drizzle_strerror(driz_ret));
+  ASSERT_EQ(1, affected[0]);
+  ASSERT_EQ(1, affected[2]);
+  ASSERT_EQ(UINT64_MAX, affected[3]);
+  ASSERT_EQ(1, affected[4]);
+  CHECK(drizzle_stmt_close(stmt));
+
+  CHECKED_QUERY("SELECT COUNT(*), COUNT(b), SUM(c) FROM test_stmt_array.t1");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  ASSERT_STREQ("204", row[0]);
+  ASSERT_STREQ("183", row[1]);
+  ASSERT_STREQ("1428", row[2]);
+  drizzle_result_free(result);
+
+  tear_down_schema("test_stmt_array");
+
+  return EXIT_SUCCESS;
+}
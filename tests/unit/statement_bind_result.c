@@ -0,0 +1,143 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_stmt_st *stmt;
+  int32_t a;
+  uint64_t b;
+  int16_t c;
+  float d;
+  char e[4];
+  size_t e_length;
+  bool a_null, e_null;
+  size_t length;
+  const char *string;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+  set_up_schema("test_stmt_bind");
+
+  CHECKED_QUERY("CREATE TABLE test_stmt_bind.t1 (a TINYINT, b INT UNSIGNED, "
+                "c BIGINT PRIMARY KEY, d DOUBLE, e VARCHAR(16))");
+  drizzle_result_free(result);
+  CHECKED_QUERY("INSERT INTO test_stmt_bind.t1 VALUES "
+                "(-5, 4000000000, 1, 1.5, 'abc'), "
+                "(NULL, 7, 2, -2.25, NULL), "
+                "(127, 0, 100000, 0, 'abcdefgh')");
+  drizzle_result_free(result);
+
+  const char *query = "SELECT a, b, c, d, e FROM test_stmt_bind.t1 ORDER BY c";
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+
+  CHECK(drizzle_stmt_bind_result(stmt, 0, DRIZZLE_COLUMN_TYPE_LONG, &a,
+                                 sizeof(a), NULL, &a_null));
+  CHECK(drizzle_stmt_bind_result(stmt, 1, DRIZZLE_COLUMN_TYPE_LONGLONG, &b,
+                                 sizeof(b), NULL, NULL));
+  CHECK(drizzle_stmt_bind_result(stmt, 2, DRIZZLE_COLUMN_TYPE_SHORT, &c,
+                                 sizeof(c), NULL, NULL));
+  CHECK(drizzle_stmt_bind_result(stmt, 3, DRIZZLE_COLUMN_TYPE_FLOAT, &d,
+                                 sizeof(d), NULL, NULL));
+  CHECK(drizzle_stmt_bind_result(stmt, 4, DRIZZLE_COLUMN_TYPE_STRING, e,
+                                 sizeof(e), &e_length, &e_null));
+
+  /* Bad bindings are refused */
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_stmt_bind_result(stmt, 5, DRIZZLE_COLUMN_TYPE_LONG, &a,
+                                     sizeof(a), NULL, NULL));
+  ASSERT_EQ(DRIZZLE_RETURN_INVALID_ARGUMENT,
+            drizzle_stmt_bind_result(stmt, 0, DRIZZLE_COLUMN_TYPE_LONGLONG, &a,
+                                     sizeof(a), NULL, NULL));
+
+  CHECK(drizzle_stmt_execute(stmt));
+
+  /* Signed values are sign extended to the bound type */
+  CHECK(drizzle_stmt_fetch(stmt));
+  ASSERT_FALSE(a_null);
+  ASSERT_EQ(-5, a);
+  ASSERT_EQ(UINT64_C(4000000000), b);
+  ASSERT_EQ(1, c);
+  ASSERT_TRUE(d > 1.49f && d < 1.51f);
+  ASSERT_FALSE(e_null);
+  ASSERT_EQ(3U, e_length);
+  ASSERT_EQ(0, memcmp(e, "abc", 3));
+
+  /* The getters decode the same row */
+  ASSERT_EQ(UINT64_C(4000000000), drizzle_stmt_get_bigint(stmt, 1, &driz_ret));
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  string = drizzle_stmt_get_string(stmt, 0, &length, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  ASSERT_STREQ("-5", string);
+
+  CHECK(drizzle_stmt_fetch(stmt));
+  ASSERT_TRUE(a_null);
+  ASSERT_EQ(UINT64_C(7), b);
+  ASSERT_TRUE(d < -2.24f && d > -2.26f);
+  ASSERT_TRUE(e_null);
+
+  /* Values that do not fit are truncated */
+  ASSERT_EQ(DRIZZLE_RETURN_TRUNCATED, drizzle_stmt_fetch(stmt));
+  ASSERT_EQ(127, a);
+  ASSERT_EQ(UINT64_C(0), b);
+  ASSERT_EQ(8U, e_length);
+  ASSERT_EQ(0, memcmp(e, "abcd", 4));
+  string = drizzle_stmt_get_string(stmt, 4, &length, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  ASSERT_EQ(8U, length);
+  ASSERT_EQ(0, memcmp(string, "abcdefgh", 8));
+
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_stmt_fetch(stmt));
+  CHECK(drizzle_stmt_close(stmt));
+
+  tear_down_schema("test_stmt_bind");
+
+  return EXIT_SUCCESS;
+}
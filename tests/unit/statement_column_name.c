@@ -0,0 +1,106 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLUMNS 60
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_return_t driz_ret;
+  drizzle_stmt_st *stmt;
+  char query[2048];
+  char name[16];
+  size_t used;
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  /* SELECT 0 AS c0, 1 AS c1, ..., with the last name repeated */
+  used = (size_t)snprintf(query, sizeof(query), "SELECT ");
+  for (i = 0; i < COLUMNS; i++)
+  {
+    used += (size_t)snprintf(query + used, sizeof(query) - used, "%d AS c%d, ",
+                             i, i);
+  }
+  snprintf(query + used, sizeof(query) - used, "%d AS c%d", COLUMNS,
+           COLUMNS - 1);
+
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  ASSERT_EQ(COLUMNS + 1, drizzle_stmt_column_count(stmt));
+
+  for (i = 0; i < COLUMNS; i++)
+  {
+    snprintf(name, sizeof(name), "c%d", i);
+    ASSERT_EQ(i, drizzle_stmt_column_number(stmt, name, &driz_ret));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  }
+  drizzle_stmt_column_number(stmt, "c60", &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, driz_ret);
+  drizzle_stmt_column_number(stmt, "", &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, driz_ret);
+
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_buffer(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  for (i = 0; i < COLUMNS; i++)
+  {
+    snprintf(name, sizeof(name), "c%d", i);
+    ASSERT_EQ(i, (int)drizzle_stmt_get_bigint_from_name(stmt, name, &driz_ret));
+    ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  }
+
+  /* The first of two columns with the same name is found */
+  ASSERT_EQ(COLUMNS - 1,
+            (int)drizzle_stmt_get_bigint_from_name(stmt, "c59", &driz_ret));
+  drizzle_stmt_get_bigint_from_name(stmt, "missing", &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_FOUND, driz_ret);
+
+  CHECK(drizzle_stmt_close(stmt));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROWS 100
+
+/* Rows per COM_STMT_FETCH, not a divisor of ROWS */
+#define PREFETCH_ROWS 7
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_stmt_st *stmt;
+  uint32_t ids[ROWS];
+  uint32_t value;
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+  set_up_schema("test_stmt_cursor");
+
+  CHECKED_QUERY("CREATE TABLE test_stmt_cursor.t1 (a INT PRIMARY KEY)");
+  drizzle_result_free(result);
+
+  const char *query = "INSERT INTO test_stmt_cursor.t1 VALUES (?)";
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  for (i = 0; i < ROWS; i++)
+  {
+    ids[i] = i + 1;
+  }
+  CHECK(drizzle_stmt_set_array(stmt, 0, DRIZZLE_COLUMN_TYPE_LONG, ids, NULL,
+                               NULL, false));
+  CHECK(drizzle_stmt_execute_array(stmt, ROWS, NULL));
+  CHECK(drizzle_stmt_close(stmt));
+
+  query = "SELECT a FROM test_stmt_cursor.t1 ORDER BY a";
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+  CHECK(drizzle_stmt_set_cursor(stmt, PREFETCH_ROWS));
+  CHECK(drizzle_stmt_execute(stmt));
+
+  /* The rows stay on the server, so they cannot be buffered */
+  ASSERT_EQ(DRIZZLE_RETURN_NOT_READY, drizzle_stmt_buffer(stmt));
+
+  for (i = 0; i < ROWS; i++)
+  {
+    driz_ret = drizzle_stmt_fetch(stmt);
+    ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "Row %d: %s", i,
+               drizzle_error(con));
+    value = drizzle_stmt_get_int(stmt, 0, &driz_ret);
+    ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+    ASSERT_EQ(ids[i], value);
+
+    /* Other queries can run between two batches */
+    if ((i % PREFETCH_ROWS) == PREFETCH_ROWS - 1)
+    {
+      CHECKED_QUERY("SELECT 1");
+      CHECK(drizzle_result_buffer(result));
+      drizzle_result_free(result);
+    }
+  }
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_stmt_fetch(stmt));
+
+  /* A second execution opens a new cursor */
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  ASSERT_EQ(1, drizzle_stmt_get_int(stmt, 0, &driz_ret));
+  CHECK(drizzle_stmt_close(stmt));
+
+  tear_down_schema("test_stmt_cursor");
+
+  return EXIT_SUCCESS;
+}
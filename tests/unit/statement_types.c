@@ -0,0 +1,123 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Larger than the connection buffer, so it can not be packed in place */
+#define LARGE_PARAM_SIZE (2 * 1024 * 1024)
+
+static void execute_and_check(drizzle_stmt_st *stmt, const char *expected,
+                              size_t expected_len)
+{
+  drizzle_return_t driz_ret;
+  const char *value;
+  size_t len;
+
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_buffer(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  if (expected == NULL)
+  {
+    ASSERT_TRUE_(drizzle_stmt_get_is_null(stmt, 0, &driz_ret),
+                 "Expected a NULL value");
+  }
+  else
+  {
+    value = drizzle_stmt_get_string(stmt, 0, &len, &driz_ret);
+    ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+    ASSERT_EQ(expected_len, len);
+    ASSERT_EQ_(0, memcmp(expected, value, len), "Retrieved bad value");
+  }
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_stmt_fetch(stmt));
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_stmt_st *stmt;
+  drizzle_return_t driz_ret;
+  char *large;
+  int i;
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  const char *query = "SELECT ?";
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "%s", drizzle_error(con));
+
+  /* The types are only sent again when they change between executions */
+  for (i = 0; i < 3; i++)
+  {
+    CHECK(drizzle_stmt_set_int(stmt, 0, 12345, false));
+    execute_and_check(stmt, "12345", 5);
+  }
+
+  CHECK(drizzle_stmt_set_bigint(stmt, 0, UINT64_C(1234567890123), false));
+  execute_and_check(stmt, "1234567890123", 13);
+
+  CHECK(drizzle_stmt_set_null(stmt, 0));
+  execute_and_check(stmt, NULL, 0);
+
+  CHECK(drizzle_stmt_set_string(stmt, 0, "libdrizzle", 10));
+  execute_and_check(stmt, "libdrizzle", 10);
+
+  large = malloc(LARGE_PARAM_SIZE);
+  ASSERT_NOT_NULL_(large, "malloc() failed");
+  for (i = 0; i < LARGE_PARAM_SIZE; i++)
+  {
+    large[i] = 'a' + i % 26;
+  }
+  CHECK(drizzle_stmt_set_string(stmt, 0, large, LARGE_PARAM_SIZE));
+  execute_and_check(stmt, large, LARGE_PARAM_SIZE);
+  free(large);
+
+  CHECK(drizzle_stmt_set_int(stmt, 0, 54321, false));
+  execute_and_check(stmt, "54321", 5);
+
+  CHECK(drizzle_stmt_close(stmt));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+/*  vim:expandtab:shiftwidth=2:tabstop=2:smarttab:
+ *
+ *  Drizzle Client & Protocol Library
+ *
+ * Copyright (C) 2012 Drizzle Developer Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ *     * The names of its contributors may not be used to endorse or
+ * promote products derived from this software without specific prior
+ * written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include <yatl/lite.h>
+#include "tests/unit/common.h"
+
+#include <libdrizzle-redux/libdrizzle.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_SIZE 2
+
+static const char *query_a = "SELECT ? + 1";
+static const char *query_b = "SELECT ? + 2";
+static const char *query_c = "SELECT ? + 3";
+static const char *query_t = "SELECT a FROM t";
+
+/* Number of statements the server prepared for this session */
+static uint64_t prepare_count(void)
+{
+  drizzle_result_st *result;
+  drizzle_return_t driz_ret;
+  drizzle_row_t row;
+  uint64_t count;
+
+  CHECKED_QUERY("SHOW SESSION STATUS LIKE 'Com_stmt_prepare'");
+  CHECK(drizzle_result_buffer(result));
+  row = drizzle_row_next(result);
+  ASSERT_NOT_NULL_(row, "Could not get the next row");
+  count = strtoull(row[1], NULL, 10);
+  drizzle_result_free(result);
+
+  return count;
+}
+
+static drizzle_stmt_st *prepare_and_run(const char *query, uint32_t value,
+                                        uint32_t expected)
+{
+  drizzle_stmt_st *stmt;
+  drizzle_return_t driz_ret;
+
+  stmt = drizzle_stmt_prepare(con, query, strlen(query), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_stmt_prepare(): %s",
+             drizzle_error(con));
+  CHECK(drizzle_stmt_set_int(stmt, 0, value, false));
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_buffer(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  ASSERT_EQ(expected, drizzle_stmt_get_int(stmt, 0, &driz_ret));
+  ASSERT_EQ(DRIZZLE_RETURN_ROW_END, drizzle_stmt_fetch(stmt));
+
+  return stmt;
+}
+
+/* Value of the one row of table t in the default schema */
+static int32_t read_t(void)
+{
+  drizzle_stmt_st *stmt;
+  drizzle_return_t driz_ret;
+  int32_t value;
+
+  stmt = drizzle_stmt_prepare(con, query_t, strlen(query_t), &driz_ret);
+  ASSERT_EQ_(DRIZZLE_RETURN_OK, driz_ret, "drizzle_stmt_prepare(): %s",
+             drizzle_error(con));
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_buffer(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  value = (int32_t)drizzle_stmt_get_int(stmt, 0, &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  CHECK(drizzle_stmt_close(stmt));
+
+  return value;
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  drizzle_stmt_st *stmt;
+  drizzle_stmt_st *other;
+  drizzle_result_st VARIABLE_IS_NOT_USED *result;
+  drizzle_return_t driz_ret;
+  uint64_t prepared;
+
+  opts = drizzle_options_create();
+  drizzle_options_set_stmt_cache_size(opts, CACHE_SIZE);
+  ASSERT_EQ(CACHE_SIZE, drizzle_options_get_stmt_cache_size(opts));
+
+  /* Skips the test when no server is available */
+  set_up_connection();
+
+  prepared = prepare_count();
+  stmt = prepare_and_run(query_a, 1, 2);
+  CHECK(drizzle_stmt_close(stmt));
+  ASSERT_EQ(prepared + 1, prepare_count());
+
+  /* Preparing the same SQL again is answered from the cache, with the
+     parameters unbound */
+  other = drizzle_stmt_prepare(con, query_a, strlen(query_a), &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  ASSERT_TRUE_(other == stmt, "Cached statement was not reused");
+  ASSERT_EQ(DRIZZLE_RETURN_STMT_ERROR, drizzle_stmt_execute(other));
+  CHECK(drizzle_stmt_set_int(other, 0, 41, false));
+  CHECK(drizzle_stmt_execute(other));
+  CHECK(drizzle_stmt_buffer(other));
+  CHECK(drizzle_stmt_fetch(other));
+  ASSERT_EQ(42, drizzle_stmt_get_int(other, 0, &driz_ret));
+  ASSERT_EQ(prepared + 1, prepare_count());
+
+  /* A statement in use is not handed out twice */
+  stmt = prepare_and_run(query_a, 2, 3);
+  ASSERT_TRUE_(other != stmt, "Statement in use was handed out again");
+  ASSERT_EQ(prepared + 2, prepare_count());
+  CHECK(drizzle_stmt_close(stmt));
+  CHECK(drizzle_stmt_close(other));
+
+  /* Filling the cache evicts the least recently used statement */
+  stmt = prepare_and_run(query_b, 1, 3);
+  CHECK(drizzle_stmt_close(stmt));
+  stmt = prepare_and_run(query_c, 1, 4);
+  CHECK(drizzle_stmt_close(stmt));
+  ASSERT_EQ(prepared + 4, prepare_count());
+  stmt = prepare_and_run(query_c, 2, 5);
+  CHECK(drizzle_stmt_close(stmt));
+  stmt = prepare_and_run(query_a, 2, 3);
+  CHECK(drizzle_stmt_close(stmt));
+  ASSERT_EQ(prepared + 5, prepare_count());
+
+  /* The cursor of a released statement is not handed to the next user */
+  stmt = drizzle_stmt_prepare(con, query_a, strlen(query_a), &driz_ret);
+  ASSERT_EQ(DRIZZLE_RETURN_OK, driz_ret);
+  CHECK(drizzle_stmt_set_int(stmt, 0, 5, false));
+  CHECK(drizzle_stmt_set_cursor(stmt, 1));
+  CHECK(drizzle_stmt_execute(stmt));
+  CHECK(drizzle_stmt_fetch(stmt));
+  ASSERT_EQ(6, drizzle_stmt_get_int(stmt, 0, &driz_ret));
+  CHECK(drizzle_stmt_close(stmt));
+  stmt = prepare_and_run(query_a, 6, 7);
+  CHECK(drizzle_stmt_close(stmt));
+
+  /* The same SQL text prepared under another schema is a different
+     statement */
+  set_up_schema("test_stmt_cache_1");
+  CHECKED_QUERY("CREATE TABLE t (a INT)");
+  CHECKED_QUERY("INSERT INTO t VALUES (1)");
+  set_up_schema("test_stmt_cache_2");
+  CHECKED_QUERY("CREATE TABLE t (a INT)");
+  CHECKED_QUERY("INSERT INTO t VALUES (2)");
+  CHECK(drizzle_select_db(con, "test_stmt_cache_1"));
+  ASSERT_EQ(1, read_t());
+  CHECK(drizzle_select_db(con, "test_stmt_cache_2"));
+  ASSERT_EQ(2, read_t());
+  prepared = prepare_count();
+  CHECK(drizzle_select_db(con, "test_stmt_cache_1"));
+  ASSERT_EQ(1, read_t());
+  ASSERT_EQ(prepared, prepare_count());
+  tear_down_schema("test_stmt_cache_1");
+  tear_down_schema("test_stmt_cache_2");
+
+  /* Reconnecting starts with an empty cache */
+  drizzle_close(con);
+  CHECK(drizzle_connect(con));
+  prepared = prepare_count();
+  stmt = prepare_and_run(query_a, 1, 2);
+  CHECK(drizzle_stmt_close(stmt));
+  ASSERT_EQ(prepared + 1, prepare_count());
+
+  return EXIT_SUCCESS;
+}